@@ -210,9 +210,15 @@ Server config:
                             when the flag is not on the CLI.
 
 Broadcaster config (only relevant when --start-broadcast is on):
-  --broadcast-mode MODE     unicast (default) | subnet | limited
+  --broadcast-mode MODE     unicast (default) | subnet | limited | multicast
   -c, --m_broadcasting-address ADDR   destination for subnet/limited mode
   -b, --broadcasting-port PORT        UDP destination port (default 8765)
+  --multicast-group ADDR    destination for multicast mode
+                            (default 239.255.66.76)
+  --multicast-ttl HOPS      multicast TTL (default 1)
+  --multicast-interface ADDR
+                            local address to multicast from
+                            (default: routing table)
   --program-refresh-ms MS   PROGRAM background refresh period in ms
                             (default 200). On-change pushes are also
                             sent twice ~50 ms apart for Wi-Fi loss
@@ -240,6 +246,7 @@ QoS / diagnostics config (protocol v4):
                      compensation. Best on Wi-Fi for <=10 controllers.
   subnet:            broadcast to --m_broadcasting-address (e.g. 192.168.1.255).
   limited:           broadcast to 255.255.255.255 (often dropped by Wi-Fi APs).
+  multicast:         one packet to --multicast-group, which controllers join.
 
 Examples:
   $(basename "$0") server start --start-http --start-udp --start-broadcast
@@ -947,7 +954,7 @@ cmd_test() {
       info "Running server tests..."
       "$SERVER_BUILD_DIR/tests/api_handler/test_api_handler"
       "$SERVER_BUILD_DIR/tests/state_manager/test_state_manager"
-      "$SERVER_BUILD_DIR/tests/test_audio_buffer_pool"
+      "$SERVER_BUILD_DIR/tests/test_audio_ring"
       "$SERVER_BUILD_DIR/tests/udp/test_udp_protocol"
       "$SERVER_BUILD_DIR/tests/udp/test_udp_request_handler"
       "$SERVER_BUILD_DIR/tests/http/test_mime_types"
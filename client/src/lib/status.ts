@@ -62,6 +62,9 @@ export interface DeviceQos {
   time_sync_outlier_total: number;
   valid_sample_count: number;
   last_applied_program_seq: number;
+  // Receive-buffer slab counters, protocol v6. Absent from older servers.
+  rx_slab_exhausted_total?: number;
+  rx_slab_high_water?: number;
   server_received_at_us: number;
   last_rtt_us: number;
 }
@@ -25,7 +25,7 @@ extern "C" {
 // reserved forever as {version_major, version_minor}. A server of any
 // major version can therefore always read the peer's major version, even
 // when the rest of the message layout has changed.
-#define BEATLED_PROTOCOL_VERSION_MAJOR 5
+#define BEATLED_PROTOCOL_VERSION_MAJOR 6
 #define BEATLED_PROTOCOL_VERSION_MINOR 0
 
 typedef enum {
@@ -42,6 +42,11 @@ typedef enum {
   // Protocol v4: server-initiated diagnostic probe + response.
   BEATLED_MESSAGE_STATUS_REQUEST,
   BEATLED_MESSAGE_STATUS_RESPONSE,
+  // Protocol v5.1: burst time sync.
+  BEATLED_MESSAGE_TIME_BURST_REQUEST,
+  BEATLED_MESSAGE_TIME_BURST_RESPONSE,
+  // Protocol v5.2: the beat grid ahead, so lost NEXT_BEATs don't stutter.
+  BEATLED_MESSAGE_BEAT_SCHEDULE,
   BEATLED_MESSAGE_LAST_VALUE
 } beatled_message_type_t;
 
@@ -71,17 +76,20 @@ typedef struct {
 // the wire layout is computed once. All multi-byte fields are network
 // byte order; the controller htonl/htonll-encodes them at fill time.
 //
-// Sized to 32 B so the extended TEMPO_REQUEST stays well under any
-// realistic UDP MTU on Wi-Fi.
+// Sized to 42 B so the extended TEMPO_REQUEST stays well under any
+// realistic UDP MTU on Wi-Fi. Protocol v6 appended the receive-slab
+// counters (see controller/src/hal/network/include/hal/msg_slab.h).
 typedef struct {
   int64_t current_offset_us;        // controller's view of server-time-offset
   uint64_t uptime_us;               // time_us_64() since boot
   uint32_t median_rtt_us;           // sliding-window median delay (RTT)
   uint32_t next_beat_gap_total;     // cumulative NEXT_BEAT seq gaps observed
-  uint32_t intercore_drop_total;    // cumulative intercore-queue drops
+  uint32_t intercore_drop_total;    // 0: the LED core reads a seqlock, nothing drops
   uint32_t time_sync_outlier_total; // cumulative TIME samples rejected by filter
   uint16_t valid_sample_count;      // current depth of the time-sync ring
   uint16_t last_applied_program_seq;
+  uint32_t rx_slab_exhausted_total; // cumulative datagrams dropped for want of a buffer
+  uint16_t rx_slab_high_water;      // most receive buffers ever in use at once
 } __attribute__((__packed__)) beatled_qos_block_t;
 
 // Tempo message. eCommandType = BEATLED_MESSAGE_TEMPO_REQUEST
@@ -155,6 +163,34 @@ typedef struct {
   uint64_t xmit_time;
 } __attribute__((__packed__)) beatled_message_time_response_t;
 
+// eCommandType = BEATLED_MESSAGE_TIME_BURST_REQUEST
+//
+// Protocol v5.1: one of the closely spaced requests a controller sends to
+// fill its offset filter in one go (after registering, or when its offset
+// jumps) rather than one TIME_REQUEST per refresh. Each sample needs a
+// round trip of its own, so a burst is one datagram per sample each way;
+// `index` numbers the samples so the controller can have all of them
+// outstanding, where it only ever waits on one TIME_REQUEST. A server older
+// than v5.1 answers BEATLED_ERROR_UNKNOWN_MESSAGE_TYPE, and the controller
+// falls back to TIME_REQUEST.
+typedef struct {
+  beatled_message_t base;
+  uint64_t orig_time;
+  uint8_t index;
+} __attribute__((__packed__)) beatled_message_time_burst_request_t;
+
+// eCommandType = BEATLED_MESSAGE_TIME_BURST_RESPONSE
+//
+// TIME_RESPONSE with the request's `index` echoed after the timestamps, so
+// they sit at the same offsets in both.
+typedef struct {
+  beatled_message_t base;
+  uint64_t orig_time;
+  uint64_t recv_time;
+  uint64_t xmit_time;
+  uint8_t index;
+} __attribute__((__packed__)) beatled_message_time_burst_response_t;
+
 // eCommandType = BEATLED_MESSAGE_PROGRAM
 //
 // Protocol v2: gains a sequence number so controllers can ignore stale or
@@ -214,6 +250,59 @@ typedef struct {
   uint32_t epoch;
 } __attribute__((__packed__)) beatled_message_beat_t;
 
+// eCommandType = BEATLED_MESSAGE_BEAT_SCHEDULE
+//
+// Protocol v5.2: the beat grid from `beat_time_ref` on, rather than the one
+// beat NEXT_BEAT announces, so a controller keeps its phase through a burst
+// of lost datagrams and the server can send one every few beats. Beat
+// `beat_count + k` falls beatled_beat_schedule_offset_us(k) after
+// `beat_time_ref` (server clock): each beat is `period_slope_ns` longer than
+// the one before it, which follows a tempo ramp, until `beat_span` beats
+// past the anchor, after which the grid keeps the last period. `seq` and
+// `epoch` work as on NEXT_BEAT, with a counter of their own.
+typedef struct {
+  beatled_message_t base;
+  uint64_t beat_time_ref;
+  uint32_t beat_count;
+  uint32_t tempo_period_us;
+  int32_t period_slope_ns;
+  uint16_t beat_span;
+  uint16_t seq;
+  uint32_t epoch;
+} __attribute__((__packed__)) beatled_message_beat_schedule_t;
+
+// Time from a BEAT_SCHEDULE's `beat_time_ref` to beat `beat_count + k`, in
+// microseconds. The server and the controller both place beats with this,
+// so they agree on the grid to the microsecond.
+static inline int64_t beatled_beat_schedule_offset_us(uint32_t tempo_period_us,
+                                                      int32_t period_slope_ns,
+                                                      uint16_t beat_span, int64_t k) {
+  const int64_t period = tempo_period_us;
+  if (k <= 0 || beat_span == 0) {
+    return k * period;
+  }
+  // Beats 0 .. r-1 ramp: their periods sum to r * period + r(r-1)/2 * slope
+  int64_t r = k < beat_span ? k : beat_span;
+  int64_t offset = r * period + r * (r - 1) / 2 * period_slope_ns / 1000;
+  if (k <= beat_span) {
+    return offset;
+  }
+  int64_t before = (r - 1) * period + (r - 1) * (r - 2) / 2 * period_slope_ns / 1000;
+  return offset + (k - r) * (offset - before);
+}
+
+// Longest ramp a BEAT_SCHEDULE describes. A controller reads a longer
+// `beat_span` as this one.
+#define BEATLED_BEAT_SCHEDULE_MAX_SPAN 64
+
+// Length of beat `beat_count + k` of a BEAT_SCHEDULE, in microseconds
+static inline int64_t beatled_beat_schedule_period_us(uint32_t tempo_period_us,
+                                                      int32_t period_slope_ns,
+                                                      uint16_t beat_span, int64_t k) {
+  return beatled_beat_schedule_offset_us(tempo_period_us, period_slope_ns, beat_span, k + 1) -
+         beatled_beat_schedule_offset_us(tempo_period_us, period_slope_ns, beat_span, k);
+}
+
 // eCommandType = BEATLED_MESSAGE_STATUS_REQUEST
 //
 // Protocol v4: server-initiated probe. The controller echoes
@@ -11,14 +11,37 @@
 // static uint64_t sntp_request_local_time_ref;
 // static uint64_t sntp_server_time_ref_us = 0;
 
+// Server clock model, fitted by command/time.c:
+//
+//   server_time = local_time + server_time_offset
+//                 + server_time_skew_ppb * (local_time - server_time_ref) / 1e9
+//
+// The skew term carries the crystals' frequency difference between syncs,
+// which a constant offset turns into phase error.
 static int64_t server_time_offset = 0;
+static int32_t server_time_skew_ppb = 0;
+static uint64_t server_time_ref = 0;
 
 void set_server_time_offset(int64_t new_server_time_offset) {
-  server_time_offset = new_server_time_offset;
+  set_server_clock_model(new_server_time_offset, 0, 0);
+}
+
+void set_server_clock_model(int64_t offset_us, int32_t skew_ppb,
+                            uint64_t ref_local_time) {
+  server_time_offset = offset_us;
+  server_time_skew_ppb = skew_ppb;
+  server_time_ref = ref_local_time;
 }
 
 int64_t get_server_time_offset() { return server_time_offset; }
 
+int32_t get_server_clock_skew_ppb() { return server_time_skew_ppb; }
+
+int64_t server_time_offset_at(uint64_t local_time) {
+  int64_t elapsed = (int64_t)(local_time - server_time_ref);
+  return server_time_offset + elapsed * server_time_skew_ppb / 1000000000;
+}
+
 // void sntp_set_system_time(uint32_t sec, uint32_t usec) {
 //   puts("Got SNTP response");
 
@@ -48,8 +71,10 @@ bool clock_is_synced() { return server_time_offset != 0; }
 // uint64_t get_sntp_server_time_ref_us() { return sntp_server_time_ref_us; }
 
 uint64_t server_time_to_local_time(uint64_t server_time) {
-  return (server_time_offset > 0) ? server_time - server_time_offset
-                                  : server_time + (-server_time_offset);
+  // The offset is a function of local time; evaluating it at the constant
+  // offset's estimate is off by skew^2 * elapsed, well under 1us.
+  uint64_t local_estimate = server_time - (uint64_t)server_time_offset;
+  return server_time - (uint64_t)server_time_offset_at(local_estimate);
   // return server_time + server_time_offset;
   // return delayed_by_us(sntp_request_local_time_ref,
   //                      server_time - sntp_server_time_ref_us);
@@ -10,8 +10,18 @@ extern "C" {
 
 // void sntp_sync_init(void);
 
+// Sets a constant offset, with no skew
 void set_server_time_offset(int64_t new_server_time_offset);
+// Sets the full model: server time is local time plus `offset_us` at
+// `ref_local_time`, and gains `skew_ppb` ns per second of local time from
+// there
+void set_server_clock_model(int64_t offset_us, int32_t skew_ppb,
+                            uint64_t ref_local_time);
+// Offset at the model's reference time
 int64_t get_server_time_offset();
+int32_t get_server_clock_skew_ppb();
+// Offset at `local_time`, extrapolated with the skew
+int64_t server_time_offset_at(uint64_t local_time);
 uint64_t server_time_to_local_time(uint64_t server_time);
 
 bool clock_is_synced();
@@ -4,16 +4,16 @@
 #include "beatled/protocol.h"
 #include "command/command.h"
 #include "command/next_beat.h"
-#include "command/qos.h"
 #include "command/status.h"
 #include "command/tempo.h"
 #include "command/time.h"
 #include "command/utils.h"
 #include "config/constants.h"
 #include "hal/blink.h"
+#include "hal/msg_slab.h"
 #include "hal/network.h"
 #include "hal/registry.h"
-#include "process/intercore_queue.h"
+#include "process/beat_state.h"
 #include "state_manager/state_manager.h"
 
 // Track the last-seen PROGRAM sequence number to drop late duplicates.
@@ -60,11 +60,7 @@ int command_program(beatled_message_t *server_msg, size_t data_length) {
     return 0;
   }
 
-  intercore_message_t msg = {.message_type = INTERCORE_FLAG_PROGRAM_UPDATE};
-  if (!hal_queue_add_message(intercore_command_queue, &msg)) {
-    qos_intercore_drop_bump();
-    puts("[ERR] Intercore queue full, skipping notification");
-  }
+  beat_state_publish_program(program_id);
 
   return 0;
 }
@@ -117,10 +113,18 @@ int validate_server_message(void *event_data, size_t data_length) {
     err = !(sizeof(beatled_message_time_response_t) == data_length);
     break;
 
+  case BEATLED_MESSAGE_TIME_BURST_RESPONSE:
+    err = !(sizeof(beatled_message_time_burst_response_t) == data_length);
+    break;
+
   case BEATLED_MESSAGE_NEXT_BEAT:
     err = !(sizeof(beatled_message_next_beat_t) == data_length);
     break;
 
+  case BEATLED_MESSAGE_BEAT_SCHEDULE:
+    err = !(sizeof(beatled_message_beat_schedule_t) == data_length);
+    break;
+
   case BEATLED_MESSAGE_STATUS_REQUEST:
     err = !(sizeof(beatled_message_status_request_t) == data_length);
     break;
@@ -171,10 +175,18 @@ int handle_server_message(void *event_data, size_t data_length, uint64_t dest_ti
     err = process_time_msg(server_msg, data_length, dest_time);
     break;
 
+  case BEATLED_MESSAGE_TIME_BURST_RESPONSE:
+    err = process_time_burst_msg(server_msg, data_length, dest_time);
+    break;
+
   case BEATLED_MESSAGE_NEXT_BEAT:
     err = process_next_beat_msg(server_msg, data_length);
     break;
 
+  case BEATLED_MESSAGE_BEAT_SCHEDULE:
+    err = process_beat_schedule_msg(server_msg, data_length);
+    break;
+
   case BEATLED_MESSAGE_STATUS_REQUEST:
     err = process_status_request(server_msg, data_length);
     break;
@@ -229,9 +241,13 @@ int handle_event(event_t *event) {
   }
   // puts("Event handled.");
   if (event->data != NULL) {
-    // puts("Deleteing event data.");
-    // printf("Freeing memory at %x\n", event->data);
-    free(event->data);
+    // Datagrams come from the receive slab; state transitions (and the
+    // autotest and test harnesses) hand over heap memory.
+    if (msg_slab_owns(event->data)) {
+      msg_slab_free(event->data);
+    } else {
+      free(event->data);
+    }
   }
 
   return err;
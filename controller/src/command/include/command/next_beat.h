@@ -7,8 +7,11 @@
 
 int process_next_beat_msg(beatled_message_t *server_msg, size_t data_length);
 
-// Total NEXT_BEAT broadcasts the controller knows it missed, derived from
-// the protocol-v2 sequence number gaps. Exposed for status/log heartbeats
+// Protocol v5.2: adopts the server's beat grid for the next few beats
+int process_beat_schedule_msg(beatled_message_t *server_msg, size_t data_length);
+
+// Total NEXT_BEAT and BEAT_SCHEDULE broadcasts the controller knows it
+// missed, derived from the protocol-v2 sequence number gaps. Exposed for status/log heartbeats
 // and integration tests.
 uint32_t next_beat_get_gap_total(void);
 
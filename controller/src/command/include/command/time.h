@@ -1,6 +1,7 @@
 #ifndef COMMAND__TIME__TIME_H
 #define COMMAND__TIME__TIME_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -12,6 +13,19 @@ int validate_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_
 
 int process_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t dest_time);
 
+int process_time_burst_msg(beatled_message_t *server_msg, size_t data_length,
+                           uint64_t dest_time);
+
+// Refill the offset filter in one go: closely spaced TIME_BURST_REQUESTs,
+// one per ring slot, instead of one TIME_REQUEST per refresh. Runs on
+// entering REGISTERED and when the offset jumps; restarts a burst already
+// running. Non-zero if the burst timer can't be allocated.
+int time_sync_start_burst(void);
+
+// Whether a burst's timer is still running (cancelled once every response
+// is in, or a second after the last request when some were lost).
+bool time_sync_burst_active(void);
+
 // Current estimate of one-way delay (server↔controller) in microseconds,
 // computed as median(RTT)/2 across the sliding sample ring. Returns 0
 // before the ring has any valid samples. Used by TEMPO_REQUEST to report
@@ -39,4 +53,8 @@ void time_sync_reset_for_testing(void);
 // process_time_msg without going through the real prepare/send path.
 void time_sync_seed_outstanding_for_testing(uint64_t orig_time);
 
+// Fire the burst timer once: sends the burst's next request. Tests use this
+// in place of the timer.
+void time_sync_burst_tick_for_testing(void);
+
 #endif // COMMAND__TIME__TIME_H
\ No newline at end of file
@@ -5,24 +5,87 @@
 #include "config/constants.h"
 #include "clock/clock.h"
 #include "command/next_beat.h"
-#include "command/qos.h"
 #include "command/utils.h"
 #include "hal/network.h"
 #include "hal/registry.h"
-#include "process/intercore_queue.h"
+#include "process/beat_state.h"
 #include "state_manager/state_manager.h"
 
 // Track the last-seen sequence number to detect packet loss. Wraparound is
 // handled by treating the signed 16-bit difference as the actual increment.
-static uint16_t last_next_beat_seq = 0;
-static uint32_t last_next_beat_epoch = 0;
-static bool have_seen_next_beat = false;
+// NEXT_BEAT and BEAT_SCHEDULE are numbered by separate server counters.
+typedef struct {
+  uint16_t last_seq;
+  uint32_t last_epoch;
+  bool seen;
+} seq_tracker_t;
+
+static seq_tracker_t next_beat_seq = {0};
+static seq_tracker_t beat_schedule_seq = {0};
 static uint32_t next_beat_gap_total = 0;
 
 uint32_t next_beat_get_gap_total(void) {
   return next_beat_gap_total;
 }
 
+// Sequence-gap accounting, scoped to one server-boot epoch. (int16_t) cast
+// handles 16-bit wrap correctly. A new epoch means the server restarted and
+// reset its seq counter; re-anchor without rejecting the message or logging
+// the reset as a flood of lost beats (see protocol v5). Returns false for a
+// stale or duplicate message, which must not be applied.
+static bool accept_seq(seq_tracker_t *tracker, uint16_t seq, uint32_t epoch, const char *name) {
+  if (tracker->seen && epoch == tracker->last_epoch) {
+    int16_t delta = (int16_t)(seq - tracker->last_seq);
+    if (delta <= 0) {
+#if BEATLED_VERBOSE_LOG
+      printf("[CMD] Stale %s seq=%u (last=%u), dropping\n", name, seq, tracker->last_seq);
+#endif
+      return false;
+    }
+    if (delta > 1) {
+      uint32_t lost = (uint32_t)delta - 1;
+      next_beat_gap_total += lost;
+#if BEATLED_VERBOSE_LOG
+      printf("[CMD] %s gap: %" PRIu32 " missed (seq %u -> %u, total=%" PRIu32 ")\n", name, lost,
+             tracker->last_seq, seq, next_beat_gap_total);
+#endif
+    }
+  }
+  (void)name;
+  tracker->last_seq = seq;
+  tracker->last_epoch = epoch;
+  tracker->seen = true;
+  return true;
+}
+
+// How far the ramp of a BEAT_SCHEDULE may take the period from
+// `tempo_period_us`, in percent. The server limits its slope to 1% of the
+// period per beat over a few beats; this only stops a schedule whose
+// periods reach zero, which would leave the LED core's grid stuck.
+#define BEAT_SCHEDULE_MAX_RAMP_PERCENT 25
+
+static bool schedule_is_sane(uint32_t tempo_period_us, int32_t period_slope_ns,
+                             uint16_t beat_span) {
+  if (beat_span == 0) {
+    return true;
+  }
+  // The ramp is linear, so its last period bounds all the others
+  int64_t last_period_us =
+      beatled_beat_schedule_period_us(tempo_period_us, period_slope_ns, beat_span, beat_span - 1);
+  int64_t max_drift_us = (int64_t)tempo_period_us * BEAT_SCHEDULE_MAX_RAMP_PERCENT / 100;
+  return last_period_us > 0 && llabs(last_period_us - (int64_t)tempo_period_us) <= max_drift_us;
+}
+
+static int enter_tempo_synced(void) {
+  if (state_manager_get_state() != STATE_TEMPO_SYNCED) {
+    if (!schedule_state_transition(STATE_TEMPO_SYNCED)) {
+      BEATLED_FATAL("Failed to schedule transition to tempo synced state");
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int process_next_beat_msg(beatled_message_t *server_msg, size_t data_length) {
 
   if (!check_size(data_length, sizeof(beatled_message_next_beat_t))) {
@@ -42,31 +105,9 @@ int process_next_beat_msg(beatled_message_t *server_msg, size_t data_length) {
   uint16_t seq = ntohs(next_beat_msg->seq);
   uint32_t epoch = ntohl(next_beat_msg->epoch);
 
-  // Sequence-gap accounting, scoped to one server-boot epoch. (int16_t) cast
-  // handles 16-bit wrap correctly. A new epoch means the server restarted and
-  // reset its seq counter; re-anchor without rejecting the message or logging
-  // the reset as a flood of lost beats (see protocol v5).
-  if (have_seen_next_beat && epoch == last_next_beat_epoch) {
-    int16_t delta = (int16_t)(seq - last_next_beat_seq);
-    if (delta <= 0) {
-      // Stale or duplicate (older or same seq) — drop without applying.
-#if BEATLED_VERBOSE_LOG
-      printf("[CMD] Stale NEXT_BEAT seq=%u (last=%u), dropping\n", seq, last_next_beat_seq);
-#endif
-      return 0;
-    }
-    if (delta > 1) {
-      uint32_t lost = (uint32_t)delta - 1;
-      next_beat_gap_total += lost;
-#if BEATLED_VERBOSE_LOG
-      printf("[CMD] NEXT_BEAT gap: %" PRIu32 " missed (seq %u -> %u, total=%" PRIu32 ")\n", lost,
-             last_next_beat_seq, seq, next_beat_gap_total);
-#endif
-    }
+  if (!accept_seq(&next_beat_seq, seq, epoch, "NEXT_BEAT")) {
+    return 0;
   }
-  last_next_beat_seq = seq;
-  last_next_beat_epoch = epoch;
-  have_seen_next_beat = true;
 
 #if BEATLED_VERBOSE_LOG
   printf("[CMD] Next beat: seq=%u ref=%llu (in %lld us) beat=%" PRIu32 "\n", seq,
@@ -74,27 +115,87 @@ int process_next_beat_msg(beatled_message_t *server_msg, size_t data_length) {
          beat_count);
 #endif
 
-  if (state_manager_get_state() != STATE_TEMPO_SYNCED) {
-    if (!schedule_state_transition(STATE_TEMPO_SYNCED)) {
-      BEATLED_FATAL("Failed to schedule transition to tempo synced state");
-      return 1;
-    }
+  if (enter_tempo_synced()) {
+    return 1;
   }
 
   registry_lock_mutex();
   registry.next_beat_time_ref = next_beat_time_ref;
   registry.beat_count = beat_count;
+  // A NEXT_BEAT replaces any schedule: the grid goes back to a flat period.
+  registry.period_slope_ns = 0;
+  registry.beat_span = 0;
   // Note: tempo_period_us and program_id are no longer carried on NEXT_BEAT
   // (protocol v2). They come from TEMPO_RESPONSE and PROGRAM push.
   registry.update_timestamp = time_us_64();
   registry_unlock_mutex();
 
-  intercore_message_t msg = {.message_type = INTERCORE_FLAG_TIME_REF_UPDATE};
+  beat_state_publish_next_beat(next_beat_time_ref, beat_count);
+
+  return 0;
+}
+
+int process_beat_schedule_msg(beatled_message_t *server_msg, size_t data_length) {
+
+  if (!check_size(data_length, sizeof(beatled_message_beat_schedule_t))) {
+    return 1;
+  }
+
+  int current_state = state_manager_get_state();
+  if (current_state != STATE_TIME_SYNCED && current_state != STATE_TEMPO_SYNCED) {
+    return 0;
+  }
+
+  beatled_message_beat_schedule_t *schedule_msg = (beatled_message_beat_schedule_t *)server_msg;
 
-  if (!hal_queue_add_message(intercore_command_queue, &msg)) {
-    qos_intercore_drop_bump();
-    puts("[ERR] Intercore queue full, skipping notification");
+  uint64_t beat_time_ref = server_time_to_local_time(ntohll(schedule_msg->beat_time_ref));
+  uint32_t beat_count = ntohl(schedule_msg->beat_count);
+  uint32_t tempo_period_us = ntohl(schedule_msg->tempo_period_us);
+  int32_t period_slope_ns = (int32_t)ntohl((uint32_t)schedule_msg->period_slope_ns);
+  uint16_t beat_span = ntohs(schedule_msg->beat_span);
+  uint16_t seq = ntohs(schedule_msg->seq);
+  uint32_t epoch = ntohl(schedule_msg->epoch);
+
+  if (tempo_period_us == 0) {
+    // No grid to follow (the server lost the tempo); keep the current one
+    return 0;
   }
 
+  if (beat_span > BEATLED_BEAT_SCHEDULE_MAX_SPAN) {
+    beat_span = BEATLED_BEAT_SCHEDULE_MAX_SPAN;
+  }
+  if (!schedule_is_sane(tempo_period_us, period_slope_ns, beat_span)) {
+    printf("[ERR] Beat schedule ramps out of range: period=%" PRIu32 " us slope=%" PRId32
+           " ns span=%u\n",
+           tempo_period_us, period_slope_ns, beat_span);
+    return 1;
+  }
+
+  if (!accept_seq(&beat_schedule_seq, seq, epoch, "BEAT_SCHEDULE")) {
+    return 0;
+  }
+
+#if BEATLED_VERBOSE_LOG
+  printf("[CMD] Beat schedule: seq=%u ref=%llu beat=%" PRIu32 " period=%" PRIu32
+         " us slope=%" PRId32 " ns span=%u\n",
+         seq, beat_time_ref, beat_count, tempo_period_us, period_slope_ns, beat_span);
+#endif
+
+  if (enter_tempo_synced()) {
+    return 1;
+  }
+
+  registry_lock_mutex();
+  registry.next_beat_time_ref = beat_time_ref;
+  registry.beat_count = beat_count;
+  registry.tempo_period_us = tempo_period_us;
+  registry.period_slope_ns = period_slope_ns;
+  registry.beat_span = beat_span;
+  registry.update_timestamp = time_us_64();
+  registry_unlock_mutex();
+
+  beat_state_publish_schedule(beat_time_ref, beat_count, tempo_period_us, period_slope_ns,
+                              beat_span);
+
   return 0;
 }
@@ -9,7 +9,7 @@
 #include "hal/network.h"
 #include "hal/registry.h"
 #include "hal/udp.h"
-#include "process/intercore_queue.h"
+#include "process/beat_state.h"
 #include "state_manager/state_manager.h"
 
 int prepare_tempo_request(void *buffer_payload, size_t buf_len) {
@@ -77,13 +77,8 @@ int process_tempo_msg(beatled_message_t *server_msg, size_t data_length) {
   //                                      .registry_update_fields =
   //                                          (0x01 << REGISTRY_UPDATE_TEMPO)};
 
-  intercore_message_t msg = {.message_type =
-                                 INTERCORE_FLAG_TEMPO_UPDATE | INTERCORE_FLAG_PROGRAM_UPDATE};
-
-  if (!hal_queue_add_message(intercore_command_queue, &msg)) {
-    qos_intercore_drop_bump();
-    puts("[ERR] Intercore queue full, skipping notification");
-  }
+  beat_state_publish_tempo(tempo_period_us, time_us_64());
+  beat_state_publish_program(program_id);
 
   return 0;
 }
\ No newline at end of file
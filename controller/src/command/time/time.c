@@ -6,6 +6,7 @@
 #include "command/utils.h"
 #include "config/constants.h"
 #include "hal/network.h"
+#include "hal/time.h"
 #include "hal/udp.h"
 #include "state_manager/state_manager.h"
 #include "state_manager/states.h"
@@ -19,12 +20,28 @@
 // ones whose measured delay is more than 2x the median (a Wi-Fi retransmit
 // outlier), and apply the median offset of what remains.
 //
-// The window is small (TIME_SYNC_SAMPLES) because the refresh interval is now
-// short (5s) so a fresh-enough median takes ~30-40s to converge after boot.
+// The window is small (TIME_SYNC_SAMPLES). At one sample per refresh the
+// ring would take minutes to fill after boot, so it is filled by a burst
+// instead (below).
+//
+// The kept samples are also fitted for skew, the crystals' frequency
+// difference (Theil-Sen: the median of the slopes between every pair of
+// samples at least TIME_SKEW_MIN_SPAN_US apart). The applied offset is the
+// median of the kept samples' offsets carried forward to the newest sample
+// along that slope, and clock.c extrapolates it from there. Between
+// refreshes the phase error then only grows with the error in the skew, not
+// with the skew itself: 50 ppm is 2.5ms over a 50s refresh.
 
 #define TIME_SYNC_SAMPLES 8
 
+// Pairs closer than this (a burst) measure noise, not skew.
+#define TIME_SKEW_MIN_SPAN_US 10000000
+// Crystals are within +-50 ppm of each other; anything past this is a fit
+// gone wrong.
+#define TIME_SKEW_MAX_PPB 500000
+
 typedef struct {
+  uint64_t local_time_us; // midpoint of the round trip, local clock
   uint64_t delay_us;
   int64_t offset_us;
   bool valid;
@@ -44,6 +61,49 @@ static uint32_t time_sync_outlier_total_ = 0;
 static uint64_t outstanding_orig_time = 0;
 static bool have_outstanding_request = false;
 
+// Local time of the first sample the skew fit may use. Moved up past an
+// offset jump, since pairs across it would read the step as skew.
+static uint64_t skew_fit_start = 0;
+
+// Whether the model's skew was fitted from pairs since skew_fit_start.
+// Until it is (e.g. right after a burst, whose samples are too close
+// together to measure it), the clocks may have drifted apart by any
+// plausible skew since the last sample.
+static bool skew_fitted = false;
+
+// --- Burst sync ------------------------------------------------------------
+//
+// A burst sends TIME_BURST_SIZE TIME_BURST_REQUESTs TIME_BURST_SPACING_US
+// apart, and the server answers each, so the whole ring is refilled in well
+// under a second. It runs on entering REGISTERED, and when a sample that is
+// not an outlier lands further from the model's offset than its delay can
+// explain: a jump the median would otherwise take 4 refreshes (over 3
+// minutes) to follow. The spacing keeps a request from queueing behind the previous one
+// on the link, which would skew every sample the same way.
+//
+// The first request goes out at the start, the others from the burst timer.
+// The responses, and everything that cancels the timer, are handled on the
+// event loop. A request's slot holds its orig_time before the request is
+// sent, so any response that echoes it is genuine, in whatever order the
+// responses come back.
+
+#define TIME_BURST_SIZE TIME_SYNC_SAMPLES
+#define TIME_BURST_SPACING_US 20000
+// A burst whose last responses were lost is reaped this long after its last
+// request went out.
+#define TIME_BURST_TIMEOUT_US 1000000
+// A clean sample's offset is within its delay (<= 2x the median) of the
+// truth, and so is the applied median's. Past that plus this margin the
+// clock has moved.
+#define TIME_JUMP_MARGIN_US 2000
+
+static hal_alarm_t *burst_alarm = NULL;
+static uint64_t burst_orig_times[TIME_BURST_SIZE];
+static bool burst_answered[TIME_BURST_SIZE];
+static size_t burst_sent = 0;
+static size_t burst_received = 0;
+static uint64_t burst_start_time = 0;
+
 static int compare_uint64(const void *a, const void *b) {
   uint64_t x = *(const uint64_t *)a;
   uint64_t y = *(const uint64_t *)b;
@@ -71,12 +131,28 @@ static uint64_t median_delay(void) {
   return delays[n / 2];
 }
 
+static void stop_time_burst(void) {
+  if (burst_alarm) {
+    hal_cancel_repeating_timer(burst_alarm);
+    burst_alarm = NULL;
+  }
+}
+
 void time_sync_reset_for_testing(void) {
+  stop_time_burst();
+  for (size_t i = 0; i < TIME_BURST_SIZE; i++) {
+    burst_orig_times[i] = 0;
+    burst_answered[i] = false;
+  }
+  burst_sent = 0;
+  burst_received = 0;
   for (size_t i = 0; i < TIME_SYNC_SAMPLES; i++) {
     samples[i].valid = false;
   }
   sample_write_idx = 0;
   valid_sample_count = 0;
+  skew_fit_start = 0;
+  skew_fitted = false;
   outstanding_orig_time = 0;
   have_outstanding_request = false;
   time_sync_outlier_total_ = 0;
@@ -108,8 +184,11 @@ uint32_t time_sync_owd_estimate_us(void) {
   return owd > UINT32_MAX ? UINT32_MAX : (uint32_t)owd;
 }
 
-static int64_t median_offset_excluding_outliers(uint64_t delay_threshold) {
-  int64_t offsets[TIME_SYNC_SAMPLES];
+// Fits the clock model to the samples within `delay_threshold` and applies
+// it. Skew comes from the pairs of samples taken since skew_fit_start, or
+// stays as it was when there are none.
+static int64_t fit_clock_model(uint64_t delay_threshold) {
+  const time_sample_t *kept[TIME_SYNC_SAMPLES];
   size_t n = 0;
   size_t rejected = 0;
   for (size_t i = 0; i < TIME_SYNC_SAMPLES; i++) {
@@ -117,22 +196,62 @@ static int64_t median_offset_excluding_outliers(uint64_t delay_threshold) {
       continue;
     }
     if (samples[i].delay_us <= delay_threshold) {
-      offsets[n++] = samples[i].offset_us;
+      kept[n++] = &samples[i];
     } else {
       rejected++;
     }
   }
   // Saturating bump — the wire field is uint32_t so wrapping at UINT32_MAX
   // is preferable to a UB increment past the max.
-  if (rejected > 0 && time_sync_outlier_total_ + rejected >= time_sync_outlier_total_) {
+  if (time_sync_outlier_total_ + rejected >= time_sync_outlier_total_) {
     time_sync_outlier_total_ += (uint32_t)rejected;
   } else {
     time_sync_outlier_total_ = UINT32_MAX;
   }
   if (n == 0) {
-    return 0;
+    return get_server_time_offset();
+  }
+
+  int64_t slopes[TIME_SYNC_SAMPLES * (TIME_SYNC_SAMPLES - 1) / 2];
+  size_t n_slopes = 0;
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = i + 1; j < n; j++) {
+      const time_sample_t *a = kept[i];
+      const time_sample_t *b = kept[j];
+      if (a->local_time_us < skew_fit_start || b->local_time_us < skew_fit_start) {
+        continue;
+      }
+      int64_t span = (int64_t)(b->local_time_us - a->local_time_us);
+      int64_t rise = b->offset_us - a->offset_us;
+      // The second test keeps rise * 1e9 in range
+      if ((span < TIME_SKEW_MIN_SPAN_US && span > -TIME_SKEW_MIN_SPAN_US) ||
+          rise > INT64_MAX / 1000000000 || rise < -(INT64_MAX / 1000000000)) {
+        continue;
+      }
+      slopes[n_slopes++] = rise * 1000000000 / span;
+    }
+  }
+  int64_t skew_ppb = get_server_clock_skew_ppb();
+  if (n_slopes > 0) {
+    skew_fitted = true;
+    qsort(slopes, n_slopes, sizeof(int64_t), compare_int64);
+    skew_ppb = slopes[n_slopes / 2];
+    if (skew_ppb > TIME_SKEW_MAX_PPB) {
+      skew_ppb = TIME_SKEW_MAX_PPB;
+    } else if (skew_ppb < -TIME_SKEW_MAX_PPB) {
+      skew_ppb = -TIME_SKEW_MAX_PPB;
+    }
+  }
+
+  uint64_t ref_time = samples[(sample_write_idx + TIME_SYNC_SAMPLES - 1) % TIME_SYNC_SAMPLES]
+                          .local_time_us;
+  int64_t offsets[TIME_SYNC_SAMPLES];
+  for (size_t i = 0; i < n; i++) {
+    int64_t elapsed = (int64_t)(ref_time - kept[i]->local_time_us);
+    offsets[i] = kept[i]->offset_us + elapsed * skew_ppb / 1000000000;
   }
   qsort(offsets, n, sizeof(int64_t), compare_int64);
+  set_server_clock_model(offsets[n / 2], (int32_t)skew_ppb, ref_time);
   return offsets[n / 2];
 }
 
@@ -163,38 +282,109 @@ int send_time_request() {
   return send_udp_request(sizeof(beatled_message_time_request_t), &prepare_time_request);
 }
 
-int validate_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t dest_time) {
-  if (!check_size(data_length, sizeof(beatled_message_time_response_t))) {
+static int prepare_time_burst_request(void *buffer_payload, size_t buf_len) {
+  if (buf_len != sizeof(beatled_message_time_burst_request_t)) {
+    printf("[ERR] Time burst request size mismatch: %zu vs %zu\n", buf_len,
+           sizeof(beatled_message_time_burst_request_t));
     return 1;
   }
+
+  beatled_message_time_burst_request_t *msg = buffer_payload;
+  msg->base.type = BEATLED_MESSAGE_TIME_BURST_REQUEST;
+  uint64_t orig_time = time_us_64();
+  msg->orig_time = htonll(orig_time);
+  msg->index = (uint8_t)burst_sent;
+  burst_orig_times[burst_sent] = orig_time;
   return 0;
 }
 
-int process_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t dest_time) {
-  if (!check_size(data_length, sizeof(beatled_message_time_response_t))) {
+static void time_burst_timer_callback(void *data) {
+  // The timer keeps firing after the last request until the event loop
+  // cancels it
+  if (burst_sent >= TIME_BURST_SIZE) {
+    return;
+  }
+  send_udp_request(sizeof(beatled_message_time_burst_request_t), &prepare_time_burst_request);
+  burst_sent++;
+}
+
+void time_sync_burst_tick_for_testing(void) { time_burst_timer_callback(NULL); }
+
+int time_sync_start_burst(void) {
+  stop_time_burst();
+  for (size_t i = 0; i < TIME_BURST_SIZE; i++) {
+    burst_orig_times[i] = 0;
+    burst_answered[i] = false;
+  }
+  burst_sent = 0;
+  burst_received = 0;
+  burst_start_time = time_us_64();
+
+  // The first request goes out now, the timer sends the rest
+  time_burst_timer_callback(NULL);
+  burst_alarm = hal_add_repeating_timer(TIME_BURST_SPACING_US, &time_burst_timer_callback, NULL);
+  if (!burst_alarm) {
+    puts("[ERR] Failed to allocate time burst alarm");
     return 1;
   }
-  beatled_message_time_response_t *time_resp_msg = (beatled_message_time_response_t *)server_msg;
+  printf("[CMD] Time sync burst of %d requests\n", TIME_BURST_SIZE);
+  return 0;
+}
 
-  uint64_t orig_time = ntohll(time_resp_msg->orig_time);
-  uint64_t recv_time = ntohll(time_resp_msg->recv_time);
-  uint64_t xmit_time = ntohll(time_resp_msg->xmit_time);
+bool time_sync_burst_active(void) { return burst_alarm != NULL; }
 
-  // A2 prerequisite (A3): drop stale duplicate responses. If the echoed
-  // orig_time doesn't match the most-recently-sent one, this is a delayed
-  // response from a prior request — applying it would corrupt the offset.
-  if (!have_outstanding_request || orig_time != outstanding_orig_time) {
-    printf("[CMD] Stale TIME_RESPONSE orig=%llu (expected %llu), dropping\n",
-           (unsigned long long)orig_time, (unsigned long long)outstanding_orig_time);
-    return 0;
+static void reap_time_burst(void) {
+  if (!burst_alarm) {
+    return;
   }
-  have_outstanding_request = false;
+  uint64_t deadline =
+      burst_start_time + TIME_BURST_SIZE * TIME_BURST_SPACING_US + TIME_BURST_TIMEOUT_US;
+  if (burst_received == TIME_BURST_SIZE || time_us_64() > deadline) {
+    stop_time_burst();
+  }
+}
+
+// Whether a new sample says the clock moved, rather than that the link was
+// slow. Only judged once the ring is full and no burst is refilling it.
+static bool is_offset_jump(uint64_t local_time, uint64_t delay, int64_t offset) {
+  if (burst_alarm || valid_sample_count < TIME_SYNC_SAMPLES) {
+    return false;
+  }
+  uint64_t med_delay = median_delay();
+  if (delay > 2 * med_delay) {
+    return false; // an outlier, which the filter drops anyway
+  }
+  int64_t step = offset - server_time_offset_at(local_time);
+  uint64_t distance = step < 0 ? (uint64_t)-step : (uint64_t)step;
+  uint64_t tolerance = 2 * med_delay + TIME_JUMP_MARGIN_US;
+  if (!skew_fitted) {
+    // Unknown skew: a step it could explain is drift, which this sample
+    // lets the fit measure. Calling it a jump would burst, and the burst
+    // would leave the skew unknown again.
+    uint64_t newest =
+        samples[(sample_write_idx + TIME_SYNC_SAMPLES - 1) % TIME_SYNC_SAMPLES].local_time_us;
+    uint64_t elapsed = local_time > newest ? local_time - newest : 0;
+    // In ms first, so years of it stay in range
+    tolerance += elapsed / 1000 * TIME_SKEW_MAX_PPB / 1000000;
+  }
+  return distance > tolerance;
+}
 
+// Feeds one round trip to the filter and applies the new median offset
+static int add_time_sample(uint64_t orig_time, uint64_t recv_time, uint64_t xmit_time,
+                           uint64_t dest_time) {
   uint64_t delay = (dest_time - orig_time) - (xmit_time - recv_time);
   int64_t clock_offset = ((int64_t)(recv_time / 2) - (int64_t)(orig_time / 2)) +
                          ((int64_t)(xmit_time / 2) - (int64_t)(dest_time / 2));
+  uint64_t local_time = orig_time + (dest_time - orig_time) / 2;
+  bool jumped = is_offset_jump(local_time, delay, clock_offset);
+  if (jumped) {
+    skew_fit_start = local_time;
+    skew_fitted = false;
+  }
 
   // Append to the ring.
+  samples[sample_write_idx].local_time_us = local_time;
   samples[sample_write_idx].delay_us = delay;
   samples[sample_write_idx].offset_us = clock_offset;
   samples[sample_write_idx].valid = true;
@@ -206,14 +396,18 @@ int process_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t
   uint64_t med_delay = median_delay();
   // Reject anything > 2x the median delay as a likely Wi-Fi retransmit.
   uint64_t threshold = med_delay * 2 > med_delay ? med_delay * 2 : UINT64_MAX;
-  int64_t med_offset = median_offset_excluding_outliers(threshold);
+  int64_t med_offset = fit_clock_model(threshold);
 
   printf("[CMD] Time sync: delay=%lluus offset=%lldus "
-         "(med_delay=%lluus med_offset=%lldus n=%zu)\n",
+         "(med_delay=%lluus med_offset=%lldus skew=%ldppb n=%zu)\n",
          (unsigned long long)delay, (long long)clock_offset, (unsigned long long)med_delay,
-         (long long)med_offset, valid_sample_count);
+         (long long)med_offset, (long)get_server_clock_skew_ppb(), valid_sample_count);
 
-  set_server_time_offset(med_offset);
+  if (jumped) {
+    printf("[CMD] Time offset jumped by %lldus, resyncing\n",
+           (long long)(clock_offset - med_offset));
+    time_sync_start_burst();
+  }
 
   if (state_manager_get_state() < STATE_TIME_SYNCED) {
     if (!schedule_state_transition(STATE_TIME_SYNCED)) {
@@ -223,4 +417,64 @@ int process_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t
   }
 
   return 0;
+}
+
+int validate_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t dest_time) {
+  if (!check_size(data_length, sizeof(beatled_message_time_response_t))) {
+    return 1;
+  }
+  return 0;
+}
+
+int process_time_msg(beatled_message_t *server_msg, size_t data_length, uint64_t dest_time) {
+  if (!check_size(data_length, sizeof(beatled_message_time_response_t))) {
+    return 1;
+  }
+  beatled_message_time_response_t *time_resp_msg = (beatled_message_time_response_t *)server_msg;
+
+  uint64_t orig_time = ntohll(time_resp_msg->orig_time);
+  uint64_t recv_time = ntohll(time_resp_msg->recv_time);
+  uint64_t xmit_time = ntohll(time_resp_msg->xmit_time);
+
+  // A2 prerequisite (A3): drop stale duplicate responses. If the echoed
+  // orig_time doesn't match the most-recently-sent one, this is a delayed
+  // response from a prior request — applying it would corrupt the offset.
+  if (!have_outstanding_request || orig_time != outstanding_orig_time) {
+    printf("[CMD] Stale TIME_RESPONSE orig=%llu (expected %llu), dropping\n",
+           (unsigned long long)orig_time, (unsigned long long)outstanding_orig_time);
+    return 0;
+  }
+  have_outstanding_request = false;
+
+  int err = add_time_sample(orig_time, recv_time, xmit_time, dest_time);
+  reap_time_burst();
+  return err;
+}
+
+int process_time_burst_msg(beatled_message_t *server_msg, size_t data_length,
+                           uint64_t dest_time) {
+  if (!check_size(data_length, sizeof(beatled_message_time_burst_response_t))) {
+    return 1;
+  }
+  beatled_message_time_burst_response_t *burst_resp_msg =
+      (beatled_message_time_burst_response_t *)server_msg;
+
+  uint64_t orig_time = ntohll(burst_resp_msg->orig_time);
+  uint8_t index = burst_resp_msg->index;
+
+  // Same stale-duplicate check as TIME_RESPONSE, per burst slot. A response
+  // to an earlier burst doesn't match its slot's new orig_time.
+  if (index >= TIME_BURST_SIZE || burst_answered[index] || orig_time == 0 ||
+      orig_time != burst_orig_times[index]) {
+    printf("[CMD] Stale TIME_BURST_RESPONSE index=%u orig=%llu, dropping\n", index,
+           (unsigned long long)orig_time);
+    return 0;
+  }
+  burst_answered[index] = true;
+  burst_received++;
+
+  int err = add_time_sample(orig_time, ntohll(burst_resp_msg->recv_time),
+                            ntohll(burst_resp_msg->xmit_time), dest_time);
+  reap_time_burst();
+  return err;
 }
\ No newline at end of file
@@ -18,13 +18,6 @@
 #define LED_CORE_SLEEP_MS 10
 #define CONTROL_CORE_SLEEP_MS 20
 
-// Headroom for the LED loop blocking on output_strings_dma. Each NEXT_BEAT
-// now queues a single message (protocol v2 dropped the redundant tempo /
-// program bits from the per-beat update), so 128 covers ~minutes of producer
-// activity even if the consumer blocks pathologically long. Producers still
-// drop-newest on overflow, but at the new rates that case should be rare.
-#define MAX_INTERCORE_QUEUE_COUNT 128
-
 // LED messages
 #define ERROR_BLINK_SPEED 100
 #define MESSAGE_BLINK_SPEED 400
@@ -40,6 +33,14 @@
 #define UDP_SERVER_PORT 9090
 #define UDP_PORT 8765
 
+// Group the server's --broadcast-mode=multicast sends to (its
+// --multicast-group default). Ports that support it join the group on
+// UDP_PORT at startup; a member costs nothing while the server uses another
+// mode. Empty disables the join.
+#ifndef UDP_MULTICAST_GROUP
+#define UDP_MULTICAST_GROUP "239.255.66.76"
+#endif
+
 // Verbose logging for [LED], [TEMPO], [QUEUE] debug prints.
 // On by default for POSIX development builds, off on Pico.
 #ifndef BEATLED_VERBOSE_LOG
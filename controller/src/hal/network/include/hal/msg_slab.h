@@ -0,0 +1,83 @@
+#ifndef HAL__MSG_SLAB_H
+#define HAL__MSG_SLAB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "beatled/protocol.h"
+
+// Fixed-size blocks for received datagrams. Every network port takes the
+// buffer it hands to the event queue from here instead of the heap, and
+// handle_event returns it once the message is dispatched, so a burst of
+// broadcasts can't fragment a small heap and no allocator runs in the
+// receive path right after rx_time_us is stamped.
+//
+// Alloc and free may run concurrently on any thread, core or interrupt:
+// the free list is C11 atomics, lock-free wherever the core has a
+// compare-exchange (POSIX, ESP32, RP2350). On the RP2040 pico_atomic backs
+// it with a hardware spinlock held for a few instructions.
+
+// Any message the protocol defines fits in one block; a longer datagram is
+// not a valid message and is dropped before it reaches the slab.
+typedef union {
+  beatled_message_t base;
+  beatled_message_error_t error;
+  beatled_message_hello_request_t hello_request;
+  beatled_message_hello_response_t hello_response;
+  beatled_message_tempo_request_t tempo_request;
+  beatled_message_tempo_response_t tempo_response;
+  beatled_message_time_request_t time_request;
+  beatled_message_time_response_t time_response;
+  beatled_message_time_burst_request_t time_burst_request;
+  beatled_message_time_burst_response_t time_burst_response;
+  beatled_message_program_t program;
+  beatled_message_next_beat_t next_beat;
+  beatled_message_beat_t beat;
+  beatled_message_beat_schedule_t beat_schedule;
+  beatled_message_status_request_t status_request;
+  beatled_message_status_response_t status_response;
+} msg_slab_message_t;
+
+#define MSG_SLAB_BLOCK_SIZE sizeof(msg_slab_message_t)
+
+// Blocks in the slab. The event queue drains them every loop iteration,
+// so this only has to cover the datagrams that pile up while one event is
+// handled; a datagram that finds the slab empty is dropped and counted.
+#ifndef MSG_SLAB_BLOCK_COUNT
+#define MSG_SLAB_BLOCK_COUNT 32
+#endif
+
+typedef struct {
+  uint16_t in_use;          // blocks allocated right now
+  uint16_t high_water;      // most blocks ever allocated at once
+  uint32_t exhausted_total; // allocations refused because every block was in use
+} msg_slab_stats_t;
+
+// A block for a `size`-byte datagram, or NULL when `size` exceeds
+// MSG_SLAB_BLOCK_SIZE or every block is in use (counted in
+// exhausted_total).
+void *msg_slab_alloc(size_t size);
+
+// Returns a block from msg_slab_alloc to the slab
+void msg_slab_free(void *block);
+
+// True if `ptr` is one of the slab's blocks, so event data that came from
+// elsewhere (state transitions, tests) can still go to free()
+bool msg_slab_owns(const void *ptr);
+
+void msg_slab_get_stats(msg_slab_stats_t *out);
+
+// Empties the free list and zeroes the counters. Only valid while no
+// block is allocated.
+void msg_slab_reset_for_testing(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HAL__MSG_SLAB_H
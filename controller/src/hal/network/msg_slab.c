@@ -0,0 +1,127 @@
+#include <stdatomic.h>
+
+#include "hal/msg_slab.h"
+
+// Free blocks form a Treiber stack. The head packs a 16-bit generation tag
+// above a 16-bit link, bumped on every push and pop, so a pop that races a
+// pop-then-push of the same block fails its compare-exchange instead of
+// installing a stale link (ABA). A link is a block index plus one; 0 ends
+// the list.
+//
+// Blocks that were never allocated aren't on the stack: `fresh` hands them
+// out in order first. All state is zero-initialised, so the slab needs no
+// init call and the receive path can use it before anything else starts.
+
+#define LINK_MASK 0xFFFFu
+#define TAG_STEP 0x10000u
+
+_Static_assert(MSG_SLAB_BLOCK_COUNT > 0 && MSG_SLAB_BLOCK_COUNT < LINK_MASK,
+               "MSG_SLAB_BLOCK_COUNT must fit a 16-bit link");
+
+typedef union {
+  msg_slab_message_t message;
+  uint64_t align;
+} block_t;
+
+static block_t blocks_[MSG_SLAB_BLOCK_COUNT];
+static _Atomic uint16_t next_link_[MSG_SLAB_BLOCK_COUNT];
+static _Atomic uint32_t free_head_;
+static _Atomic uint32_t fresh_;
+
+static _Atomic uint32_t in_use_;
+static _Atomic uint32_t high_water_;
+static _Atomic uint32_t exhausted_total_;
+
+static int pop_free(void) {
+  uint32_t head = atomic_load_explicit(&free_head_, memory_order_acquire);
+  while ((head & LINK_MASK) != 0) {
+    int index = (int)(head & LINK_MASK) - 1;
+    uint32_t next = ((head + TAG_STEP) & ~LINK_MASK) |
+                    atomic_load_explicit(&next_link_[index], memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(&free_head_, &head, next, memory_order_acquire,
+                                              memory_order_acquire)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+static void push_free(int index) {
+  uint32_t head = atomic_load_explicit(&free_head_, memory_order_relaxed);
+  uint32_t next;
+  do {
+    atomic_store_explicit(&next_link_[index], (uint16_t)(head & LINK_MASK), memory_order_relaxed);
+    next = ((head + TAG_STEP) & ~LINK_MASK) | (uint32_t)(index + 1);
+  } while (!atomic_compare_exchange_weak_explicit(&free_head_, &head, next, memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+static int take_fresh(void) {
+  uint32_t fresh = atomic_load_explicit(&fresh_, memory_order_relaxed);
+  while (fresh < MSG_SLAB_BLOCK_COUNT) {
+    if (atomic_compare_exchange_weak_explicit(&fresh_, &fresh, fresh + 1, memory_order_relaxed,
+                                              memory_order_relaxed)) {
+      return (int)fresh;
+    }
+  }
+  return -1;
+}
+
+void *msg_slab_alloc(size_t size) {
+  if (size > MSG_SLAB_BLOCK_SIZE) {
+    return NULL;
+  }
+
+  int index = pop_free();
+  if (index < 0) {
+    index = take_fresh();
+  }
+  if (index < 0) {
+    atomic_fetch_add_explicit(&exhausted_total_, 1, memory_order_relaxed);
+    return NULL;
+  }
+
+  uint32_t in_use = atomic_fetch_add_explicit(&in_use_, 1, memory_order_relaxed) + 1;
+  uint32_t high_water = atomic_load_explicit(&high_water_, memory_order_relaxed);
+  while (in_use > high_water &&
+         !atomic_compare_exchange_weak_explicit(&high_water_, &high_water, in_use,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+  }
+
+  return &blocks_[index];
+}
+
+void msg_slab_free(void *block) {
+  if (!msg_slab_owns(block)) {
+    return;
+  }
+  int index = (int)((block_t *)block - blocks_);
+  atomic_fetch_sub_explicit(&in_use_, 1, memory_order_relaxed);
+  push_free(index);
+}
+
+bool msg_slab_owns(const void *ptr) {
+  uintptr_t p = (uintptr_t)ptr;
+  uintptr_t begin = (uintptr_t)blocks_;
+  if (p < begin || p >= begin + sizeof(blocks_)) {
+    return false;
+  }
+  return (p - begin) % sizeof(block_t) == 0;
+}
+
+void msg_slab_get_stats(msg_slab_stats_t *out) {
+  if (!out) {
+    return;
+  }
+  out->in_use = (uint16_t)atomic_load_explicit(&in_use_, memory_order_relaxed);
+  out->high_water = (uint16_t)atomic_load_explicit(&high_water_, memory_order_relaxed);
+  out->exhausted_total = atomic_load_explicit(&exhausted_total_, memory_order_relaxed);
+}
+
+void msg_slab_reset_for_testing(void) {
+  atomic_store(&free_head_, 0);
+  atomic_store(&fresh_, 0);
+  atomic_store(&in_use_, 0);
+  atomic_store(&high_water_, 0);
+  atomic_store(&exhausted_total_, 0);
+}
@@ -14,6 +14,7 @@
 #include "config/constants.h"
 
 #include "dns.h"
+#include "hal/msg_slab.h"
 #include "hal/time.h"
 #include "hal/udp.h"
 
@@ -126,9 +127,9 @@ static void udp_socket_listen(void *data) {
     if (recvlen > 0) {
       uint64_t rx_time_us = time_us_64();
       buffer[recvlen] = 0;
-      void *server_msg = (void *)pvPortMalloc(recvlen);
+      void *server_msg = msg_slab_alloc(recvlen);
       if (!server_msg) {
-        puts("[ERR] Failed to allocate UDP message buffer");
+        printf("[ERR] No receive buffer for %d-byte UDP message, dropping\n", recvlen);
         continue;
       }
       memcpy(server_msg, buffer, recvlen);
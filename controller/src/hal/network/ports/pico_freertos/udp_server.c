@@ -5,6 +5,7 @@
 #include <pico/time.h>
 #include <pico/unique_id.h>
 
+#include "hal/msg_slab.h"
 #include "hal/network.h"
 #include "hal/udp.h"
 #include "pico_udp.h"
@@ -21,9 +22,9 @@ void dgram_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
   uint64_t rx_time_us = time_us_64();
 
   size_t data_length = p->tot_len;
-  void *server_msg = (void *)malloc(data_length);
+  void *server_msg = msg_slab_alloc(data_length);
   if (!server_msg) {
-    printf("[ERR] Failed to allocate %zu bytes for UDP message\n", data_length);
+    printf("[ERR] No receive buffer for %zu-byte UDP message, dropping\n", data_length);
     pbuf_free(p);
     return;
   }
@@ -45,7 +46,7 @@ void dgram_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
 
   if (server_msg_enqueue_error) {
     printf("[ERR] Failed to enqueue UDP message, freeing buffer\n");
-    free(server_msg);
+    msg_slab_free(server_msg);
   }
 }
 
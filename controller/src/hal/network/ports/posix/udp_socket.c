@@ -20,6 +20,30 @@
 int udp_socket_fd;
 struct sockaddr_in server_addr;
 
+// Join `group` so the server's multicast mode reaches this socket. The
+// interface comes from BEATLED_MULTICAST_IF (a local address, e.g. 127.0.0.1
+// to run against a server on the same host) or else the routing table.
+static int join_multicast_group(const char *group) {
+  struct ip_mreq mreq = {0};
+  if (inet_pton(AF_INET, group, &mreq.imr_multiaddr) != 1 ||
+      !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr))) {
+    printf("[ERR] Invalid multicast group '%s'\n", group);
+    return 1;
+  }
+  mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+  const char *iface = getenv("BEATLED_MULTICAST_IF");
+  if (iface && iface[0] != '\0' && inet_pton(AF_INET, iface, &mreq.imr_interface) != 1) {
+    printf("[ERR] Invalid BEATLED_MULTICAST_IF '%s'; using the default interface\n", iface);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+  }
+  if (setsockopt(udp_socket_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+    printf("[ERR] Joining multicast group %s failed: %s\n", group, strerror(errno));
+    return 1;
+  }
+  printf("[NET] Joined multicast group %s\n", group);
+  return 0;
+}
+
 int create_udp_socket(udp_parameters_t *udp_params) {
   struct sockaddr_in *addr;
   struct sockaddr_in device_addr;
@@ -70,6 +94,17 @@ int create_udp_socket(udp_parameters_t *udp_params) {
     perror("bind failed");
     return 1;
   }
+
+  // Group traffic only reaches sockets bound to the wildcard address. A
+  // failed join is not fatal: the server may well be in another mode.
+  const char *group = udp_params->multicast_group;
+  if (group && group[0] != '\0') {
+    if (device_addr.sin_addr.s_addr != htonl(INADDR_ANY)) {
+      printf("[NET] Bound to a fixed address; not joining multicast group %s\n", group);
+    } else {
+      join_multicast_group(group);
+    }
+  }
   return 0;
 }
 
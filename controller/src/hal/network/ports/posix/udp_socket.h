@@ -15,6 +15,8 @@ typedef struct udp_parameters {
   const char *server_name;
   uint16_t server_port;
   uint16_t udp_port;
+  // IPv4 group to join on udp_port, or NULL / "" for none
+  const char *multicast_group;
   process_response_fn process_response;
 } udp_parameters_t;
 
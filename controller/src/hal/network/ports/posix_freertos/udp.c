@@ -10,6 +10,7 @@
 
 #include "config/constants.h"
 
+#include "hal/msg_slab.h"
 #include "hal/time.h"
 #include "hal/udp.h"
 #include "../posix/udp_socket.h"
@@ -44,9 +45,9 @@ static void udp_socket_listen(void *data) {
     if (recvlen > 0) {
       uint64_t rx_time_us = time_us_64();
       buffer[recvlen] = 0;
-      void *server_msg = (void *)pvPortMalloc(recvlen);
+      void *server_msg = msg_slab_alloc(recvlen);
       if (!server_msg) {
-        puts("[ERR] Failed to allocate UDP message buffer");
+        printf("[ERR] No receive buffer for %d-byte UDP message, dropping\n", recvlen);
         continue;
       }
       memcpy(server_msg, buffer, recvlen);
@@ -71,6 +72,7 @@ void start_udp(const char *server_name, uint16_t server_port, uint16_t udp_port,
   params->process_response = process_response;
   params->server_name = server_name;
   params->server_port = server_port;
+  params->multicast_group = UDP_MULTICAST_GROUP;
 
   if (create_udp_socket(params)) {
     perror("Error creating sockets");
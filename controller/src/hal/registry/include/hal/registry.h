@@ -17,6 +17,9 @@ typedef struct registry {
   uint64_t tempo_time_update_timestamp;
   uint32_t tempo_period_us;
   uint32_t beat_count;
+  // Grid shape from the last BEAT_SCHEDULE; both 0 after a NEXT_BEAT
+  int32_t period_slope_ns;
+  uint16_t beat_span;
   uint16_t program_id;
 } registry_t;
 
@@ -16,6 +16,13 @@ uint64_t get_local_time_us();
 // it to its native busy/blocking delay.
 void hal_sleep_ms(uint32_t ms);
 
+// Block the caller until time_us_64() reaches `deadline_us`; returns at
+// once if it already has. Sleeping to an absolute time instead of for a
+// duration keeps a periodic loop on its grid however long each iteration
+// took. Every port wakes within well under a millisecond of the deadline
+// without spinning for more than a scheduler tick.
+void hal_sleep_until_us(uint64_t deadline_us);
+
 typedef struct hal_alarm hal_alarm_t;
 typedef void (*alarm_callback_fn)(void *user_data);
 
@@ -1,5 +1,7 @@
 #include "esp_rom_sys.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "hal/time.h"
 
@@ -14,3 +16,42 @@ uint64_t get_local_time_us() {
 void hal_sleep_ms(uint32_t ms) {
   esp_rom_delay_us((uint32_t)ms * 1000);
 }
+
+static void wake_sleeper(void *arg) {
+  xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+// vTaskDelay only resolves whole ticks, so the task blocks on a
+// notification from a one-shot esp_timer instead, which fires at
+// microsecond resolution. One timer per task that sleeps this way; in
+// practice that is the LED task alone.
+void hal_sleep_until_us(uint64_t deadline_us) {
+  static esp_timer_handle_t timer = NULL;
+  static TaskHandle_t sleeper = NULL;
+
+  uint64_t now = time_us_64();
+  if (deadline_us <= now) {
+    return;
+  }
+
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  if (timer == NULL || sleeper != self) {
+    if (timer != NULL) {
+      esp_timer_delete(timer);
+    }
+    const esp_timer_create_args_t args = {
+        .callback = wake_sleeper,
+        .arg = self,
+        .name = "sleep_until",
+    };
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+      timer = NULL;
+      vTaskDelay(pdMS_TO_TICKS((deadline_us - now + 999) / 1000));
+      return;
+    }
+    sleeper = self;
+  }
+
+  esp_timer_start_once(timer, deadline_us - now);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
@@ -9,3 +9,8 @@ uint64_t get_local_time_us() {
 void hal_sleep_ms(uint32_t ms) {
   sleep_ms(ms);
 }
+
+void hal_sleep_until_us(uint64_t deadline_us) {
+  // The SDK sleeps on a hardware alarm at microsecond resolution
+  sleep_until(from_us_since_boot(deadline_us));
+}
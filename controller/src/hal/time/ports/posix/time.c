@@ -1,3 +1,4 @@
+#include <errno.h>
 #include <stdint.h>
 #include <time.h>
 #include <unistd.h>
@@ -16,3 +17,22 @@ uint64_t get_local_time_us() {
 void hal_sleep_ms(uint32_t ms) {
   usleep((useconds_t)ms * 1000);
 }
+
+void hal_sleep_until_us(uint64_t deadline_us) {
+#if defined(__APPLE__)
+  // No clock_nanosleep on macOS: sleep the remaining interval, re-checked
+  // after an interrupted sleep
+  uint64_t now;
+  while ((now = time_us_64()) < deadline_us) {
+    uint64_t remaining = deadline_us - now;
+    struct timespec ts = {.tv_sec = (time_t)(remaining / 1000000),
+                          .tv_nsec = (long)(remaining % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+  }
+#else
+  struct timespec ts = {.tv_sec = (time_t)(deadline_us / 1000000),
+                        .tv_nsec = (long)(deadline_us % 1000000) * 1000};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+  }
+#endif
+}
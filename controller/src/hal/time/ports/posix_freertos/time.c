@@ -1,7 +1,11 @@
+#include <errno.h>
 #include <stdint.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "hal/time.h"
 
 uint64_t time_us_64() {
@@ -17,3 +21,16 @@ uint64_t get_local_time_us() {
 void hal_sleep_ms(uint32_t ms) {
   usleep((useconds_t)ms * 1000);
 }
+
+void hal_sleep_until_us(uint64_t deadline_us) {
+  // Whole ticks go to the scheduler so other tasks run; the last partial
+  // tick is an OS sleep on this task's thread, as hal_sleep_ms already is
+  const uint64_t tick_us = 1000000u / configTICK_RATE_HZ;
+  uint64_t now = time_us_64();
+  if (deadline_us > now + tick_us) {
+    vTaskDelay((TickType_t)((deadline_us - now) / tick_us - 1));
+  }
+  while ((now = time_us_64()) < deadline_us) {
+    usleep((useconds_t)(deadline_us - now));
+  }
+}
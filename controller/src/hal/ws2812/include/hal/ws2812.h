@@ -4,15 +4,57 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include <stdbool.h>
 #include <stdint.h>
 
 void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency,
                  bool is_rgbw);
 
+// Hands a frame to the strip. Returns once the transfer has started (pico)
+// or finished (esp32); waits first while the previous frame is still on
+// the wire or latching. The caller must not touch `stream` until the next
+// call has returned.
 void output_strings_dma(uint32_t *stream);
 
+// How long a frame takes to show after output_strings_dma. WS2812 pixels
+// shift the data along the chain and all latch together once the line has
+// idled low, so a whole frame lights at one instant: after the setup, the
+// wire time of every pixel and the latch.
+typedef struct {
+  uint32_t setup_us; // output_strings_dma call to the first bit on the wire
+  uint32_t pixel_ns; // wire time of one pixel
+  uint32_t latch_us; // idle-low time after the last bit before the pixels show
+} ws2812_latency_model_t;
+
+// This port's model for the strip passed to ws2812_init
+void ws2812_get_latency_model(ws2812_latency_model_t *model);
+
+// Wire time of one pixel: 24 bits (32 for RGBW) at `frequency`
+uint32_t ws2812_pixel_ns(uint32_t frequency, bool is_rgbw);
+
+// Frames handed to the strip, so the next one's presentation time can be
+// predicted. Platform-independent: shared by every port.
+typedef struct {
+  ws2812_latency_model_t model;
+  uint16_t num_pixels;
+  // When the last frame has latched; the next transfer cannot start before
+  uint64_t strip_free_us;
+} ws2812_timeline_t;
+
+void ws2812_timeline_init(ws2812_timeline_t *timeline, const ws2812_latency_model_t *model,
+                          uint16_t num_pixels);
+
+// Hand-over to presentation on an idle strip
+uint32_t ws2812_timeline_lead_us(const ws2812_timeline_t *timeline);
+
+// When a frame handed over at `handoff_us` shows
+uint64_t ws2812_timeline_predict(const ws2812_timeline_t *timeline, uint64_t handoff_us);
+
+// Records a frame handed over at `handoff_us`; returns when it shows
+uint64_t ws2812_timeline_commit(ws2812_timeline_t *timeline, uint64_t handoff_us);
+
 #ifdef __cplusplus
 }
 #endif
 
-#endif // HAL__WS2812_H
\ No newline at end of file
+#endif // HAL__WS2812_H
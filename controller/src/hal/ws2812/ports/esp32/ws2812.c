@@ -4,10 +4,14 @@
 
 static led_strip_handle_t led_strip;
 static uint16_t num_pixels_stored;
+static uint32_t frequency_stored;
+static bool is_rgbw_stored;
 
 void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency,
                  bool is_rgbw) {
   num_pixels_stored = num_pixel;
+  frequency_stored = frequency;
+  is_rgbw_stored = is_rgbw;
 
   led_strip_config_t strip_config = {
       .strip_gpio_num = ws2812_pin,
@@ -38,3 +42,13 @@ void output_strings_dma(uint32_t *stream) {
   }
   led_strip_refresh(led_strip);
 }
+
+void ws2812_get_latency_model(ws2812_latency_model_t *model) {
+  // Copying the frame into led_strip runs ahead of the RMT transfer, about
+  // a microsecond a pixel. led_strip_refresh blocks until the last bit is
+  // out, so the next frame cannot overlap this one; the chip latches after
+  // the line has idled low for its 280 us reset time.
+  model->setup_us = num_pixels_stored;
+  model->pixel_ns = ws2812_pixel_ns(frequency_stored, is_rgbw_stored);
+  model->latch_us = 280;
+}
@@ -16,6 +16,8 @@
 static PIO pio;
 static uint offset;
 static uint sm;
+static uint32_t frequency_;
+static bool is_rgbw_;
 
 void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency,
                  bool is_rgbw) {
@@ -29,7 +31,17 @@ void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency,
   sm = pio_claim_unused_sm(pio, true);
 
   ws2812_program_init(pio, sm, offset, ws2812_pin, frequency, is_rgbw);
+  frequency_ = frequency;
+  is_rgbw_ = is_rgbw;
   dma_init(pio, sm, num_pixel);
 
   puts("[INIT] WS2812 driver initialized");
 }
+
+void ws2812_get_latency_model(ws2812_latency_model_t *model) {
+  // The DMA trigger feeds the PIO FIFO at once; the frame shows when the
+  // reset delay that gates the next transfer ends
+  model->setup_us = 1;
+  model->pixel_ns = ws2812_pixel_ns(frequency_, is_rgbw_);
+  model->latch_us = WS2812_RESET_DELAY_US;
+}
@@ -12,10 +12,6 @@
 
 #include "ws2812_dma.h"
 
-// WS2812B latch: the data line must idle low >=280 us (current chip
-// revisions) before the next frame; 400 us adds margin.
-#define WS2812_RESET_DELAY_US 400
-
 int dma_channel;
 uint32_t dma_channel_mask = 0;
 
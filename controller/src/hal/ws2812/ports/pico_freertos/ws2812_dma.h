@@ -3,6 +3,10 @@
 
 #include "hardware/pio.h"
 
+// WS2812B latch: the data line must idle low >=280 us (current chip
+// revisions) before the next frame; 400 us adds margin.
+#define WS2812_RESET_DELAY_US 400
+
 void dma_init(PIO pio, uint sm, uint16_t num_pixel);
 
 void output_strings_dma(uint32_t *stream);
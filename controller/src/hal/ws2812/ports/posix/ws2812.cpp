@@ -15,3 +15,8 @@ void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency,
 void output_strings_dma(uint32_t *stream) {
   push_color_stream(stream, num_pixel_);
 }
+
+void ws2812_get_latency_model(ws2812_latency_model_t *model) {
+  // The simulator draws a pushed frame on its next redraw: no wire to model
+  *model = ws2812_latency_model_t{};
+}
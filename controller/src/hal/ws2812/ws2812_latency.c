@@ -0,0 +1,40 @@
+#include "hal/ws2812.h"
+
+uint32_t ws2812_pixel_ns(uint32_t frequency, bool is_rgbw) {
+  if (frequency == 0) {
+    return 0;
+  }
+  const uint64_t bits = is_rgbw ? 32 : 24;
+  return (uint32_t)((bits * 1000000000u + frequency / 2) / frequency);
+}
+
+void ws2812_timeline_init(ws2812_timeline_t *timeline, const ws2812_latency_model_t *model,
+                          uint16_t num_pixels) {
+  timeline->model = *model;
+  timeline->num_pixels = num_pixels;
+  timeline->strip_free_us = 0;
+}
+
+static uint32_t wire_us(const ws2812_timeline_t *timeline) {
+  return (uint32_t)(((uint64_t)timeline->num_pixels * timeline->model.pixel_ns + 999) / 1000);
+}
+
+uint32_t ws2812_timeline_lead_us(const ws2812_timeline_t *timeline) {
+  return timeline->model.setup_us + wire_us(timeline) + timeline->model.latch_us;
+}
+
+// The transfer starts after the setup, or once the previous frame has
+// latched if that is later: output_strings_dma waits for it
+static uint64_t transfer_start(const ws2812_timeline_t *timeline, uint64_t handoff_us) {
+  const uint64_t start = handoff_us + timeline->model.setup_us;
+  return start > timeline->strip_free_us ? start : timeline->strip_free_us;
+}
+
+uint64_t ws2812_timeline_predict(const ws2812_timeline_t *timeline, uint64_t handoff_us) {
+  return transfer_start(timeline, handoff_us) + wire_us(timeline) + timeline->model.latch_us;
+}
+
+uint64_t ws2812_timeline_commit(ws2812_timeline_t *timeline, uint64_t handoff_us) {
+  timeline->strip_free_us = ws2812_timeline_predict(timeline, handoff_us);
+  return timeline->strip_free_us;
+}
@@ -0,0 +1,115 @@
+#include <stdatomic.h>
+#include <string.h>
+
+#include "beatled/protocol.h"
+#include "process/beat_state.h"
+
+// Seqlock: the writer makes `seq_` odd, stores the words, then makes it
+// even again; a reader that sees the same even value on both sides of its
+// copy has a consistent snapshot. The words are atomics read and written
+// relaxed, so a copy that races a publish is a detected retry, never a
+// data race.
+
+#define BEAT_STATE_WORDS ((sizeof(beat_state_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+static _Atomic uint32_t seq_;
+static _Atomic uint32_t words_[BEAT_STATE_WORDS];
+
+// The writer's own copy, which every publish starts from
+static beat_state_t current_;
+
+static void publish(void) {
+  uint32_t words[BEAT_STATE_WORDS] = {0};
+  memcpy(words, &current_, sizeof(current_));
+
+  uint32_t seq = atomic_load_explicit(&seq_, memory_order_relaxed);
+  atomic_store_explicit(&seq_, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  for (size_t i = 0; i < BEAT_STATE_WORDS; i++) {
+    atomic_store_explicit(&words_[i], words[i], memory_order_relaxed);
+  }
+  atomic_store_explicit(&seq_, seq + 2, memory_order_release);
+}
+
+bool beat_state_read(beat_state_t *out, uint32_t *version) {
+  uint32_t begin = atomic_load_explicit(&seq_, memory_order_acquire);
+  if (begin & 1) {
+    return false;
+  }
+  uint32_t words[BEAT_STATE_WORDS];
+  for (size_t i = 0; i < BEAT_STATE_WORDS; i++) {
+    words[i] = atomic_load_explicit(&words_[i], memory_order_relaxed);
+  }
+  atomic_thread_fence(memory_order_acquire);
+  if (atomic_load_explicit(&seq_, memory_order_relaxed) != begin) {
+    return false;
+  }
+  memcpy(out, words, sizeof(*out));
+  *version = begin >> 1;
+  return true;
+}
+
+uint64_t beat_state_beat_time(const beat_state_t *state, int64_t k) {
+  return state->beat_time_ref + beatled_beat_schedule_offset_us(state->tempo_period_us,
+                                                                state->period_slope_ns,
+                                                                state->beat_span, k);
+}
+
+void beat_state_publish_schedule(uint64_t beat_time_ref, uint32_t beat_count,
+                                 uint32_t tempo_period_us, int32_t period_slope_ns,
+                                 uint16_t beat_span) {
+  current_.beat_time_ref = beat_time_ref;
+  current_.beat_count = beat_count;
+  current_.tempo_period_us = tempo_period_us;
+  current_.period_slope_ns = period_slope_ns;
+  current_.beat_span = beat_span;
+  current_.anchor_seq++;
+  publish();
+}
+
+void beat_state_publish_next_beat(uint64_t beat_time_ref, uint32_t beat_count) {
+  current_.beat_time_ref = beat_time_ref;
+  current_.beat_count = beat_count;
+  current_.period_slope_ns = 0;
+  current_.beat_span = 0;
+  current_.anchor_seq++;
+  publish();
+}
+
+void beat_state_publish_tempo(uint32_t tempo_period_us, uint64_t now) {
+  if (current_.beat_span != 0) {
+    return;
+  }
+
+  if (current_.beat_time_ref == 0) {
+    // No beat yet: start the grid here, first beat one period out
+    current_.beat_time_ref = now;
+    current_.beat_count = 0;
+    current_.anchor_seq++;
+  } else if (current_.tempo_period_us > 0) {
+    // Re-base on the first beat after `now`, count in step, so the change
+    // takes effect at a boundary instead of shifting the phase
+    const int64_t period = current_.tempo_period_us;
+    const int64_t since_ref = (int64_t)(now - current_.beat_time_ref);
+    const int64_t k =
+        (since_ref >= 0 ? since_ref / period : -((-since_ref + period - 1) / period)) + 1;
+    current_.beat_time_ref += (uint64_t)(k * period);
+    current_.beat_count += (uint32_t)k;
+  }
+  // A NEXT_BEAT that beat the first tempo left a grid with no period; the
+  // reader anchors on it once it has one
+
+  current_.tempo_period_us = tempo_period_us;
+  publish();
+}
+
+void beat_state_publish_program(uint16_t program_id) {
+  current_.program_id = program_id;
+  publish();
+}
+
+void beat_state_reset_for_testing(void) {
+  memset(&current_, 0, sizeof(current_));
+  publish();
+  atomic_store(&seq_, 0);
+}
@@ -0,0 +1,70 @@
+#ifndef PROCESS__BEAT_STATE_H
+#define PROCESS__BEAT_STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The beat grid and program the LED core renders, published by core0 as a
+// versioned snapshot. Core0 is the only writer: the command handlers call
+// the beat_state_publish_* functions from the event loop. The LED core
+// reads with beat_state_read, which never blocks and never retries, so a
+// core0 handler can't push a frame past its deadline.
+//
+// The snapshot is a seqlock over 32-bit atomic words. Only plain loads,
+// stores and fences are used, no read-modify-write, so it is lock-free on
+// every port, the RP2040 included.
+
+typedef struct {
+  uint64_t beat_time_ref;   // local time of beat `beat_count`
+  uint32_t beat_count;
+  uint32_t tempo_period_us; // 0 until the first tempo: nothing to render
+  // Grid shape (protocol v5.2): beat beat_count + k falls
+  // beatled_beat_schedule_offset_us(k) after beat_time_ref. Both 0 is a
+  // flat grid, which is all NEXT_BEAT and TEMPO_RESPONSE describe.
+  int32_t period_slope_ns;
+  uint16_t beat_span;
+  uint16_t program_id;
+  // Bumped when the reader must re-place its phase on the grid (a new
+  // NEXT_BEAT, BEAT_SCHEDULE or first tempo). A tempo change on a flat
+  // grid leaves it alone: the beat in progress keeps its length and the
+  // new period applies from the next boundary.
+  uint32_t anchor_seq;
+} beat_state_t;
+
+// Local time of beat state->beat_count + k
+uint64_t beat_state_beat_time(const beat_state_t *state, int64_t k);
+
+// Copies the latest snapshot into `out` and its version into `version`.
+// Returns false, leaving both untouched, when core0 is mid-publish or
+// published while the copy was made; the caller keeps rendering from its
+// previous copy and tries again next frame.
+bool beat_state_read(beat_state_t *out, uint32_t *version);
+
+// Writer side (core0 only)
+
+// BEAT_SCHEDULE: the full grid shape
+void beat_state_publish_schedule(uint64_t beat_time_ref, uint32_t beat_count,
+                                 uint32_t tempo_period_us, int32_t period_slope_ns,
+                                 uint16_t beat_span);
+
+// NEXT_BEAT: a flat grid through one beat at the current tempo
+void beat_state_publish_next_beat(uint64_t beat_time_ref, uint32_t beat_count);
+
+// TEMPO_RESPONSE: a new period for a flat grid, from the first beat after
+// `now`. A ramping schedule stays in charge until the next one replaces it.
+void beat_state_publish_tempo(uint32_t tempo_period_us, uint64_t now);
+
+void beat_state_publish_program(uint16_t program_id);
+
+// Zeroes the snapshot. Only valid while nothing reads it.
+void beat_state_reset_for_testing(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROCESS__BEAT_STATE_H
@@ -19,7 +19,12 @@ static void retry_time_request_callback(void *data) {
 }
 
 int enter_registered_state() {
-  send_time_request();
+  // The burst fills the offset filter within a second; the retry timer is
+  // the fallback when its requests go unanswered (a server older than
+  // protocol v5.1 doesn't know TIME_BURST_REQUEST).
+  if (time_sync_start_burst()) {
+    send_time_request();
+  }
   retry_alarm = hal_add_repeating_timer(TIME_REQUEST_RETRY_US, &retry_time_request_callback, NULL);
   if (!retry_alarm) {
     puts("[ERR] Failed to allocate time request retry alarm");
@@ -10,12 +10,9 @@
 #include "hal/wifi.h"
 
 #include "hal/registry.h"
-#include "process/intercore_queue.h"
 #include "state_manager/state_manager.h"
 #include "state_manager/states/started.h"
 
-hal_queue_handle_t intercore_command_queue;
-
 int enter_started_state() {
   // board_id_handle_t board_id_ptr = get_unique_board_id();
   // printf("Starting on pico board %s\n", state_manager_get_unique_board_id());
@@ -26,9 +23,6 @@ int enter_started_state() {
   puts("[INIT] Initializing event queue");
   event_queue_init();
 
-  puts("[INIT] Initializing intercore queue");
-  intercore_command_queue = hal_queue_init(sizeof(intercore_message_t), MAX_INTERCORE_QUEUE_COUNT);
-
   puts("[INIT] Initializing STDIO");
   hal_stdio_init();
 
@@ -6,10 +6,12 @@
 #include "state_manager/states/tempo_synced.h"
 
 #define TEMPO_ALARM_DELAY_US 10000000
-// Was 100s; with the new median offset filter each sample is cheap and the
-// 8-sample ring needs ~30-40s to fill, so a 5s refresh keeps the offset both
-// fresh enough to track drift and well-averaged.
-#define TIME_ALARM_DELAY_US 5000000
+// Was 5s; the offset filter now also fits the crystals' skew and
+// extrapolates along it, so drift no longer needs frequent samples to
+// track. Over a 50s refresh the 8-sample ring spans ~6 minutes, long enough
+// to fit the skew to a ppm. The ring is filled by a burst at registration
+// rather than by these refreshes.
+#define TIME_ALARM_DELAY_US 50000000
 #define HELLO_ALARM_DELAY_US 10000000
 
 static hal_alarm_t *tempo_alarm = NULL;
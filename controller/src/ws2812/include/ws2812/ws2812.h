@@ -3,17 +3,17 @@
 
 #include <stdint.h>
 
-#include "process/intercore_queue.h"
-
 void led_init();
 void led_set_random_pattern();
-// Render one frame. Returns the suggested sleep before the next frame, in
-// microseconds: the regular frame interval, shortened when a beat boundary
-// falls inside it so the first frame of every beat lands on the boundary —
-// otherwise free-running render loops quantize beat onsets by up to a full
-// frame differently on every controller.
-uint32_t led_update(void);
-void update_tempo(intercore_message_t *ic_message);
+// Render one frame. Returns the time_us_64() deadline of the next frame, to
+// pass to hal_sleep_until_us: frames show on the strip at the regular
+// interval from the last beat boundary and one shows exactly on every
+// boundary — otherwise free-running render loops quantize beat onsets by up
+// to a full frame differently on every controller. Each frame is rendered
+// for its predicted presentation time, and the deadline is early by the
+// render, wire and latch time. Picks up the beat grid core0 published in
+// beat_state first; it takes no lock.
+uint64_t led_update(void);
 
 uint8_t calculate_beat_fraction(uint64_t current_time, uint64_t last_time, uint64_t next_time);
 
@@ -5,6 +5,8 @@
 // Brightest channel value this program may emit (0-255); bounds current draw.
 #define DROPS_MAX_BRIGHTNESS 64u
 
+static brightness_lut_t lut = BRIGHTNESS_LUT_INIT(DROPS_MAX_BRIGHTNESS);
+
 void pattern_drops(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
   // Calculate drop position that sweeps from start to end of strip within one beat
   // t ranges 0-255, NUM_PIXELS is typically 30
@@ -26,35 +28,25 @@ void pattern_drops(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count)
   // the hue stable in the dim trail instead of re-running HSV at a low value
   uint32_t color = convert_hsv_to_rgb(hue, 255, 255);
 
-  // Calculate color for each LED position
-  for (int i = 0; i < len; ++i) {
-    int value;
-
-    if (i > pos) {
-      // LEDs ahead of drop position are dark (drop hasn't reached them yet)
-      value = 0;
-    } else {
-      // LEDs behind or at drop position show trailing gradient
-      // Calculate how far behind the drop this LED is
-      int distance = pos - i;
-
-      // Trail length is 1/3 of strip length (e.g., 10 LEDs on 30-LED strip)
-      int trail_length = NUM_PIXELS / 3;
-
-      if (distance < trail_length) {
-        // LED is within trail: calculate gradient brightness
-        // At distance=0 (drop position): value = max_intensity
-        // At distance=trail_length: value ≈ 0
-        // Creates smooth fade from bright to dark
-        value = max_intensity - (distance * max_intensity / trail_length);
-      } else {
-        // LED is too far behind drop, outside trail area
-        value = 0;
-      }
+  // LEDs ahead of the drop (it hasn't reached them yet) and too far behind
+  // it are dark; only the trail gets a level
+  stream_fill(stream, len, 0);
+
+  // Trail length is 1/3 of strip length (e.g., 10 LEDs on 30-LED strip)
+  int trail_length = NUM_PIXELS / 3;
+
+  // Walk the trail back from the drop position
+  // At distance=0 (drop position): value = max_intensity
+  // At distance=trail_length: value ≈ 0
+  // Creates smooth fade from bright to dark
+  for (int distance = 0; distance < trail_length && distance <= pos; ++distance) {
+    int i = pos - distance;
+    if ((size_t)i < len) {
+      stream[i] = (uint32_t)(max_intensity - (distance * max_intensity / trail_length));
     }
-
-    // Gamma-correct for perceptually linear brightness, cap at the program
-    // ceiling, then scale the full-brightness colour down to that level
-    stream[i] = color_scale(color, brightness_apply((uint8_t)value, DROPS_MAX_BRIGHTNESS));
   }
+
+  // Gamma-correct each level for perceptually linear brightness, cap at the
+  // program ceiling, then scale the full-brightness colour down to it
+  stream_shade(stream, len, color, brightness_lut(&lut));
 }
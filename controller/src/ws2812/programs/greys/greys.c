@@ -5,6 +5,8 @@
 // Brightest channel value this program may emit (0-255); bounds current draw.
 #define GREYS_MAX_BRIGHTNESS 32u
 
+static brightness_lut_t lut = BRIGHTNESS_LUT_INIT(GREYS_MAX_BRIGHTNESS);
+
 void pattern_greys(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
   // Calculate brightness using 4th-power exponential decay curve
   // t ranges from 0 (beat start) to 255 (beat end)
@@ -12,15 +14,10 @@ void pattern_greys(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count)
   // beat_intensity_exp4(255) = 0 (faded out at beat end)
   // Gamma-correct the full-range envelope so the fade looks perceptually
   // linear, then cap at the program brightness ceiling.
-  uint8_t brightness = brightness_apply(beat_intensity_exp4(t), GREYS_MAX_BRIGHTNESS);
-
-  // Pack RGB values into 32-bit color word
-  // Using same brightness for R, G, B creates white/grey color
-  uint32_t color = rgb_u32(brightness, brightness, brightness);
+  uint8_t brightness = brightness_lut(&lut)[beat_intensity_exp4(t)];
 
-  // Set all LEDs in the strip to the same color
+  // Set all LEDs in the strip to white, scaled to the same grey
   // This creates a synchronized "breathing" effect across the entire strip
-  for (int i = 0; i < len; ++i) {
-    stream[i] = color; // Write color to LED position i
-  }
+  stream_fill(stream, len, rgb_u32(255, 255, 255));
+  stream_scale(stream, len, brightness);
 }
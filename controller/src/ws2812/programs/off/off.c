@@ -1,9 +1,9 @@
 #include "off.h"
 
+#include "../utils.h"
+
 void pattern_off(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
   (void)t;
   (void)beat_count;
-  for (size_t i = 0; i < len; ++i) {
-    stream[i] = 0;
-  }
+  stream_fill(stream, len, 0);
 }
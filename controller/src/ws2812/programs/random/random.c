@@ -7,6 +7,8 @@
 // Brightest channel value this program may emit (0-255); bounds current draw.
 #define RANDOM_MAX_BRIGHTNESS 16u
 
+static brightness_lut_t lut = BRIGHTNESS_LUT_INIT(RANDOM_MAX_BRIGHTNESS);
+
 void pattern_random(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
   // Freeze pattern at the very start of beat for strong visual "hit"
   // t < 8 means first ~3% of beat (8/255 ≈ 0.03)
@@ -34,7 +36,7 @@ void pattern_random(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count
   // Calculate maximum brightness using quadratic decay curve
   // Bright at beat start (t=0), dim by beat end (t=255)
   // Gamma-correct the full-range envelope, then cap at the program ceiling
-  uint8_t max_brightness = brightness_apply(beat_intensity_quadratic(t), RANDOM_MAX_BRIGHTNESS);
+  uint8_t max_brightness = brightness_lut(&lut)[beat_intensity_quadratic(t)];
 
   // Generate random color for each LED
   for (int i = 0; i < len; ++i) {
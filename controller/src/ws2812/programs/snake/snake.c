@@ -12,6 +12,8 @@
 // Brightest channel value this program may emit (0-255); bounds current draw.
 #define SNAKE_MAX_BRIGHTNESS 125u
 
+static brightness_lut_t lut = BRIGHTNESS_LUT_INIT(SNAKE_MAX_BRIGHTNESS);
+
 void pattern_snakes_init() {}
 
 void pattern_snakes(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
@@ -46,26 +48,51 @@ void pattern_snakes(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count
   // along the body for depth.
   uint8_t head_hue = (uint8_t)(beat_count * 32u);
 
-  for (size_t i = 0; i < len; ++i) {
-    // How far this pixel sits behind the head, walking backwards round the
-    // ring, in 1/256-LED units. 0 == exactly at the head.
-    uint32_t pixel_q8 = (uint32_t)i << 8;
-    uint32_t dist_q8 = (head_q8 + ring_q8 - pixel_q8) % ring_q8;
+  const uint8_t *levels = brightness_lut(&lut);
+  stream_fill(stream, len, 0); // outside the body
 
-    if (dist_q8 >= tail_q8) {
-      stream[i] = 0; // outside the body
-      continue;
-    }
+  // Walk the body from the head back round the ring. dist_q8 is how far the
+  // pixel sits behind the head in 1/256-LED units, and grows by one LED a
+  // step. The spatial fade (tail_q8 - dist_q8) * 255 / tail_q8 and the hue
+  // offset dist_q8 * 48 / tail_q8 are stepped as quotient and remainder,
+  // so the body costs a few divisions a frame rather than three a pixel.
+  size_t i = head_q8 >> 8;
+  uint32_t dist_q8 = head_q8 & 0xffu;
 
-    // Spatial fade: bright at the head, dark at the tail tip.
-    uint32_t tail_fade = (tail_q8 - dist_q8) * 255u / tail_q8; // 0..255
-    uint8_t value = (uint8_t)((tail_fade * beat_env) >> 8);
+  uint32_t fade_num = (tail_q8 - dist_q8) * 255u;
+  uint32_t fade_q = fade_num / tail_q8;
+  uint32_t fade_r = fade_num % tail_q8;
+  const uint32_t fade_step_q = (256u * 255u) / tail_q8;
+  const uint32_t fade_step_r = (256u * 255u) % tail_q8;
+
+  uint32_t hue_num = dist_q8 * 48u;
+  uint32_t hue_q = hue_num / tail_q8;
+  uint32_t hue_r = hue_num % tail_q8;
+  const uint32_t hue_step_q = (256u * 48u) / tail_q8;
+  const uint32_t hue_step_r = (256u * 48u) % tail_q8;
 
-    uint8_t hue = head_hue + (uint8_t)(dist_q8 * 48u / tail_q8);
+  while (dist_q8 < tail_q8) {
+    // Spatial fade: bright at the head, dark at the tail tip.
+    uint8_t value = (uint8_t)((fade_q * beat_env) >> 8);
+    uint8_t hue = head_hue + (uint8_t)hue_q;
     // Full-brightness colour scaled down, rather than HSV at a low value,
     // so the tail fades without hue-quantization flicker. The combined
     // fade is gamma-corrected and capped at the program ceiling first.
-    stream[i] = color_scale(convert_hsv_to_rgb(hue, 255, 255),
-                            brightness_apply(value, SNAKE_MAX_BRIGHTNESS));
+    stream[i] = color_scale(convert_hsv_to_rgb(hue, 255, 255), levels[value]);
+
+    i = (i == 0 ? len : i) - 1;
+    dist_q8 += 256u;
+    fade_q -= fade_step_q;
+    if (fade_r < fade_step_r) {
+      fade_r += tail_q8;
+      fade_q--;
+    }
+    fade_r -= fade_step_r;
+    hue_q += hue_step_q;
+    hue_r += hue_step_r;
+    if (hue_r >= tail_q8) {
+      hue_r -= tail_q8;
+      hue_q++;
+    }
   }
 }
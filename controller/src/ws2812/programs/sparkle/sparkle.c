@@ -5,6 +5,8 @@
 // Brightest channel value this program may emit (0-255); bounds current draw.
 #define SPARKLE_MAX_BRIGHTNESS 64u
 
+static brightness_lut_t lut = BRIGHTNESS_LUT_INIT(SPARKLE_MAX_BRIGHTNESS);
+
 void pattern_sparkle(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
   // Control sparkle density based on position within beat
   // Creates "burst" effect: many sparkles at beat start, then fades to
@@ -21,7 +23,7 @@ void pattern_sparkle(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_coun
   // Calculate brightness using quadratic decay curve for smooth fade
   // Starts at 255 at beat start, decays to 0 by beat end
   // Gamma-correct the full-range envelope, then cap at the program ceiling
-  uint8_t brightness = brightness_apply(beat_intensity_quadratic(t), SPARKLE_MAX_BRIGHTNESS);
+  uint8_t brightness = brightness_lut(&lut)[beat_intensity_quadratic(t)];
 
   // Pack brightness into RGB word (white sparkles)
   uint32_t color = rgb_u32(brightness, brightness, brightness);
@@ -1,6 +1,8 @@
 #ifndef SRC__WS2812__PROGRAMS__UTILS__H_
 #define SRC__WS2812__PROGRAMS__UTILS__H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 const static uint8_t gamma8[] = {
@@ -23,6 +25,20 @@ static inline uint32_t rgb_u32(uint8_t r, uint8_t g, uint8_t b) {
   return ((uint32_t)(r) << 16) | ((uint32_t)(g) << 24) | (uint32_t)(b) << 8;
 }
 
+// x / 255, exact for 0 <= x < 65535: every product of two channel bytes
+// plus a rounding bias. The Cortex-M0+ has no divider, so a real division
+// is a library call; this is two adds and two shifts.
+static inline uint32_t div255(uint32_t x) {
+  return (x + 1u + (x >> 8)) >> 8;
+}
+
+// div255 on both 16-bit lanes of a word at once. A packed 0xGGRRBB00
+// colour shifted down and masked with 0x00ff00ff puts G and B in separate
+// lanes, with room for a channel times a scale: two channels per multiply.
+static inline uint32_t div255_x2(uint32_t x) {
+  return ((x + 0x00010001u + ((x >> 8) & 0x00ff00ffu)) >> 8) & 0x00ff00ffu;
+}
+
 // Map a perceptual intensity (0-255) to the linear PWM value sent to the
 // LEDs: gamma-correct over the full input range first, then scale so
 // `max_brightness` is the largest channel value the program can emit.
@@ -31,7 +47,29 @@ static inline uint32_t rgb_u32(uint8_t r, uint8_t g, uint8_t b) {
 // gamma8[] crushes everything into the bottom table entries (gamma8[31]
 // is 1), which is how several programs ended up nearly invisible.
 static inline uint8_t brightness_apply(uint8_t value, uint8_t max_brightness) {
-  return (uint8_t)(((uint32_t)gamma8[value] * max_brightness + 127u) / 255u);
+  return (uint8_t)div255((uint32_t)gamma8[value] * max_brightness + 127u);
+}
+
+// brightness_apply for one program's cap, for every value: a program
+// declares one with BRIGHTNESS_LUT_INIT and looks levels up per pixel
+// instead of computing them. Filled on first use; only the LED core runs
+// programs, so that needs no lock.
+typedef struct {
+  uint8_t max_brightness;
+  bool ready;
+  uint8_t level[256];
+} brightness_lut_t;
+
+#define BRIGHTNESS_LUT_INIT(max_brightness) {(max_brightness), false, {0}}
+
+static inline const uint8_t *brightness_lut(brightness_lut_t *lut) {
+  if (!lut->ready) {
+    for (int v = 0; v < 256; v++) {
+      lut->level[v] = brightness_apply((uint8_t)v, lut->max_brightness);
+    }
+    lut->ready = true;
+  }
+  return lut->level;
 }
 
 // Scale a packed 0xGGRRBB00 colour by scale/255, rounding to nearest.
@@ -39,10 +77,67 @@ static inline uint8_t brightness_apply(uint8_t value, uint8_t max_brightness) {
 // brightness; re-running the HSV conversion with a tiny `value` instead
 // quantizes channels away one at a time, so dim pixels pop between colours.
 static inline uint32_t color_scale(uint32_t color, uint8_t scale) {
-  uint32_t g = ((((color >> 24) & 0xffu) * scale) + 127u) / 255u;
-  uint32_t r = ((((color >> 16) & 0xffu) * scale) + 127u) / 255u;
-  uint32_t b = ((((color >> 8) & 0xffu) * scale) + 127u) / 255u;
-  return (g << 24) | (r << 16) | (b << 8);
+  uint32_t gb = ((color >> 8) & 0x00ff00ffu) * scale + 0x007f007fu;
+  uint32_t r = ((color >> 16) & 0xffu) * scale + 127u;
+  return (div255_x2(gb) << 8) | (div255(r) << 16);
+}
+
+// a * (255 - alpha) / 255 + b * alpha / 255 per channel, rounding to nearest
+static inline uint32_t color_blend(uint32_t a, uint32_t b, uint8_t alpha) {
+  uint32_t inv = 255u - alpha;
+  uint32_t gb = ((a >> 8) & 0x00ff00ffu) * inv + ((b >> 8) & 0x00ff00ffu) * alpha + 0x007f007fu;
+  uint32_t r = ((a >> 16) & 0xffu) * inv + ((b >> 16) & 0xffu) * alpha + 127u;
+  return (div255_x2(gb) << 8) | (div255(r) << 16);
+}
+
+// Whole-stream kernels. Programs build a frame from these rather than
+// calling the per-pixel helpers in their own loops.
+
+static inline void stream_fill(uint32_t *stream, size_t len, uint32_t color) {
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = color;
+  }
+}
+
+// Replaces each pixel's perceptual level (0-255, written by the program)
+// with `color` scaled by levels[level]. The colour is split into lanes
+// once for the whole stream.
+static inline void stream_shade(uint32_t *stream, size_t len, uint32_t color,
+                                const uint8_t *levels) {
+  const uint32_t gb = (color >> 8) & 0x00ff00ffu;
+  const uint32_t r = (color >> 16) & 0xffu;
+  for (size_t i = 0; i < len; ++i) {
+    const uint32_t scale = levels[stream[i] & 0xffu];
+    stream[i] = (div255_x2(gb * scale + 0x007f007fu) << 8) | (div255(r * scale + 127u) << 16);
+  }
+}
+
+// Scales every pixel by scale/255 (see color_scale). Programs whose frame
+// is one envelope over a full-brightness picture fill or draw it at full
+// brightness and scale it once. Frames are mostly runs of one colour (a
+// fill, a dark background), so a pixel equal to the previous one reuses
+// its result: a compare instead of two multiplies.
+static inline void stream_scale(uint32_t *stream, size_t len, uint8_t scale) {
+  if (len == 0) {
+    return;
+  }
+  uint32_t in = stream[0];
+  uint32_t out = color_scale(in, scale);
+  for (size_t i = 0; i < len; ++i) {
+    if (stream[i] != in) {
+      in = stream[i];
+      out = color_scale(in, scale);
+    }
+    stream[i] = out;
+  }
+}
+
+// Moves `stream` towards `target` by alpha/255 (see color_blend)
+static inline void stream_blend(uint32_t *stream, const uint32_t *target, size_t len,
+                                uint8_t alpha) {
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = color_blend(stream[i], target[i], alpha);
+  }
 }
 
 // Beat intensity curve functions for musical synchronization
@@ -94,7 +189,8 @@ static inline uint32_t convert_hsv_to_rgb(uint8_t hue, uint8_t saturation, uint8
     return rgb_u32(red, green, blue);
   }
 
-  region = hue / 43;
+  // hue / 43 by multiply-shift, exact over 0-255
+  region = (uint8_t)((hue * 191u) >> 13);
   remainder = (hue - (region * 43)) * 6;
 
   p = (value * (255 - saturation)) >> 8;
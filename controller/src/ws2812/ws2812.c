@@ -10,11 +10,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "beatled/protocol.h"
 #include "config/constants.h"
 #include "hal/registry.h"
 #include "hal/ws2812.h"
 #include "hal/time.h"
-#include "process/intercore_queue.h"
+#include "process/beat_state.h"
 #include "state_manager/state_manager.h"
 #include "programs/utils.h"
 #include "ws2812/ws2812.h"
@@ -62,18 +63,28 @@ static void led_self_test(void) {
 #endif
 
 uint32_t _cycle_idx = 0;
-uint64_t _time_ref = 0;
+
+// The LED core's copy of the last consistent beat_state snapshot and its
+// place on that grid. Only this core touches them, so no lock guards them.
+static beat_state_t _beat = {0};
+static uint32_t _beat_version = 0;
 uint64_t _last_beat_time = 0;
 uint64_t _next_beat_time = 0;
-uint64_t _tempo_period_us = 0;
 // Beat count of the beat that fires at _next_beat_time. The count rendered
 // for the beat in progress is _next_beat_count - 1; deriving it from the
 // grid keeps it consistent with the beat fraction on every frame.
 uint32_t _next_beat_count = 0;
-uint8_t _program_id = 0;
+
+// Frames on their way to the strip, and how long the last one took to
+// render: together they predict when the next frame will show.
+static ws2812_timeline_t _timeline;
+static uint32_t _render_us = 0;
 
 void led_init() {
   ws2812_init(NUM_PIXELS, WS2812_PIN, 800000, IS_RGBW);
+  ws2812_latency_model_t model;
+  ws2812_get_latency_model(&model);
+  ws2812_timeline_init(&_timeline, &model, NUM_PIXELS);
   puts("[INIT] LED manager initialized");
   led_self_test();
 }
@@ -110,157 +121,148 @@ uint8_t scale8(uint64_t value, uint64_t range) {
   return result;
 }
 
-void update_tempo(intercore_message_t *ic_message) {
-  registry_lock_mutex();
-
-  // printf("Message type %d\n", ic_message->message_type);
-  if (ic_message->message_type & INTERCORE_FLAG_TIME_REF_UPDATE) {
-    uint64_t ref = registry.next_beat_time_ref;
-    uint32_t count_at_ref = registry.beat_count;
-    uint64_t now = time_us_64();
-
-#if BEATLED_VERBOSE_LOG
-    printf("[TEMPO] Time ref update: %llu -> %llu (shift=%lld)\n", _next_beat_time, ref,
-           (int64_t)(ref - _next_beat_time));
-#endif
+// Points _next_beat_time at the first beat of the grid after `now`. The
+// announced beat may already have passed (late delivery) or be more than
+// one beat away (early delivery racing the local wrap). Walking the grid,
+// count in step, means a re-anchor can only nudge the phase by the
+// clock-sync error, never jump it by a full beat.
+static void anchor_schedule(uint64_t now) {
+  int64_t k = 0;
+  while (beat_state_beat_time(&_beat, k) <= now) {
+    k++;
+  }
+  while (beat_state_beat_time(&_beat, k - 1) > now) {
+    k--;
+  }
+  _last_beat_time = beat_state_beat_time(&_beat, k - 1);
+  _next_beat_time = beat_state_beat_time(&_beat, k);
+  _next_beat_count = _beat.beat_count + (uint32_t)k;
+}
 
-    if (_tempo_period_us > 0) {
-      // The announced beat may already have passed (late delivery) or be
-      // more than one beat away (early delivery racing the local wrap).
-      // Roll it by whole periods, count in step, so it always names the
-      // next upcoming boundary — a re-anchor can then nudge the phase by
-      // the clock-sync error only, never jump the grid by a full beat.
-      while (ref <= now) {
-        ref += _tempo_period_us;
-        count_at_ref++;
-      }
-      while (ref > now + _tempo_period_us) {
-        ref -= _tempo_period_us;
-        count_at_ref--;
-      }
-      _last_beat_time = ref - _tempo_period_us;
-    } else {
-      // No tempo yet; led_update stays idle until one arrives.
-      _last_beat_time = ref;
-    }
-    _time_ref = registry.next_beat_time_ref;
-    _next_beat_time = ref;
-    _next_beat_count = count_at_ref;
+// Picks up whatever core0 published since the last frame. A read that
+// races a publish keeps the previous copy for one more frame.
+static void sync_beat_state(uint64_t now) {
+  beat_state_t beat;
+  uint32_t version;
+  if (!beat_state_read(&beat, &version) || version == _beat_version) {
+    return;
   }
+  _beat_version = version;
 
-  if (ic_message->message_type & INTERCORE_FLAG_TEMPO_UPDATE) {
-    _tempo_period_us = registry.tempo_period_us;
+  if (beat.program_id != _beat.program_id) {
+    printf("[LED] Program update: id=%u\n", beat.program_id);
+  }
 
-    // Initialize time_ref on first tempo update if not set yet
-    if (_time_ref == 0 && _tempo_period_us > 0) {
-      _time_ref = time_us_64();
-      _last_beat_time = _time_ref;
-      _next_beat_time = _time_ref + _tempo_period_us;
-      _next_beat_count = 1;
-    }
+  // A new anchor, or the first grid with a period, re-places the phase. A
+  // tempo change alone keeps the beat in progress: advancing indexes the
+  // new grid by count, so it takes over at the next boundary.
+  bool reanchor = beat.anchor_seq != _beat.anchor_seq || _beat.tempo_period_us == 0;
+  _beat = beat;
+  if (_beat.tempo_period_us > 0 && reanchor) {
+    anchor_schedule(now);
 
 #if BEATLED_VERBOSE_LOG
-    printf("[TEMPO] Period=%llu us (%.1f BPM)\n", _tempo_period_us,
-           _tempo_period_us > 0 ? 60000000.0 / _tempo_period_us : 0.0);
+    printf("[TEMPO] Grid: beat %" PRIu32 " at %llu, period=%" PRIu32 " us slope=%" PRId32
+           " ns span=%u\n",
+           _next_beat_count, _next_beat_time, _beat.tempo_period_us, _beat.period_slope_ns,
+           _beat.beat_span);
 #endif
   }
+}
 
-  if (ic_message->message_type & INTERCORE_FLAG_PROGRAM_UPDATE) {
-    uint8_t new_program_id = registry.program_id;
-    if (new_program_id != _program_id) {
-      _program_id = new_program_id;
-      printf("[LED] Program update: id=%u\n", _program_id);
-    }
+// Frames run on a grid that restarts at every beat boundary: the next
+// deadline is a whole number of frames after the last beat, pulled in to
+// the next beat when that comes first. One frame lands on each boundary,
+// and the frame phase within a beat is the same on every controller.
+static uint64_t next_frame_deadline(uint64_t now, uint32_t frame_us) {
+  if (now < _last_beat_time) {
+    return now + frame_us;
   }
-
-  registry_unlock_mutex();
+  uint64_t deadline = _last_beat_time + ((now - _last_beat_time) / frame_us + 1) * frame_us;
+  return deadline < _next_beat_time ? deadline : _next_beat_time;
 }
 
-uint32_t led_update(void) {
+uint64_t led_update(void) {
   const uint32_t frame_us = (uint32_t)LED_CORE_SLEEP_MS * 1000u;
 
-  // Snapshot shared state under registry lock to prevent torn reads from core0
-  registry_lock_mutex();
-  uint64_t time_ref = _time_ref;
-  uint64_t tempo_period_us = _tempo_period_us;
-  uint64_t last_beat_time = _last_beat_time;
-  uint64_t next_beat_time = _next_beat_time;
-  uint32_t next_beat_count = _next_beat_count;
-  uint8_t program_id = _program_id;
-  int64_t time_offset = (int64_t)registry.time_offset;
-  registry_unlock_mutex();
-
-  if (time_ref == 0 || tempo_period_us == 0) {
-    return frame_us;
+  // Render for the moment the frame shows, not the moment it is computed:
+  // the wire time of a long strip plus the latch would otherwise put every
+  // beat onset that much late. The grid, the beat fraction and the
+  // boundary below all work in presentation time.
+  const uint64_t wake_time = time_us_64();
+  uint64_t current_time = ws2812_timeline_predict(&_timeline, wake_time + _render_us);
+  sync_beat_state(current_time);
+
+  if (_beat.tempo_period_us == 0) {
+    return wake_time + frame_us;
   }
 
   static uint32_t colors[2][NUM_PIXELS];
   static unsigned int current_stream = 0;
 
-  uint64_t current_time = time_us_64();
-
-  // Advance the beat grid (using local copies). The count moves with the
-  // boundary, before rendering, so the pattern never sees a fresh beat
-  // fraction paired with the previous beat's count.
-  while (next_beat_time < current_time) {
+  // Advance the beat grid. The count moves with the boundary, before
+  // rendering, so the pattern never sees a fresh beat fraction paired with
+  // the previous beat's count. Each beat is placed on the grid from its
+  // anchor, so a ramp's rounding never accumulates. A frame woken right on
+  // the boundary renders the new beat.
+  while (_next_beat_time <= current_time) {
 #if BEATLED_VERBOSE_LOG
     puts("[LED] Advancing next beat time");
 #endif
-    last_beat_time = next_beat_time;
-    next_beat_time += tempo_period_us;
-    next_beat_count++;
+    _last_beat_time = _next_beat_time;
+    _next_beat_count++;
+    _next_beat_time =
+        beat_state_beat_time(&_beat, (int64_t)(int32_t)(_next_beat_count - _beat.beat_count));
   }
 
-  uint8_t beat_frac = calculate_beat_fraction(current_time, last_beat_time, next_beat_time);
+  uint8_t beat_frac = calculate_beat_fraction(current_time, _last_beat_time, _next_beat_time);
 
   // Count of the beat in progress: one behind the upcoming boundary's count.
-  uint32_t beat_count = next_beat_count - 1;
+  uint32_t beat_count = _next_beat_count - 1;
 
 #if BEATLED_VERBOSE_LOG
   printf("[BEATFRAC] beat_frac=%u (current_time=%llu last_beat_time=%llu "
          "next_beat_time=%llu beat=%" PRIu32 ")\n",
-         beat_frac, current_time, last_beat_time, next_beat_time, beat_count);
+         beat_frac, current_time, _last_beat_time, _next_beat_time, beat_count);
 #endif
 
-  run_pattern(program_id, colors[current_stream], NUM_PIXELS, beat_frac, beat_count);
+  run_pattern(_beat.program_id, colors[current_stream], NUM_PIXELS, beat_frac, beat_count);
 
+  // The pico transfer runs from this buffer after the call returns, while
+  // the next frame renders into the other one; that frame's own call waits
+  // for this one to latch before the buffer comes round again
+  const uint64_t handoff_time = time_us_64();
+  _render_us = (uint32_t)(handoff_time - wake_time);
   output_strings_dma(colors[current_stream]);
+  ws2812_timeline_commit(&_timeline, handoff_time);
   current_stream ^= 1;
 
   // Update status ~10x per second (every 10 LED cycles at 100Hz). No-op on
-  // hardware (no HUD); see BEATLED_HUD_UPDATE.
+  // hardware (no HUD); see BEATLED_HUD_UPDATE. The offset is read unlocked:
+  // at worst the simulator shows a stale value for a frame.
   if (_cycle_idx % 10 == 0) {
     BEATLED_HUD_UPDATE(state_manager_get_state(), state_manager_get_state() >= STATE_REGISTERED,
-                       program_id, (uint32_t)tempo_period_us, beat_count, time_offset);
+                       _beat.program_id, _beat.tempo_period_us, beat_count,
+                       (int64_t)registry.time_offset);
   }
 
   // Verbose logging every 1000 cycles (~10 seconds)
   if (_cycle_idx % 1000 == 0) {
 #if BEATLED_VERBOSE_LOG
-    printf("[LED] cycle=%" PRIu32 " program=%u beat_frac=%.3f tempo=%llu us (%.1f BPM) "
+    printf("[LED] cycle=%" PRIu32 " program=%u beat_frac=%.3f tempo=%" PRIu32 " us (%.1f BPM) "
            "beat=%" PRIu32 "\n",
-           _cycle_idx, program_id, (float)beat_frac / UINT8_MAX, tempo_period_us,
-           tempo_period_us > 0 ? 60000000.0 / tempo_period_us : 0.0, beat_count);
+           _cycle_idx, _beat.program_id, (float)beat_frac / UINT8_MAX, _beat.tempo_period_us,
+           60000000.0 / _beat.tempo_period_us, beat_count);
 #endif
   }
 
   _cycle_idx++;
 
-  // Write back modified state under lock
-  registry_lock_mutex();
-  _last_beat_time = last_beat_time;
-  _next_beat_time = next_beat_time;
-  _next_beat_count = next_beat_count;
-  registry_unlock_mutex();
-
-  // Wake for the beat boundary if it falls before the next regular frame so
-  // the onset frame renders right at the beat on every controller.
-  uint64_t after = time_us_64();
-  if (next_beat_time > after) {
-    uint64_t remaining = next_beat_time - after;
-    if (remaining < frame_us) {
-      return (uint32_t)remaining;
-    }
-  }
-  return frame_us;
+  // Grid slots are presentation times: wake early enough to render the
+  // frame and clock it out by its slot. Measured after rendering, so a slow
+  // frame skips slots instead of bunching the next ones up; a boundary
+  // already passed is rendered at once.
+  const uint32_t lead_us = ws2812_timeline_lead_us(&_timeline) + _render_us;
+  const uint64_t present = next_frame_deadline(time_us_64() + lead_us, frame_us);
+  return present > lead_us ? present - lead_us : 0;
 }
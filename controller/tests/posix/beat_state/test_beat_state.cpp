@@ -0,0 +1,169 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "beatled/protocol.h"
+#include "process/beat_state.h"
+
+namespace {
+
+// Publish `i` of the stress test: every field a different function of `i`,
+// both halves of the 64-bit reference included, so a snapshot mixing two
+// publishes fails consistent().
+void publish(uint32_t i) {
+  beat_state_publish_schedule((static_cast<uint64_t>(i) << 32) | ~i, i, i * 3u,
+                              -static_cast<int32_t>(i), static_cast<uint16_t>(i));
+}
+
+bool consistent(const beat_state_t &s, uint32_t version) {
+  const uint32_t i = s.beat_count;
+  return s.beat_time_ref == ((static_cast<uint64_t>(i) << 32) | ~i) &&
+         s.tempo_period_us == i * 3u && s.period_slope_ns == -static_cast<int32_t>(i) &&
+         s.beat_span == static_cast<uint16_t>(i) && s.anchor_seq == i && version == i;
+}
+
+beat_state_t read() {
+  beat_state_t state;
+  uint32_t version;
+  REQUIRE(beat_state_read(&state, &version));
+  return state;
+}
+
+} // namespace
+
+TEST_CASE("The LED core never reads a torn beat state", "[beat_state]") {
+  beat_state_reset_for_testing();
+
+  constexpr uint32_t PUBLISHES = 2000000;
+  constexpr int READERS = 2;
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> torn{0};
+  std::atomic<uint32_t> backwards{0};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> retries{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&]() {
+      uint32_t last_version = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        beat_state_t state;
+        uint32_t version;
+        if (!beat_state_read(&state, &version)) {
+          retries++;
+          continue;
+        }
+        reads++;
+        if (version != 0 && !consistent(state, version)) {
+          torn++;
+        }
+        if (version < last_version) {
+          backwards++;
+        }
+        last_version = version;
+      }
+    });
+  }
+
+  // Core0 is the only writer
+  for (uint32_t i = 1; i <= PUBLISHES; i++) {
+    publish(i);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  INFO("reads=" << reads << " retries=" << retries);
+  REQUIRE(torn == 0);
+  REQUIRE(backwards == 0);
+  REQUIRE(reads > 0);
+
+  uint32_t version = 0;
+  beat_state_t last;
+  REQUIRE(beat_state_read(&last, &version));
+  REQUIRE(consistent(last, version));
+  REQUIRE(version == PUBLISHES);
+}
+
+TEST_CASE("Beat state publishers describe the grid the LED core follows", "[beat_state]") {
+  beat_state_reset_for_testing();
+
+  SECTION("The first tempo starts the grid one period out") {
+    beat_state_publish_tempo(500000, 1000);
+    beat_state_t s = read();
+    REQUIRE(s.beat_time_ref == 1000);
+    REQUIRE(s.beat_count == 0);
+    REQUIRE(s.tempo_period_us == 500000);
+    REQUIRE(s.anchor_seq == 1);
+    REQUIRE(beat_state_beat_time(&s, 1) == 501000);
+  }
+
+  SECTION("A tempo change on a flat grid takes over at the next boundary") {
+    beat_state_publish_tempo(500000, 1000);
+    beat_state_publish_next_beat(1000000, 10);
+    REQUIRE(read().anchor_seq == 2);
+
+    // Beats at 1.0, 1.5, 2.0 and 2.5 s: the first after 2.2 s is beat 13
+    beat_state_publish_tempo(400000, 2200000);
+    beat_state_t s = read();
+    REQUIRE(s.beat_time_ref == 2500000);
+    REQUIRE(s.beat_count == 13);
+    REQUIRE(s.tempo_period_us == 400000);
+    REQUIRE(s.anchor_seq == 2);
+
+    // Before the reference the grid extends back: 2.1 s is beat 12
+    beat_state_publish_tempo(300000, 2000000);
+    s = read();
+    REQUIRE(s.beat_time_ref == 2100000);
+    REQUIRE(s.beat_count == 12);
+    REQUIRE(s.tempo_period_us == 300000);
+  }
+
+  SECTION("A ramping schedule ignores tempo until the next one replaces it") {
+    beat_state_publish_schedule(1000000, 20, 500000, -2000, 8);
+    uint32_t version = 0;
+    beat_state_t before;
+    REQUIRE(beat_state_read(&before, &version));
+
+    beat_state_publish_tempo(400000, 1200000);
+    uint32_t after_version = 0;
+    beat_state_t after;
+    REQUIRE(beat_state_read(&after, &after_version));
+    REQUIRE(after_version == version);
+    REQUIRE(beat_state_beat_time(&after, 3) ==
+            1000000 + static_cast<uint64_t>(beatled_beat_schedule_offset_us(500000, -2000, 8, 3)));
+
+    // NEXT_BEAT flattens the grid at the schedule's period
+    beat_state_publish_next_beat(3000000, 24);
+    after = read();
+    REQUIRE(after.period_slope_ns == 0);
+    REQUIRE(after.beat_span == 0);
+    REQUIRE(after.tempo_period_us == 500000);
+    REQUIRE(after.anchor_seq == before.anchor_seq + 1);
+  }
+
+  SECTION("A NEXT_BEAT ahead of the first tempo waits for a period") {
+    beat_state_publish_next_beat(1000000, 4);
+    REQUIRE(read().tempo_period_us == 0);
+
+    beat_state_publish_tempo(500000, 1200000);
+    beat_state_t s = read();
+    REQUIRE(s.beat_time_ref == 1000000);
+    REQUIRE(s.beat_count == 4);
+    REQUIRE(s.tempo_period_us == 500000);
+  }
+
+  SECTION("Program changes leave the grid alone") {
+    beat_state_publish_tempo(500000, 1000);
+    const beat_state_t before = read();
+    beat_state_publish_program(6);
+    beat_state_t s = read();
+    REQUIRE(s.program_id == 6);
+    REQUIRE(s.beat_time_ref == before.beat_time_ref);
+    REQUIRE(s.anchor_seq == before.anchor_seq);
+  }
+}
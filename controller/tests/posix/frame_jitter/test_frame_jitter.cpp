@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+extern "C" {
+#include "config/constants.h"
+#include "hal/time.h"
+}
+
+namespace {
+
+uint64_t thread_cpu_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000u + static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+}
+
+// Lateness histogram, in microseconds past the deadline
+struct histogram_t {
+  static constexpr uint64_t EDGES[] = {50, 100, 200, 500, 1000};
+  static constexpr size_t BUCKETS = sizeof(EDGES) / sizeof(EDGES[0]) + 1;
+  uint32_t counts[BUCKETS] = {0};
+
+  void add(uint64_t late_us) {
+    size_t b = 0;
+    while (b < BUCKETS - 1 && late_us >= EDGES[b]) {
+      b++;
+    }
+    counts[b]++;
+  }
+
+  void print(const char *title, uint32_t total) const {
+    std::printf("%s\n", title);
+    for (size_t b = 0; b < BUCKETS; b++) {
+      char label[24];
+      if (b < BUCKETS - 1) {
+        std::snprintf(label, sizeof(label), "< %4llu us", (unsigned long long)EDGES[b]);
+      } else {
+        std::snprintf(label, sizeof(label), ">=%4llu us", (unsigned long long)EDGES[b - 1]);
+      }
+      const int bar = static_cast<int>(60u * counts[b] / total);
+      std::printf("  %s %6u |%.*s\n", label, counts[b], bar,
+                  "############################################################");
+    }
+  }
+};
+
+} // namespace
+
+TEST_CASE("Frames sleep to absolute deadlines without drifting or spinning", "[frame_jitter]") {
+  // A 500 Hz frame grid with 300 us of rendering per frame: a loop that
+  // slept for a duration would drift by the render time every frame
+  constexpr uint32_t FRAMES = 500;
+  constexpr uint64_t FRAME_US = 2000;
+  constexpr uint64_t RENDER_US = 300;
+
+  histogram_t histogram;
+  std::vector<uint64_t> lateness;
+  lateness.reserve(FRAMES);
+  uint64_t early = 0;
+  uint64_t sleep_wall_us = 0;
+  uint64_t sleep_cpu_us = 0;
+
+  const uint64_t start = time_us_64() + FRAME_US;
+  for (uint32_t frame = 0; frame < FRAMES; frame++) {
+    const uint64_t deadline = start + frame * FRAME_US;
+
+    const uint64_t wall_before = time_us_64();
+    const uint64_t cpu_before = thread_cpu_us();
+    hal_sleep_until_us(deadline);
+    const uint64_t woke = time_us_64();
+    sleep_cpu_us += thread_cpu_us() - cpu_before;
+    sleep_wall_us += woke - wall_before;
+
+    if (woke < deadline) {
+      early++;
+    } else {
+      lateness.push_back(woke - deadline);
+      histogram.add(woke - deadline);
+    }
+
+    // Render
+    while (time_us_64() < woke + RENDER_US) {
+    }
+  }
+
+  std::sort(lateness.begin(), lateness.end());
+  const uint64_t p50 = lateness[lateness.size() / 2];
+  const uint64_t p99 = lateness[lateness.size() * 99 / 100];
+  histogram.print("hal_sleep_until_us wake-up lateness, 500 frames at 2 ms:", FRAMES);
+  std::printf("  p50 %llu us, p99 %llu us, max %llu us; %llu us CPU over %llu us asleep\n",
+              (unsigned long long)p50, (unsigned long long)p99,
+              (unsigned long long)lateness.back(), (unsigned long long)sleep_cpu_us,
+              (unsigned long long)sleep_wall_us);
+
+  REQUIRE(early == 0);
+  // Generous bounds so a loaded CI host passes; on an idle Linux host the
+  // median wake-up is around 100 us late, timer slack included
+  REQUIRE(p50 < 500);
+  REQUIRE(sleep_cpu_us * 5 < sleep_wall_us);
+
+  // The tail is what costs frames: the LED loop skips a slot for a wake-up
+  // more than a frame late. An idle host keeps p99 within a few hundred us;
+  // a loaded one is only reported, unless it would lose two frames in a row
+  constexpr uint64_t LED_FRAME_US = LED_CORE_SLEEP_MS * 1000;
+  if (p99 >= LED_FRAME_US) {
+    WARN("p99 wake-up lateness " << p99 << " us exceeds an LED frame (" << LED_FRAME_US
+                                 << " us)");
+  }
+  REQUIRE(p99 < 2 * LED_FRAME_US);
+}
+
+TEST_CASE("A deadline already passed returns at once", "[frame_jitter]") {
+  const uint64_t now = time_us_64();
+  hal_sleep_until_us(now - 1000);
+  hal_sleep_until_us(0);
+  REQUIRE(time_us_64() - now < 1000);
+}
@@ -93,11 +93,17 @@ typedef int (*prepare_payload_fn)(void *buffer_payload, size_t size);
 typedef int (*process_response_fn)(void *buffer_payload, size_t size,
                                    uint64_t rx_time_us);
 
+/* The last request the controller sent, as the server would get it. */
+uint8_t stub_last_request[64];
+size_t stub_last_request_size = 0;
+
 int send_udp_request(size_t msg_length, prepare_payload_fn prepare_payload) {
-  (void)msg_length;
-  (void)prepare_payload;
   stub_send_udp_count++;
-  return 0;
+  if (msg_length > sizeof(stub_last_request)) {
+    return 1;
+  }
+  stub_last_request_size = msg_length;
+  return prepare_payload(stub_last_request, msg_length);
 }
 
 void start_udp(const char *server_name, uint16_t server_port, uint16_t udp_port,
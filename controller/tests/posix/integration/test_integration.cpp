@@ -15,12 +15,11 @@ extern "C" {
 #include "hal/queue.h"
 #include "hal/registry.h"
 #include "hal/time.h"
-#include "process/intercore_queue.h"
+#include "process/beat_state.h"
 #include "state_manager/state_manager.h"
 
 // Internal symbols for test setup / verification
 extern hal_queue_handle_t event_queue_ptr;
-extern hal_queue_handle_t intercore_command_queue;
 
 typedef struct state_manager_internal_state {
   state_manager_state_t current_state;
@@ -74,11 +73,12 @@ static void reset_machine() {
   internal_state.last_tempo_sync_time = 0;
   set_server_time_offset(0);
   time_sync_reset_for_testing();
+  beat_state_reset_for_testing();
   stub_reset_counters();
 }
 
 // Transition to STARTED — the real enter_started_state() initialises
-// registry, event queue, and intercore queue, then schedules a
+// registry and event queue, then schedules a
 // transition to INITIALIZED.
 static void init_system() {
   reset_machine();
@@ -145,18 +145,22 @@ static void advance_to(state_manager_state_t target) {
   }
 }
 
-// Pop one intercore message (asserts it exists).
-static intercore_message_t pop_intercore_msg() {
-  intercore_message_t msg;
-  REQUIRE(hal_queue_pop_message(intercore_command_queue, &msg));
-  return msg;
+// The beat state the LED core would read next. Nothing publishes
+// concurrently here, so the read always succeeds.
+static beat_state_t read_beat_state(uint32_t *version = nullptr) {
+  beat_state_t state;
+  uint32_t v = 0;
+  REQUIRE(beat_state_read(&state, &v));
+  if (version) {
+    *version = v;
+  }
+  return state;
 }
 
-// Drain leftover intercore messages.
-static void drain_intercore_queue() {
-  intercore_message_t msg;
-  while (hal_queue_pop_message(intercore_command_queue, &msg)) {
-  }
+static uint32_t beat_state_version() {
+  uint32_t version = 0;
+  read_beat_state(&version);
+  return version;
 }
 
 // ── Tests ────────────────────────────────────────────────────────────
@@ -183,7 +187,7 @@ TEST_CASE("Full lifecycle: UNKNOWN to TEMPO_SYNCED via server messages", "[integ
   REQUIRE(state_manager_get_state() == STATE_REGISTERED);
   // exit_initialized_state cancelled the hello timer
   REQUIRE(stub_timer_cancel_count == 1);
-  // enter_registered_state sent a time request
+  // enter_registered_state sent the first time burst request
   REQUIRE(stub_send_udp_count == 1);
 
   // ── Inject TIME_RESPONSE → TIME_SYNCED ──
@@ -221,16 +225,16 @@ TEST_CASE("Full lifecycle: UNKNOWN to TEMPO_SYNCED via server messages", "[integ
   REQUIRE(registry.tempo_period_us == 500000);
   REQUIRE(registry.program_id == 3);
 
-  // Intercore message should be queued
-  intercore_message_t ic_msg = pop_intercore_msg();
-  REQUIRE((ic_msg.message_type & INTERCORE_FLAG_TEMPO_UPDATE) != 0);
-  REQUIRE((ic_msg.message_type & INTERCORE_FLAG_PROGRAM_UPDATE) != 0);
+  // ...and published to the LED core
+  beat_state_t beat = read_beat_state();
+  REQUIRE(beat.tempo_period_us == 500000);
+  REQUIRE(beat.program_id == 3);
 
   process_pending_events();
   REQUIRE(state_manager_get_state() == STATE_TEMPO_SYNCED);
-  // 1 hello (INITIALIZED) + 1 time retry (REGISTERED) + 1 tempo retry
-  // (TIME_SYNCED) + 3 sync timers (TEMPO_SYNCED)
-  REQUIRE(stub_timer_create_count == 6);
+  // 1 hello (INITIALIZED) + 1 time burst and 1 time retry (REGISTERED) +
+  // 1 tempo retry (TIME_SYNCED) + 3 sync timers (TEMPO_SYNCED)
+  REQUIRE(stub_timer_create_count == 7);
 }
 
 TEST_CASE("State entry handlers perform correct setup", "[integration]") {
@@ -238,11 +242,8 @@ TEST_CASE("State entry handlers perform correct setup", "[integration]") {
   stub_reset_counters();
 
   SECTION("enter_started_state initialises data structures") {
-    // Already called by init_system.  Verify the queues exist.
+    // Already called by init_system.  Verify the queue exists.
     REQUIRE(event_queue_ptr != nullptr);
-    REQUIRE(intercore_command_queue != nullptr);
-    // MAX_INTERCORE_QUEUE_COUNT bumped from 64 → 128 for backpressure headroom.
-    REQUIRE(hal_queue_capacity(intercore_command_queue) == 128);
   }
 
   SECTION("enter_initialized_state starts hello timer") {
@@ -252,21 +253,21 @@ TEST_CASE("State entry handlers perform correct setup", "[integration]") {
 
   SECTION("enter_registered_state sends time request") {
     advance_to(STATE_REGISTERED);
-    // The real enter_registered_state calls send_time_request()
+    // The real enter_registered_state sends the first time burst request
     REQUIRE(stub_send_udp_count >= 1);
   }
 
   SECTION("enter_time_synced_state sends tempo request") {
     advance_to(STATE_TIME_SYNCED);
-    // send_time_request (entering REGISTERED) + send_tempo_request (entering TIME_SYNCED)
+    // Time burst request (entering REGISTERED) + tempo request (entering TIME_SYNCED)
     REQUIRE(stub_send_udp_count >= 2);
   }
 
   SECTION("enter_tempo_synced_state creates 3 repeating timers") {
     advance_to(STATE_TEMPO_SYNCED);
-    // 1 hello timer (INITIALIZED) + 1 time retry (REGISTERED) + 1 tempo
-    // retry (TIME_SYNCED) + 3 sync timers (TEMPO_SYNCED)
-    REQUIRE(stub_timer_create_count == 6);
+    // 1 hello timer (INITIALIZED) + 1 time burst and 1 time retry
+    // (REGISTERED) + 1 tempo retry (TIME_SYNCED) + 3 sync timers (TEMPO_SYNCED)
+    REQUIRE(stub_timer_create_count == 7);
   }
 
   SECTION("tempo re-sync updates registry without state re-entry") {
@@ -328,10 +329,9 @@ TEST_CASE("Time sync calculates correct clock offset", "[integration]") {
   REQUIRE(state_manager_get_state() == STATE_TIME_SYNCED);
 }
 
-TEST_CASE("Tempo response updates registry and queues intercore message", "[integration]") {
+TEST_CASE("Tempo response updates registry and publishes the beat state", "[integration]") {
   init_system();
   advance_to(STATE_TIME_SYNCED);
-  drain_intercore_queue();
 
   beatled_message_tempo_response_t tempo_msg;
   memset(&tempo_msg, 0, sizeof(tempo_msg));
@@ -347,9 +347,12 @@ TEST_CASE("Tempo response updates registry and queues intercore message", "[inte
   REQUIRE(registry.program_id == 42);
   REQUIRE(registry.update_timestamp > 0);
 
-  intercore_message_t ic = pop_intercore_msg();
-  REQUIRE((ic.message_type & (0x01 << intercore_tempo_update)) != 0);
-  REQUIRE((ic.message_type & (0x01 << intercore_program_update)) != 0);
+  // No beat yet: the grid starts now, one period to the first beat
+  beat_state_t beat = read_beat_state();
+  REQUIRE(beat.tempo_period_us == 600000);
+  REQUIRE(beat.program_id == 42);
+  REQUIRE(beat.beat_time_ref > 0);
+  REQUIRE(beat.anchor_seq == 1);
 
   process_pending_events();
   REQUIRE(state_manager_get_state() == STATE_TEMPO_SYNCED);
@@ -358,7 +361,7 @@ TEST_CASE("Tempo response updates registry and queues intercore message", "[inte
 TEST_CASE("Next beat updates registry with beat timing", "[integration]") {
   init_system();
   advance_to(STATE_TEMPO_SYNCED);
-  drain_intercore_queue();
+  const uint32_t anchor_before = read_beat_state().anchor_seq;
 
   beatled_message_next_beat_t nb_msg;
   memset(&nb_msg, 0, sizeof(nb_msg));
@@ -376,16 +379,146 @@ TEST_CASE("Next beat updates registry with beat timing", "[integration]") {
   REQUIRE(registry.next_beat_time_ref > 0);
   REQUIRE(registry.update_timestamp > 0);
 
-  intercore_message_t ic = pop_intercore_msg();
-  REQUIRE((ic.message_type & (0x01 << intercore_time_ref_update)) != 0);
+  // The LED core re-anchors on the beat, at the tempo it already has
+  beat_state_t beat = read_beat_state();
+  REQUIRE(beat.beat_count == 16);
+  REQUIRE(beat.beat_time_ref == registry.next_beat_time_ref);
+  REQUIRE(beat.tempo_period_us == 500000);
+  REQUIRE(beat.anchor_seq == anchor_before + 1);
 
   REQUIRE(state_manager_get_state() == STATE_TEMPO_SYNCED);
 }
 
+TEST_CASE("Beat schedule sets the grid shape that NEXT_BEAT clears", "[integration]") {
+  init_system();
+  advance_to(STATE_TIME_SYNCED);
+
+  // Epochs of their own re-anchor both seq counters
+  auto make_schedule = [](uint16_t seq, uint32_t beat_count) {
+    beatled_message_beat_schedule_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.base.type = BEATLED_MESSAGE_BEAT_SCHEDULE;
+    msg.beat_time_ref = htonll(9000000);
+    msg.beat_count = htonl(beat_count);
+    msg.tempo_period_us = htonl(500000);
+    msg.period_slope_ns = (int32_t)htonl((uint32_t)-1500);
+    msg.beat_span = htons(4);
+    msg.seq = htons(seq);
+    msg.epoch = htonl(0xBEA75C);
+    return msg;
+  };
+
+  auto schedule = make_schedule(5, 32);
+  event_t event = make_server_event(&schedule, sizeof(schedule));
+  REQUIRE(handle_event(&event) == 0);
+
+  REQUIRE(registry.beat_count == 32);
+  REQUIRE(registry.tempo_period_us == 500000);
+  REQUIRE(registry.period_slope_ns == -1500);
+  REQUIRE(registry.beat_span == 4);
+  uint32_t version = 0;
+  beat_state_t beat = read_beat_state(&version);
+  REQUIRE(beat.beat_count == 32);
+  REQUIRE(beat.tempo_period_us == 500000);
+  REQUIRE(beat.period_slope_ns == -1500);
+  REQUIRE(beat.beat_span == 4);
+
+  process_pending_events();
+  REQUIRE(state_manager_get_state() == STATE_TEMPO_SYNCED);
+
+  // A replayed schedule is dropped
+  auto stale = make_schedule(4, 999);
+  event = make_server_event(&stale, sizeof(stale));
+  REQUIRE(handle_event(&event) == 0);
+  REQUIRE(registry.beat_count == 32);
+  REQUIRE(beat_state_version() == version);
+
+  // NEXT_BEAT counts its seqs apart, and flattens the grid
+  beatled_message_next_beat_t nb_msg;
+  memset(&nb_msg, 0, sizeof(nb_msg));
+  nb_msg.base.type = BEATLED_MESSAGE_NEXT_BEAT;
+  nb_msg.next_beat_time_ref = htonll(9500000);
+  nb_msg.beat_count = htonl(33);
+  nb_msg.seq = htons(1);
+  nb_msg.epoch = htonl(0xBEA75C);
+  event = make_server_event(&nb_msg, sizeof(nb_msg));
+  REQUIRE(handle_event(&event) == 0);
+
+  REQUIRE(registry.beat_count == 33);
+  REQUIRE(registry.period_slope_ns == 0);
+  REQUIRE(registry.beat_span == 0);
+  beat = read_beat_state();
+  REQUIRE(beat.beat_count == 33);
+  REQUIRE(beat.period_slope_ns == 0);
+  REQUIRE(beat.beat_span == 0);
+  REQUIRE(beat.tempo_period_us == 500000);
+
+  // Wrong size is rejected by validation
+  event = make_server_event(&schedule, sizeof(schedule) - 1);
+  REQUIRE(handle_event(&event) == 1);
+}
+
+TEST_CASE("Beat schedule whose ramp leaves the tempo is rejected", "[integration]") {
+  init_system();
+  advance_to(STATE_TEMPO_SYNCED);
+
+  // The seq tracker outlives the test case: a new epoch per run re-anchors it
+  static uint32_t run_epoch = 0x5C0000;
+  const uint32_t epoch = ++run_epoch;
+  auto make_schedule = [epoch](uint16_t seq, int32_t period_slope_ns, uint16_t beat_span) {
+    beatled_message_beat_schedule_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.base.type = BEATLED_MESSAGE_BEAT_SCHEDULE;
+    msg.beat_time_ref = htonll(9000000);
+    msg.beat_count = htonl(64);
+    msg.tempo_period_us = htonl(500000);
+    msg.period_slope_ns = (int32_t)htonl((uint32_t)period_slope_ns);
+    msg.beat_span = htons(beat_span);
+    msg.seq = htons(seq);
+    msg.epoch = htonl(epoch);
+    return msg;
+  };
+
+  const uint32_t beat_count = registry.beat_count;
+  const uint32_t version = beat_state_version();
+
+  SECTION("Periods that reach zero") {
+    // 500 ms shorter every beat: the second beat would have no length
+    auto hostile = make_schedule(1, -500000000, 4);
+    event_t event = make_server_event(&hostile, sizeof(hostile));
+    REQUIRE(handle_event(&event) == 1);
+  }
+
+  SECTION("A long span of a small slope") {
+    // 10 ms per beat is harmless over 4 beats, not over 65535
+    auto hostile = make_schedule(1, -10000000, 0xFFFF);
+    event_t event = make_server_event(&hostile, sizeof(hostile));
+    REQUIRE(handle_event(&event) == 1);
+  }
+
+  SECTION("A span past the limit is clamped") {
+    auto schedule = make_schedule(1, -100000, 0xFFFF);
+    event_t event = make_server_event(&schedule, sizeof(schedule));
+    REQUIRE(handle_event(&event) == 0);
+    REQUIRE(registry.beat_count == 64);
+    REQUIRE(registry.beat_span == BEATLED_BEAT_SCHEDULE_MAX_SPAN);
+    REQUIRE(read_beat_state().beat_span == BEATLED_BEAT_SCHEDULE_MAX_SPAN);
+    return;
+  }
+
+  // The grid is untouched, and the seq not consumed
+  REQUIRE(registry.beat_count == beat_count);
+  REQUIRE(beat_state_version() == version);
+  auto schedule = make_schedule(1, -1500, 4);
+  event_t event = make_server_event(&schedule, sizeof(schedule));
+  REQUIRE(handle_event(&event) == 0);
+  REQUIRE(registry.beat_count == 64);
+}
+
 TEST_CASE("Tempo and next_beat rejected before TIME_SYNCED", "[integration]") {
   init_system();
   advance_to(STATE_REGISTERED);
-  drain_intercore_queue();
+  const uint32_t version = beat_state_version();
 
   SECTION("Tempo response rejected in REGISTERED state") {
     beatled_message_tempo_response_t tempo_msg;
@@ -412,15 +545,13 @@ TEST_CASE("Tempo and next_beat rejected before TIME_SYNCED", "[integration]") {
     REQUIRE(handle_event(&event) == 0);
     REQUIRE(state_manager_get_state() == STATE_REGISTERED);
 
-    intercore_message_t ic;
-    REQUIRE_FALSE(hal_queue_pop_message(intercore_command_queue, &ic));
+    REQUIRE(beat_state_version() == version);
   }
 }
 
-TEST_CASE("Program change updates registry and queues intercore message", "[integration]") {
+TEST_CASE("Program change updates registry and publishes the beat state", "[integration]") {
   init_system();
   advance_to(STATE_TEMPO_SYNCED);
-  drain_intercore_queue();
 
   beatled_message_program_t prog_msg;
   memset(&prog_msg, 0, sizeof(prog_msg));
@@ -432,15 +563,12 @@ TEST_CASE("Program change updates registry and queues intercore message", "[inte
   REQUIRE(handle_event(&event) == 0);
 
   REQUIRE(registry.program_id == 99);
-
-  intercore_message_t ic = pop_intercore_msg();
-  REQUIRE((ic.message_type & (0x01 << intercore_program_update)) != 0);
+  REQUIRE(read_beat_state().program_id == 99);
 }
 
 TEST_CASE("Program seq resets across a server-boot epoch change (v5)", "[integration]") {
   init_system();
   advance_to(STATE_TEMPO_SYNCED);
-  drain_intercore_queue();
 
   // Epoch E1: apply program 5 at a high seq (simulating a long-running server).
   beatled_message_program_t p1;
@@ -498,7 +626,6 @@ TEST_CASE("Multiple tempo re-syncs cycle correctly", "[integration]") {
   advance_to(STATE_TEMPO_SYNCED);
 
   // First re-sync: new tempo
-  drain_intercore_queue();
   int cancel_before = stub_timer_cancel_count;
   {
     beatled_message_tempo_response_t tempo_msg;
@@ -520,7 +647,6 @@ TEST_CASE("Multiple tempo re-syncs cycle correctly", "[integration]") {
 
   // Second re-sync: next_beat. Protocol v2 NEXT_BEAT only carries
   // next_beat_time_ref + beat_count + seq.
-  drain_intercore_queue();
   {
     beatled_message_next_beat_t nb_msg;
     memset(&nb_msg, 0, sizeof(nb_msg));
@@ -534,9 +660,7 @@ TEST_CASE("Multiple tempo re-syncs cycle correctly", "[integration]") {
   }
   REQUIRE(state_manager_get_state() == STATE_TEMPO_SYNCED);
   REQUIRE(registry.beat_count == 32);
-
-  intercore_message_t ic = pop_intercore_msg();
-  REQUIRE((ic.message_type & (0x01 << intercore_time_ref_update)) != 0);
+  REQUIRE(read_beat_state().beat_count == 32);
 }
 
 TEST_CASE("Hello response with wrong size is rejected", "[integration]") {
@@ -2,13 +2,15 @@
 //
 // Exercises the controller-side filters that protect against Wi-Fi jitter
 // and loss: the median-with-outlier-reject time offset filter, the
-// outstanding-orig_time check that drops stale TIME_RESPONSEs, and the
+// outstanding-orig_time check that drops stale TIME_RESPONSEs, the burst
+// that fills the filter on registration and after an offset jump, and the
 // 16-bit NEXT_BEAT / PROGRAM sequence-number tracking that lets us count
 // loss and ignore late duplicates without applying them.
 
 #include <catch2/catch_test_macros.hpp>
 #include <cstdlib>
 #include <cstring>
+#include <random>
 #include <vector>
 
 #ifdef __cplusplus
@@ -25,7 +27,6 @@ extern "C" {
 #include "hal/queue.h"
 #include "hal/registry.h"
 #include "hal/time.h"
-#include "process/intercore_queue.h"
 #include "state_manager/state_manager.h"
 
 #ifdef __cplusplus
@@ -33,7 +34,6 @@ extern "C" {
 #endif
 
 extern "C" hal_queue_handle_t event_queue_ptr;
-extern "C" hal_queue_handle_t intercore_command_queue;
 
 typedef struct state_manager_internal_state {
   state_manager_state_t current_state;
@@ -44,6 +44,9 @@ extern "C" state_manager_internal_state_t internal_state;
 extern "C" exit_state_fn exit_current_state;
 
 extern "C" void stub_reset_counters(void);
+extern "C" int stub_send_udp_count;
+extern "C" uint8_t stub_last_request[64];
+extern "C" size_t stub_last_request_size;
 
 namespace {
 
@@ -101,7 +104,53 @@ void reset_state() {
   stub_reset_counters();
 }
 
-void advance_to_time_synced() {
+void drain_events() {
+  event_t e;
+  while (hal_queue_pop_message(event_queue_ptr, &e)) {
+    handle_event(&e);
+  }
+}
+
+// The TIME_BURST_REQUEST the controller sent last
+beatled_message_time_burst_request_t last_burst_request() {
+  REQUIRE(stub_last_request_size == sizeof(beatled_message_time_burst_request_t));
+  beatled_message_time_burst_request_t request;
+  memcpy(&request, stub_last_request, sizeof(request));
+  REQUIRE(request.base.type == BEATLED_MESSAGE_TIME_BURST_REQUEST);
+  return request;
+}
+
+// Answer a burst request as a server `offset_us` ahead would, over a link
+// with round trip `rtt_us`, through the controller's event handler
+void answer_burst_request(const beatled_message_time_burst_request_t &request,
+                          int64_t offset_us, uint64_t rtt_us) {
+  TimeSample s = synthesise(ntohll(request.orig_time), offset_us, rtt_us);
+  beatled_message_time_burst_response_t response;
+  memset(&response, 0, sizeof(response));
+  response.base.type = BEATLED_MESSAGE_TIME_BURST_RESPONSE;
+  response.orig_time = htonll(s.orig);
+  response.recv_time = htonll(s.recv);
+  response.xmit_time = htonll(s.xmit);
+  response.index = request.index;
+  void *data = malloc(sizeof(response));
+  memcpy(data, &response, sizeof(response));
+  event_t e{event_server_message, s.dest, sizeof(response), data};
+  REQUIRE(handle_event(&e) == 0);
+  drain_events();
+}
+
+// Answer the request the burst sent when it started, then fire the burst
+// timer for every other slot and answer each request
+void run_burst(int64_t offset_us, uint64_t rtt_us) {
+  for (int i = 0; i < 8; i++) {
+    if (i > 0) {
+      time_sync_burst_tick_for_testing();
+    }
+    answer_burst_request(last_burst_request(), offset_us, rtt_us);
+  }
+}
+
+void advance_to_registered() {
   reset_state();
   REQUIRE(state_manager_set_state(STATE_STARTED) == 0);
   event_t e;
@@ -122,6 +171,11 @@ void advance_to_time_synced() {
     handle_event(&e);
   }
   REQUIRE(state_manager_get_state() == STATE_REGISTERED);
+}
+
+void advance_to_time_synced() {
+  advance_to_registered();
+  event_t e;
 
   // Drive at least one good time sample so we move into TIME_SYNCED.
   TimeSample first = synthesise(/*orig=*/1000, /*offset_us=*/0,
@@ -182,6 +236,162 @@ TEST_CASE("Stale TIME_RESPONSE is dropped",
   REQUIRE(get_server_time_offset() == baseline);
 }
 
+TEST_CASE("Registering starts a burst that fills the offset filter at once",
+          "[integration][sync][burst]") {
+  advance_to_registered();
+  REQUIRE(time_sync_burst_active());
+  REQUIRE(time_sync_valid_sample_count() == 0);
+
+  // One sample per slot of the ring, each slightly off, in the time a single
+  // refresh used to take
+  const int64_t true_offset = 25000;
+  std::mt19937 random{7};
+  std::uniform_int_distribution<int64_t> jitter{-200, 200};
+  std::uniform_int_distribution<uint64_t> rtt{3000, 6000};
+  for (int i = 0; i < 8; i++) {
+    if (i > 0) {
+      time_sync_burst_tick_for_testing();
+    }
+    auto request = last_burst_request();
+    REQUIRE(request.index == i);
+    answer_burst_request(request, true_offset + jitter(random), rtt(random));
+  }
+
+  REQUIRE(state_manager_get_state() == STATE_TIME_SYNCED);
+  REQUIRE(time_sync_valid_sample_count() == 8);
+  REQUIRE(std::abs(get_server_time_offset() - true_offset) <= 204);
+  // Every response is in: the burst is over, and its timer sends nothing more
+  REQUIRE_FALSE(time_sync_burst_active());
+  const int sent = stub_send_udp_count;
+  time_sync_burst_tick_for_testing();
+  REQUIRE(stub_send_udp_count == sent);
+}
+
+TEST_CASE("Burst responses are matched by index, stale ones dropped",
+          "[integration][sync][burst]") {
+  advance_to_registered();
+
+  std::vector<beatled_message_time_burst_request_t> requests{last_burst_request()};
+  for (int i = 1; i < 3; i++) {
+    time_sync_burst_tick_for_testing();
+    requests.push_back(last_burst_request());
+  }
+
+  // Out of order is fine
+  answer_burst_request(requests[2], 1000, 4000);
+  answer_burst_request(requests[0], 1000, 4000);
+  REQUIRE(time_sync_valid_sample_count() == 2);
+
+  // A duplicate, a slot not sent yet, and a response to an earlier burst
+  // (right index, wrong orig_time) are all dropped
+  answer_burst_request(requests[0], 1000, 4000);
+  auto unsent = requests[1];
+  unsent.index = 5;
+  answer_burst_request(unsent, 1000, 4000);
+  auto earlier = requests[1];
+  earlier.orig_time = htonll(ntohll(earlier.orig_time) - 1000000);
+  answer_burst_request(earlier, -90000, 4000);
+  REQUIRE(time_sync_valid_sample_count() == 2);
+  REQUIRE(std::abs(get_server_time_offset() - 1000) <= 4);
+
+  answer_burst_request(requests[1], 1000, 4000);
+  REQUIRE(time_sync_valid_sample_count() == 3);
+  REQUIRE(time_sync_burst_active());
+}
+
+TEST_CASE("An offset jump starts a burst that moves the filter at once",
+          "[integration][sync][burst]") {
+  advance_to_registered();
+  run_burst(0, 4000);
+  REQUIRE(state_manager_get_state() == STATE_TIME_SYNCED);
+  REQUIRE_FALSE(time_sync_burst_active());
+  REQUIRE(std::abs(get_server_time_offset()) <= 4);
+
+  // A slow round trip is an outlier, not a jump
+  inject_time_sample(synthesise(time_us_64(), 30000, 100000));
+  REQUIRE_FALSE(time_sync_burst_active());
+  // A fast one that far off is: the median still holds the old offset, and
+  // would for 4 more refreshes, but a burst starts
+  inject_time_sample(synthesise(time_us_64(), 30000, 4000));
+  REQUIRE(std::abs(get_server_time_offset()) <= 4);
+  REQUIRE(time_sync_burst_active());
+
+  run_burst(30000, 4000);
+  REQUIRE(std::abs(get_server_time_offset() - 30000) <= 4);
+  REQUIRE_FALSE(time_sync_burst_active());
+}
+
+TEST_CASE("50 ppm of drift is fitted as skew and extrapolated between refreshes",
+          "[integration][sync][skew]") {
+  advance_to_registered();
+  const uint64_t t0 = time_us_64();
+  const int64_t offset0 = 20000;
+  const int64_t drift_ppm = 50;
+  auto true_offset = [&](uint64_t t) {
+    return offset0 + (int64_t)(t - t0) * drift_ppm / 1000000;
+  };
+  run_burst(offset0, 4000);
+
+  // A refresh every 50s, each sample up to 200us off
+  const uint64_t refresh_us = 50000000;
+  std::mt19937 random{11};
+  std::uniform_int_distribution<int64_t> jitter{-200, 200};
+  std::uniform_int_distribution<uint64_t> rtt{3000, 6000};
+  for (int k = 1; k <= 20; k++) {
+    const uint64_t t = t0 + k * refresh_us;
+    inject_time_sample(synthesise(t, true_offset(t) + jitter(random), rtt(random)));
+    // Drift moves the offset 2.5ms per refresh; the model expects that
+    REQUIRE_FALSE(time_sync_burst_active());
+
+    // Phase error at the worst point, just before the next refresh. A
+    // constant offset would be 2.5ms off here, even with no noise at all.
+    const uint64_t next = t + refresh_us;
+    INFO("refresh " << k);
+    REQUIRE(std::abs(server_time_offset_at(next) - true_offset(next)) <= 500);
+    const uint64_t beat = (uint64_t)((int64_t)next + true_offset(next));
+    REQUIRE(std::abs((int64_t)(server_time_to_local_time(beat) - next)) <= 500);
+  }
+
+  REQUIRE(std::abs(get_server_clock_skew_ppb() - drift_ppm * 1000) <= 2000);
+}
+
+TEST_CASE("100 ppm of drift over a fast link is fitted, not taken for a jump",
+          "[integration][sync][skew]") {
+  // Right after the burst the skew is unknown, and a 1ms round trip judges
+  // jumps at 4ms: the first refresh is already 5ms off a constant offset
+  advance_to_registered();
+  const uint64_t t0 = time_us_64();
+  const int64_t offset0 = -15000;
+  const int64_t drift_ppm = 100;
+  auto true_offset = [&](uint64_t t) {
+    return offset0 + (int64_t)(t - t0) * drift_ppm / 1000000;
+  };
+  run_burst(offset0, 1000);
+  REQUIRE(get_server_clock_skew_ppb() == 0);
+
+  const uint64_t refresh_us = 50000000;
+  std::mt19937 random{13};
+  std::uniform_int_distribution<int64_t> jitter{-100, 100};
+  std::uniform_int_distribution<uint64_t> rtt{800, 1200};
+  for (int k = 1; k <= 20; k++) {
+    const uint64_t t = t0 + k * refresh_us;
+    inject_time_sample(synthesise(t, true_offset(t) + jitter(random), rtt(random)));
+    INFO("refresh " << k);
+    REQUIRE_FALSE(time_sync_burst_active());
+
+    const uint64_t next = t + refresh_us;
+    REQUIRE(std::abs(server_time_offset_at(next) - true_offset(next)) <= 500);
+  }
+
+  REQUIRE(std::abs(get_server_clock_skew_ppb() - drift_ppm * 1000) <= 2000);
+
+  // Once the skew is known a jump is still one, however long since the
+  // last refresh
+  const uint64_t t = t0 + 21 * refresh_us;
+  inject_time_sample(synthesise(t, true_offset(t) + 10000, 1000));
+  REQUIRE(time_sync_burst_active());
+}
+
 TEST_CASE("NEXT_BEAT sequence gaps are counted, stale duplicates ignored",
           "[integration][sync]") {
   advance_to_time_synced();
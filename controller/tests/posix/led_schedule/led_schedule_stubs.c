@@ -0,0 +1,75 @@
+/*
+ * LED schedule test stubs: a clock the test moves by hand and a strip
+ * that only counts frames.
+ *
+ * ws2812.c is compiled as is. Rendering advances the clock by
+ * stub_render_us, so the test decides how long each frame takes, and the
+ * latency model it reports is whatever the test put in stub_latency_model.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hal/registry.h"
+#include "hal/time.h"
+#include "hal/ws2812.h"
+#include "state_manager/state_manager.h"
+
+uint64_t stub_now_us = 0;
+uint32_t stub_render_us = 0;
+ws2812_latency_model_t stub_latency_model = {0};
+
+/* What the last frame rendered */
+uint8_t stub_last_beat_pos = 0;
+uint32_t stub_last_beat_count = 0;
+uint32_t stub_frame_count = 0;
+
+/* ── Time HAL ────────────────────────────────────────────────────── */
+uint64_t time_us_64(void) { return stub_now_us; }
+
+uint64_t get_local_time_us(void) { return stub_now_us; }
+
+void hal_sleep_ms(uint32_t ms) { stub_now_us += (uint64_t)ms * 1000u; }
+
+/* ── Strip ───────────────────────────────────────────────────────── */
+void ws2812_init(uint16_t num_pixel, uint8_t ws2812_pin, uint32_t frequency, bool is_rgbw) {
+  (void)num_pixel;
+  (void)ws2812_pin;
+  (void)frequency;
+  (void)is_rgbw;
+}
+
+void ws2812_get_latency_model(ws2812_latency_model_t *model) { *model = stub_latency_model; }
+
+void output_strings_dma(uint32_t *stream) {
+  (void)stream;
+  stub_frame_count++;
+}
+
+void run_pattern(int pattern_idx, uint32_t *stream, size_t len, uint8_t beat_pos,
+                 uint32_t beat_count) {
+  (void)pattern_idx;
+  (void)stream;
+  (void)len;
+  stub_last_beat_pos = beat_pos;
+  stub_last_beat_count = beat_count;
+  stub_now_us += stub_render_us;
+}
+
+/* ── Registry / state manager / HUD ──────────────────────────────── */
+registry_t registry;
+
+bool registry_try_lock_mutex() { return false; }
+void registry_unlock_mutex() {}
+
+state_manager_state_t state_manager_get_state() { return STATE_TEMPO_SYNCED; }
+
+void push_status_update(uint8_t state, bool connected, uint16_t program_id,
+                        uint32_t tempo_period_us, uint32_t beat_count, int64_t time_offset) {
+  (void)state;
+  (void)connected;
+  (void)program_id;
+  (void)tempo_period_us;
+  (void)beat_count;
+  (void)time_offset;
+}
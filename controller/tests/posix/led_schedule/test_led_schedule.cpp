@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include "config/constants.h"
+#include "hal/ws2812.h"
+#include "process/beat_state.h"
+#include "ws2812/ws2812.h"
+
+// led_schedule_stubs.c
+extern uint64_t stub_now_us;
+extern uint32_t stub_render_us;
+extern ws2812_latency_model_t stub_latency_model;
+extern uint8_t stub_last_beat_pos;
+extern uint32_t stub_last_beat_count;
+}
+
+namespace {
+
+constexpr uint64_t FRAME_US = LED_CORE_SLEEP_MS * 1000;
+constexpr uint32_t BEAT_COUNT = 100;
+// Not a whole number of frames: every boundary pulls a frame in
+constexpr uint32_t PERIOD_US = 487300;
+
+// What the pico port reports for an RGB strip at 800 kHz
+constexpr ws2812_latency_model_t PICO_MODEL = {1, 30000, 400};
+
+// ws2812.c keeps its place on the grid between test cases: each one runs a
+// minute after the last
+uint64_t fresh_epoch() {
+  static uint64_t epoch = 0;
+  epoch += 60000000;
+  return epoch;
+}
+
+struct frame_t {
+  uint64_t present_us; // the time the frame was rendered for
+  uint8_t beat_pos;
+  uint32_t beat_count;
+};
+
+// The LED core's loop: render, then sleep to the returned deadline, or not
+// at all if it has passed. On an idle strip a frame woken at `wake` is
+// rendered for `wake + lead_us`.
+std::vector<frame_t> run_frames(uint64_t until, uint64_t lead_us) {
+  std::vector<frame_t> frames;
+  while (stub_now_us < until) {
+    const uint64_t wake = stub_now_us;
+    const uint64_t deadline = led_update();
+    frames.push_back({wake + lead_us, stub_last_beat_pos, stub_last_beat_count});
+    stub_now_us = std::max(stub_now_us, deadline);
+  }
+  return frames;
+}
+
+beat_state_t publish_grid(uint64_t beat_time_ref, int32_t period_slope_ns, uint16_t beat_span) {
+  beat_state_publish_schedule(beat_time_ref, BEAT_COUNT, PERIOD_US, period_slope_ns, beat_span);
+  beat_state_t grid = {};
+  grid.beat_time_ref = beat_time_ref;
+  grid.beat_count = BEAT_COUNT;
+  grid.tempo_period_us = PERIOD_US;
+  grid.period_slope_ns = period_slope_ns;
+  grid.beat_span = beat_span;
+  return grid;
+}
+
+uint64_t boundary_of(const beat_state_t &grid, uint32_t beat_count) {
+  return beat_state_beat_time(&grid, (int64_t)beat_count - BEAT_COUNT);
+}
+
+} // namespace
+
+TEST_CASE("A frame lands on every beat boundary", "[led_schedule]") {
+  constexpr uint32_t RENDER_US = 700;
+  const uint64_t epoch = fresh_epoch();
+  stub_now_us = epoch;
+  stub_render_us = RENDER_US;
+  stub_latency_model = PICO_MODEL;
+  led_init();
+
+  ws2812_timeline_t timeline;
+  ws2812_timeline_init(&timeline, &PICO_MODEL, NUM_PIXELS);
+  const uint64_t lead = ws2812_timeline_lead_us(&timeline) + RENDER_US;
+
+  int32_t slope_ns = 0;
+  uint16_t span = 0;
+  SECTION("Flat grid") {}
+  SECTION("Ramping grid") {
+    slope_ns = -1500;
+    span = 8;
+  }
+  const beat_state_t grid = publish_grid(epoch + 3000, slope_ns, span);
+  const uint64_t until = epoch + 3000000;
+  auto frames = run_frames(until, lead);
+  // The first frame was timed with the previous render time
+  frames.erase(frames.begin());
+
+  uint32_t boundaries = 0;
+  for (uint32_t count = BEAT_COUNT + 1; boundary_of(grid, count) < until - FRAME_US; count++) {
+    const uint64_t boundary = boundary_of(grid, count);
+    const auto on_boundary = std::find_if(frames.begin(), frames.end(), [&](const frame_t &f) {
+      return f.present_us == boundary;
+    });
+    REQUIRE(on_boundary != frames.end());
+    // ...and renders the new beat from its start
+    REQUIRE(on_boundary->beat_pos == 0);
+    REQUIRE(on_boundary->beat_count == count);
+    boundaries++;
+  }
+  REQUIRE(boundaries >= 5);
+
+  // Every other frame is a whole number of frames into its beat
+  for (const frame_t &f : frames) {
+    const uint64_t beat_start = boundary_of(grid, f.beat_count);
+    REQUIRE(f.present_us >= beat_start);
+    REQUIRE((f.present_us - beat_start) % FRAME_US == 0);
+  }
+}
+
+TEST_CASE("Slow frames skip grid slots instead of bunching up", "[led_schedule]") {
+  constexpr uint32_t RENDER_US = 500;
+  constexpr uint32_t SLOW_RENDER_US = 23000;
+  const uint64_t epoch = fresh_epoch();
+  stub_now_us = epoch;
+  stub_render_us = RENDER_US;
+  // No wire: the lead is the render time alone
+  stub_latency_model = ws2812_latency_model_t{};
+  led_init();
+
+  const beat_state_t grid = publish_grid(epoch + 3000, 0, 0);
+  run_frames(epoch + 300000, RENDER_US);
+
+  stub_render_us = SLOW_RENDER_US;
+  auto frames = run_frames(epoch + 2000000, SLOW_RENDER_US);
+  // Woken for the fast render time; rendered for the time it shows from
+  // the next frame on
+  frames.erase(frames.begin());
+
+  uint32_t skipped = 0;
+  for (size_t i = 1; i < frames.size(); i++) {
+    const frame_t &previous = frames[i - 1];
+    const frame_t &frame = frames[i];
+    const uint64_t beat_start = boundary_of(grid, frame.beat_count);
+    REQUIRE(frame.present_us >= beat_start);
+    // Never before the previous frame is out...
+    REQUIRE(frame.present_us - previous.present_us >= SLOW_RENDER_US);
+
+    if (frame.beat_count != previous.beat_count) {
+      // A boundary already passed by the time its frame could be rendered
+      // shows at once
+      REQUIRE(frame.present_us - beat_start <= SLOW_RENDER_US);
+      continue;
+    }
+    // ...and otherwise on the first grid slot after it
+    REQUIRE((frame.present_us - beat_start) % FRAME_US == 0);
+    REQUIRE(frame.present_us - previous.present_us < SLOW_RENDER_US + FRAME_US);
+    skipped += (uint32_t)((frame.present_us - previous.present_us) / FRAME_US) - 1;
+  }
+  REQUIRE(frames.size() > 30);
+  // Three slots per frame: two of them skipped
+  REQUIRE(skipped >= frames.size());
+}
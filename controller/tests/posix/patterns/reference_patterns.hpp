@@ -0,0 +1,180 @@
+// The pattern programs as they were before the packed-pixel kernels: one
+// division per channel, per pixel. The golden tests hold the ported
+// programs to these bit for bit, and the benchmark measures against them.
+
+#ifndef TESTS__POSIX__PATTERNS__REFERENCE_PATTERNS_HPP_
+#define TESTS__POSIX__PATTERNS__REFERENCE_PATTERNS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "programs/utils.h"
+
+namespace reference {
+
+inline uint8_t brightness_apply(uint8_t value, uint8_t max_brightness) {
+  return (uint8_t)(((uint32_t)gamma8[value] * max_brightness + 127u) / 255u);
+}
+
+inline uint32_t color_scale(uint32_t color, uint8_t scale) {
+  uint32_t g = ((((color >> 24) & 0xffu) * scale) + 127u) / 255u;
+  uint32_t r = ((((color >> 16) & 0xffu) * scale) + 127u) / 255u;
+  uint32_t b = ((((color >> 8) & 0xffu) * scale) + 127u) / 255u;
+  return (g << 24) | (r << 16) | (b << 8);
+}
+
+inline uint32_t convert_hsv_to_rgb(uint8_t hue, uint8_t saturation, uint8_t value) {
+  uint8_t red, green, blue;
+  unsigned char region, remainder, p, q, t;
+
+  if (saturation == 0) {
+    return rgb_u32(value, value, value);
+  }
+
+  region = hue / 43;
+  remainder = (hue - (region * 43)) * 6;
+
+  p = (value * (255 - saturation)) >> 8;
+  q = (value * (255 - ((saturation * remainder) >> 8))) >> 8;
+  t = (value * (255 - ((saturation * (255 - remainder)) >> 8))) >> 8;
+
+  switch (region) {
+  case 0:
+    red = value, green = t, blue = p;
+    break;
+  case 1:
+    red = q, green = value, blue = p;
+    break;
+  case 2:
+    red = p, green = value, blue = t;
+    break;
+  case 3:
+    red = p, green = q, blue = value;
+    break;
+  case 4:
+    red = t, green = p, blue = value;
+    break;
+  default:
+    red = value, green = p, blue = q;
+    break;
+  }
+  return rgb_u32(red, green, blue);
+}
+
+inline void snakes(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
+  if (len == 0) {
+    return;
+  }
+  uint32_t loop_phase = ((uint32_t)(beat_count % 4u) << 8) + t;
+  uint32_t ring_q8 = (uint32_t)len << 8;
+  uint32_t head_q8 = (loop_phase * (uint32_t)len) / 4u;
+  head_q8 %= ring_q8;
+  uint32_t tail_q8 = ring_q8 / 3u;
+  if (tail_q8 == 0) {
+    tail_q8 = 256;
+  }
+  uint8_t beat_env = 70u + (uint8_t)(((255u - 70u) * beat_intensity_quadratic(t)) >> 8);
+  uint8_t head_hue = (uint8_t)(beat_count * 32u);
+
+  for (size_t i = 0; i < len; ++i) {
+    uint32_t pixel_q8 = (uint32_t)i << 8;
+    uint32_t dist_q8 = (head_q8 + ring_q8 - pixel_q8) % ring_q8;
+    if (dist_q8 >= tail_q8) {
+      stream[i] = 0;
+      continue;
+    }
+    uint32_t tail_fade = (tail_q8 - dist_q8) * 255u / tail_q8;
+    uint8_t value = (uint8_t)((tail_fade * beat_env) >> 8);
+    uint8_t hue = head_hue + (uint8_t)(dist_q8 * 48u / tail_q8);
+    stream[i] = color_scale(convert_hsv_to_rgb(hue, 255, 255), brightness_apply(value, 125u));
+  }
+}
+
+inline void random(uint32_t *stream, size_t len, uint8_t t, uint32_t) {
+  if (t < 8) {
+    return;
+  }
+  uint8_t update_mask = t < 64 ? 0x03 : t < 128 ? 0x07 : 0x0F;
+  if ((t & update_mask) != 0) {
+    return;
+  }
+  uint8_t max_brightness = brightness_apply(beat_intensity_quadratic(t), 16u);
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t r = (rand() % (max_brightness + 1u));
+    uint8_t g = (rand() % (max_brightness + 1u));
+    uint8_t b = (rand() % (max_brightness + 1u));
+    stream[i] = rgb_u32(r, g, b);
+  }
+}
+
+inline void sparkle(uint32_t *stream, size_t len, uint8_t t, uint32_t) {
+  uint8_t density_threshold = t < 32 ? 4 : t < 128 ? 8 : 16;
+  uint8_t brightness = brightness_apply(beat_intensity_quadratic(t), 64u);
+  uint32_t color = rgb_u32(brightness, brightness, brightness);
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = (rand() % density_threshold == 0) ? color : 0;
+  }
+}
+
+inline void greys(uint32_t *stream, size_t len, uint8_t t, uint32_t) {
+  uint8_t brightness = brightness_apply(beat_intensity_exp4(t), 32u);
+  uint32_t color = rgb_u32(brightness, brightness, brightness);
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = color;
+  }
+}
+
+inline void drops(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
+  int pos = (t * NUM_PIXELS) >> 8;
+  uint8_t max_intensity = beat_intensity_quadratic(t);
+  uint8_t hue = (beat_count << 4) % 256;
+  uint32_t color = convert_hsv_to_rgb(hue, 255, 255);
+  for (size_t i = 0; i < len; ++i) {
+    int value = 0;
+    int distance = pos - (int)i;
+    int trail_length = NUM_PIXELS / 3;
+    if (distance >= 0 && distance < trail_length) {
+      value = max_intensity - (distance * max_intensity / trail_length);
+    }
+    stream[i] = color_scale(color, brightness_apply((uint8_t)value, 64u));
+  }
+}
+
+inline void solid(uint32_t *stream, size_t len, uint8_t t, uint32_t) {
+  uint8_t pos = brightness_apply(t, 125u);
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = (pos * 0x01010100);
+  }
+}
+
+inline void fade_grey(uint32_t *stream, size_t len, uint8_t t, uint32_t) {
+  uint8_t value = brightness_apply(beat_intensity_quadratic(t), 64u);
+  uint32_t v = value * 0x01010100;
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = v;
+  }
+}
+
+inline void fade_color(uint32_t *stream, size_t len, uint8_t t, uint32_t beat_count) {
+  uint8_t value = brightness_apply(beat_intensity_quadratic(t), 64u);
+  uint32_t color = color_scale(convert_hsv_to_rgb((beat_count << 2) % 255, 255, 255), value);
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = color;
+  }
+}
+
+inline void off(uint32_t *stream, size_t len, uint8_t, uint32_t) {
+  for (size_t i = 0; i < len; ++i) {
+    stream[i] = 0;
+  }
+}
+
+// Indexed by program id, in BEATLED_PROGRAM_TABLE order
+using pattern_fn = void (*)(uint32_t *, size_t, uint8_t, uint32_t);
+constexpr pattern_fn PROGRAMS[] = {snakes, random, sparkle, greys, drops,
+                                   solid,  fade_grey, fade_color, off};
+
+} // namespace reference
+
+#endif // TESTS__POSIX__PATTERNS__REFERENCE_PATTERNS_HPP_
@@ -4,9 +4,13 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include "beatled/protocol.h"
+#include "programs/utils.h"
+#include "reference_patterns.hpp"
 #include "ws2812_patterns.h"
 
 namespace {
@@ -84,3 +88,113 @@ TEST_CASE("patterns tolerate len == 0 and out-of-range ids", "[patterns]") {
     REQUIRE(stream[i] == 0);
   }
 }
+
+TEST_CASE("packed-pixel helpers match per-channel division", "[patterns]") {
+  // Exhaustive where it is cheap; mismatches are counted rather than
+  // REQUIREd one by one so the sweep stays fast
+  uint32_t mismatches = 0;
+  for (uint32_t x = 0; x <= 255u * 255u + 127u; ++x) {
+    mismatches += div255(x) != x / 255u;
+  }
+  REQUIRE(mismatches == 0);
+
+  for (uint32_t a = 0; a < 256; ++a) {
+    for (uint32_t b = 0; b < 256; ++b) {
+      const uint32_t color = rgb_u32(a, b, a ^ b);
+      for (uint32_t scale = 0; scale < 256; ++scale) {
+        mismatches += color_scale(color, scale) != reference::color_scale(color, scale);
+      }
+    }
+  }
+  REQUIRE(mismatches == 0);
+
+  // Blending rounds the weighted sum once
+  for (uint32_t a = 0; a < 256; a += 5) {
+    for (uint32_t b = 0; b < 256; b += 3) {
+      for (uint32_t alpha = 0; alpha < 256; ++alpha) {
+        const uint32_t expected = (a * (255 - alpha) + b * alpha + 127) / 255;
+        mismatches += color_blend(rgb_u32(a, b, a), rgb_u32(b, a, b), alpha) !=
+                      rgb_u32(expected, (b * (255 - alpha) + a * alpha + 127) / 255, expected);
+      }
+    }
+  }
+  REQUIRE(mismatches == 0);
+
+  for (uint32_t hue = 0; hue < 256; ++hue) {
+    for (uint32_t sat = 0; sat < 256; ++sat) {
+      for (uint32_t val = 0; val < 256; val += 17) {
+        mismatches +=
+            convert_hsv_to_rgb(hue, sat, val) != reference::convert_hsv_to_rgb(hue, sat, val);
+      }
+    }
+  }
+  REQUIRE(mismatches == 0);
+
+  for (uint32_t max = 0; max < 256; ++max) {
+    brightness_lut_t lut = BRIGHTNESS_LUT_INIT(static_cast<uint8_t>(max));
+    const uint8_t *levels = brightness_lut(&lut);
+    for (uint32_t v = 0; v < 256; ++v) {
+      mismatches += levels[v] != reference::brightness_apply(v, max);
+    }
+  }
+  REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("stream kernels match the per-pixel helpers", "[patterns]") {
+  std::vector<uint32_t> colors;
+  for (uint32_t a = 0; a < 256; a += 15) {
+    for (uint32_t b = 0; b < 256; b += 17) {
+      colors.push_back(rgb_u32(a, b, a ^ b));
+    }
+  }
+  std::vector<uint32_t> targets(colors.rbegin(), colors.rend());
+
+  uint32_t mismatches = 0;
+  for (uint32_t k = 0; k < 256; ++k) {
+    std::vector<uint32_t> scaled = colors;
+    stream_scale(scaled.data(), scaled.size(), k);
+    std::vector<uint32_t> blended = colors;
+    stream_blend(blended.data(), targets.data(), blended.size(), k);
+    for (size_t i = 0; i < colors.size(); ++i) {
+      mismatches += scaled[i] != color_scale(colors[i], k);
+      mismatches += blended[i] != color_blend(colors[i], targets[i], k);
+    }
+  }
+  REQUIRE(mismatches == 0);
+
+  // Scaling white is how the grey programs set a level
+  for (uint32_t level = 0; level < 256; ++level) {
+    uint32_t pixel = rgb_u32(255, 255, 255);
+    stream_scale(&pixel, 1, level);
+    mismatches += pixel != rgb_u32(level, level, level);
+  }
+  REQUIRE(mismatches == 0);
+
+  // Nothing past `len` is touched
+  uint32_t pair[2] = {rgb_u32(10, 20, 30), rgb_u32(40, 50, 60)};
+  stream_scale(pair, 1, 0);
+  stream_blend(pair, pair, 0, 128);
+  REQUIRE(pair[0] == 0);
+  REQUIRE(pair[1] == rgb_u32(40, 50, 60));
+}
+
+TEST_CASE("every program matches its reference bit for bit", "[patterns]") {
+  // The whole beat at several strip lengths and beat counts, both sides
+  // seeded alike so the random programs draw the same numbers
+  for (size_t len : {size_t{1}, size_t{7}, kLen, size_t{NUM_PIXELS}, size_t{300}}) {
+    std::vector<uint32_t> expected(len, 0xDEADBEEF);
+    std::vector<uint32_t> actual(len, 0xDEADBEEF);
+    for (int id = 0; id < BEATLED_PROGRAM_COUNT; ++id) {
+      for (uint32_t beat : {0u, 1u, 3u, 5u, 17u, 100u}) {
+        for (int t = 0; t < 256; ++t) {
+          std::srand(beat * 256 + t);
+          reference::PROGRAMS[id](expected.data(), len, t, beat);
+          std::srand(beat * 256 + t);
+          run_pattern(id, actual.data(), len, t, beat);
+          INFO("program " << id << " len " << len << " beat " << beat << " t " << t);
+          REQUIRE(actual == expected);
+        }
+      }
+    }
+  }
+}
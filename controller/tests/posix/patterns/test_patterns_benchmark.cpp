@@ -0,0 +1,53 @@
+// Cost per pixel of every program, before (the reference per-channel
+// division code) and after the packed-pixel kernels. A host CPU divides in
+// hardware, so the gap here understates the one on the Cortex-M0+, where
+// every division is a library call.
+//
+// Run with: ./test_patterns_benchmark "[!benchmark]"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "beatled/protocol.h"
+#include "reference_patterns.hpp"
+#include "ws2812_patterns.h"
+
+namespace {
+
+constexpr size_t kLen = 300;
+constexpr int kSweeps = 200;
+
+// ns per pixel over kSweeps whole beats, one frame per beat position
+template <typename Fn> double ns_per_pixel(Fn &&render) {
+  std::vector<uint32_t> stream(kLen, 0);
+  uint32_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int sweep = 0; sweep < kSweeps; ++sweep) {
+    for (int t = 0; t < 256; ++t) {
+      render(stream.data(), static_cast<uint8_t>(t), static_cast<uint32_t>(sweep));
+      sink += stream[t % kLen];
+    }
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  // Keep the frames observable so the loops aren't optimised away
+  volatile uint32_t keep = sink;
+  (void)keep;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (kSweeps * 256.0 * kLen);
+}
+
+} // namespace
+
+TEST_CASE("Per-pixel cost of each program", "[!benchmark][patterns]") {
+  std::printf("%-14s %12s %12s\n", "program", "before ns/px", "after ns/px");
+  for (int id = 0; id < BEATLED_PROGRAM_COUNT; ++id) {
+    const double before = ns_per_pixel([id](uint32_t *stream, uint8_t t, uint32_t beat) {
+      reference::PROGRAMS[id](stream, kLen, t, beat);
+    });
+    const double after = ns_per_pixel(
+        [id](uint32_t *stream, uint8_t t, uint32_t beat) { run_pattern(id, stream, kLen, t, beat); });
+    std::printf("%-14s %12.2f %12.2f\n", pattern_get_name(id), before, after);
+  }
+}
@@ -50,14 +50,26 @@ TEST_CASE("Protocol struct sizes match wire format", "[protocol]") {
     REQUIRE(sizeof(beatled_message_time_response_t) == 25);
   }
 
-  SECTION("QoS block is 36 bytes (v4)") {
-    // int64 offset (8) + uint64 uptime (8) + 4 * uint32 (16) + 2 * uint16 (4)
-    REQUIRE(sizeof(beatled_qos_block_t) == 36);
+  SECTION("Time burst request is 10 bytes (v5.1)") {
+    // 1 byte type + 8 bytes orig_time + 1 byte index
+    REQUIRE(sizeof(beatled_message_time_burst_request_t) == 10);
   }
 
-  SECTION("Tempo request is 41 bytes (v4)") {
-    // 1 byte type + 4 bytes owd_us_estimate + 36 byte qos block
-    REQUIRE(sizeof(beatled_message_tempo_request_t) == 41);
+  SECTION("Time burst response is TIME_RESPONSE + index (v5.1)") {
+    REQUIRE(sizeof(beatled_message_time_burst_response_t) == 26);
+    REQUIRE(offsetof(beatled_message_time_burst_response_t, xmit_time) ==
+            offsetof(beatled_message_time_response_t, xmit_time));
+  }
+
+  SECTION("QoS block is 42 bytes (v6)") {
+    // int64 offset (8) + uint64 uptime (8) + 4 * uint32 (16) + 2 * uint16 (4),
+    // then the v6 receive-slab counters: uint32 (4) + uint16 (2)
+    REQUIRE(sizeof(beatled_qos_block_t) == 42);
+  }
+
+  SECTION("Tempo request is 47 bytes (v6)") {
+    // 1 byte type + 4 bytes owd_us_estimate + 42 byte qos block
+    REQUIRE(sizeof(beatled_message_tempo_request_t) == 47);
   }
 
   SECTION("Status request is 9 bytes (v4)") {
@@ -65,9 +77,9 @@ TEST_CASE("Protocol struct sizes match wire format", "[protocol]") {
     REQUIRE(sizeof(beatled_message_status_request_t) == 9);
   }
 
-  SECTION("Status response is 45 bytes (v4)") {
-    // 1 byte type + 8 echo + 36 qos block
-    REQUIRE(sizeof(beatled_message_status_response_t) == 45);
+  SECTION("Status response is 51 bytes (v6)") {
+    // 1 byte type + 8 echo + 42 qos block
+    REQUIRE(sizeof(beatled_message_status_response_t) == 51);
   }
 
   SECTION("Tempo response is 15 bytes") {
@@ -90,8 +102,40 @@ TEST_CASE("Protocol struct sizes match wire format", "[protocol]") {
     REQUIRE(sizeof(beatled_message_beat_t) == 19);
   }
 
+  SECTION("Beat schedule message is 29 bytes (v5.2)") {
+    // base(1) + beat_time_ref(8) + beat_count(4) + tempo_period_us(4) +
+    // period_slope_ns(4) + beat_span(2) + seq(2) + epoch(4) = 29
+    REQUIRE(sizeof(beatled_message_beat_schedule_t) == 29);
+  }
+
   SECTION("Message type enum has expected count") {
-    // v4 added STATUS_REQUEST + STATUS_RESPONSE
-    REQUIRE(BEATLED_MESSAGE_LAST_VALUE == 12);
+    // v4 added STATUS_REQUEST + STATUS_RESPONSE, v5.1 TIME_BURST_REQUEST +
+    // TIME_BURST_RESPONSE, v5.2 BEAT_SCHEDULE
+    REQUIRE(BEATLED_MESSAGE_LAST_VALUE == 15);
+  }
+}
+
+TEST_CASE("Beat schedule offsets follow the ramp, then hold its last period", "[protocol]") {
+  SECTION("A flat schedule is a plain grid, both ways from the anchor") {
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 0, 0, 0) == 0);
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 0, 0, 3) == 1500000);
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 0, 0, -2) == -1000000);
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 1000, 0, 3) == 1500000);
+  }
+
+  SECTION("Each beat of the span is one slope longer than the last") {
+    // Periods 500000, 500002, 500004, 500006, then 500006 for good
+    REQUIRE(beatled_beat_schedule_period_us(500000, 2000, 4, 0) == 500000);
+    REQUIRE(beatled_beat_schedule_period_us(500000, 2000, 4, 1) == 500002);
+    REQUIRE(beatled_beat_schedule_period_us(500000, 2000, 4, 3) == 500006);
+    REQUIRE(beatled_beat_schedule_period_us(500000, 2000, 4, 4) == 500006);
+    REQUIRE(beatled_beat_schedule_period_us(500000, 2000, 4, 40) == 500006);
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 2000, 4, 4) == 2000012);
+    REQUIRE(beatled_beat_schedule_offset_us(500000, 2000, 4, 6) == 3000024);
+  }
+
+  SECTION("Beats before the anchor use the base period") {
+    REQUIRE(beatled_beat_schedule_period_us(500000, -3000, 4, -1) == 500000);
+    REQUIRE(beatled_beat_schedule_period_us(500000, -3000, 4, 1) == 499997);
   }
 }
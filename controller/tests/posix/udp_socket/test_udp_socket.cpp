@@ -0,0 +1,107 @@
+// create_udp_socket and the server's multicast mode. The group is joined on
+// the loopback interface (BEATLED_MULTICAST_IF=127.0.0.1) and fed from a
+// local sender, so this runs on any Linux host without a network.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "config/constants.h"
+#include "udp_socket.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+namespace {
+
+constexpr const char *GROUP = "239.255.66.76";
+
+uint16_t local_port(int fd) {
+  sockaddr_in addr{};
+  socklen_t len = sizeof(addr);
+  REQUIRE(getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+  return ntohs(addr.sin_port);
+}
+
+// What the server does in multicast mode: one datagram to group:port, sent
+// out of the loopback interface
+void send_to_group(uint16_t port, const char *payload) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  REQUIRE(fd >= 0);
+  in_addr iface{};
+  inet_pton(AF_INET, "127.0.0.1", &iface);
+  REQUIRE(setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) == 0);
+
+  sockaddr_in dst{};
+  dst.sin_family = AF_INET;
+  dst.sin_port = htons(port);
+  inet_pton(AF_INET, GROUP, &dst.sin_addr);
+  const auto sent = sendto(fd, payload, std::strlen(payload), 0,
+                           reinterpret_cast<const sockaddr *>(&dst), sizeof(dst));
+  close(fd);
+  REQUIRE(sent == static_cast<ssize_t>(std::strlen(payload)));
+}
+
+bool readable(int fd, int timeout_ms) {
+  pollfd pfd{fd, POLLIN, 0};
+  return poll(&pfd, 1, timeout_ms) == 1;
+}
+
+udp_parameters_t parameters(const char *multicast_group) {
+  udp_parameters_t params{};
+  params.server_name = "localhost";
+  params.server_port = UDP_SERVER_PORT;
+  params.udp_port = 0; // any free port
+  params.multicast_group = multicast_group;
+  return params;
+}
+
+} // namespace
+
+TEST_CASE("create_udp_socket joins the multicast group", "[udp_socket][multicast]") {
+  setenv("BEATLED_MULTICAST_IF", "127.0.0.1", 1);
+  unsetenv("BEATLED_BIND_ADDR");
+  auto params = parameters(GROUP);
+  REQUIRE(create_udp_socket(&params) == 0);
+
+  send_to_group(local_port(udp_socket_fd), "beat");
+
+  REQUIRE(readable(udp_socket_fd, 1000));
+  char buffer[16];
+  const auto n = recv(udp_socket_fd, buffer, sizeof(buffer), 0);
+  close(udp_socket_fd);
+  REQUIRE(n == 4);
+  CHECK(std::memcmp(buffer, "beat", 4) == 0);
+}
+
+TEST_CASE("create_udp_socket without a group ignores multicast", "[udp_socket][multicast]") {
+  setenv("BEATLED_MULTICAST_IF", "127.0.0.1", 1);
+  unsetenv("BEATLED_BIND_ADDR");
+  auto params = parameters(nullptr);
+  REQUIRE(create_udp_socket(&params) == 0);
+
+  send_to_group(local_port(udp_socket_fd), "beat");
+
+  const bool received = readable(udp_socket_fd, 200);
+  close(udp_socket_fd);
+  CHECK_FALSE(received);
+}
+
+TEST_CASE("create_udp_socket survives an invalid group", "[udp_socket][multicast]") {
+  // Unicast and broadcast still work without the membership
+  unsetenv("BEATLED_BIND_ADDR");
+  auto params = parameters("10.0.0.1");
+  REQUIRE(create_udp_socket(&params) == 0);
+  close(udp_socket_fd);
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+
+#include "hal/ws2812.h"
+
+namespace {
+
+// What the pico port reports for an RGB strip at 800 kHz
+constexpr ws2812_latency_model_t PICO_MODEL = {1, 30000, 400};
+constexpr uint16_t PIXELS = 300;
+
+} // namespace
+
+TEST_CASE("Pixel wire time follows the bit count and the frequency", "[ws2812_latency]") {
+  REQUIRE(ws2812_pixel_ns(800000, false) == 30000);
+  REQUIRE(ws2812_pixel_ns(800000, true) == 40000);
+  REQUIRE(ws2812_pixel_ns(400000, false) == 60000);
+  REQUIRE(ws2812_pixel_ns(0, false) == 0);
+}
+
+TEST_CASE("A frame shows after the setup, the wire time and the latch", "[ws2812_latency]") {
+  ws2812_timeline_t timeline;
+  ws2812_timeline_init(&timeline, &PICO_MODEL, PIXELS);
+
+  // 300 pixels of 24 bits at 800 kHz: 9 ms on the wire
+  REQUIRE(ws2812_timeline_lead_us(&timeline) == 1 + 9000 + 400);
+  REQUIRE(ws2812_timeline_predict(&timeline, 1000) == 10401);
+
+  SECTION("Predicting leaves the strip idle") {
+    REQUIRE(ws2812_timeline_predict(&timeline, 1000) == 10401);
+    REQUIRE(timeline.strip_free_us == 0);
+  }
+
+  SECTION("A frame handed over while the strip is busy waits for the latch") {
+    REQUIRE(ws2812_timeline_commit(&timeline, 1000) == 10401);
+    REQUIRE(ws2812_timeline_predict(&timeline, 5000) == 10401 + 9400);
+    // Once the strip is free again only the setup delays the transfer
+    REQUIRE(ws2812_timeline_predict(&timeline, 20000) == 20000 + 9401);
+  }
+
+  SECTION("Without a wire the frame shows as it is handed over") {
+    const ws2812_latency_model_t simulator = {};
+    ws2812_timeline_init(&timeline, &simulator, PIXELS);
+    REQUIRE(ws2812_timeline_lead_us(&timeline) == 0);
+    REQUIRE(ws2812_timeline_commit(&timeline, 1000) == 1000);
+    REQUIRE(ws2812_timeline_predict(&timeline, 1000) == 1000);
+  }
+}
+
+TEST_CASE("Frames rendered ahead by the lead show on their grid slots", "[ws2812_latency]") {
+  // The LED core's schedule: 10 ms slots, woken the lead plus the render
+  // time ahead, handing the frame over once rendered. The next frame
+  // renders while the previous one is on the wire.
+  constexpr uint64_t FRAME_US = 10000;
+  constexpr uint64_t RENDER_US = 700;
+  ws2812_timeline_t timeline;
+  ws2812_timeline_init(&timeline, &PICO_MODEL, PIXELS);
+  const uint64_t lead = ws2812_timeline_lead_us(&timeline) + RENDER_US;
+
+  uint64_t late = 0;
+  for (uint64_t slot = 1000000; slot < 2000000; slot += FRAME_US) {
+    const uint64_t wake = slot - lead;
+    // What the frame is rendered for
+    const uint64_t predicted = ws2812_timeline_predict(&timeline, wake + RENDER_US);
+    const uint64_t shown = ws2812_timeline_commit(&timeline, wake + RENDER_US);
+    REQUIRE(predicted == shown);
+    late += shown - slot;
+  }
+  REQUIRE(late == 0);
+
+  // Rendering for the wake-up time instead would show every beat onset
+  // the whole lead late: 10.1 ms on this strip
+  REQUIRE(lead == 10101);
+}
@@ -7,7 +7,6 @@
 
 #include "./application.hpp"
 #include "beat_detector/beat_detector.hpp"
-#include "config.hpp"
 #include "http_server/http_server.hpp"
 #include "manual_tempo/manual_tempo.hpp"
 #include "tempo_broadcaster/tempo_broadcaster.hpp"
@@ -56,9 +55,12 @@ Application::Application(const Config &beatled_config)
 
     tp->broadcast_next_beat(next_beat_time_ref, beat_count);
   };
+  auto on_beat_schedule = [tp = tempo_broadcaster.get()](const core::BeatSchedule &schedule) {
+    tp->broadcast_beat_schedule(schedule);
+  };
 
   registerController(std::make_unique<beatled::detector::BeatDetector>(
-      BEAT_DETECTOR_ID, 44100, beatled::constants::audio_buffer_size,
+      BEAT_DETECTOR_ID, 44100, server_parameters_.audio_hop_size,
       [&](uint64_t beat_time_ref, double tempo, double estimated_tempo, uint32_t beat_count) {
         uint64_t next_beat_time_ref = state_manager_.get_next_beat_time_ref();
 
@@ -69,10 +71,11 @@ Application::Application(const Config &beatled_config)
                      static_cast<int64_t>(beat_time_ref) -
                          static_cast<int64_t>(next_beat_time_ref));
       },
-      on_next_beat));
+      on_next_beat, server_parameters_.audio_source, &state_manager_.latency_metrics(),
+      server_parameters_.fftw_wisdom, on_beat_schedule));
 
-  registerController(std::make_unique<server::ManualTempo>(MANUAL_TEMPO_ID, io_context_,
-                                                           state_manager_, on_next_beat));
+  registerController(std::make_unique<server::ManualTempo>(
+      MANUAL_TEMPO_ID, io_context_, state_manager_, on_next_beat, on_beat_schedule));
 
   registerController(std::make_unique<server::UDPServer>(UDP_SERVER_ID, io_context_,
                                                          server_parameters_.udp, state_manager_));
@@ -98,6 +101,12 @@ void Application::run() {
     service(HTTP_SERVER_ID)->start();
   }
 
+  // An explicit file/pipe/generator source means a headless run (CI,
+  // staging): start detecting right away rather than waiting for the API.
+  if (server_parameters_.audio_source.kind != detector::AudioSourceConfig::Kind::PortAudio) {
+    service(BEAT_DETECTOR_ID)->start();
+  }
+
   start_threads();
   SPDLOG_INFO("Stopped servers. Waiting for beat detection thread.");
   service(BEAT_DETECTOR_ID)->stop();
@@ -0,0 +1,43 @@
+#include <AudioFile/AudioFile.h>
+#include <spdlog/spdlog.h>
+
+#include "audio_exception.hpp"
+#include "audio_file_loader.hpp"
+
+using namespace beatled::detector;
+
+bool beatled::detector::load_mono_audio_file(const std::filesystem::path &path, MonoAudio &audio) {
+  if (!std::filesystem::is_regular_file(path)) {
+    throw AudioException(fmt::format("Audio file '{}' doesn't exist", path.string()));
+  }
+
+  AudioFile<float> audio_file;
+  if (!audio_file.load(path.string())) {
+    SPDLOG_ERROR("Couldn't load audio file {}", path.string());
+    return false;
+  }
+
+  const int channels = audio_file.getNumChannels();
+  const std::size_t length = audio_file.getNumSamplesPerChannel();
+  if (channels < 1 || length == 0) {
+    SPDLOG_ERROR("Audio file {} has no samples", path.string());
+    return false;
+  }
+
+  if (channels == 1) {
+    audio.samples = std::move(audio_file.samples[0]);
+  } else {
+    audio.samples.assign(length, 0.0f);
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (int channel = 0; channel < channels; channel++) {
+      const float *in = audio_file.samples[channel].data();
+      for (std::size_t i = 0; i < length; i++) {
+        audio.samples[i] += in[i] * scale;
+      }
+    }
+  }
+
+  audio.sample_rate = audio_file.getSampleRate();
+  audio.channels = channels;
+  return true;
+}
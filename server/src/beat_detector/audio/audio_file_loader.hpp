@@ -0,0 +1,30 @@
+#ifndef BEAT_DETECTOR__AUDIO_FILE_LOADER_HPP
+#define BEAT_DETECTOR__AUDIO_FILE_LOADER_HPP
+
+#include <filesystem>
+#include <vector>
+
+namespace beatled::detector {
+
+/**
+ * @brief Decoded mono audio
+ */
+struct MonoAudio {
+  std::vector<float> samples;
+  double sample_rate = 0;
+  int channels = 0;
+
+  double duration() const { return sample_rate > 0 ? samples.size() / sample_rate : 0; }
+};
+
+/**
+ * @brief Decodes a WAV or AIFF file with AudioFile, downmixing to mono
+ *
+ * Throws AudioException if the file doesn't exist. Returns false if it can't
+ * be decoded or has no samples.
+ */
+bool load_mono_audio_file(const std::filesystem::path &path, MonoAudio &audio);
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__AUDIO_FILE_LOADER_HPP
@@ -7,9 +7,9 @@
 using namespace beatled::detector;
 using beatled::core::Clock;
 
-AudioInput::AudioInput(AudioBufferPool *audio_buffer_pool, double desired_sample_rate,
+AudioInput::AudioInput(AudioRing *audio_ring, double desired_sample_rate,
                        unsigned long frames_per_buffer)
-    : AudioInterface(audio_buffer_pool, desired_sample_rate, frames_per_buffer) {}
+    : AudioInterface(audio_ring, desired_sample_rate, frames_per_buffer) {}
 
 AudioInput::~AudioInput() {
   SPDLOG_INFO("Destroying audio input");
@@ -63,13 +63,10 @@ int AudioInput::paCallbackMethod(const void *inputBuffer, void *outputBuffer,
   float *input = (float *)inputBuffer;
   copy_to_buffer(input, frameCount, timeInfo->inputBufferAdcTime, timeInfo->currentTime);
 
+  // Logging from the callback can lock and allocate; count the flags and let
+  // the consumer thread report them.
   if (statusFlags) {
-    // spdlog uses fmt-style {} placeholders, not printf %lu. Log the raw
-    // bitmask plus the input flags that actually matter here — both mean
-    // dropped audio frames on an input-only stream.
-    SPDLOG_ERROR(" *** PortAudio stream status {:#x}{}{}", statusFlags,
-                 (statusFlags & paInputUnderflow) ? " input-underflow" : "",
-                 (statusFlags & paInputOverflow) ? " input-overflow" : "");
+    count_status_flags(statusFlags);
   }
   (void)outputBuffer;
 
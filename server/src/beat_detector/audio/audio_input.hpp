@@ -10,7 +10,7 @@
 #include <stdio.h>
 #include <vector>
 
-#include "audio_buffer_pool.hpp"
+#include "audio_ring.hpp"
 #include "audio_exception.hpp"
 #include "audio_interface.hpp"
 #include "beat_detector/audio/config.h"
@@ -24,12 +24,12 @@ namespace fs = std::filesystem;
  * @brief Wrapper around an audio input (using PortAudio)
  *
  * Wrapper around PortAudio to allow for audio inputs.
- * Data is captured into `AudioBuffer`s and is enqueued for consumption by the
- * audio processor.
+ * Data is captured into an `AudioRing` and is handed to the audio processor
+ * as hop views.
  */
 class AudioInput : public AudioInterface {
 public:
-  AudioInput(AudioBufferPool *audio_buffer_pool, double desired_sample_rate,
+  AudioInput(AudioRing *audio_ring, double desired_sample_rate,
              unsigned long frames_per_buffer = 0);
 
   virtual ~AudioInput();
@@ -7,9 +7,9 @@
 using namespace beatled::detector;
 using beatled::core::Clock;
 
-AudioInterface::AudioInterface(AudioBufferPool *audio_buffer_pool, double desired_sample_rate,
+AudioInterface::AudioInterface(AudioRing *audio_ring, double desired_sample_rate,
                                unsigned long frames_per_buffer)
-    : stream_(nullptr), audio_buffer_pool_{audio_buffer_pool}, sample_rate_{desired_sample_rate},
+    : AudioSource(audio_ring, desired_sample_rate), stream_(nullptr),
       frames_per_buffer_{frames_per_buffer} {
   if (frames_per_buffer_ == 0) {
     frames_per_buffer_ = paFramesPerBufferUnspecified;
@@ -59,9 +59,9 @@ bool AudioInterface::open() {
               stream_info->sampleRate);
 
   sample_rate_ = stream_info->sampleRate;
-  frame_duration_ = static_cast<double>(audio_buffer_pool_->buffer_size()) / sample_rate_;
+  frame_duration_ = static_cast<double>(audio_ring_->hop_size()) / sample_rate_;
 
-  audio_buffer_pool_->set_sample_rate(sample_rate_);
+  reset_ring();
 
   if (err != paNoError) {
     /* Failed to open stream to device !!! */
@@ -95,7 +95,6 @@ bool AudioInterface::start() {
   if (stream_ == nullptr)
     return false;
 
-  current_buffer_ = audio_buffer_pool_->get_new_buffer();
   stream_start_time_ = Clock::time_us_64();
   stream_start_timeInfo_ = Pa_GetStreamTime(stream_);
   SPDLOG_INFO("stream_start_time_ {},  stream_start_timeInfo_ {}", stream_start_time_,
@@ -143,27 +142,20 @@ void AudioInterface::copy_to_buffer(float *input_buffer, unsigned long frame_cou
   PaTime stream_time = Pa_GetStreamTime(stream_);
   SPDLOG_DEBUG("Copy to Buffer {:.4f} {:.4f} {:4f}", input_output_time, current_time, stream_time);
 
-  unsigned long elements_copied = 0;
-  while (elements_copied < frame_count) {
-    // If we have a new buffer, let's set the start time
-    if (current_buffer_->start_time() == 0) {
-      uint64_t now = Clock::time_us_64();
-      uint64_t buffer_time = now - static_cast<uint64_t>(1e6 * (stream_time - input_output_time));
-      current_buffer_->set_start_time(buffer_time);
-    }
-
-    elements_copied += current_buffer_->copy_raw_data(input_buffer + elements_copied,
-                                                      frame_count - elements_copied);
-
-    // If buffer is full, let's get a new one
-    if (current_buffer_->is_full()) {
-      audio_buffer_pool_->enqueue(std::move(current_buffer_));
-      current_buffer_ = audio_buffer_pool_->get_new_buffer();
-    }
+  uint64_t now = Clock::time_us_64();
+  uint64_t capture_time = now - static_cast<uint64_t>(1e6 * (stream_time - input_output_time));
+  write_frames(input_buffer, frame_count, capture_time);
+}
+
+void AudioInterface::count_status_flags(PaStreamCallbackFlags status_flags) {
+  if (status_flags & paInputOverflow) {
+    input_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (status_flags & paInputUnderflow) {
+    input_underflow_count_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void AudioInterface::paStreamFinishedMethod() {
   SPDLOG_INFO("Stream Completed");
-  audio_buffer_pool_->release_buffer(std::move(current_buffer_));
 }
@@ -7,8 +7,9 @@
 #include <portaudio.h>
 #include <vector>
 
-#include "audio_buffer_pool.hpp"
+#include "audio_ring.hpp"
 #include "audio_exception.hpp"
+#include "audio_source.hpp"
 #include "beat_detector/audio/config.h"
 #include "portaudio_handler.hpp"
 
@@ -19,13 +20,12 @@ namespace fs = std::filesystem;
 /**
  * @brief Wrapper around an audio input (using PortAudio)
  *
- * Wrapper around PortAudio to allow for audio inputs.
- * Data is captured into `AudioBuffer`s and is enqueued for consumption by the
- * audio processor.
+ * PortAudio backend of `AudioSource`. Data is written to an `AudioRing` from
+ * the PortAudio callback, for consumption by the audio processor.
  */
-class AudioInterface {
+class AudioInterface : public AudioSource {
 public:
-  AudioInterface(AudioBufferPool *audio_buffer_pool, double desired_sample_rate,
+  AudioInterface(AudioRing *audio_ring, double desired_sample_rate,
                  unsigned long frames_per_buffer = 0);
 
   virtual ~AudioInterface();
@@ -34,39 +34,34 @@ public:
    * @brief Opens the audio stream
    * @return true on successful opening of the stream
    */
-  bool open();
+  bool open() override;
 
   /**
    * @brief Closes the audio stream
    * @return true on successful closing of the stream
    */
-  bool close();
+  bool close() override;
 
   /**
    * @brief Starts the audio stream
    * @return true on successful streaming of the stream
    */
-  bool start();
+  bool start() override;
 
   /**
    * @brief Indicates whether the audio stream is currently active
    * @return true on active
    */
-  bool is_active();
+  bool is_active() override;
 
-  bool wait();
+  bool wait() override;
 
   /**
    * @brief Stops the audio stream
    * @return true on successful stropping of the stream
    */
-  bool stop();
+  bool stop() override;
 
-  /**
-   * @brief Returns the effective sample rate
-   * @return Value of the sample rate that PortAudio is sampling at
-   */
-  double effective_sample_rate() const { return sample_rate_; }
 
 protected:
   virtual const PaStreamParameters *get_input_parameters() { return NULL; }
@@ -105,27 +100,21 @@ protected:
   void copy_to_buffer(float *input_buffer, unsigned long frame_count, double input_output_time,
                       double current_time);
 
-  PortaudioHandle port_audio_handler_;
-
   /**
-   * @brief A PortAudio stream object
+   * @brief Records PortAudio status flags without logging (callback-safe)
    */
+  void count_status_flags(PaStreamCallbackFlags status_flags);
 
-  PaStream *stream_ = nullptr;
+  PortaudioHandle port_audio_handler_;
 
   /**
-   * @brief The AudioBufferPool to get and enqueue `AudioBuffer`s
+   * @brief A PortAudio stream object
    */
-  AudioBufferPool *audio_buffer_pool_;
 
-  /**
-   * @brief The sample rate of the input
-   */
-  double sample_rate_;
+  PaStream *stream_ = nullptr;
 
   unsigned long frames_per_buffer_;
 
-  AudioBuffer::Ptr current_buffer_;
   double frame_duration_;
 
   uint64_t stream_start_time_;
@@ -13,15 +13,16 @@
 #include "audio_exception.hpp"
 #include "audio_output.hpp"
 #include "beat_detector/audio/config.h"
+#include "sample_convert.hpp"
 
 namespace fs = std::filesystem;
 
 using namespace beatled::detector;
 
-AudioOutput::AudioOutput(std::vector<audio_buffer_t> &audio_data,
-                         AudioBufferPool *audio_buffer_pool, uint32_t sample_rate,
+AudioOutput::AudioOutput(std::vector<float> &audio_data,
+                         AudioRing *audio_ring, uint32_t sample_rate,
                          std::size_t audio_buffer_size, unsigned long frames_per_buffer)
-    : AudioInterface(audio_buffer_pool, sample_rate, frames_per_buffer),
+    : AudioInterface(audio_ring, sample_rate, frames_per_buffer),
       audio_data_{std::move(audio_data)}, read_index_{0} {}
 
 const PaStreamParameters *AudioOutput::get_output_parameters() {
@@ -51,13 +52,7 @@ int AudioOutput::paCallbackMethod(const void *inputBuffer, void *outputBuffer,
   bool last_segment = (elements_readable < frameCount);
   int elements_to_read = last_segment ? elements_readable : frameCount;
 
-  for (int i = 0; i < elements_to_read; i++) {
-    out[i] = audio_data_[read_index_ + i];
-  }
-
-  double *hop_data = audio_data_.data();
-  auto audio_frame =
-      std::span<double>(hop_data + read_index_, hop_data + read_index_ + elements_to_read);
+  convert_samples(audio_data_.data() + read_index_, elements_to_read, out);
 
   read_index_ = read_index_ + elements_to_read;
 
@@ -16,7 +16,7 @@ namespace beatled::detector {
 
 class AudioOutput : public AudioInterface {
 public:
-  AudioOutput(std::vector<audio_buffer_t> &audio_data, AudioBufferPool *audio_buffer_pool,
+  AudioOutput(std::vector<float> &audio_data, AudioRing *audio_ring,
               uint32_t sample_rate, std::size_t audio_buffer_size,
               unsigned long frames_per_buffer = 0);
   // virtual ~AudioOutput();
@@ -29,7 +29,7 @@ private:
   int paCallbackMethod(const void *inputBuffer, void *outputBuffer, unsigned long frameCount,
                        const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags);
 
-  std::vector<audio_buffer_t> audio_data_;
+  std::vector<float> audio_data_;
   int read_index_ = 0;
 
   PaStreamParameters output_parameters_;
@@ -4,21 +4,24 @@
 #include <spdlog/spdlog.h>
 #include <thread>
 
-#include "audio_buffer_pool.hpp"
 #include "audio_output.hpp"
+#include "audio_ring.hpp"
 #include "beat_detector/audio/audio_player.hpp"
+#include "sample_convert.hpp"
 
-using namespace beatled::detector;
+namespace beatled::detector {
 
-AudioPlayer::AudioPlayer(const std::string &filename, std::size_t audio_buffer_size)
+template <typename SampleT>
+BasicAudioPlayer<SampleT>::BasicAudioPlayer(const std::string &filename,
+                                            std::size_t audio_buffer_size)
     : filename_{filename}, audio_buffer_size_{audio_buffer_size} {}
 
-void AudioPlayer::play() {
+template <typename SampleT> void BasicAudioPlayer<SampleT>::play() {
   load_from_disk();
 
-  AudioBufferPool audio_buffer_pool{audio_buffer_size_, sample_rate_};
+  AudioRing audio_ring{audio_buffer_size_, sample_rate_};
 
-  AudioOutput audio_output(audio_data_, &audio_buffer_pool, sample_rate_, audio_buffer_size_);
+  AudioOutput audio_output(audio_data_, &audio_ring, sample_rate_, audio_buffer_size_);
 
   if (!audio_output.open()) {
     throw AudioException("Couldn't open device.");
@@ -43,7 +46,7 @@ void AudioPlayer::play() {
   audio_output.close();
 }
 
-void AudioPlayer::load_from_disk() {
+template <typename SampleT> void BasicAudioPlayer<SampleT>::load_from_disk() {
   //---------------------------------------------------------------
   // 1. Set a file path to an audio file on your machine
   auto filePath = absolute_file_path();
@@ -51,7 +54,7 @@ void AudioPlayer::load_from_disk() {
   //---------------------------------------------------------------
   // 2. Create an AudioFile object and load the audio file
 
-  AudioFile<audio_buffer_t> audio_file;
+  AudioFile<SampleT> audio_file;
   /** If you hit this assert then the file path above
    probably doesn't refer to a valid audio file */
   assert(audio_file.load(filePath));
@@ -68,13 +71,15 @@ void AudioPlayer::load_from_disk() {
 
   int channel = 0;
 
-  audio_data_.resize(audio_file.getNumSamplesPerChannel());
-  for (int i = 0; i < audio_file.getNumSamplesPerChannel(); i++) {
-    audio_data_[i] = audio_file.samples[channel][i];
-  }
+  // Convert once, in bulk, to the device format so the output callback is a
+  // plain copy
+  const auto &samples = audio_file.samples[channel];
+  audio_data_.resize(samples.size());
+  convert_samples(samples.data(), samples.size(), audio_data_.data());
 }
 
-std::filesystem::path AudioPlayer::absolute_file_path() const {
+template <typename SampleT>
+std::filesystem::path BasicAudioPlayer<SampleT>::absolute_file_path() const {
   fs::path audio_file_path = filename_;
   if (audio_file_path.is_relative()) {
     audio_file_path = fs::current_path() / audio_file_path;
@@ -83,4 +88,9 @@ std::filesystem::path AudioPlayer::absolute_file_path() const {
     throw AudioException("File doesn't exist");
   }
   return audio_file_path;
-}
\ No newline at end of file
+}
+
+template class BasicAudioPlayer<float>;
+template class BasicAudioPlayer<double>;
+
+} // namespace beatled::detector
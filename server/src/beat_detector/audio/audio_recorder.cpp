@@ -3,25 +3,28 @@
 #include <fmt/std.h>
 #include <spdlog/spdlog.h>
 
-#include "audio_buffer_pool.hpp"
 #include "audio_input.hpp"
+#include "audio_ring.hpp"
 #include "beat_detector/audio/audio_recorder.hpp"
+#include "sample_convert.hpp"
 
 namespace beatled::detector {
 
-AudioRecorder::AudioRecorder(const std::string &filename, double duration, double sample_rate,
-                             double frames_per_buffer, std::size_t audio_buffer_size)
+template <typename SampleT>
+BasicAudioRecorder<SampleT>::BasicAudioRecorder(const std::string &filename, double duration,
+                                                double sample_rate, double frames_per_buffer,
+                                                std::size_t audio_buffer_size)
     : filename_{filename}, duration_{duration}, sample_rate_{sample_rate},
       audio_buffer_size_{audio_buffer_size} {}
 
-std::string AudioRecorder::record() {
+template <typename SampleT> std::string BasicAudioRecorder<SampleT>::record() {
   const unsigned long TOTAL_BUFFER_SIZE = sample_rate_ * duration_;
 
-  AudioBufferPool audio_buffer_pool{audio_buffer_size_, sample_rate_};
+  AudioRing audio_ring{audio_buffer_size_, sample_rate_};
 
   // Use frame_rate = 0 to let the OS choose the frame rate (potentially
   // dynamcially)
-  AudioInput audio_input(&audio_buffer_pool, sample_rate_);
+  AudioInput audio_input(&audio_ring, sample_rate_);
   // AudioInput audio_input(audio_buffer_pool, sample_rate_,
   // frames_per_buffer_);
 
@@ -35,7 +38,7 @@ std::string AudioRecorder::record() {
 
   SPDLOG_INFO("Audio input active: {}", audio_input.is_active());
 
-  AudioFile<audio_buffer_t> audio_file;
+  AudioFile<SampleT> audio_file;
   audio_file.samples.resize(1);
   auto &audio_data = audio_file.samples[0];
   audio_data.reserve(TOTAL_BUFFER_SIZE);
@@ -43,24 +46,21 @@ std::string AudioRecorder::record() {
   int idx = 0;
   const int cycle_per_second = static_cast<int>(sample_rate_) / audio_buffer_size_;
 
-  AudioBuffer::Ptr buffer;
   while (1) {
-    buffer = audio_buffer_pool.dequeue_blocking();
-    if (!buffer) {
+    const AudioRing::View hop = audio_ring.acquire_blocking();
+    if (!hop) {
       SPDLOG_INFO("Stopping thread");
       audio_input.stop();
       break;
     }
 
-    size_t elements_to_copy = (buffer->size() > audio_data_remaining_capacity)
-                                  ? audio_data_remaining_capacity
-                                  : buffer->size();
+    size_t elements_to_copy =
+        (hop.size() > audio_data_remaining_capacity) ? audio_data_remaining_capacity : hop.size();
 
-    const AudioBuffer::audio_buffer_data_t &buffer_data = buffer->data();
-    for (size_t i = 0; i < elements_to_copy; i++) {
-      audio_data.push_back(buffer_data[i]);
-    }
-    audio_buffer_pool.release_buffer(std::move(buffer));
+    const std::size_t offset = audio_data.size();
+    audio_data.resize(offset + elements_to_copy);
+    convert_samples(hop.samples.data(), elements_to_copy, audio_data.data() + offset);
+    audio_ring.release();
     audio_data_remaining_capacity -= elements_to_copy;
     if (audio_data_remaining_capacity == 0) {
       audio_input.stop();
@@ -87,7 +87,8 @@ std::string AudioRecorder::record() {
   return audio_file_path;
 }
 
-std::filesystem::path AudioRecorder::absolute_file_path() const {
+template <typename SampleT>
+std::filesystem::path BasicAudioRecorder<SampleT>::absolute_file_path() const {
   fs::path audio_file_path = filename_;
   if (audio_file_path.is_relative()) {
     audio_file_path = fs::current_path() / audio_file_path;
@@ -95,4 +96,7 @@ std::filesystem::path AudioRecorder::absolute_file_path() const {
   return audio_file_path;
 }
 
+template class BasicAudioRecorder<float>;
+template class BasicAudioRecorder<double>;
+
 } // namespace beatled::detector
\ No newline at end of file
@@ -0,0 +1,368 @@
+#ifndef BEAT_DETECTOR__AUDIO_RING_HPP
+#define BEAT_DETECTOR__AUDIO_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "beat_detector/audio/config.h"
+#include "sample_convert.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Contiguous sample ring handing out hop views
+ *
+ * Replaces the buffer pool between the audio callback (the single producer)
+ * and the processor thread (the single consumer). Samples are converted once
+ * into the ring; the processor then reads them in place through `View`s:
+ * windows of `hop_size + overlap` samples, one per `hop_size` new samples.
+ * Overlapping windows therefore cost no copy.
+ *
+ * Views are always contiguous: the ring is wrap-duplicated, i.e. its first
+ * `window_size()` samples are mirrored past the end of the storage, so a
+ * window that wraps around is still one span.
+ *
+ * Each view carries the capture time of its first sample (stamped by the
+ * producer at every hop boundary) and the time the producer published its
+ * last sample.
+ *
+ * `write` never locks, blocks or allocates, so it can be called from the
+ * PortAudio callback. When the processor falls behind and the ring is full,
+ * the frames that don't fit are dropped and `overrun_count()` is bumped.
+ */
+template <typename SampleT> class BasicAudioRing {
+public:
+  /**
+   * @brief A window of the ring, valid until `release()`
+   */
+  struct View {
+    /**
+     * @brief `window_size()` samples, empty once the ring is inactive and drained
+     */
+    std::span<const SampleT> samples;
+
+    /**
+     * @brief Capture time of `samples[0]`
+     */
+    uint64_t start_time = 0;
+
+    /**
+     * @brief Time the producer published the last sample of the window
+     */
+    uint64_t ready_time = 0;
+
+    /**
+     * @brief Hop number since the last `reset()`
+     */
+    uint64_t index = 0;
+
+    double sample_rate = 0;
+
+    /**
+     * @brief Capture time just past the last sample
+     */
+    uint64_t end_time() const {
+      return start_time + static_cast<uint64_t>(samples.size() * 1e6 / sample_rate);
+    }
+
+    std::size_t size() const { return samples.size(); }
+
+    explicit operator bool() const { return !samples.empty(); }
+  };
+
+  /**
+   * @param hop_size New samples between consecutive views
+   * @param sample_rate Rate of the samples, used for view timestamps
+   * @param overlap Samples a view shares with the previous one
+   * @param min_capacity Samples the ring holds at least (rounded up to a
+   * whole number of hops, and to at least a window plus a hop)
+   */
+  BasicAudioRing(std::size_t hop_size, double sample_rate, std::size_t overlap = 0,
+                 std::size_t min_capacity = 4096)
+      : hop_size_{hop_size}, window_size_{hop_size + overlap}, sample_rate_{sample_rate} {
+    if (hop_size_ == 0) {
+      throw std::invalid_argument("Audio ring hop size must be positive");
+    }
+    const std::size_t hops =
+        std::max((min_capacity + hop_size_ - 1) / hop_size_,
+                 (window_size_ + hop_size_ - 1) / hop_size_ + 1);
+    capacity_ = hops * hop_size_;
+    storage_.assign(capacity_ + window_size_, SampleT{0});
+    start_times_.assign(hops, 0);
+    ready_times_.assign(hops, 0);
+  }
+
+  BasicAudioRing(const BasicAudioRing &) = delete;
+  BasicAudioRing &operator=(const BasicAudioRing &) = delete;
+
+  /**
+   * @brief Empties the ring for a new stream
+   * Doesn't allocate. Must not be called while a producer or consumer is
+   * running.
+   */
+  void reset(double sample_rate) {
+    sample_rate_ = sample_rate;
+    resync_requested_.store(false, std::memory_order_relaxed);
+    write_pos_.store(0, std::memory_order_relaxed);
+    read_pos_.store(0, std::memory_order_relaxed);
+    read_hop_ = 0;
+    next_ready_hop_ = 0;
+  }
+
+  std::size_t hop_size() const { return hop_size_; }
+
+  std::size_t overlap() const { return window_size_ - hop_size_; }
+
+  std::size_t window_size() const { return window_size_; }
+
+  /**
+   * @brief Number of samples the ring holds
+   */
+  std::size_t capacity() const { return capacity_; }
+
+  double sample_rate() const { return sample_rate_; }
+
+  /**
+   * @brief Number of writes that dropped frames because the ring was full
+   */
+  inline uint64_t overrun_count() const { return overrun_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Samples the producer can write without dropping any
+   */
+  std::size_t free_space() const {
+    return capacity_ - static_cast<std::size_t>(write_pos_.load(std::memory_order_relaxed) -
+                                                read_pos_.load(std::memory_order_acquire));
+  }
+
+  /**
+   * @brief Views that are complete but not yet acquired
+   * Only exact when neither side is running concurrently.
+   */
+  std::size_t queued_views() const {
+    const uint64_t written = write_pos_.load(std::memory_order_acquire);
+    const uint64_t start = read_pos_.load(std::memory_order_acquire);
+    return written < start + window_size_
+               ? 0
+               : static_cast<std::size_t>((written - start - window_size_) / hop_size_ + 1);
+  }
+
+  /**
+   * @brief Appends samples (producer side, non-blocking)
+   * @param frames Mono float32 samples
+   * @param frame_count Number of samples
+   * @param capture_time_us Capture time of `frames[0]`, in microseconds
+   * @param ready_time_us Time stamped on the views these samples complete
+   * @return Number of samples written; fewer than `frame_count` on overrun
+   */
+  std::size_t write(const float *frames, std::size_t frame_count, double capture_time_us,
+                    uint64_t ready_time_us) {
+    uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    if (resync_requested_.load(std::memory_order_acquire)) {
+      // The consumer isn't reading while a resync is pending, so its read
+      // position is stable: restart the stream there, on a hop boundary
+      write_pos = read_pos_.load(std::memory_order_acquire);
+      next_ready_hop_ = write_pos / hop_size_;
+      write_pos_.store(write_pos, std::memory_order_relaxed);
+      resync_requested_.store(false, std::memory_order_release);
+    }
+    const std::size_t free = capacity_ - static_cast<std::size_t>(
+                                             write_pos - read_pos_.load(std::memory_order_acquire));
+    const std::size_t count = std::min(frame_count, free);
+    if (count < frame_count) {
+      overrun_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (count == 0) {
+      return 0;
+    }
+
+    // Stamp every hop that starts within these samples
+    const uint64_t end_pos = write_pos + count;
+    for (uint64_t hop = (write_pos + hop_size_ - 1) / hop_size_; hop * hop_size_ < end_pos;
+         hop++) {
+      const double offset = static_cast<double>(hop * hop_size_ - write_pos);
+      const double start_time_us = capture_time_us + 1e6 * offset / sample_rate_;
+      start_times_[hop % start_times_.size()] =
+          static_cast<uint64_t>(std::max(0.0, start_time_us));
+    }
+
+    // Copy in at most two runs (around the end of the storage), mirroring
+    // the head of the ring past its end
+    std::size_t copied = 0;
+    while (copied < count) {
+      const std::size_t index = static_cast<std::size_t>((write_pos + copied) % capacity_);
+      const std::size_t run = std::min(count - copied, capacity_ - index);
+      convert_samples(frames + copied, run, storage_.data() + index);
+      if (index < window_size_) {
+        const std::size_t mirrored = std::min(run, window_size_ - index);
+        convert_samples(frames + copied, mirrored, storage_.data() + capacity_ + index);
+      }
+      copied += run;
+    }
+
+    // Stamp the views these samples complete, then publish them
+    bool completed = false;
+    while (next_ready_hop_ * hop_size_ + window_size_ <= end_pos) {
+      ready_times_[next_ready_hop_ % ready_times_.size()] = ready_time_us;
+      next_ready_hop_++;
+      completed = true;
+    }
+    write_pos_.store(end_pos, std::memory_order_release);
+    if (completed) {
+      ready_seq_.fetch_add(1, std::memory_order_release);
+      ready_seq_.notify_one();
+    }
+    return count;
+  }
+
+  void set_active(bool active) {
+    active_.store(active, std::memory_order_release);
+
+    // Wake the consumer so it can observe the new state
+    ready_seq_.fetch_add(1, std::memory_order_release);
+    ready_seq_.notify_all();
+  }
+
+  /**
+   * @brief Drops everything written but not yet acquired (consumer side)
+   *
+   * For a consumer resuming after it stopped reading for a while, e.g. a
+   * paused detector in front of a stream that kept running: the ring is full
+   * of stale audio, and the hop being written when it filled up mixes
+   * samples from before and after the gap. The producer carries out the
+   * resync on its next write, restarting the stream on a hop boundary so
+   * every view is contiguous and correctly stamped. No view is handed out
+   * until then.
+   */
+  void request_resync() { resync_requested_.store(true, std::memory_order_release); }
+
+  /**
+   * @brief Whether a resync is waiting for the producer's next write
+   */
+  bool resync_pending() const { return resync_requested_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Returns the next view if it is complete (consumer side)
+   * @return false if the producer hasn't written the whole window yet
+   */
+  bool try_acquire(View &view) {
+    if (resync_pending()) {
+      return false;
+    }
+    const uint64_t start = read_hop_ * hop_size_;
+    if (write_pos_.load(std::memory_order_acquire) < start + window_size_) {
+      return false;
+    }
+    const std::size_t slot = static_cast<std::size_t>(read_hop_ % start_times_.size());
+    view.samples = std::span<const SampleT>(
+        storage_.data() + static_cast<std::size_t>(start % capacity_), window_size_);
+    view.start_time = start_times_[slot];
+    view.ready_time = ready_times_[slot];
+    view.index = read_hop_;
+    view.sample_rate = sample_rate_;
+    return true;
+  }
+
+  /**
+   * @brief Returns the next view, blocking (consumer side)
+   * @return The next view, or an empty one once the ring is inactive and
+   * drained. Views completed before deactivation are still handed out, so a
+   * source reaching the end of its stream doesn't lose its last hops.
+   */
+  View acquire_blocking() {
+    View view;
+    while (true) {
+      // Snapshot the sequence before checking state and ring so a write or
+      // set_active that lands in between changes it and the wait returns
+      const uint32_t seq = ready_seq_.load(std::memory_order_acquire);
+      if (try_acquire(view)) {
+        return view;
+      }
+      if (!active_.load(std::memory_order_acquire)) {
+        return View{};
+      }
+      ready_seq_.wait(seq, std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * @brief Done with the current view (consumer side)
+   * Frees its first `hop_size()` samples for the producer; the overlap stays
+   * in place for the next view.
+   */
+  void release() {
+    read_hop_++;
+    read_pos_.store(read_hop_ * hop_size_, std::memory_order_release);
+  }
+
+private:
+  std::size_t hop_size_;
+  std::size_t window_size_;
+  std::size_t capacity_;
+  double sample_rate_;
+
+  /**
+   * @brief `capacity_` samples followed by a copy of the first `window_size_`
+   */
+  std::vector<SampleT> storage_;
+
+  /**
+   * @brief Capture time of the first sample of each hop, indexed by hop
+   * number modulo the ring's hop count
+   */
+  std::vector<uint64_t> start_times_;
+
+  /**
+   * @brief Publication time of the window starting at each hop
+   */
+  std::vector<uint64_t> ready_times_;
+
+  // Fixed rather than std::hardware_destructive_interference_size, which
+  // GCC warns about using in headers (its value is ABI-unstable).
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Samples written since `reset()`, and the producer's next
+   * incomplete view
+   */
+  alignas(kCacheLineSize) std::atomic<uint64_t> write_pos_{0};
+  uint64_t next_ready_hop_ = 0;
+
+  /**
+   * @brief Oldest sample the consumer still needs, and its next view
+   */
+  alignas(kCacheLineSize) std::atomic<uint64_t> read_pos_{0};
+  uint64_t read_hop_ = 0;
+
+  /**
+   * @brief Bumped whenever views complete or the state changes; the consumer
+   * waits on it
+   */
+  alignas(kCacheLineSize) std::atomic<uint32_t> ready_seq_{0};
+
+  /**
+   * @brief Number of writes that dropped frames
+   */
+  std::atomic<uint64_t> overrun_count_{0};
+
+  std::atomic<bool> active_{true};
+
+  /**
+   * @brief Set by the consumer, cleared by the producer once it has dropped
+   * the unread samples
+   */
+  std::atomic<bool> resync_requested_{false};
+};
+
+/**
+ * @brief Ring of the pipeline's sample type (see `audio_buffer_t`)
+ */
+using AudioRing = BasicAudioRing<audio_buffer_t>;
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__AUDIO_RING_HPP
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "audio_source.hpp"
+#include "core/clock.hpp"
+
+using namespace beatled::detector;
+
+void AudioSource::set_decimation(unsigned factor) {
+  if (factor == 0) {
+    throw std::invalid_argument("Decimation factor must be positive");
+  }
+  decimation_ = factor;
+  if (decimation_ > 1) {
+    decimator_ = std::make_unique<Decimator>(decimation_);
+    decimated_.assign(decimator_->max_block() / decimation_ + 1, 0.0f);
+  } else {
+    decimator_.reset();
+    decimated_.clear();
+  }
+}
+
+std::size_t AudioSource::write_frames(const float *frames, std::size_t frame_count,
+                                      uint64_t capture_time_us) {
+  const uint64_t now = beatled::core::Clock::time_us_64();
+  if (decimator_ && audio_ring_->resync_pending()) {
+    // The ring restarts the stream: so does the filter
+    decimator_->reset();
+  }
+  if (!decimator_) {
+    return audio_ring_->write(frames, frame_count, static_cast<double>(capture_time_us), now);
+  }
+
+  std::size_t written = 0;
+  for (std::size_t offset = 0; offset < frame_count; offset += decimator_->max_block()) {
+    const std::size_t block = std::min(decimator_->max_block(), frame_count - offset);
+    std::size_t first_input = 0;
+    const std::size_t produced =
+        decimator_->process(frames + offset, block, decimated_.data(), first_input);
+    if (produced == 0) {
+      continue;
+    }
+    // The first output describes the input `delay()` samples before the
+    // newest sample it was computed from
+    const double input_index = static_cast<double>(offset + first_input) - decimator_->delay();
+    const double first_time_us =
+        static_cast<double>(capture_time_us) + 1e6 * input_index / sample_rate_;
+    written += audio_ring_->write(decimated_.data(), produced, first_time_us, now);
+  }
+  return written;
+}
+
+void AudioSource::reset_ring() {
+  if (decimator_) {
+    decimator_->reset();
+  }
+  audio_ring_->reset(effective_sample_rate());
+}
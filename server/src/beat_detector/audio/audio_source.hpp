@@ -0,0 +1,151 @@
+#ifndef BEAT_DETECTOR__AUDIO_SOURCE_HPP
+#define BEAT_DETECTOR__AUDIO_SOURCE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "audio_ring.hpp"
+#include "beat_detector/audio/config.h"
+#include "decimator.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Producer side of the audio pipeline
+ *
+ * An `AudioSource` captures (or reads, or synthesizes) mono float32 samples
+ * and feeds them into an `AudioRing`, which hands timestamped hops to the
+ * beat detector. Backends: PortAudio devices (`AudioInterface`), audio files,
+ * raw PCM pipes and a click generator (`ThreadedAudioSource`).
+ *
+ * The `write_frames` helper is the only code that touches the ring; it never
+ * locks or allocates so it is safe from a real-time callback.
+ */
+class AudioSource {
+public:
+  using Ptr = std::unique_ptr<AudioSource>;
+
+  AudioSource(AudioRing *audio_ring, double sample_rate)
+      : audio_ring_{audio_ring}, sample_rate_{sample_rate} {}
+
+  virtual ~AudioSource() = default;
+
+  AudioSource(const AudioSource &) = delete;
+  AudioSource &operator=(const AudioSource &) = delete;
+
+  /**
+   * @brief Opens the source and sizes the pool for its sample rate
+   * @return true on success
+   */
+  virtual bool open() = 0;
+
+  /**
+   * @brief Closes the source
+   * @return true on success
+   */
+  virtual bool close() = 0;
+
+  /**
+   * @brief Starts delivering samples
+   * @return true on success
+   */
+  virtual bool start() = 0;
+
+  /**
+   * @brief Stops delivering samples
+   * @return true on success
+   */
+  virtual bool stop() = 0;
+
+  /**
+   * @brief Indicates whether the source is still delivering samples
+   */
+  virtual bool is_active() = 0;
+
+  /**
+   * @brief Blocks until the source has stopped
+   */
+  virtual bool wait() = 0;
+
+  /**
+   * @brief Returns the effective sample rate
+   * @return Sample rate of the delivered samples (after decimation), valid
+   * after `open()`
+   */
+  double effective_sample_rate() const { return sample_rate_ / decimation_; }
+
+  /**
+   * @brief Low-pass and decimate the input by `factor` before it reaches the pool
+   * Call before `open()`. With a factor of 4, 44.1 kHz capture reaches the
+   * beat tracker at 11025 Hz. Hop timestamps still give the capture time of
+   * their first sample (the filter's group delay is compensated).
+   */
+  void set_decimation(unsigned factor);
+
+  unsigned decimation() const { return decimation_; }
+
+  /**
+   * @brief Number of input overflows reported by the backend
+   * Counted from the producer, which must not log; read from any thread.
+   */
+  uint64_t input_overflow_count() const {
+    return input_overflow_count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of input underflows reported by the backend
+   */
+  uint64_t input_underflow_count() const {
+    return input_underflow_count_.load(std::memory_order_relaxed);
+  }
+
+protected:
+  /**
+   * @brief Appends frames to the ring
+   * Decimates them first if requested. Drops the frames that don't fit
+   * (counted as a ring overrun) if the processor has fallen behind. Never
+   * blocks, locks or allocates.
+   * @param frames Mono float32 samples
+   * @param frame_count Number of samples
+   * @param capture_time_us `Clock::time_us_64()` time of the first sample
+   * @return Number of samples written to the ring
+   */
+  std::size_t write_frames(const float *frames, std::size_t frame_count, uint64_t capture_time_us);
+
+  /**
+   * @brief Empties the ring for the source's (decimated) sample rate
+   * Called from `open()`, while neither side of the ring is running.
+   */
+  void reset_ring();
+
+  /**
+   * @brief The ring the samples are written to
+   */
+  AudioRing *audio_ring_;
+
+  /**
+   * @brief The sample rate of the source
+   */
+  double sample_rate_;
+
+  unsigned decimation_ = 1;
+
+  /**
+   * @brief Anti-aliasing decimator, only when `decimation_ > 1`
+   */
+  std::unique_ptr<Decimator> decimator_;
+
+  /**
+   * @brief Output of the decimator for one block
+   */
+  std::vector<float> decimated_;
+
+  std::atomic<uint64_t> input_overflow_count_{0};
+  std::atomic<uint64_t> input_underflow_count_{0};
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__AUDIO_SOURCE_HPP
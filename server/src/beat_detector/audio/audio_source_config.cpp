@@ -0,0 +1,84 @@
+#include <fmt/format.h>
+#include <stdexcept>
+
+#include "beat_detector/audio/audio_source_config.hpp"
+
+namespace beatled::detector {
+
+AudioSourceConfig parse_audio_source_config(const std::string &spec, const std::string &pacing) {
+  AudioSourceConfig config;
+
+  if (pacing == "realtime") {
+    config.pacing = AudioPacing::RealTime;
+  } else if (pacing == "fast") {
+    config.pacing = AudioPacing::AsFastAsPossible;
+  } else {
+    throw std::invalid_argument{
+        fmt::format("Invalid audio pacing '{}' (must be realtime or fast)", pacing)};
+  }
+
+  const auto colon = spec.find(':');
+  const std::string kind = spec.substr(0, colon);
+  const std::string argument = (colon == std::string::npos) ? "" : spec.substr(colon + 1);
+
+  if (kind == "portaudio" || kind.empty()) {
+    config.kind = AudioSourceConfig::Kind::PortAudio;
+  } else if (kind == "file") {
+    if (argument.empty()) {
+      throw std::invalid_argument{"Audio source 'file' needs a path (file:<path>)"};
+    }
+    config.kind = AudioSourceConfig::Kind::File;
+    config.path = argument;
+  } else if (kind == "pipe") {
+    config.kind = AudioSourceConfig::Kind::Pipe;
+    config.path = argument.empty() ? "-" : argument;
+  } else if (kind == "generator") {
+    config.kind = AudioSourceConfig::Kind::Generator;
+    if (!argument.empty()) {
+      std::size_t parsed = 0;
+      try {
+        config.generator_bpm = std::stod(argument, &parsed);
+      } catch (const std::exception &) {
+        parsed = 0;
+      }
+      if (parsed != argument.size() || config.generator_bpm <= 0) {
+        throw std::invalid_argument{
+            fmt::format("Invalid generator tempo '{}' (expected generator:<bpm>)", argument)};
+      }
+    }
+  } else {
+    throw std::invalid_argument{fmt::format(
+        "Invalid audio source '{}' (must be portaudio, file:<path>, pipe:<path> or "
+        "generator[:<bpm>])",
+        spec)};
+  }
+  return config;
+}
+
+namespace {
+
+std::string describe_source(const AudioSourceConfig &config) {
+  const char *pacing = config.pacing == AudioPacing::RealTime ? "realtime" : "fast";
+  switch (config.kind) {
+  case AudioSourceConfig::Kind::PortAudio:
+    return "portaudio";
+  case AudioSourceConfig::Kind::File:
+    return fmt::format("file:{} ({}{})", config.path, pacing, config.loop ? ", loop" : "");
+  case AudioSourceConfig::Kind::Pipe:
+    return fmt::format("pipe:{} ({})", config.path, pacing);
+  case AudioSourceConfig::Kind::Generator:
+    return fmt::format("generator:{} ({})", config.generator_bpm, pacing);
+  }
+  return "unknown";
+}
+
+} // namespace
+
+std::string to_string(const AudioSourceConfig &config) {
+  if (config.decimation > 1) {
+    return fmt::format("{}, decimated by {}", describe_source(config), config.decimation);
+  }
+  return describe_source(config);
+}
+
+} // namespace beatled::detector
@@ -0,0 +1,39 @@
+#include "audio_source_factory.hpp"
+#include "audio_input.hpp"
+#include "file_audio_source.hpp"
+#include "generator_audio_source.hpp"
+#include "pipe_audio_source.hpp"
+
+namespace beatled::detector {
+
+namespace {
+
+AudioSource::Ptr make_source(const AudioSourceConfig &config, AudioRing *audio_ring,
+                             double sample_rate, unsigned long frames_per_buffer) {
+  switch (config.kind) {
+  case AudioSourceConfig::Kind::File:
+    return std::make_unique<FileAudioSource>(audio_ring, config.path, config.pacing,
+                                             frames_per_buffer, config.loop);
+  case AudioSourceConfig::Kind::Pipe:
+    return std::make_unique<PipeAudioSource>(audio_ring, config.path, sample_rate, config.pacing,
+                                             frames_per_buffer);
+  case AudioSourceConfig::Kind::Generator:
+    return std::make_unique<GeneratorAudioSource>(audio_ring, config.generator_bpm, sample_rate,
+                                                  config.pacing, frames_per_buffer);
+  case AudioSourceConfig::Kind::PortAudio:
+    break;
+  }
+  return std::make_unique<AudioInput>(audio_ring, sample_rate, frames_per_buffer);
+}
+
+} // namespace
+
+AudioSource::Ptr make_audio_source(const AudioSourceConfig &config,
+                                   AudioRing *audio_ring, double sample_rate,
+                                   unsigned long frames_per_buffer) {
+  AudioSource::Ptr source = make_source(config, audio_ring, sample_rate, frames_per_buffer);
+  source->set_decimation(config.decimation);
+  return source;
+}
+
+} // namespace beatled::detector
@@ -0,0 +1,22 @@
+#ifndef BEAT_DETECTOR__AUDIO_SOURCE_FACTORY_HPP
+#define BEAT_DETECTOR__AUDIO_SOURCE_FACTORY_HPP
+
+#include "audio_source.hpp"
+#include "beat_detector/audio/audio_source_config.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Creates the backend described by `config`
+ * @param config Which backend, how to pace it and how much to decimate it
+ * @param audio_ring Ring the source feeds
+ * @param sample_rate Requested sample rate (files use their own)
+ * @param frames_per_buffer Frames per callback / chunk (0 lets PortAudio pick)
+ */
+AudioSource::Ptr make_audio_source(const AudioSourceConfig &config,
+                                   AudioRing *audio_ring, double sample_rate,
+                                   unsigned long frames_per_buffer);
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__AUDIO_SOURCE_FACTORY_HPP
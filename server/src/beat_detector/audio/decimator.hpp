@@ -0,0 +1,82 @@
+#ifndef BEAT_DETECTOR__DECIMATOR_HPP
+#define BEAT_DETECTOR__DECIMATOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace beatled::detector {
+
+/**
+ * @brief Anti-aliasing decimator by an integer factor
+ *
+ * A linear-phase windowed-sinc low-pass (cut-off at 90% of the output
+ * Nyquist frequency, 24 taps per unit of decimation) evaluated in polyphase
+ * form: only every `factor`-th output is computed, as one contiguous dot
+ * product over the input history, which the compiler vectorizes.
+ *
+ * Streaming: the filter state carries over between `process()` calls, so
+ * the input may be split into chunks of any size. `process()` never
+ * allocates; the scratch it needs is sized at construction for blocks of
+ * up to `max_block` input frames.
+ */
+class Decimator {
+public:
+  /**
+   * @param factor Decimation factor (1 passes samples through)
+   * @param max_block Largest input block accepted by `process()`
+   */
+  explicit Decimator(unsigned factor, std::size_t max_block = 1024);
+
+  unsigned factor() const { return factor_; }
+
+  std::size_t max_block() const { return max_block_; }
+
+  std::size_t taps() const { return taps_.size(); }
+
+  /**
+   * @brief Group delay of the filter, in input samples
+   * An output sample describes the input as it was this many samples before
+   * the newest input sample it was computed from.
+   */
+  double delay() const { return 0.5 * static_cast<double>(taps_.size() - 1); }
+
+  /**
+   * @brief Filters and decimates one block of input
+   * @param input Mono float32 samples, at most `max_block()`
+   * @param count Number of input samples
+   * @param output Receives up to `count / factor + 1` samples
+   * @param first_input_index Index in `input` of the newest sample the first
+   * output was computed from (meaningless when nothing is returned)
+   * @return Number of output samples
+   */
+  std::size_t process(const float *input, std::size_t count, float *output,
+                      std::size_t &first_input_index);
+
+  /**
+   * @brief Clears the filter history and output phase
+   */
+  void reset();
+
+private:
+  unsigned factor_;
+  std::size_t max_block_;
+
+  /**
+   * @brief Filter taps, reversed so each output is a forward dot product
+   */
+  std::vector<float> taps_;
+
+  /**
+   * @brief The last `taps - 1` input samples followed by the current block
+   */
+  std::vector<float> history_;
+
+  /**
+   * @brief Input samples to skip before the next output is due
+   */
+  std::size_t phase_ = 0;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__DECIMATOR_HPP
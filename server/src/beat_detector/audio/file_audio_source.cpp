@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#include "audio_file_loader.hpp"
+#include "file_audio_source.hpp"
+#include "sample_convert.hpp"
+
+using namespace beatled::detector;
+
+FileAudioSource::FileAudioSource(AudioRing *audio_ring,
+                                 const std::filesystem::path &path, AudioPacing pacing,
+                                 std::size_t frames_per_chunk, bool loop)
+    : ThreadedAudioSource(audio_ring, 0, pacing, frames_per_chunk), path_{path},
+      loop_{loop} {}
+
+bool FileAudioSource::open_source() {
+  MonoAudio audio;
+  if (!load_mono_audio_file(path_, audio)) {
+    return false;
+  }
+
+  samples_ = std::move(audio.samples);
+  sample_rate_ = audio.sample_rate;
+  read_index_ = 0;
+  SPDLOG_INFO("Opened audio file {}: {} Hz, {} channel(s), {:.1f} s", path_.string(), sample_rate_,
+              audio.channels, samples_.size() / sample_rate_);
+  return true;
+}
+
+void FileAudioSource::close_source() {
+  samples_.clear();
+  samples_.shrink_to_fit();
+}
+
+std::size_t FileAudioSource::read_frames(float *frames, std::size_t max_frames) {
+  if (read_index_ == samples_.size() && loop_) {
+    read_index_ = 0;
+  }
+  const std::size_t count = std::min(max_frames, samples_.size() - read_index_);
+  convert_samples(samples_.data() + read_index_, count, frames);
+  read_index_ += count;
+  return count;
+}
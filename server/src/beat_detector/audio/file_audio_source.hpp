@@ -0,0 +1,37 @@
+#ifndef BEAT_DETECTOR__FILE_AUDIO_SOURCE_HPP
+#define BEAT_DETECTOR__FILE_AUDIO_SOURCE_HPP
+
+#include <filesystem>
+#include <vector>
+
+#include "threaded_audio_source.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Audio source reading a WAV or AIFF file
+ *
+ * The file is decoded once by AudioFile in `open()` (multi-channel files are
+ * downmixed to mono) and then streamed from memory at the file's own sample
+ * rate.
+ */
+class FileAudioSource : public ThreadedAudioSource {
+public:
+  FileAudioSource(AudioRing *audio_ring, const std::filesystem::path &path,
+                  AudioPacing pacing, std::size_t frames_per_chunk, bool loop = false);
+
+protected:
+  bool open_source() override;
+  void close_source() override;
+  std::size_t read_frames(float *frames, std::size_t max_frames) override;
+
+private:
+  std::filesystem::path path_;
+  bool loop_;
+  std::vector<float> samples_;
+  std::size_t read_index_ = 0;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__FILE_AUDIO_SOURCE_HPP
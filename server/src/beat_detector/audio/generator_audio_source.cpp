@@ -0,0 +1,49 @@
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+#include "generator_audio_source.hpp"
+
+using namespace beatled::detector;
+
+namespace {
+constexpr double kClickDurationS = 0.03;
+constexpr double kClickDecayS = 0.006;
+constexpr double kClickToneHz = 1000.0;
+constexpr float kNoiseFloor = 0.01f;
+} // namespace
+
+GeneratorAudioSource::GeneratorAudioSource(AudioRing *audio_ring, double bpm,
+                                           double sample_rate, AudioPacing pacing,
+                                           std::size_t frames_per_chunk)
+    : ThreadedAudioSource(audio_ring, sample_rate, pacing, frames_per_chunk), bpm_{bpm} {}
+
+bool GeneratorAudioSource::open_source() {
+  frame_index_ = 0;
+  SPDLOG_INFO("Generating a {} BPM click track at {} Hz", bpm_, sample_rate_);
+  return bpm_ > 0 && sample_rate_ > 0;
+}
+
+float GeneratorAudioSource::next_noise() {
+  // xorshift32, mapped to [-1, 1)
+  noise_state_ ^= noise_state_ << 13;
+  noise_state_ ^= noise_state_ >> 17;
+  noise_state_ ^= noise_state_ << 5;
+  return static_cast<float>(noise_state_) / 2147483648.0f - 1.0f;
+}
+
+std::size_t GeneratorAudioSource::read_frames(float *frames, std::size_t max_frames) {
+  const double beat_period = 60.0 / bpm_;
+  for (std::size_t i = 0; i < max_frames; i++, frame_index_++) {
+    const double t = static_cast<double>(frame_index_) / sample_rate_;
+    const double since_beat = std::fmod(t, beat_period);
+
+    float sample = kNoiseFloor * next_noise();
+    if (since_beat < kClickDurationS) {
+      const double envelope = std::exp(-since_beat / kClickDecayS);
+      sample += static_cast<float>(
+          envelope * (0.5 * next_noise() + 0.5 * std::sin(2 * M_PI * kClickToneHz * since_beat)));
+    }
+    frames[i] = sample;
+  }
+  return max_frames;
+}
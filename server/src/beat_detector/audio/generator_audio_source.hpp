@@ -0,0 +1,36 @@
+#ifndef BEAT_DETECTOR__GENERATOR_AUDIO_SOURCE_HPP
+#define BEAT_DETECTOR__GENERATOR_AUDIO_SOURCE_HPP
+
+#include <cstdint>
+
+#include "threaded_audio_source.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Audio source synthesizing a click track
+ *
+ * Emits a short, exponentially decaying noise + 1 kHz burst on every beat of
+ * a fixed tempo over a quiet noise floor. Deterministic (fixed-seed noise),
+ * endless, and strongly percussive so the tracker locks on quickly.
+ */
+class GeneratorAudioSource : public ThreadedAudioSource {
+public:
+  GeneratorAudioSource(AudioRing *audio_ring, double bpm, double sample_rate,
+                       AudioPacing pacing, std::size_t frames_per_chunk);
+
+protected:
+  bool open_source() override;
+  std::size_t read_frames(float *frames, std::size_t max_frames) override;
+
+private:
+  float next_noise();
+
+  double bpm_;
+  uint64_t frame_index_ = 0;
+  uint32_t noise_state_ = 0x1234567u;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__GENERATOR_AUDIO_SOURCE_HPP
@@ -0,0 +1,71 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "pipe_audio_source.hpp"
+
+using namespace beatled::detector;
+
+PipeAudioSource::PipeAudioSource(AudioRing *audio_ring, const std::string &path,
+                                 double sample_rate, AudioPacing pacing,
+                                 std::size_t frames_per_chunk)
+    : ThreadedAudioSource(audio_ring, sample_rate, pacing, frames_per_chunk),
+      path_{path} {}
+
+bool PipeAudioSource::open_source() {
+  if (path_ == "-") {
+    fd_ = STDIN_FILENO;
+  } else {
+    // O_NONBLOCK so opening a FIFO doesn't hang until a writer shows up;
+    // reads go through poll() anyway
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd_ < 0) {
+      SPDLOG_ERROR("Couldn't open PCM pipe {}: {}", path_, std::strerror(errno));
+      return false;
+    }
+  }
+  SPDLOG_INFO("Reading f32le PCM from {} at {} Hz", path_ == "-" ? "stdin" : path_, sample_rate_);
+  return true;
+}
+
+void PipeAudioSource::close_source() {
+  if (fd_ >= 0 && fd_ != STDIN_FILENO) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+}
+
+std::size_t PipeAudioSource::read_frames(float *frames, std::size_t max_frames) {
+  auto *bytes = reinterpret_cast<char *>(frames);
+  const std::size_t wanted = max_frames * sizeof(float);
+  std::size_t received = 0;
+
+  while (received < wanted && !stop_requested()) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, 100);
+    if (ready < 0 && errno != EINTR) {
+      SPDLOG_ERROR("Polling PCM pipe failed: {}", std::strerror(errno));
+      break;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+
+    ssize_t n = ::read(fd_, bytes + received, wanted - received);
+    if (n > 0) {
+      received += static_cast<std::size_t>(n);
+    } else if (n == 0) {
+      // Writer closed
+      break;
+    } else if (errno != EAGAIN && errno != EINTR) {
+      SPDLOG_ERROR("Reading PCM pipe failed: {}", std::strerror(errno));
+      break;
+    }
+  }
+
+  // A trailing partial sample is dropped
+  return received / sizeof(float);
+}
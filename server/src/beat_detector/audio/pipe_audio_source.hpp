@@ -0,0 +1,34 @@
+#ifndef BEAT_DETECTOR__PIPE_AUDIO_SOURCE_HPP
+#define BEAT_DETECTOR__PIPE_AUDIO_SOURCE_HPP
+
+#include <string>
+
+#include "threaded_audio_source.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Audio source reading raw PCM from stdin, a named pipe or a file
+ *
+ * Expects mono float32 little-endian samples at `sample_rate`, e.g.
+ * `ffmpeg -i track.mp3 -f f32le -ac 1 -ar 44100 - | beat_server --audio-source pipe:-`.
+ * The stream ends when the writer closes its end.
+ */
+class PipeAudioSource : public ThreadedAudioSource {
+public:
+  PipeAudioSource(AudioRing *audio_ring, const std::string &path, double sample_rate,
+                  AudioPacing pacing, std::size_t frames_per_chunk);
+
+protected:
+  bool open_source() override;
+  void close_source() override;
+  std::size_t read_frames(float *frames, std::size_t max_frames) override;
+
+private:
+  std::string path_;
+  int fd_ = -1;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__PIPE_AUDIO_SOURCE_HPP
@@ -0,0 +1,31 @@
+#ifndef BEAT_DETECTOR__SAMPLE_CONVERT_HPP
+#define BEAT_DETECTOR__SAMPLE_CONVERT_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace beatled::detector {
+
+/**
+ * @brief Bulk copy of `count` samples from `src` to `dst`
+ *
+ * A plain memcpy when both sides share a sample type. Otherwise a single
+ * branch-free loop over non-aliasing contiguous arrays, which the compiler
+ * turns into packed conversions (e.g. cvtps2pd / fcvtl) rather than one
+ * scalar conversion per sample.
+ */
+template <typename Dst, typename Src>
+inline void convert_samples(const Src *__restrict src, std::size_t count, Dst *__restrict dst) {
+  if constexpr (std::is_same_v<Dst, Src>) {
+    std::memcpy(dst, src, count * sizeof(Src));
+  } else {
+    for (std::size_t i = 0; i < count; i++) {
+      dst[i] = static_cast<Dst>(src[i]);
+    }
+  }
+}
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__SAMPLE_CONVERT_HPP
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include "core/clock.hpp"
+#include "threaded_audio_source.hpp"
+
+using namespace beatled::detector;
+using beatled::core::Clock;
+
+ThreadedAudioSource::ThreadedAudioSource(AudioRing *audio_ring, double sample_rate,
+                                         AudioPacing pacing, std::size_t frames_per_chunk)
+    : AudioSource(audio_ring, sample_rate), pacing_{pacing},
+      chunk_(frames_per_chunk == 0 ? 512 : frames_per_chunk) {}
+
+ThreadedAudioSource::~ThreadedAudioSource() {
+  stop();
+  close();
+}
+
+bool ThreadedAudioSource::open() {
+  if (opened_) {
+    return true;
+  }
+  if (!open_source()) {
+    return false;
+  }
+  reset_ring();
+  opened_ = true;
+  return true;
+}
+
+bool ThreadedAudioSource::close() {
+  if (!opened_) {
+    return false;
+  }
+  stop();
+  close_source();
+  opened_ = false;
+  return true;
+}
+
+bool ThreadedAudioSource::start() {
+  if (!opened_ || thread_.joinable()) {
+    return false;
+  }
+  stop_requested_ = false;
+  frames_delivered_ = 0;
+  active_ = true;
+  thread_ = std::thread([this]() { run(); });
+  return true;
+}
+
+bool ThreadedAudioSource::stop() {
+  stop_requested_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  return true;
+}
+
+bool ThreadedAudioSource::is_active() { return active_.load(); }
+
+bool ThreadedAudioSource::wait() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  return true;
+}
+
+void ThreadedAudioSource::run() {
+  const uint64_t start_time = Clock::time_us_64();
+  uint64_t frames = 0;
+
+  while (!stop_requested_.load(std::memory_order_relaxed)) {
+    const std::size_t read = read_frames(chunk_.data(), chunk_.size());
+    if (read == 0) {
+      SPDLOG_INFO("Audio source reached end of stream after {} frames", frames);
+      // Wake the consumer: no more buffers are coming
+      audio_ring_->set_active(false);
+      break;
+    }
+
+    const uint64_t capture_time =
+        start_time + static_cast<uint64_t>(1e6 * static_cast<double>(frames) / sample_rate_);
+
+    if (pacing_ == AudioPacing::RealTime) {
+      // A sound card hands a chunk over once its last sample is captured
+      const uint64_t release_time =
+          start_time +
+          static_cast<uint64_t>(1e6 * static_cast<double>(frames + read) / sample_rate_);
+      const uint64_t now = Clock::time_us_64();
+      if (release_time > now) {
+        std::this_thread::sleep_for(std::chrono::microseconds(release_time - now));
+      }
+    } else {
+      // Nobody is waiting on the wall clock: apply back-pressure instead of
+      // dropping audio when the consumer is busy. `read` frames take up at
+      // most one ring sample per `decimation_` frames, plus one. Never wait
+      // for more than the ring frees while the consumer waits for a window.
+      const std::size_t needed =
+          std::min(audio_ring_->capacity() - audio_ring_->window_size(),
+                   1 + (read + decimation_ - 1) / decimation_);
+      // A resync empties the ring on the next write, don't wait for the
+      // consumer to do it.
+      while (audio_ring_->free_space() < needed && !audio_ring_->resync_pending() &&
+             !stop_requested_.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+
+    write_frames(chunk_.data(), read, capture_time);
+    frames += read;
+    frames_delivered_.store(frames, std::memory_order_relaxed);
+  }
+  active_ = false;
+}
@@ -0,0 +1,83 @@
+#ifndef BEAT_DETECTOR__THREADED_AUDIO_SOURCE_HPP
+#define BEAT_DETECTOR__THREADED_AUDIO_SOURCE_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "audio_source.hpp"
+#include "beat_detector/audio/audio_source_config.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Base for audio sources that don't need a sound card
+ *
+ * Runs a producer thread that pulls chunks of `frames_per_chunk` samples from
+ * `read_frames` and writes them to the ring. With `AudioPacing::RealTime` the
+ * thread sleeps so chunks are released at the nominal sample rate, stamped as
+ * if captured live. With `AudioPacing::AsFastAsPossible` it only waits for
+ * the consumer to free space in the ring (nothing is dropped) and stamps
+ * chunks on a virtual clock starting at `start()`.
+ *
+ * When `read_frames` reports the end of the stream the ring is deactivated,
+ * which wakes the consumer with an empty view.
+ */
+class ThreadedAudioSource : public AudioSource {
+public:
+  ThreadedAudioSource(AudioRing *audio_ring, double sample_rate, AudioPacing pacing,
+                      std::size_t frames_per_chunk);
+
+  ~ThreadedAudioSource() override;
+
+  bool open() override;
+  bool close() override;
+  bool start() override;
+  bool stop() override;
+  bool is_active() override;
+  bool wait() override;
+
+  /**
+   * @brief Frames delivered since `start()`
+   */
+  uint64_t frames_delivered() const { return frames_delivered_.load(std::memory_order_relaxed); }
+
+protected:
+  /**
+   * @brief Backend specific open, may update `sample_rate_`
+   * @return true on success
+   */
+  virtual bool open_source() = 0;
+
+  /**
+   * @brief Backend specific close
+   */
+  virtual void close_source() {}
+
+  /**
+   * @brief Reads up to `max_frames` mono samples
+   * Called from the producer thread only.
+   * @return Number of samples read, 0 at the end of the stream
+   */
+  virtual std::size_t read_frames(float *frames, std::size_t max_frames) = 0;
+
+  /**
+   * @brief Lets blocking `read_frames` implementations bail out on `stop()`
+   */
+  bool stop_requested() const { return stop_requested_.load(std::memory_order_relaxed); }
+
+private:
+  void run();
+
+  AudioPacing pacing_;
+  std::vector<float> chunk_;
+  std::thread thread_;
+  std::atomic_bool stop_requested_{false};
+  std::atomic_bool active_{false};
+  std::atomic<uint64_t> frames_delivered_{0};
+  bool opened_ = false;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__THREADED_AUDIO_SOURCE_HPP
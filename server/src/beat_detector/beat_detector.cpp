@@ -5,7 +5,7 @@
 #include <spdlog/spdlog.h>
 
 #include "audio/audio_exception.hpp"
-#include "audio/audio_input.hpp"
+#include "audio/audio_source_factory.hpp"
 #include "beat_detector/beat_detector.hpp"
 #include "beat_detector_impl.h"
 #include "core/clock.hpp"
@@ -19,40 +19,83 @@ using beatled::core::Clock;
 
 BeatDetector::BeatDetector(const std::string &id, uint32_t sample_rate,
                            std::size_t audio_buffer_size, beat_detector_cb_t beat_callback,
-                           beat_detector_cb_t next_beat_callback)
+                           beat_detector_cb_t next_beat_callback,
+                           const AudioSourceConfig &audio_source,
+                           core::LatencyMetrics *latency_metrics,
+                           const FftwWisdomConfig &fftw_wisdom,
+                           beat_schedule_cb_t beat_schedule_callback)
     : ServiceControllerInterface{id},
       pImpl{std::make_unique<Impl>(sample_rate, audio_buffer_size, beat_callback,
-                                   next_beat_callback)} {}
+                                   next_beat_callback, audio_source, latency_metrics,
+                                   fftw_wisdom, beat_schedule_callback)} {}
 
-BeatDetector::~BeatDetector() {}
+BeatDetector::~BeatDetector() { pImpl->shutdown(); }
 
 void BeatDetector::stop_sync() {
-  SPDLOG_INFO("Requesting Beat Detector to stop");
-  pImpl->stop_requested_ = true;
-  if (pImpl->bd_thread_future_.valid()) {
-    pImpl->bd_thread_future_.wait();
-    pImpl->bd_thread_future_.get();
+  SPDLOG_INFO("Requesting Beat Detector to pause");
+  {
+    const std::lock_guard<std::mutex> lock(pImpl->state_mutex_);
+    pImpl->processing_requested_ = false;
+    pImpl->stop_requested_ = true;
+    // Wake the loop even if the source has stalled (e.g. an idle pipe). Under
+    // the lock, so a worker resuming concurrently can't activate the ring
+    // after this.
+    pImpl->audio_ring_->set_active(false);
   }
+  pImpl->wait_until_parked();
 }
 
 void BeatDetector::stop_blocking() {
   stop();
-  SPDLOG_INFO("Waiting for Beat Detector to stop");
-  if (pImpl->bd_thread_future_.valid()) {
-    pImpl->bd_thread_future_.wait();
-    pImpl->bd_thread_future_.get();
-  }
+  SPDLOG_INFO("Beat Detector paused");
 }
 
 void BeatDetector::start_sync() {
   if (!pImpl->bd_thread_future_.valid() ||
       pImpl->bd_thread_future_.wait_for(0s) == std::future_status::ready) {
+    // A worker that died (e.g. the device went away) is joined first, so its
+    // error is reported rather than dropped with the future
+    pImpl->join_worker();
     SPDLOG_INFO("Starting thread");
-    pImpl->stop_requested_.store(false);
+    {
+      const std::lock_guard<std::mutex> lock(pImpl->state_mutex_);
+      pImpl->shutdown_requested_ = false;
+    }
     pImpl->bd_thread_future_ =
         std::async(std::launch::async, [this]() -> void { return pImpl->do_detect_tempo(); });
-  } else {
-    SPDLOG_INFO("Beat detector is already running");
+  }
+
+  const std::lock_guard<std::mutex> lock(pImpl->state_mutex_);
+  pImpl->processing_requested_ = true;
+  pImpl->stop_requested_ = false;
+  pImpl->state_cv_.notify_all();
+}
+
+void BeatDetector::Impl::wait_until_parked() {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  state_cv_.wait(lock, [this]() { return parked_; });
+}
+
+void BeatDetector::Impl::shutdown() {
+  {
+    const std::lock_guard<std::mutex> lock(state_mutex_);
+    shutdown_requested_ = true;
+    processing_requested_ = false;
+    stop_requested_ = true;
+    audio_ring_->set_active(false);
+    state_cv_.notify_all();
+  }
+  join_worker();
+}
+
+void BeatDetector::Impl::join_worker() {
+  if (!bd_thread_future_.valid()) {
+    return;
+  }
+  try {
+    bd_thread_future_.get();
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Beat detector thread failed: {}", e.what());
   }
 }
 
@@ -63,60 +106,150 @@ void BeatDetector::start_sync() {
 static constexpr int kBeatDetectorRtPriority = 80;
 
 void BeatDetector::Impl::do_detect_tempo() {
+  // Whatever happens, don't leave stop_sync() waiting for a dead worker
+  struct ParkOnExit {
+    Impl &impl;
+    ~ParkOnExit() {
+      const std::lock_guard<std::mutex> lock(impl.state_mutex_);
+      impl.parked_ = true;
+      impl.is_running_ = false;
+      impl.state_cv_.notify_all();
+    }
+  } park_on_exit{*this};
+
   // This loop is the timing-critical path — a late dequeue skews the beat
   // estimate. Promote it to SCHED_FIFO on Linux (no-op / soft-fail elsewhere)
   // so the scheduler never preempts it for time-sharing work.
   beatled::core::set_thread_realtime_priority(kBeatDetectorRtPriority);
 
-  // Use frame_rate = 0 to let the OS choose the frame rate (potentially
-  // dynamically)
-  AudioInput audio_input(audio_buffer_pool_.get(), sample_rate_, 512);
-
-  if (!audio_input.open()) {
-    throw AudioInputException("Couldn't open device.");
+  // Built once: the tracker keeps its tempo estimate across pauses
+  const uint64_t setup_start_time = Clock::time_us_64();
+  build_beat_tracker();
+  const uint64_t tracker_setup_time = Clock::time_us_64() - setup_start_time;
+  SPDLOG_INFO("Beat tracker ready in {} us", tracker_setup_time);
+  if (latency_metrics_) {
+    latency_metrics_->record_startup(core::StartupStage::TrackerSetup, tracker_setup_time);
   }
 
-  if (!audio_input.start()) {
-    throw AudioInputException("Couldn't start stream.");
-  }
+  // The source, and with it the PortAudio stream, lives as long as the
+  // worker: pausing stops reading hops, not capturing them
+  AudioSource::Ptr audio_source;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(state_mutex_);
+      parked_ = true;
+      state_cv_.notify_all();
+      state_cv_.wait(lock, [this]() { return processing_requested_ || shutdown_requested_; });
+      if (shutdown_requested_) {
+        break;
+      }
+      parked_ = false;
+      // While the session is still requested: a stop landing after this
+      // deactivates the ring again, so the loop below sees it
+      audio_ring_->set_active(true);
+    }
 
-  SPDLOG_INFO("Audio input active: {}", audio_input.is_active());
+    // Time to first beat runs from here, for a cold start or a resume
+    session_start_time_ = Clock::time_us_64();
+    first_beat_pending_ = true;
+    // The tempo ramp, if any, was the previous session's
+    beat_schedule_tracker_.reset();
+
+    if (audio_source && audio_source->is_active()) {
+      // Resume: the stream kept running while paused. Drop what it captured
+      // meanwhile and carry on from the next hop.
+      SPDLOG_INFO("Resuming beat detection");
+      audio_ring_->request_resync();
+    } else {
+      // First start, or the previous stream ended (e.g. a file without
+      // --audio-loop): open it (again)
+      audio_source.reset();
+      SPDLOG_INFO("Audio source: {}", to_string(audio_source_config_));
+      audio_source = make_audio_source(audio_source_config_, audio_ring_.get(), sample_rate_,
+                                       audio_buffer_size_);
+
+      if (!audio_source->open()) {
+        throw AudioInputException("Couldn't open device.");
+      }
+
+      if (!audio_source->start()) {
+        throw AudioInputException("Couldn't start stream.");
+      }
+
+      SPDLOG_INFO("Audio input active: {}", audio_source->is_active());
+      beat_tracker_->set_sampling_rate(audio_source->effective_sample_rate());
+    }
 
-  beat_tracker_.set_sampling_rate(audio_input.effective_sample_rate());
+    is_running_ = true;
+    const bool stream_open = process_hops(*audio_source);
+    is_running_ = false;
+
+    if (!stream_open) {
+      audio_source->stop();
+      audio_source->wait();
+      SPDLOG_INFO("Audio stats: {} input overflows, {} input underflows",
+                  audio_source->input_overflow_count(), audio_source->input_underflow_count());
+      audio_source.reset();
+
+      // Nothing left to process: park until the next start
+      const std::lock_guard<std::mutex> lock(state_mutex_);
+      processing_requested_ = false;
+      stop_requested_ = true;
+    }
+  }
 
-  is_running_ = true;
+  if (audio_source) {
+    audio_source->stop();
+    audio_source->wait();
+  }
+  SPDLOG_INFO("Exiting beat detector loop");
+}
+
+bool BeatDetector::Impl::process_hops(AudioSource &audio_source) {
   uint64_t previous_buffer_time = 0;
+  // Drops while paused are expected: only report the ones from this session
+  const uint64_t initial_overruns = audio_ring_->overrun_count();
+  uint64_t reported_overruns = initial_overruns;
+  uint64_t reported_overflows = audio_source.input_overflow_count();
   while (true) {
-    audio_buffer_ = audio_buffer_pool_->dequeue_blocking();
-
-    if (!audio_buffer_) {
-      SPDLOG_INFO("Stopping thread");
-      audio_input.stop();
-      break;
+    hop_ = audio_ring_->acquire_blocking();
+    dequeue_time_ = Clock::time_us_64();
+
+    if (!hop_) {
+      if (stop_requested_.load()) {
+        SPDLOG_INFO("Pausing beat detection");
+        return true;
+      }
+      SPDLOG_INFO("Audio source reached the end of its stream");
+      return false;
     }
-    auto diff = audio_buffer_->start_time() - previous_buffer_time;
+    auto diff = hop_.start_time - previous_buffer_time;
 
-    SPDLOG_DEBUG("New buffer. Processing it. Start stream time {}, id {}, time diff {}",
-                 audio_buffer_->start_time(), audio_buffer_->buffer_id(), diff);
+    SPDLOG_DEBUG("New hop. Processing it. Start stream time {}, index {}, time diff {}",
+                 hop_.start_time, hop_.index, diff);
 
-    auto hop_data = audio_buffer_->data();
-    beat_tracker_.process_audio_frame(hop_data);
+    process_hop(*beat_tracker_, hop_.samples, tracker_hop_);
 
-    previous_buffer_time = audio_buffer_->start_time();
+    previous_buffer_time = hop_.start_time;
 
-    audio_buffer_pool_->release_buffer(std::move(audio_buffer_));
+    audio_ring_->release();
 
-    if (stop_requested_.load()) {
-      SPDLOG_INFO("Stopping thread");
-      audio_input.stop();
+    // The audio callback can't log, it only counts. Report new drops from here.
+    const uint64_t overruns = audio_ring_->overrun_count();
+    const uint64_t overflows = audio_source.input_overflow_count();
+    if (overruns != reported_overruns || overflows != reported_overflows) {
+      SPDLOG_WARN("Audio dropped: {} ring overruns, {} input overflows since last report",
+                  overruns - reported_overruns, overflows - reported_overflows);
+      reported_overruns = overruns;
+      reported_overflows = overflows;
+    }
 
-      break;
+    if (stop_requested_.load()) {
+      SPDLOG_INFO("Pausing beat detection after {} ring overruns",
+                  audio_ring_->overrun_count() - initial_overruns);
+      return true;
     }
   }
-
-  audio_input.wait();
-  is_running_ = false;
-  SPDLOG_INFO("Exiting beat detector loop");
 }
 
 } // namespace beatled::detector
\ No newline at end of file
@@ -1,18 +1,27 @@
 #ifndef SERVER__SRC__BEAT_DETECTOR__BEAT_DETECTOR_IMPL__H_
 #define SERVER__SRC__BEAT_DETECTOR__BEAT_DETECTOR_IMPL__H_
 
+#include <algorithm>
 #include <beat_tracker.hpp>
 #include <chrono>
+#include <condition_variable>
 #include <fmt/format.h>
 #include <future>
 #include <iostream>
+#include <mutex>
 #include <spdlog/spdlog.h>
 #include <sys/time.h>
+#include <type_traits>
+#include <vector>
 
 #include "audio/audio_exception.hpp"
-#include "audio/audio_input.hpp"
+#include "audio/audio_source_factory.hpp"
+#include "beat_detector/audio/config.h"
 #include "beat_detector/beat_detector.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
+#include "beat_tracker_factory.hpp"
 #include "core/clock.hpp"
+#include "process_hop.hpp"
 
 namespace beatled::detector {
 
@@ -23,59 +32,210 @@ using beatled::core::Clock;
 class BeatDetector::Impl {
 public:
   Impl(uint32_t sample_rate, std::size_t audio_buffer_size, beat_detector_cb_t beat_callback,
-       beat_detector_cb_t next_beat_callback)
+       beat_detector_cb_t next_beat_callback, const AudioSourceConfig &audio_source,
+       core::LatencyMetrics *latency_metrics, const FftwWisdomConfig &fftw_wisdom,
+       beat_schedule_cb_t beat_schedule_callback)
       : sample_rate_{sample_rate}, audio_buffer_size_{audio_buffer_size},
-        beat_callback_{beat_callback}, next_beat_callback_{next_beat_callback}, beat_count_{0}
+        audio_source_config_{audio_source}, beat_callback_{beat_callback},
+        next_beat_callback_{next_beat_callback}, beat_schedule_callback_{beat_schedule_callback},
+        latency_metrics_{latency_metrics},
+        fftw_wisdom_{fftw_wisdom, tracker_fft_precision<btrack::BTrack>}, beat_count_{0}
 
   {
-    audio_buffer_pool_ = std::make_unique<AudioBufferPool>(audio_buffer_size_, sample_rate_);
+    // Hops keep their duration when decimating: the ring hands out
+    // `audio_buffer_size / decimation` samples at the reduced rate. BTrack
+    // keeps its own analysis frame, so views don't overlap.
+    const unsigned decimation = std::max(1u, audio_source_config_.decimation);
+    if (audio_buffer_size_ % decimation != 0) {
+      throw AudioException(fmt::format("Audio buffer size {} is not a multiple of decimation {}",
+                                       audio_buffer_size_, decimation));
+    }
+    hop_size_ = audio_buffer_size_ / decimation;
+    audio_ring_ =
+        std::make_unique<AudioRing>(hop_size_, static_cast<double>(sample_rate_) / decimation);
+    tracker_hop_.reserve(hop_size_);
+
+    // Measured kernels from a previous run reach the tracker through the
+    // wisdom; anything missing is measured in the background and cached for
+    // the next start
+    fftw_wisdom_.import_wisdom();
+    fftw_wisdom_.plan_async(tracker_fft_shapes<btrack::BTrack>(hop_size_));
+  }
+
+  ~Impl() {
+    // Background planning may still be running: the tracker's plans go
+    // through the planner too
+    auto lock = FftwWisdom::planner_lock();
+    beat_tracker_.reset();
+  }
+
+  /**
+   * @brief Builds the tracker, once per worker thread: it stays warm across
+   * pauses. Planning its transforms is most of the cost; with wisdom it is a
+   * lookup.
+   */
+  void build_beat_tracker() {
+    {
+      auto lock = FftwWisdom::planner_lock();
+      beat_tracker_.reset();
+      beat_tracker_ = make_beat_tracker<btrack::BTrack>(hop_size_);
+    }
+
     if (beat_callback_) {
-      beat_tracker_.set_beat_callback([&](double tempo, double estimated_tempo) {
-        SPDLOG_INFO("Beat: buffer start time {}, current_time {}, diff {}",
-                    this->audio_buffer_->start_time(), Clock::time_us_64(),
-                    (int64_t)(this->audio_buffer_->start_time()) - (int64_t)(Clock::time_us_64()));
+      beat_tracker_->set_beat_callback([&](double tempo, double estimated_tempo) {
+        SPDLOG_DEBUG("Beat: buffer start time {}", this->hop_.start_time);
+        record_first_beat();
         beat_count_++;
-        beat_callback_(this->audio_buffer_->start_time(), tempo, estimated_tempo, beat_count_);
+        beat_callback_(this->hop_.start_time, tempo, estimated_tempo, beat_count_);
       });
     }
 
     if (next_beat_callback_) {
-      beat_tracker_.set_next_beat_callback(
+      beat_tracker_->set_next_beat_callback(
           [&](uint64_t delay, double tempo, double estimated_tempo) {
-            SPDLOG_INFO("Next beat: buffer start time {}, mid {}, delay {}, next beat "
-                        "time {}, current_time {}, diff "
-                        "{}",
-                        this->audio_buffer_->start_time(), this->audio_buffer_->start_time(), delay,
-                        this->audio_buffer_->start_time() + delay, Clock::time_us_64(),
-                        (int64_t)this->audio_buffer_->start_time() + (int64_t)delay -
-                            (int64_t)Clock::time_us_64());
-
-            next_beat_callback_(this->audio_buffer_->start_time() + delay, tempo, estimated_tempo,
+            record_first_beat();
+            record_latency();
+            SPDLOG_DEBUG("Next beat: buffer start time {}, delay {}", this->hop_.start_time,
+                         delay);
+
+            next_beat_callback_(this->hop_.start_time + delay, tempo, estimated_tempo,
                                 beat_count_ + 1);
+            if (beat_schedule_callback_) {
+              beat_schedule_callback_(beat_schedule_tracker_.update(
+                  this->hop_.start_time + delay, tempo, beat_count_ + 1));
+            }
           });
     }
   }
 
+  /**
+   * @brief Reports how long the session took to produce its first beat
+   */
+  void record_first_beat() {
+    if (!first_beat_pending_) {
+      return;
+    }
+    first_beat_pending_ = false;
+    const uint64_t time_to_first_beat = Clock::time_us_64() - session_start_time_;
+    SPDLOG_INFO("Time to first beat: {} ms", time_to_first_beat / 1000);
+    if (latency_metrics_) {
+      latency_metrics_->record_startup(core::StartupStage::FirstBeat, time_to_first_beat);
+    }
+  }
+
+  /**
+   * @brief Records the detector's stages for the hop that produced a beat
+   * prediction: capture (last sample digitised -> hop handed over), queue
+   * (handed over -> dequeued) and tracker (dequeued -> now)
+   */
+  void record_latency() {
+    if (!latency_metrics_) {
+      return;
+    }
+    using core::LatencyStage;
+    latency_metrics_->record_delta(LatencyStage::Capture, hop_.end_time(), hop_.ready_time);
+    latency_metrics_->record_delta(LatencyStage::Queue, hop_.ready_time, dequeue_time_);
+    latency_metrics_->record_delta(LatencyStage::Tracker, dequeue_time_, Clock::time_us_64());
+  }
+
+  /**
+   * @brief The worker thread: owns the audio source and the tracker, and
+   * parks between sessions instead of exiting
+   */
   void do_detect_tempo();
 
+  /**
+   * @brief Feeds hops to the tracker until paused or the source ends
+   * @return false if the source reached the end of its stream
+   */
+  bool process_hops(AudioSource &audio_source);
+
+  /**
+   * @brief Waits for the worker to park (or exit)
+   */
+  void wait_until_parked();
+
+  /**
+   * @brief Stops and joins the worker, closing the audio stream
+   */
+  void shutdown();
+
+  /**
+   * @brief Joins a worker that has exited or been asked to, logging the
+   * error that ended it, if any
+   */
+  void join_worker();
+
   std::future<void> bd_thread_future_;
-  std::atomic_bool stop_requested_;
+
+  /**
+   * @brief Mirror of `processing_requested_` polled once per hop
+   */
+  std::atomic_bool stop_requested_ = true;
   std::atomic_bool is_running_ = false;
 
+  /**
+   * @brief Worker state, guarded by `state_mutex_`: whether sessions are
+   * requested, whether the worker should exit, and whether it is parked
+   */
+  std::mutex state_mutex_;
+  std::condition_variable state_cv_;
+  bool processing_requested_ = false;
+  bool shutdown_requested_ = false;
+  bool parked_ = true;
+
   uint32_t sample_rate_;
   std::size_t audio_buffer_size_;
+  AudioSourceConfig audio_source_config_;
 
   beat_detector_cb_t beat_callback_ = [](uint64_t next_beat, double tempo, double estimated_tempo,
                                          uint32_t beat_count) {};
   beat_detector_cb_t next_beat_callback_ = [](uint64_t next_beat, double tempo,
                                               double estimated_tempo, uint32_t beat_count) {};
+  beat_schedule_cb_t beat_schedule_callback_;
 
-  std::unique_ptr<AudioBufferPool> audio_buffer_pool_;
-  btrack::BTrack beat_tracker_;
+  /**
+   * @brief Beats BTrack's predictions are extrapolated over: the tempo it
+   * reports moves in steps, so a ramp is only trusted a few beats ahead
+   */
+  static constexpr uint16_t kBeatScheduleSpan = 4;
+  core::BeatScheduleTracker beat_schedule_tracker_{kBeatScheduleSpan};
 
-  AudioBuffer::Ptr audio_buffer_;
+  core::LatencyMetrics *latency_metrics_;
+
+  FftwWisdom fftw_wisdom_;
+
+  /**
+   * @brief Samples per hop handed to the tracker
+   */
+  std::size_t hop_size_ = 0;
+
+  std::unique_ptr<AudioRing> audio_ring_;
+  std::unique_ptr<btrack::BTrack> beat_tracker_;
+
+  /**
+   * @brief The hop being processed, a view into `audio_ring_`
+   */
+  AudioRing::View hop_;
+
+  /**
+   * @brief When `hop_` was acquired
+   */
+  uint64_t dequeue_time_ = 0;
+
+  /**
+   * @brief Copy of the hop for trackers that only take a `std::vector<double>`
+   */
+  std::vector<double> tracker_hop_;
 
   uint32_t beat_count_;
+
+  /**
+   * @brief When the current session (start or resume) began, and whether it
+   * has produced a beat yet
+   */
+  uint64_t session_start_time_ = 0;
+  bool first_beat_pending_ = false;
 };
 
 } // namespace beatled::detector
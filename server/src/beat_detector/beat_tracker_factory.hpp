@@ -0,0 +1,65 @@
+#ifndef BEAT_DETECTOR__BEAT_TRACKER_FACTORY_HPP
+#define BEAT_DETECTOR__BEAT_TRACKER_FACTORY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "beat_detector/audio/config.h"
+#include "beat_detector/fftw_wisdom.hpp"
+#include "process_hop.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Analysis frame the tracker is built with for `hop_size`-sample hops
+ */
+constexpr std::size_t tracker_frame_size(std::size_t hop_size) { return 2 * hop_size; }
+
+/**
+ * @brief Length of the tracker's autocorrelation transform. A tracker that
+ * publishes it as `acf_fft_length` is taken at its word. BTrack releases
+ * without it zero-pad their 512-value onset history to 1024, whatever the
+ * hop.
+ */
+template <typename Tracker> constexpr std::size_t tracker_acf_length() {
+  if constexpr (requires { Tracker::acf_fft_length; }) {
+    return static_cast<std::size_t>(Tracker::acf_fft_length);
+  } else {
+    return 1024;
+  }
+}
+
+/**
+ * @brief Transforms the tracker plans for `hop_size`-sample hops
+ */
+template <typename Tracker> std::vector<FftShape> tracker_fft_shapes(std::size_t hop_size) {
+  return beat_tracker_fft_shapes(tracker_frame_size(hop_size), tracker_acf_length<Tracker>());
+}
+
+/**
+ * @brief FFTW precision the tracker plans in, from the sample type
+ * process_hop() feeds it: double for BTrack even in the float32 build
+ */
+template <typename Tracker>
+constexpr FftPrecision tracker_fft_precision =
+    fft_precision_of<tracker_sample_t<Tracker, audio_buffer_t>>;
+
+/**
+ * @brief Builds a tracker for `hop_size`-sample hops
+ * Decimated input reaches the tracker in proportionally shorter hops (same
+ * duration, fewer samples), so the tracker must be told the hop and frame
+ * size. A tracker that only knows its default 512-sample hop would silently
+ * mis-track them: that is a build error, not a fallback.
+ */
+template <typename Tracker> std::unique_ptr<Tracker> make_beat_tracker(std::size_t hop_size) {
+  static_assert(std::is_constructible_v<Tracker, int, int>,
+                "The beat tracker must take (hop_size, frame_size)");
+  return std::make_unique<Tracker>(static_cast<int>(hop_size),
+                                   static_cast<int>(tracker_frame_size(hop_size)));
+}
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__BEAT_TRACKER_FACTORY_HPP
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "beat_detector/evaluation/beat_metrics.hpp"
+
+namespace beatled::detector {
+
+namespace {
+
+std::vector<double> trim(const std::vector<double> &beats, double skip_seconds) {
+  std::vector<double> trimmed;
+  trimmed.reserve(beats.size());
+  for (double beat : beats) {
+    if (beat >= skip_seconds) {
+      trimmed.push_back(beat);
+    }
+  }
+  return trimmed;
+}
+
+struct ContinuityScore {
+  double continuous = 0;
+  double total = 0;
+};
+
+/**
+ * Each detected beat is correct if it is within the phase tolerance of the
+ * nearest reference beat and its inter-beat interval agrees with the local
+ * reference interval.
+ */
+ContinuityScore continuity(const std::vector<double> &reference, const std::vector<double> &detected,
+                           const BeatMetricsParameters &parameters) {
+  if (reference.size() < 2 || detected.size() < 2) {
+    return {};
+  }
+
+  std::size_t run = 0;
+  std::size_t longest_run = 0;
+  std::size_t correct = 0;
+  for (std::size_t m = 0; m < detected.size(); m++) {
+    const double beat = detected[m];
+    auto it = std::lower_bound(reference.begin(), reference.end(), beat);
+    std::size_t nearest = static_cast<std::size_t>(it - reference.begin());
+    if (nearest == reference.size() ||
+        (nearest > 0 && beat - reference[nearest - 1] < reference[nearest] - beat)) {
+      nearest--;
+    }
+
+    const double reference_interval = nearest > 0 ? reference[nearest] - reference[nearest - 1]
+                                                  : reference[1] - reference[0];
+    const double detected_interval = m > 0 ? detected[m] - detected[m - 1] : detected[1] - detected[0];
+
+    const bool in_phase = std::abs(beat - reference[nearest]) <
+                          parameters.continuity_phase_tolerance * reference_interval;
+    const bool in_period = std::abs(1.0 - detected_interval / reference_interval) <=
+                           parameters.continuity_period_tolerance;
+
+    if (in_phase && in_period) {
+      correct++;
+      longest_run = std::max(longest_run, ++run);
+    } else {
+      run = 0;
+    }
+  }
+
+  const double normalizer = static_cast<double>(std::max(reference.size(), detected.size()));
+  return {longest_run / normalizer, correct / normalizer};
+}
+
+} // namespace
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  const double rank = std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * values.size());
+  const std::size_t index = rank < 1 ? 0 : static_cast<std::size_t>(rank) - 1;
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+BeatMetrics evaluate_beats(const std::vector<double> &annotated_beats,
+                           const std::vector<double> &detected_beats,
+                           const BeatMetricsParameters &parameters) {
+  const auto annotated = trim(annotated_beats, parameters.skip_seconds);
+  const auto detected = trim(detected_beats, parameters.skip_seconds);
+
+  BeatMetrics metrics;
+  metrics.annotated_beats = annotated.size();
+  metrics.detected_beats = detected.size();
+
+  // F-measure: each annotation claims the closest unclaimed detection in its window
+  std::vector<bool> claimed(detected.size(), false);
+  double offset_sum = 0;
+  std::size_t first = 0;
+  for (double beat : annotated) {
+    while (first < detected.size() && detected[first] < beat - parameters.f_measure_window) {
+      first++;
+    }
+    std::size_t best = detected.size();
+    for (std::size_t j = first;
+         j < detected.size() && detected[j] <= beat + parameters.f_measure_window; j++) {
+      if (!claimed[j] &&
+          (best == detected.size() || std::abs(detected[j] - beat) < std::abs(detected[best] - beat))) {
+        best = j;
+      }
+    }
+    if (best != detected.size()) {
+      claimed[best] = true;
+      const double error_ms = 1000.0 * (detected[best] - beat);
+      offset_sum += error_ms;
+      metrics.errors_ms.push_back(std::abs(error_ms));
+    }
+  }
+
+  metrics.matched_beats = metrics.errors_ms.size();
+  if (!detected.empty()) {
+    metrics.precision = static_cast<double>(metrics.matched_beats) / detected.size();
+  }
+  if (!annotated.empty()) {
+    metrics.recall = static_cast<double>(metrics.matched_beats) / annotated.size();
+  }
+  if (metrics.precision + metrics.recall > 0) {
+    metrics.f_measure =
+        2 * metrics.precision * metrics.recall / (metrics.precision + metrics.recall);
+  }
+  if (metrics.matched_beats > 0) {
+    double error_sum = 0;
+    for (double error : metrics.errors_ms) {
+      error_sum += error;
+    }
+    metrics.mean_error_ms = error_sum / metrics.matched_beats;
+    metrics.mean_offset_ms = offset_sum / metrics.matched_beats;
+    metrics.p95_error_ms = percentile(metrics.errors_ms, 95);
+  }
+
+  // Continuity: the annotation itself, then the allowed metrical variations
+  // (double tempo, off-beat, and the two half-tempo phases)
+  const auto cml = continuity(annotated, detected, parameters);
+  metrics.cml_c = cml.continuous;
+  metrics.cml_t = cml.total;
+
+  if (annotated.size() >= 2) {
+    std::vector<double> double_tempo;
+    std::vector<double> off_beat;
+    std::vector<double> half_odd;
+    std::vector<double> half_even;
+    for (std::size_t i = 0; i < annotated.size(); i++) {
+      double_tempo.push_back(annotated[i]);
+      if (i + 1 < annotated.size()) {
+        const double mid = 0.5 * (annotated[i] + annotated[i + 1]);
+        double_tempo.push_back(mid);
+        off_beat.push_back(mid);
+      }
+      (i % 2 == 0 ? half_odd : half_even).push_back(annotated[i]);
+    }
+
+    metrics.aml_c = cml.continuous;
+    metrics.aml_t = cml.total;
+    for (const auto *variation : {&double_tempo, &off_beat, &half_odd, &half_even}) {
+      const auto score = continuity(*variation, detected, parameters);
+      metrics.aml_c = std::max(metrics.aml_c, score.continuous);
+      metrics.aml_t = std::max(metrics.aml_t, score.total);
+    }
+  }
+
+  return metrics;
+}
+
+std::vector<double> load_beat_annotations(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Couldn't read beat annotations from " + path.string());
+  }
+
+  std::vector<double> beats;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    const auto start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    double time;
+    if (!(fields >> time)) {
+      continue;
+    }
+    beats.push_back(time);
+  }
+  std::sort(beats.begin(), beats.end());
+  return beats;
+}
+
+} // namespace beatled::detector
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <atomic>
+#include <beat_tracker.hpp>
+#include <cctype>
+#include <chrono>
+#include <fmt/format.h>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <thread>
+
+#include "../audio/audio_file_loader.hpp"
+#include "../audio/decimator.hpp"
+#include "../audio/sample_convert.hpp"
+#include "../beat_tracker_factory.hpp"
+#include "../process_hop.hpp"
+#include "beat_detector/audio/config.h"
+#include "beat_detector/evaluation/corpus_evaluator.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
+
+namespace beatled::detector {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool is_audio_file(const fs::path &path) {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+  return extension == ".wav" || extension == ".aif" || extension == ".aiff";
+}
+
+std::optional<fs::path> find_annotations(const fs::path &audio, const fs::path &audio_dir,
+                                         const fs::path &annotations_dir) {
+  std::vector<fs::path> directories;
+  if (annotations_dir.empty()) {
+    directories.push_back(audio.parent_path());
+  } else {
+    directories.push_back(annotations_dir / fs::relative(audio.parent_path(), audio_dir));
+    directories.push_back(annotations_dir);
+  }
+
+  for (const auto &directory : directories) {
+    for (const char *extension : {".beats", ".txt", ".csv"}) {
+      auto candidate = directory / audio.stem();
+      candidate += extension;
+      if (fs::is_regular_file(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief One worker's tracker and hop buffers, reused across files
+ *
+ * Audio reaches the tracker as it does in the live detector: decimated by
+ * the same filter, in hops of the same duration, to a tracker built by
+ * make_beat_tracker() for that hop.
+ */
+class TrackerWorker {
+public:
+  TrackerWorker(std::size_t hop_size, unsigned decimation)
+      : decimation_{decimation}, tracker_hop_size_{hop_size / decimation}, hop_(tracker_hop_size_) {
+    scratch_.reserve(tracker_hop_size_);
+    if (decimation_ > 1) {
+      decimator_ = std::make_unique<Decimator>(decimation_);
+      block_.resize(decimator_->max_block() / decimation_ + 1);
+    }
+  }
+
+  ~TrackerWorker() {
+    // Destroying the tracker destroys its FFTW plans
+    auto lock = FftwWisdom::planner_lock();
+    tracker_.reset();
+  }
+
+  TrackerWorker(const TrackerWorker &) = delete;
+  TrackerWorker &operator=(const TrackerWorker &) = delete;
+
+  std::vector<double> track(const MonoAudio &audio) {
+    // A fresh tracker per file: BTrack keeps tempo and onset history. Its
+    // plans are made and destroyed by the FFTW planner, which the other
+    // workers are using too.
+    {
+      auto lock = FftwWisdom::planner_lock();
+      tracker_.reset();
+      tracker_ = make_beat_tracker<btrack::BTrack>(tracker_hop_size_);
+    }
+    const double sample_rate = audio.sample_rate / decimation_;
+    tracker_->set_sampling_rate(sample_rate);
+
+    const double first_sample_time = decimate(audio);
+    const std::vector<float> &samples = decimator_ ? decimated_ : audio.samples;
+
+    std::vector<double> beats;
+    double hop_start = 0;
+    tracker_->set_beat_callback(
+        [&beats, &hop_start](double tempo, double estimated_tempo) { beats.push_back(hop_start); });
+
+    // The trailing partial hop is dropped, as the live pipeline would
+    const std::size_t hops = samples.size() / tracker_hop_size_;
+    for (std::size_t i = 0; i < hops; i++) {
+      hop_start = first_sample_time + static_cast<double>(i * tracker_hop_size_) / sample_rate;
+      convert_samples(samples.data() + i * tracker_hop_size_, tracker_hop_size_, hop_.data());
+      process_hop(*tracker_, hop_, scratch_);
+    }
+    return beats;
+  }
+
+private:
+  /**
+   * @brief Runs the file through the decimator into `decimated_`
+   * @return Time of the first decimated sample in the file, in seconds: the
+   * filter's group delay back from the input it was computed from
+   */
+  double decimate(const MonoAudio &audio) {
+    if (!decimator_) {
+      return 0;
+    }
+    decimator_->reset();
+    decimated_.clear();
+    decimated_.reserve(audio.samples.size() / decimation_ + 1);
+    std::optional<double> first_index;
+    for (std::size_t offset = 0; offset < audio.samples.size();
+         offset += decimator_->max_block()) {
+      const std::size_t count = std::min(decimator_->max_block(), audio.samples.size() - offset);
+      std::size_t first_input = 0;
+      const std::size_t produced =
+          decimator_->process(audio.samples.data() + offset, count, block_.data(), first_input);
+      if (produced > 0 && !first_index) {
+        first_index = static_cast<double>(offset + first_input) - decimator_->delay();
+      }
+      decimated_.insert(decimated_.end(), block_.begin(), block_.begin() + produced);
+    }
+    return first_index.value_or(0) / audio.sample_rate;
+  }
+
+  const unsigned decimation_;
+  const std::size_t tracker_hop_size_;
+  std::unique_ptr<btrack::BTrack> tracker_;
+  std::unique_ptr<Decimator> decimator_;
+  std::vector<float> block_;
+  std::vector<float> decimated_;
+  std::vector<audio_buffer_t> hop_;
+  std::vector<double> scratch_;
+};
+
+void evaluate_file(TrackerWorker &worker, FileEvaluation &result,
+                   const BeatMetricsParameters &parameters) {
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    MonoAudio audio;
+    if (!load_mono_audio_file(result.entry.audio, audio)) {
+      result.error = "couldn't decode audio";
+      return;
+    }
+    const auto annotated = load_beat_annotations(result.entry.annotations);
+
+    result.audio_seconds = audio.duration();
+    result.detected_beats = worker.track(audio);
+    result.metrics = evaluate_beats(annotated, result.detected_beats, parameters);
+    result.ok = true;
+  } catch (const std::exception &e) {
+    result.error = e.what();
+  }
+  result.processing_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+CorpusEvaluator::CorpusEvaluator(const parameters_t &parameters) : parameters_{parameters} {
+  if (parameters_.decimation == 0 || parameters_.hop_size % parameters_.decimation != 0) {
+    throw std::invalid_argument{fmt::format("Hop size {} is not a multiple of decimation {}",
+                                            parameters_.hop_size, parameters_.decimation)};
+  }
+}
+
+std::vector<CorpusEntry> CorpusEvaluator::find_entries(const fs::path &audio_dir,
+                                                       const fs::path &annotations_dir) {
+  std::vector<CorpusEntry> entries;
+  for (const auto &item : fs::recursive_directory_iterator(audio_dir)) {
+    if (!item.is_regular_file() || !is_audio_file(item.path())) {
+      continue;
+    }
+    if (auto annotations = find_annotations(item.path(), audio_dir, annotations_dir)) {
+      entries.push_back({item.path(), *annotations});
+    } else {
+      SPDLOG_WARN("No beat annotations for {}, skipping", item.path().string());
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const CorpusEntry &a, const CorpusEntry &b) { return a.audio < b.audio; });
+  return entries;
+}
+
+CorpusEvaluation CorpusEvaluator::evaluate(const std::vector<CorpusEntry> &entries) const {
+  CorpusEvaluation evaluation;
+  evaluation.files.resize(entries.size());
+  for (std::size_t i = 0; i < entries.size(); i++) {
+    evaluation.files[i].entry = entries[i];
+  }
+
+  std::size_t threads = parameters_.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::max<std::size_t>(1, std::min(threads, entries.size()));
+  evaluation.threads = threads;
+
+  // Workers pull the next file index; results land in their own slot, so
+  // nothing else is shared
+  std::atomic_size_t next_file{0};
+  std::atomic_size_t done{0};
+  auto run_worker = [&]() {
+    TrackerWorker worker{parameters_.hop_size, parameters_.decimation};
+    for (std::size_t i = next_file++; i < entries.size(); i = next_file++) {
+      auto &result = evaluation.files[i];
+      evaluate_file(worker, result, parameters_.metrics);
+      const std::size_t completed = ++done;
+      if (result.ok) {
+        SPDLOG_DEBUG("[{}/{}] {}: F {:.3f}, {:.0f}x real time", completed, entries.size(),
+                     result.entry.audio.string(), result.metrics.f_measure,
+                     result.realtime_factor());
+      } else {
+        SPDLOG_WARN("[{}/{}] {}: {}", completed, entries.size(), result.entry.audio.string(),
+                    result.error);
+      }
+    }
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (std::size_t i = 0; i < threads; i++) {
+    pool.emplace_back(run_worker);
+  }
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  evaluation.wall_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<double> errors_ms;
+  double error_sum = 0;
+  double offset_sum = 0;
+  for (const auto &file : evaluation.files) {
+    if (!file.ok) {
+      evaluation.failed_files++;
+      continue;
+    }
+    evaluation.evaluated_files++;
+    evaluation.audio_seconds += file.audio_seconds;
+    evaluation.f_measure += file.metrics.f_measure;
+    evaluation.cml_c += file.metrics.cml_c;
+    evaluation.cml_t += file.metrics.cml_t;
+    evaluation.aml_c += file.metrics.aml_c;
+    evaluation.aml_t += file.metrics.aml_t;
+    for (double error : file.metrics.errors_ms) {
+      error_sum += error;
+      errors_ms.push_back(error);
+    }
+    offset_sum += file.metrics.mean_offset_ms * file.metrics.matched_beats;
+  }
+
+  if (evaluation.evaluated_files > 0) {
+    const double n = static_cast<double>(evaluation.evaluated_files);
+    evaluation.f_measure /= n;
+    evaluation.cml_c /= n;
+    evaluation.cml_t /= n;
+    evaluation.aml_c /= n;
+    evaluation.aml_t /= n;
+  }
+  if (!errors_ms.empty()) {
+    evaluation.mean_error_ms = error_sum / errors_ms.size();
+    evaluation.mean_offset_ms = offset_sum / errors_ms.size();
+    evaluation.p95_error_ms = percentile(std::move(errors_ms), 95);
+  }
+  return evaluation;
+}
+
+} // namespace beatled::detector
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <chrono>
+#include <fftw3.h>
+#include <filesystem>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <system_error>
+
+#include "beat_detector/fftw_wisdom.hpp"
+
+namespace beatled::detector {
+
+namespace {
+
+/**
+ * @brief The FFTW API of one precision
+ */
+template <typename Real> struct Fftw;
+
+template <> struct Fftw<double> {
+  using real = double;
+  using complex = fftw_complex;
+  using plan = fftw_plan;
+
+  static void *malloc(std::size_t bytes) { return fftw_malloc(bytes); }
+  static void free(void *p) { fftw_free(p); }
+  static plan dft_1d(int n, complex *in, complex *out, int sign, unsigned flags) {
+    return fftw_plan_dft_1d(n, in, out, sign, flags);
+  }
+  static plan dft_r2c_1d(int n, double *in, complex *out, unsigned flags) {
+    return fftw_plan_dft_r2c_1d(n, in, out, flags);
+  }
+  static void destroy_plan(plan p) { fftw_destroy_plan(p); }
+  static bool import_wisdom(const char *path) { return fftw_import_wisdom_from_filename(path); }
+  static bool export_wisdom(const char *path) { return fftw_export_wisdom_to_filename(path); }
+};
+
+#ifdef BEATLED_AUDIO_FLOAT32
+template <> struct Fftw<float> {
+  using real = float;
+  using complex = fftwf_complex;
+  using plan = fftwf_plan;
+
+  static void *malloc(std::size_t bytes) { return fftwf_malloc(bytes); }
+  static void free(void *p) { fftwf_free(p); }
+  static plan dft_1d(int n, complex *in, complex *out, int sign, unsigned flags) {
+    return fftwf_plan_dft_1d(n, in, out, sign, flags);
+  }
+  static plan dft_r2c_1d(int n, float *in, complex *out, unsigned flags) {
+    return fftwf_plan_dft_r2c_1d(n, in, out, flags);
+  }
+  static void destroy_plan(plan p) { fftwf_destroy_plan(p); }
+  static bool import_wisdom(const char *path) { return fftwf_import_wisdom_from_filename(path); }
+  static bool export_wisdom(const char *path) { return fftwf_export_wisdom_to_filename(path); }
+};
+#endif
+
+/**
+ * @brief Calls `fn` with the FFTW API of `precision`
+ */
+template <typename Fn> bool with_api(FftPrecision precision, Fn &&fn) {
+#ifdef BEATLED_AUDIO_FLOAT32
+  if (precision == FftPrecision::Single) {
+    return fn(Fftw<float>{});
+  }
+#endif
+  return fn(Fftw<double>{});
+}
+
+unsigned planner_flags(FftwPlanning planning) {
+  switch (planning) {
+  case FftwPlanning::Measure:
+    return FFTW_MEASURE;
+  case FftwPlanning::Patient:
+    return FFTW_PATIENT;
+  default:
+    return FFTW_ESTIMATE;
+  }
+}
+
+/**
+ * @brief Plans (and discards) one transform on scratch buffers allocated the
+ * way the tracker allocates them. Caller holds the planner lock.
+ * @return false if FFTW returned no plan (e.g. FFTW_WISDOM_ONLY without wisdom)
+ */
+template <typename Api> bool plan_shape(const FftShape &shape, unsigned flags) {
+  const auto n = static_cast<std::size_t>(shape.size);
+  auto *in = static_cast<typename Api::complex *>(Api::malloc(sizeof(typename Api::complex) * n));
+  auto *out = static_cast<typename Api::complex *>(Api::malloc(sizeof(typename Api::complex) * n));
+
+  typename Api::plan plan = nullptr;
+  switch (shape.kind) {
+  case FftShape::Kind::Forward:
+    plan = Api::dft_1d(shape.size, in, out, FFTW_FORWARD, flags);
+    break;
+  case FftShape::Kind::Backward:
+    plan = Api::dft_1d(shape.size, in, out, FFTW_BACKWARD, flags);
+    break;
+  case FftShape::Kind::RealToComplex:
+    plan = Api::dft_r2c_1d(shape.size, reinterpret_cast<typename Api::real *>(in), out, flags);
+    break;
+  }
+
+  const bool planned = plan != nullptr;
+  if (plan) {
+    Api::destroy_plan(plan);
+  }
+  Api::free(in);
+  Api::free(out);
+  return planned;
+}
+
+bool plan_shape(FftPrecision precision, const FftShape &shape, unsigned flags) {
+  return with_api(precision,
+                  [&](auto api) { return plan_shape<decltype(api)>(shape, flags); });
+}
+
+} // namespace
+
+FftwPlanning parse_fftw_planning(const std::string &planning) {
+  if (planning == "estimate") {
+    return FftwPlanning::Estimate;
+  } else if (planning == "measure") {
+    return FftwPlanning::Measure;
+  } else if (planning == "patient") {
+    return FftwPlanning::Patient;
+  }
+  throw std::invalid_argument{fmt::format(
+      "Invalid FFTW planning '{}' (must be estimate, measure or patient)", planning)};
+}
+
+const char *to_string(FftwPlanning planning) {
+  switch (planning) {
+  case FftwPlanning::Measure:
+    return "measure";
+  case FftwPlanning::Patient:
+    return "patient";
+  default:
+    return "estimate";
+  }
+}
+
+std::vector<FftShape> beat_tracker_fft_shapes(std::size_t frame_size, std::size_t acf_length) {
+  const int frame = static_cast<int>(frame_size);
+  const int acf = static_cast<int>(acf_length);
+  std::vector<FftShape> shapes{{frame, FftShape::Kind::Forward},
+                               {frame, FftShape::Kind::RealToComplex}};
+  if (frame != acf) {
+    shapes.push_back({acf, FftShape::Kind::Forward});
+  }
+  shapes.push_back({acf, FftShape::Kind::Backward});
+  return shapes;
+}
+
+FftwWisdom::FftwWisdom(FftwWisdomConfig config, FftPrecision precision)
+    : config_{std::move(config)}, precision_{precision} {
+#ifndef BEATLED_AUDIO_FLOAT32
+  if (precision_ == FftPrecision::Single) {
+    throw std::invalid_argument{"Single-precision FFTW wisdom needs BEATLED_AUDIO_FLOAT32"};
+  }
+#endif
+}
+
+FftwWisdom::~FftwWisdom() {
+  stop_requested_ = true;
+  wait();
+}
+
+std::unique_lock<std::mutex> FftwWisdom::planner_lock() {
+  static std::mutex planner_mutex;
+  return std::unique_lock<std::mutex>(planner_mutex);
+}
+
+bool FftwWisdom::import_wisdom() {
+  if (config_.path.empty()) {
+    return false;
+  }
+  std::error_code ec;
+  if (!std::filesystem::exists(config_.path, ec)) {
+    SPDLOG_INFO("No FFTW wisdom at {} yet", config_.path);
+    return false;
+  }
+
+  auto lock = planner_lock();
+  const bool imported = with_api(
+      precision_, [&](auto api) { return decltype(api)::import_wisdom(config_.path.c_str()); });
+  if (!imported) {
+    SPDLOG_WARN("Couldn't read FFTW wisdom from {}, ignoring it", config_.path);
+    return false;
+  }
+  SPDLOG_INFO("Imported FFTW wisdom from {}", config_.path);
+  return true;
+}
+
+bool FftwWisdom::export_wisdom() {
+  if (config_.path.empty()) {
+    return false;
+  }
+
+  // Write next to the cache and rename over it, so a crash or a concurrent
+  // server never leaves a truncated file behind
+  const std::string temporary = config_.path + ".tmp";
+  {
+    auto lock = planner_lock();
+    const bool exported = with_api(
+        precision_, [&](auto api) { return decltype(api)::export_wisdom(temporary.c_str()); });
+    if (!exported) {
+      SPDLOG_WARN("Couldn't write FFTW wisdom to {}", temporary);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(temporary, config_.path, ec);
+  if (ec) {
+    SPDLOG_WARN("Couldn't move FFTW wisdom to {}: {}", config_.path, ec.message());
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+  SPDLOG_INFO("Exported FFTW wisdom to {}", config_.path);
+  return true;
+}
+
+bool FftwWisdom::has_wisdom(const FftShape &shape, FftwPlanning planning) const {
+  auto lock = planner_lock();
+  return plan_shape(precision_, shape, planner_flags(planning) | FFTW_WISDOM_ONLY);
+}
+
+void FftwWisdom::plan_async(std::vector<FftShape> shapes) {
+  if (config_.planning == FftwPlanning::Estimate || shapes.empty()) {
+    return;
+  }
+  wait();
+  stop_requested_ = false;
+  planning_future_ = std::async(std::launch::async,
+                                [this, shapes = std::move(shapes)]() { plan(shapes); });
+}
+
+void FftwWisdom::wait() {
+  if (planning_future_.valid()) {
+    planning_future_.get();
+  }
+}
+
+void FftwWisdom::plan(const std::vector<FftShape> &shapes) {
+  const unsigned flags = planner_flags(config_.planning);
+  unsigned planned = 0;
+  for (const auto &shape : shapes) {
+    if (stop_requested_) {
+      SPDLOG_INFO("FFTW planning interrupted");
+      break;
+    }
+
+    // One transform at a time, so a detector starting meanwhile only waits
+    // for the transform being measured
+    auto lock = planner_lock();
+    if (plan_shape(precision_, shape, flags | FFTW_WISDOM_ONLY)) {
+      cached_count_++;
+      continue;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    plan_shape(precision_, shape, flags);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    planning_time_us_ +=
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    planned_count_++;
+    planned++;
+  }
+
+  SPDLOG_INFO("FFTW {} {} planning: {} transforms measured in {} ms, {} from wisdom",
+              precision_ == FftPrecision::Single ? "single" : "double",
+              to_string(config_.planning), planned_count(), planning_time_us() / 1000,
+              cached_count());
+  if (planned > 0) {
+    export_wisdom();
+  }
+}
+
+} // namespace beatled::detector
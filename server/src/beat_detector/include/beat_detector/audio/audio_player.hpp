@@ -3,14 +3,19 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "config.h"
 
 namespace beatled::detector {
 
-class AudioPlayer {
+/**
+ * @brief Plays a mono audio file decoded as `SampleT` samples
+ * Instantiated for float and double.
+ */
+template <typename SampleT> class BasicAudioPlayer {
 public:
-  AudioPlayer(const std::string &filename, std::size_t audio_buffer_size);
+  BasicAudioPlayer(const std::string &filename, std::size_t audio_buffer_size);
   void play();
 
 private:
@@ -18,10 +23,16 @@ private:
   void load_from_disk();
 
   std::string filename_;
-  std::vector<audio_buffer_t> audio_data_;
+  /**
+   * @brief Decoded samples, already in the device's float32 format
+   */
+  std::vector<float> audio_data_;
   double sample_rate_;
   std::size_t audio_buffer_size_;
 };
+
+using AudioPlayer = BasicAudioPlayer<audio_buffer_t>;
+
 } // namespace beatled::detector
 
 #endif // BEAT_TRACKER__AUDIO_PLAYER_HPP
\ No newline at end of file
@@ -4,12 +4,18 @@
 #include <filesystem>
 #include <string>
 
+#include "config.h"
+
 namespace beatled::detector {
 
-class AudioRecorder {
+/**
+ * @brief Records the default input to a WAV file of `SampleT` samples
+ * Instantiated for float and double.
+ */
+template <typename SampleT> class BasicAudioRecorder {
 public:
-  AudioRecorder(const std::string &filename, double duration, double sample_rate,
-                double frames_per_buffer, std::size_t audio_buffer_size_);
+  BasicAudioRecorder(const std::string &filename, double duration, double sample_rate,
+                     double frames_per_buffer, std::size_t audio_buffer_size_);
   std::string record();
 
 private:
@@ -20,6 +26,9 @@ private:
   double sample_rate_;
   std::size_t audio_buffer_size_;
 };
+
+using AudioRecorder = BasicAudioRecorder<audio_buffer_t>;
+
 } // namespace beatled::detector
 
 #endif // BEAT_TRACKER__AUDIO_RECORDER_HPP
\ No newline at end of file
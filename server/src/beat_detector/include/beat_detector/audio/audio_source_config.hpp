@@ -0,0 +1,80 @@
+#ifndef BEAT_DETECTOR__AUDIO_SOURCE_CONFIG_HPP
+#define BEAT_DETECTOR__AUDIO_SOURCE_CONFIG_HPP
+
+#include <string>
+
+namespace beatled::detector {
+
+/**
+ * @brief How a non-hardware audio source delivers its samples
+ */
+enum class AudioPacing {
+  /**
+   * @brief Samples are released at the nominal sample rate, as a sound card
+   * would. Beat times line up with the wall clock, so the full pipeline
+   * (including UDP broadcast) behaves as it does live.
+   */
+  RealTime,
+  /**
+   * @brief Samples are released as fast as the consumer accepts them. Buffer
+   * timestamps follow a virtual clock that starts when the source starts.
+   */
+  AsFastAsPossible,
+};
+
+/**
+ * @brief Which audio backend feeds the beat detector
+ *
+ * Parsed from a `kind[:argument]` spec:
+ * - `portaudio`: default input device (PortAudio)
+ * - `file:<path>`: WAV/AIFF file read through AudioFile
+ * - `pipe:<path>`: raw mono float32 little-endian PCM; `pipe:-` reads stdin
+ * - `generator[:<bpm>]`: synthetic click track (default 120 BPM)
+ */
+struct AudioSourceConfig {
+  enum class Kind { PortAudio, File, Pipe, Generator };
+
+  Kind kind = Kind::PortAudio;
+
+  /**
+   * @brief File or pipe path
+   */
+  std::string path;
+
+  /**
+   * @brief Click-track tempo of the generator
+   */
+  double generator_bpm = 120.0;
+
+  AudioPacing pacing = AudioPacing::RealTime;
+
+  /**
+   * @brief Restart file sources from the top when they reach the end
+   */
+  bool loop = false;
+
+  /**
+   * @brief Integer factor by which the input is low-passed and decimated
+   * before beat tracking (1 = track at the capture rate). At 44.1 kHz, 2 and
+   * 4 run the tracker at 22050 and 11025 Hz.
+   */
+  unsigned decimation = 1;
+};
+
+/**
+ * @brief Parse `--audio-source` / `--audio-pacing` values
+ * @param spec Source spec, see `AudioSourceConfig`
+ * @param pacing `realtime` or `fast`
+ * @throws std::invalid_argument on malformed values
+ */
+AudioSourceConfig parse_audio_source_config(const std::string &spec,
+                                            const std::string &pacing = "realtime");
+
+/**
+ * @brief Human readable description, for logs
+ */
+std::string to_string(const AudioSourceConfig &config);
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__AUDIO_SOURCE_CONFIG_HPP
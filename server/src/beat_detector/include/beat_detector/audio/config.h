@@ -1,9 +1,15 @@
 #ifndef SERVER__SRC__BEAT_DETECTOR__INCLUDE__BEAT_DETECTOR__AUDIO__CONFIG__H_
 #define SERVER__SRC__BEAT_DETECTOR__INCLUDE__BEAT_DETECTOR__AUDIO__CONFIG__H_
 
-// typedef float audio_buffer_t;
-
-// By default FFTW uses double so simpler...
+// Sample type of the capture -> beat tracker pipeline, selected with the
+// BEATLED_AUDIO_FLOAT32 CMake option (off by default). PortAudio delivers
+// float32, so the float build stores hops as captured; BTrack still takes
+// double hops and runs double-precision FFTW, so process_hop() converts
+// each hop for it in bulk. The double build converts once, at capture.
+#ifdef BEATLED_AUDIO_FLOAT32
+typedef float audio_buffer_t;
+#else
 typedef double audio_buffer_t;
+#endif
 
-#endif // SERVER__SRC__BEAT_DETECTOR__INCLUDE__BEAT_DETECTOR__AUDIO__CONFIG__H_
\ No newline at end of file
+#endif // SERVER__SRC__BEAT_DETECTOR__INCLUDE__BEAT_DETECTOR__AUDIO__CONFIG__H_
@@ -5,7 +5,11 @@
 #include <atomic>
 #include <experimental/propagate_const>
 
+#include "beat_detector/audio/audio_source_config.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
+#include "core/beat_schedule.hpp"
 #include "core/interfaces/service_controller.hpp"
+#include "core/latency_metrics.hpp"
 
 using beatled::core::ServiceControllerInterface;
 
@@ -13,28 +17,51 @@ namespace beatled::detector {
 
 /**
  * @brief Interface to BeatDetector
+ *
+ * Stopping and starting the service pauses and resumes a long-lived worker.
+ * The audio stream stays open for the lifetime of the detector (or until the
+ * source reaches the end of its stream), so toggling detection doesn't
+ * re-enumerate and re-open the audio device.
  */
 class BeatDetector : public ServiceControllerInterface {
 public:
   using beat_detector_cb_t = std::function<void(uint64_t, double, double, uint32_t)>;
+  using beat_schedule_cb_t = std::function<void(const core::BeatSchedule &)>;
 
+  /**
+   * @param audio_source Which backend captures the audio (PortAudio by default)
+   * @param latency_metrics If set, receives the capture, queue and tracker
+   * latency of every predicted beat, and the startup time of every session
+   * @param fftw_wisdom FFTW wisdom cache and background planning (off by
+   * default)
+   * @param beat_schedule_callback If set, receives the beat grid ahead with
+   * every predicted beat, for BEAT_SCHEDULE
+   */
   BeatDetector(const std::string &id, uint32_t sample_rate, std::size_t audio_buffer_size,
                beat_detector_cb_t beat_callback = nullptr,
-               beat_detector_cb_t next_beat_callback = nullptr);
+               beat_detector_cb_t next_beat_callback = nullptr,
+               const AudioSourceConfig &audio_source = {},
+               core::LatencyMetrics *latency_metrics = nullptr,
+               const FftwWisdomConfig &fftw_wisdom = {},
+               beat_schedule_cb_t beat_schedule_callback = nullptr);
   ~BeatDetector();
 
   /**
-   * @brief Start beat detector service
+   * @brief Start beat detector service, or resume it
+   * The first start spawns the worker thread, which opens the audio stream
+   * and builds the tracker. Later starts only resume processing.
    */
   void start_sync() override;
 
   /**
-   * @brief Stop beat detector algorithm, async
+   * @brief Pause the beat detector
+   * Returns once the worker has parked. The audio stream, the tracker state
+   * and the worker thread are kept for the next start.
    */
   void stop_sync() override;
 
   /**
-   * @brief Stop beat detector algorithm, sync
+   * @brief Pause the beat detector, sync
    */
   void stop_blocking();
 
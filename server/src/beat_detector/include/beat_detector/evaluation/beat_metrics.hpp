@@ -0,0 +1,98 @@
+#ifndef BEAT_DETECTOR__BEAT_METRICS_HPP
+#define BEAT_DETECTOR__BEAT_METRICS_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace beatled::detector {
+
+/**
+ * @brief Tolerances used when scoring detected beats against annotations
+ *
+ * Defaults follow the usual MIREX beat tracking conventions.
+ */
+struct BeatMetricsParameters {
+  /**
+   * @brief Half-width of the F-measure window, in seconds
+   */
+  double f_measure_window = 0.07;
+  /**
+   * @brief Beats before this time (seconds) are ignored on both sides, so the
+   * tracker's warm-up doesn't dominate short excerpts
+   */
+  double skip_seconds = 5.0;
+  /**
+   * @brief Continuity phase tolerance, as a fraction of the annotated inter-beat interval
+   */
+  double continuity_phase_tolerance = 0.175;
+  /**
+   * @brief Continuity tempo tolerance, relative to the annotated inter-beat interval
+   */
+  double continuity_period_tolerance = 0.175;
+};
+
+/**
+ * @brief Scores of one detected beat sequence against its annotation
+ *
+ * `cml_*` are the correct-metrical-level continuity scores, `aml_*` also
+ * accept double/half tempo and off-beat tracking. `*_c` is the longest
+ * continuously correct segment, `*_t` the total of correct beats, both as a
+ * fraction of max(annotated, detected) beats.
+ */
+struct BeatMetrics {
+  std::size_t annotated_beats = 0;
+  std::size_t detected_beats = 0;
+  std::size_t matched_beats = 0;
+
+  double precision = 0;
+  double recall = 0;
+  double f_measure = 0;
+
+  double cml_c = 0;
+  double cml_t = 0;
+  double aml_c = 0;
+  double aml_t = 0;
+
+  /**
+   * @brief Absolute error of the matched beats, in milliseconds
+   */
+  double mean_error_ms = 0;
+  double p95_error_ms = 0;
+  /**
+   * @brief Signed mean error of the matched beats (detected - annotated), in
+   * milliseconds. A systematic offset shows up here.
+   */
+  double mean_offset_ms = 0;
+
+  /**
+   * @brief Absolute errors of the matched beats (ms), kept so callers can pool them
+   */
+  std::vector<double> errors_ms;
+};
+
+/**
+ * @brief Scores detected beat times against annotated ones (both in seconds, ascending)
+ */
+BeatMetrics evaluate_beats(const std::vector<double> &annotated,
+                           const std::vector<double> &detected,
+                           const BeatMetricsParameters &parameters = {});
+
+/**
+ * @brief Loads a beat annotation file
+ *
+ * One beat per line; the first number on the line is the beat time in
+ * seconds. Any further columns (e.g. the bar position in `.beats` files) are
+ * ignored, as are empty lines and lines starting with `#`. Throws
+ * std::runtime_error if the file can't be read.
+ */
+std::vector<double> load_beat_annotations(const std::filesystem::path &path);
+
+/**
+ * @brief Nearest-rank percentile of `values` (unsorted), 0 if empty
+ */
+double percentile(std::vector<double> values, double p);
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__BEAT_METRICS_HPP
@@ -0,0 +1,132 @@
+#ifndef BEAT_DETECTOR__CORPUS_EVALUATOR_HPP
+#define BEAT_DETECTOR__CORPUS_EVALUATOR_HPP
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "beat_detector/evaluation/beat_metrics.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief An audio file and the file holding its beat annotations
+ */
+struct CorpusEntry {
+  std::filesystem::path audio;
+  std::filesystem::path annotations;
+};
+
+/**
+ * @brief Result of tracking one corpus file
+ */
+struct FileEvaluation {
+  CorpusEntry entry;
+  bool ok = false;
+  std::string error;
+
+  double audio_seconds = 0;
+  /**
+   * @brief Time the worker spent decoding and tracking the file
+   */
+  double processing_seconds = 0;
+  std::vector<double> detected_beats;
+  BeatMetrics metrics;
+
+  /**
+   * @brief Audio seconds tracked per second of one core
+   */
+  double realtime_factor() const {
+    return processing_seconds > 0 ? audio_seconds / processing_seconds : 0;
+  }
+};
+
+/**
+ * @brief Corpus-wide results
+ *
+ * Scores are averaged over the files that were tracked successfully; beat
+ * errors are pooled over all matched beats.
+ */
+struct CorpusEvaluation {
+  std::vector<FileEvaluation> files;
+
+  std::size_t evaluated_files = 0;
+  std::size_t failed_files = 0;
+  std::size_t threads = 0;
+
+  double f_measure = 0;
+  double cml_c = 0;
+  double cml_t = 0;
+  double aml_c = 0;
+  double aml_t = 0;
+  double mean_error_ms = 0;
+  double p95_error_ms = 0;
+  double mean_offset_ms = 0;
+
+  double audio_seconds = 0;
+  double wall_seconds = 0;
+
+  /**
+   * @brief Audio seconds processed per wall-clock second per worker thread
+   */
+  double throughput_per_core() const {
+    return wall_seconds > 0 && threads > 0 ? audio_seconds / (wall_seconds * threads) : 0;
+  }
+};
+
+/**
+ * @brief Runs BTrack over an annotated corpus, faster than real time
+ *
+ * Files are fanned out over a pool of worker threads. Each worker owns its
+ * tracker and scratch buffers, and resets the tracker between files. Beats
+ * are stamped with the start time of the hop during which BTrack reports
+ * them, exactly as the live detector does, so the scores (and the mean
+ * offset in particular) reflect what the server would broadcast.
+ */
+class CorpusEvaluator {
+public:
+  struct parameters_t {
+    /**
+     * @brief Worker threads, 0 for one per hardware thread
+     */
+    std::size_t threads = 0;
+    /**
+     * @brief Audio frames per tracker hop before decimation, as the live
+     * detector's `--audio-hop-size`
+     */
+    std::size_t hop_size = 512;
+    /**
+     * @brief Decimation ahead of the tracker, as `--audio-decimation`
+     */
+    unsigned decimation = 1;
+    BeatMetricsParameters metrics;
+  };
+
+  /**
+   * @throws std::invalid_argument if `hop_size` isn't a multiple of `decimation`
+   */
+  explicit CorpusEvaluator(const parameters_t &parameters);
+
+  /**
+   * @brief Finds the annotated audio files in a directory (recursively)
+   *
+   * For `song.wav` (or `.aif`/`.aiff`), the annotation is the first of
+   * `song.beats`, `song.txt` or `song.csv` found in `annotations_dir`, or next
+   * to the audio file if no annotation directory is given. Audio files
+   * without annotations are skipped. Entries are sorted by path.
+   */
+  static std::vector<CorpusEntry> find_entries(const std::filesystem::path &audio_dir,
+                                               const std::filesystem::path &annotations_dir = {});
+
+  /**
+   * @brief Tracks and scores every entry; a file that fails doesn't stop the run
+   */
+  CorpusEvaluation evaluate(const std::vector<CorpusEntry> &entries) const;
+
+private:
+  parameters_t parameters_;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__CORPUS_EVALUATOR_HPP
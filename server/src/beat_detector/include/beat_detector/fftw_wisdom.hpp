@@ -0,0 +1,175 @@
+#ifndef BEAT_DETECTOR__FFTW_WISDOM_HPP
+#define BEAT_DETECTOR__FFTW_WISDOM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace beatled::detector {
+
+/**
+ * @brief How hard FFTW searches for the fastest kernels of a transform
+ */
+enum class FftwPlanning {
+  /**
+   * @brief Heuristic plans only; no background planning
+   */
+  Estimate,
+  /**
+   * @brief Times a few candidate kernels (FFTW_MEASURE)
+   */
+  Measure,
+  /**
+   * @brief Times many more candidates (FFTW_PATIENT), slower to plan
+   */
+  Patient,
+};
+
+/**
+ * @brief FFTW precision: `fftw_*` (double) or `fftwf_*` (float). Each keeps
+ * its own wisdom, so the cache must be planned in the tracker's precision.
+ */
+enum class FftPrecision { Double, Single };
+
+template <typename Real>
+constexpr FftPrecision fft_precision_of =
+    std::is_same_v<Real, float> ? FftPrecision::Single : FftPrecision::Double;
+
+/**
+ * @brief FFTW wisdom cache of the beat detector
+ */
+struct FftwWisdomConfig {
+  /**
+   * @brief Wisdom file, imported at startup and rewritten after planning.
+   * Empty disables the cache.
+   */
+  std::string path;
+
+  FftwPlanning planning = FftwPlanning::Estimate;
+};
+
+/**
+ * @brief Parse a `--fftw-planning` value
+ * @param planning `estimate`, `measure` or `patient`
+ * @throws std::invalid_argument on other values
+ */
+FftwPlanning parse_fftw_planning(const std::string &planning);
+
+const char *to_string(FftwPlanning planning);
+
+/**
+ * @brief A transform the beat tracker plans
+ */
+struct FftShape {
+  enum class Kind { Forward, Backward, RealToComplex };
+
+  int size;
+  Kind kind;
+};
+
+/**
+ * @brief Transforms BTrack plans: a complex (and real) DFT of its analysis
+ * frame for the onset detection function, and the forward and backward
+ * transforms of its autocorrelation
+ */
+std::vector<FftShape> beat_tracker_fft_shapes(std::size_t frame_size, std::size_t acf_length);
+
+/**
+ * @brief Persistent FFTW wisdom, planned in the background
+ *
+ * Plans created with FFTW_ESTIMATE (as BTrack creates them) pick up wisdom
+ * recorded by a more rigorous planner. So importing wisdom before the tracker
+ * is built gives it measured kernels without paying the measurement again:
+ * only the very first run on a machine plans, in a background thread, and
+ * exports the result for the next start.
+ *
+ * Uses the FFTW precision the tracker plans in, which is not necessarily the
+ * audio pipeline's: BTrack converts float hops and runs double FFTW.
+ *
+ * The FFTW planner is not thread-safe. Everything that creates or destroys
+ * plans (including building a tracker) must hold `planner_lock()`.
+ */
+class FftwWisdom {
+public:
+  /**
+   * @throws std::invalid_argument for single precision in a build without fftwf
+   */
+  explicit FftwWisdom(FftwWisdomConfig config, FftPrecision precision = FftPrecision::Double);
+
+  /**
+   * @brief Stops background planning after the current transform
+   */
+  ~FftwWisdom();
+
+  FftwWisdom(const FftwWisdom &) = delete;
+  FftwWisdom &operator=(const FftwWisdom &) = delete;
+
+  /**
+   * @brief Serializes access to the FFTW planner, process-wide
+   */
+  static std::unique_lock<std::mutex> planner_lock();
+
+  /**
+   * @brief Loads the cache file into FFTW
+   * @return false if there is no cache or it couldn't be read (not an error:
+   * the first run on a machine has none)
+   */
+  bool import_wisdom();
+
+  /**
+   * @brief Writes FFTW's accumulated wisdom to the cache file, atomically
+   * @return false if there is no cache or it couldn't be written
+   */
+  bool export_wisdom();
+
+  /**
+   * @brief Whether `shape` can be planned from wisdom at `planning` rigour
+   */
+  bool has_wisdom(const FftShape &shape, FftwPlanning planning) const;
+
+  /**
+   * @brief Plans `shapes` at the configured rigour in a background thread,
+   * then exports the wisdom if anything new was learned. Shapes already
+   * covered by wisdom cost nothing.
+   */
+  void plan_async(std::vector<FftShape> shapes);
+
+  /**
+   * @brief Waits for background planning to finish
+   */
+  void wait();
+
+  const FftwWisdomConfig &config() const { return config_; }
+  FftPrecision precision() const { return precision_; }
+
+  /**
+   * @brief Shapes that had to be measured / were already in the wisdom
+   */
+  unsigned planned_count() const { return planned_count_.load(std::memory_order_relaxed); }
+  unsigned cached_count() const { return cached_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Time spent measuring, in microseconds
+   */
+  uint64_t planning_time_us() const { return planning_time_us_.load(std::memory_order_relaxed); }
+
+private:
+  void plan(const std::vector<FftShape> &shapes);
+
+  FftwWisdomConfig config_;
+  FftPrecision precision_;
+  std::future<void> planning_future_;
+  std::atomic_bool stop_requested_ = false;
+  std::atomic<unsigned> planned_count_ = 0;
+  std::atomic<unsigned> cached_count_ = 0;
+  std::atomic<uint64_t> planning_time_us_ = 0;
+};
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__FFTW_WISDOM_HPP
@@ -0,0 +1,60 @@
+#ifndef BEAT_DETECTOR__PROCESS_HOP_HPP
+#define BEAT_DETECTOR__PROCESS_HOP_HPP
+
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "audio/sample_convert.hpp"
+
+namespace beatled::detector {
+
+/**
+ * @brief Whether the tracker reads hops of `SampleT` in place
+ */
+template <typename Tracker, typename SampleT>
+concept TakesHopSpan = requires(Tracker &tracker, std::span<const SampleT> hop) {
+  tracker.process_audio_frame(hop);
+};
+
+/**
+ * @brief Sample type the tracker's frames, and so its FFTs, are in: the
+ * pipeline's own for trackers that take a span of it, else the double that
+ * process_hop() converts to
+ */
+template <typename Tracker, typename SampleT>
+using tracker_sample_t = std::conditional_t<TakesHopSpan<Tracker, SampleT>, SampleT, double>;
+
+/**
+ * @brief Feeds one hop to the tracker
+ * Trackers that take a span of the pipeline's sample type read the hop in
+ * place, straight out of the audio ring. Otherwise (e.g. BTrack's
+ * `std::vector<double>` frames) it is copied or converted in bulk into
+ * `scratch`, which is preallocated to a hop.
+ */
+template <typename Tracker, typename SampleT>
+void process_hop(Tracker &tracker, std::span<const SampleT> hop, std::vector<double> &scratch) {
+  if constexpr (TakesHopSpan<Tracker, SampleT>) {
+    tracker.process_audio_frame(hop);
+  } else {
+    scratch.resize(hop.size());
+    convert_samples(hop.data(), hop.size(), scratch.data());
+    tracker.process_audio_frame(scratch);
+  }
+}
+
+/**
+ * @brief Feeds a hop held in a vector (offline evaluation)
+ */
+template <typename Tracker, typename SampleT>
+void process_hop(Tracker &tracker, const std::vector<SampleT> &hop, std::vector<double> &scratch) {
+  if constexpr (requires { tracker.process_audio_frame(hop); }) {
+    tracker.process_audio_frame(hop);
+  } else {
+    process_hop(tracker, std::span<const SampleT>(hop), scratch);
+  }
+}
+
+} // namespace beatled::detector
+
+#endif // BEAT_DETECTOR__PROCESS_HOP_HPP
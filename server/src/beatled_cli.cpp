@@ -3,6 +3,7 @@
 #include <iostream>
 #include <lyra/lyra.hpp>
 
+#include "commands/evaluate.hpp"
 #include "commands/play.hpp"
 #include "commands/record.hpp"
 #include "commands/track.hpp"
@@ -17,6 +18,7 @@ int main(int argc, const char **argv) {
   play_audio_command play{cli};
   track_beat_command track{cli};
   track_next_beat_command track_next_beat{cli};
+  evaluate_corpus_command evaluate{cli};
 
   try {
     auto result = cli.parse({argc, argv});
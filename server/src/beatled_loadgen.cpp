@@ -0,0 +1,122 @@
+// Headless controller swarm: loads a live server with thousands of virtual
+// controllers and reports what they measured. See docs/loadgen.markdown.
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <iostream>
+#include <lyra/lyra.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "loadgen/swarm.hpp"
+
+using beatled::core::LatencyHistogram;
+using beatled::loadgen::Swarm;
+
+namespace {
+
+void print_latency(const char *name, const LatencyHistogram::Snapshot &snapshot) {
+  fmt::print("  {:<18} n={:<9} p50={:>7} p90={:>7} p99={:>7} p99.9={:>7} max={:>7} us\n", name,
+             snapshot.count, snapshot.p50_us, snapshot.p90_us, snapshot.p99_us, snapshot.p999_us,
+             snapshot.max_us);
+}
+
+void print_report(const Swarm::Report &report) {
+  fmt::print("{}/{} controllers registered in {:.1f} s ({} HELLOs)\n", report.registered,
+             report.controllers, report.duration_us / 1e6, report.hello_sent);
+  fmt::print("TIME   {} sent, {} answered, {:.2f}% lost\n", report.time_sent,
+             report.time_answered, 100 * report.time_loss());
+  print_latency("round trip", report.time_rtt);
+  print_latency("server", report.server_time);
+  fmt::print("TEMPO  {} sent, {} answered, {:.2f}% lost\n", report.tempo_sent,
+             report.tempo_answered, 100 * report.tempo_loss());
+  print_latency("round trip", report.tempo_rtt);
+  fmt::print("NEXT_BEAT  {} received, {} missed ({:.2f}%), {} late\n", report.next_beats,
+             report.next_beat_gaps, 100 * report.next_beat_loss(), report.late_next_beats);
+  print_latency("spread", report.next_beat_spread);
+  print_latency("lead", report.next_beat_lead);
+  if (report.beat_schedules + report.beat_schedule_gaps > 0) {
+    fmt::print("BEAT_SCHEDULE  {} received, {} missed ({:.2f}%), {} late\n",
+               report.beat_schedules, report.beat_schedule_gaps,
+               100 * report.beat_schedule_loss(), report.late_beat_schedules);
+    print_latency("spread", report.beat_schedule_spread);
+    print_latency("lead", report.beat_schedule_lead);
+  }
+  fmt::print("PROGRAM {}, STATUS probes {}, errors {}, send failures {}, injected drops {}\n",
+             report.programs, report.status_probes, report.errors, report.send_failures,
+             report.injected_drops);
+}
+
+} // namespace
+
+int main(int argc, const char **argv) {
+  Swarm::parameters_t parameters;
+  bool show_help = false;
+  bool json = false;
+  std::string log_level = "info";
+  double duration_s = parameters.duration_us / 1e6;
+  uint64_t ramp_ms = parameters.ramp_us / 1000;
+
+  auto cli =
+      lyra::help(show_help) |
+      lyra::opt(parameters.server_address, "address")["-s"]["--server"](
+          fmt::format("server address (default: {})", parameters.server_address)) |
+      lyra::opt(parameters.server_port, "port")["-u"]["--udp-port"](
+          fmt::format("server UDP port (default: {})", parameters.server_port)) |
+      lyra::opt(parameters.source_address, "address")["--source"](fmt::format(
+          "address of the first controller; the next ones count up from it (default: {})",
+          parameters.source_address)) |
+      lyra::opt(parameters.controllers, "count")["-n"]["--controllers"](
+          fmt::format("virtual controllers (default: {})", parameters.controllers)) |
+      lyra::opt(parameters.threads, "count")["-t"]["--threads"](
+          fmt::format("worker threads (default: {})", parameters.threads)) |
+      lyra::opt(parameters.time_rate_hz, "hz")["--time-rate"](fmt::format(
+          "TIME requests per controller per second; 0 disables (default: {})",
+          parameters.time_rate_hz)) |
+      lyra::opt(parameters.tempo_rate_hz, "hz")["--tempo-rate"](fmt::format(
+          "TEMPO requests per controller per second; 0 disables (default: {})",
+          parameters.tempo_rate_hz)) |
+      lyra::opt(parameters.loss, "probability")["--loss"](
+          fmt::format("drop each datagram, either way, with this probability (default: {})",
+                      parameters.loss)) |
+      lyra::opt(parameters.jitter_us, "us")["--jitter-us"](fmt::format(
+          "delay each datagram by up to this long (default: {})", parameters.jitter_us)) |
+      lyra::opt(duration_s, "seconds")["-d"]["--duration"](
+          fmt::format("how long to send requests for (default: {})", duration_s)) |
+      lyra::opt(ramp_ms, "ms")["--ramp-ms"](
+          fmt::format("spread the first HELLOs over this long (default: {})", ramp_ms)) |
+      lyra::opt(parameters.beat_port, "port")["-b"]["--beat-port"](
+          "also listen for broadcast/multicast beats on this port (default: off)") |
+      lyra::opt(parameters.multicast_group, "group")["--multicast-group"](
+          "IPv4 group the beat listener joins (default: none)") |
+      lyra::opt(json)["--json"]("print the report as JSON") |
+      lyra::opt(log_level, "trace|debug|info|warn|err|critical|off")["--log-level"](
+          fmt::format("spdlog level (default: {})", log_level));
+
+  try {
+    auto result = cli.parse({argc, argv});
+    if (!result) {
+      std::cerr << result.message() << std::endl;
+      return 1;
+    }
+    if (show_help) {
+      std::cout << cli << std::endl;
+      return 0;
+    }
+    spdlog::set_level(spdlog::level::from_str(log_level));
+    parameters.duration_us = static_cast<uint64_t>(duration_s * 1e6);
+    parameters.ramp_us = ramp_ms * 1000;
+
+    const Swarm::Report report = Swarm{parameters}.run();
+    if (json) {
+      std::cout << nlohmann::json(report).dump(2) << std::endl;
+    } else {
+      print_report(report);
+    }
+    return report.registered == report.controllers ? 0 : 2;
+
+  } catch (const std::exception &exception) {
+    SPDLOG_ERROR("{}", exception.what());
+  }
+  return 1;
+}
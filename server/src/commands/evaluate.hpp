@@ -0,0 +1,182 @@
+#include <filesystem>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <fstream>
+#include <iostream>
+#include <lyra/lyra.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#include "beat_detector/evaluation/corpus_evaluator.hpp"
+
+/*******************************************************************/
+struct evaluate_corpus_command {
+  bool verbose = false;
+  bool show_help = false;
+  std::string corpus_dir;
+  std::string annotations_dir;
+  std::string json_file;
+  std::size_t threads = 0;
+  std::size_t hop_size = 512;
+  unsigned decimation = 1;
+  double skip_seconds = 5.0;
+  double window_ms = 70.0;
+
+  evaluate_corpus_command(lyra::cli &cli) {
+    cli.add_argument(
+
+        lyra::command("evaluate", [this](const lyra::group &g) { this->do_command(g); })
+            .help("Track an annotated corpus offline and score the beats.")
+            .add_argument(lyra::help(show_help))
+            .add_argument(lyra::arg(corpus_dir, "corpus_dir")
+                              .required()
+                              .help("Directory of WAV/AIFF files, each with a <name>.beats, "
+                                    "<name>.txt or <name>.csv annotation (beat times in seconds)"))
+            .add_argument(lyra::opt(annotations_dir, "annotations_dir")
+                              .name("-a")
+                              .name("--annotations")
+                              .help("Look for annotations here instead of next to the audio"))
+            .add_argument(lyra::opt(threads, "threads")
+                              .name("-j")
+                              .name("--threads")
+                              .help("Worker threads (default: one per hardware thread)"))
+            .add_argument(lyra::opt(hop_size, "frames")
+                              .name("--hop-size")
+                              .help(fmt::format("Audio frames per tracker hop, as the server's "
+                                                "--audio-hop-size (default: {})",
+                                                hop_size)))
+            .add_argument(lyra::opt(decimation, "factor")
+                              .name("--decimation")
+                              .help("Decimate the audio before tracking, as the server's "
+                                    "--audio-decimation (default: 1)"))
+            .add_argument(lyra::opt(skip_seconds, "seconds")
+                              .name("--skip")
+                              .help(fmt::format("Ignore beats before this time (default: {})",
+                                                skip_seconds)))
+            .add_argument(lyra::opt(window_ms, "ms")
+                              .name("--window")
+                              .help(fmt::format("F-measure tolerance window (default: ±{} ms)",
+                                                window_ms)))
+            .add_argument(lyra::opt(json_file, "json_file")
+                              .name("--json")
+                              .help("Also write per-file and aggregate results as JSON"))
+            .add_argument(lyra::opt(verbose)
+                              .name("-v")
+                              .name("--verbose")
+                              .optional()
+                              .help("Show additional output as to what we are doing.")));
+  }
+
+  void do_command(const lyra::group &g) {
+    if (show_help) {
+      SPDLOG_INFO(fmt::streamed(g));
+      return;
+    }
+
+    using namespace beatled::detector;
+    if (verbose) {
+      spdlog::set_level(spdlog::level::debug);
+    }
+
+    const auto entries = CorpusEvaluator::find_entries(corpus_dir, annotations_dir);
+    if (entries.empty()) {
+      SPDLOG_ERROR("No annotated audio files found in {}", corpus_dir);
+      return;
+    }
+    SPDLOG_INFO("Evaluating {} files", entries.size());
+
+    CorpusEvaluator::parameters_t parameters{
+        .threads = threads, .hop_size = hop_size, .decimation = decimation};
+    parameters.metrics.skip_seconds = skip_seconds;
+    parameters.metrics.f_measure_window = window_ms / 1000.0;
+
+    try {
+      const CorpusEvaluator evaluator{parameters};
+      const auto evaluation = evaluator.evaluate(entries);
+      print_report(evaluation);
+      if (!json_file.empty()) {
+        std::ofstream out(json_file);
+        out << to_json(evaluation).dump(2) << std::endl;
+        SPDLOG_INFO("Wrote {}", json_file);
+      }
+    } catch (const std::invalid_argument &e) {
+      SPDLOG_ERROR("Invalid --hop-size/--decimation: {}", e.what());
+    }
+  }
+
+  static void print_report(const beatled::detector::CorpusEvaluation &evaluation) {
+    fmt::print("{:<40} {:>6} {:>6} {:>6} {:>6} {:>6} {:>8} {:>8} {:>8} {:>7}\n", "file", "F",
+               "CMLc", "CMLt", "AMLc", "AMLt", "err ms", "p95 ms", "off ms", "x rt");
+    for (const auto &file : evaluation.files) {
+      const auto name = file.entry.audio.filename().string();
+      if (!file.ok) {
+        fmt::print("{:<40} failed: {}\n", name, file.error);
+        continue;
+      }
+      const auto &m = file.metrics;
+      fmt::print("{:<40} {:>6.3f} {:>6.3f} {:>6.3f} {:>6.3f} {:>6.3f} {:>8.1f} {:>8.1f} {:>8.1f} "
+                 "{:>7.0f}\n",
+                 name, m.f_measure, m.cml_c, m.cml_t, m.aml_c, m.aml_t, m.mean_error_ms,
+                 m.p95_error_ms, m.mean_offset_ms, file.realtime_factor());
+    }
+    fmt::print("{:<40} {:>6.3f} {:>6.3f} {:>6.3f} {:>6.3f} {:>6.3f} {:>8.1f} {:>8.1f} {:>8.1f}\n",
+               "mean", evaluation.f_measure, evaluation.cml_c, evaluation.cml_t, evaluation.aml_c,
+               evaluation.aml_t, evaluation.mean_error_ms, evaluation.p95_error_ms,
+               evaluation.mean_offset_ms);
+    fmt::print("\n{} files ({} failed), {:.1f} s of audio in {:.2f} s on {} threads: "
+               "{:.1f} audio-s per wall-s per core\n",
+               evaluation.evaluated_files, evaluation.failed_files, evaluation.audio_seconds,
+               evaluation.wall_seconds, evaluation.threads, evaluation.throughput_per_core());
+  }
+
+  static nlohmann::json to_json(const beatled::detector::CorpusEvaluation &evaluation) {
+    auto metrics_json = [](const beatled::detector::BeatMetrics &m) {
+      return nlohmann::json{{"f_measure", m.f_measure},
+                            {"precision", m.precision},
+                            {"recall", m.recall},
+                            {"cml_c", m.cml_c},
+                            {"cml_t", m.cml_t},
+                            {"aml_c", m.aml_c},
+                            {"aml_t", m.aml_t},
+                            {"mean_error_ms", m.mean_error_ms},
+                            {"p95_error_ms", m.p95_error_ms},
+                            {"mean_offset_ms", m.mean_offset_ms},
+                            {"annotated_beats", m.annotated_beats},
+                            {"detected_beats", m.detected_beats},
+                            {"matched_beats", m.matched_beats}};
+    };
+
+    nlohmann::json files = nlohmann::json::array();
+    for (const auto &file : evaluation.files) {
+      nlohmann::json entry{{"audio", file.entry.audio.string()},
+                           {"annotations", file.entry.annotations.string()},
+                           {"ok", file.ok}};
+      if (file.ok) {
+        entry["audio_seconds"] = file.audio_seconds;
+        entry["processing_seconds"] = file.processing_seconds;
+        entry["metrics"] = metrics_json(file.metrics);
+      } else {
+        entry["error"] = file.error;
+      }
+      files.push_back(std::move(entry));
+    }
+
+    return {{"files", std::move(files)},
+            {"aggregate",
+             {{"evaluated_files", evaluation.evaluated_files},
+              {"failed_files", evaluation.failed_files},
+              {"f_measure", evaluation.f_measure},
+              {"cml_c", evaluation.cml_c},
+              {"cml_t", evaluation.cml_t},
+              {"aml_c", evaluation.aml_c},
+              {"aml_t", evaluation.aml_t},
+              {"mean_error_ms", evaluation.mean_error_ms},
+              {"p95_error_ms", evaluation.p95_error_ms},
+              {"mean_offset_ms", evaluation.mean_offset_ms},
+              {"audio_seconds", evaluation.audio_seconds},
+              {"wall_seconds", evaluation.wall_seconds},
+              {"threads", evaluation.threads},
+              {"throughput_per_core", evaluation.throughput_per_core()}}}};
+  }
+};
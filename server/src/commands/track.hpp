@@ -15,6 +15,9 @@ struct track_beat_command {
   bool verbose = false;
   bool show_help = false;
   double duration = 10;
+  std::string audio_source = "portaudio";
+  std::string audio_pacing = "realtime";
+  unsigned decimation = 1;
 
   track_beat_command(lyra::cli &cli) {
     cli.add_argument(
@@ -26,6 +29,20 @@ struct track_beat_command {
                               .name("-d")
                               .name("--duration")
                               .help(fmt::format("Which duration? (default: {})", duration)))
+            .add_argument(
+                lyra::opt(audio_source, "portaudio|file:<path>|pipe:<path>|generator[:<bpm>]")
+                    .name("--audio-source")
+                    .help(fmt::format("Audio input (default: {})", audio_source)))
+            .add_argument(lyra::opt(audio_pacing, "realtime|fast")
+                              .name("--audio-pacing")
+                              .help(fmt::format("Pacing of non-hardware audio sources "
+                                                "(default: {})",
+                                                audio_pacing)))
+            .add_argument(lyra::opt(decimation, "1|2|4")
+                              .name("--decimation")
+                              .help(fmt::format("Decimate the audio by this factor before "
+                                                "tracking (default: {})",
+                                                decimation)))
             .add_argument(lyra::opt(verbose)
                               .name("-v")
                               .name("--verbose")
@@ -42,12 +59,16 @@ struct track_beat_command {
       constexpr int sample_rate = 41000;
       StateManager state_manager;
 
+      AudioSourceConfig audio_config = parse_audio_source_config(audio_source, audio_pacing);
+      audio_config.decimation = decimation;
+
       BeatDetector bd{
           "beat-detector", sample_rate, beatled::constants::audio_buffer_size,
           [&](uint64_t delay, double tempo, double estimated_tempo, uint32_t beat_count) {
             SPDLOG_INFO("Beat ... tempo {} ... estimated {} ... beat count {}", tempo,
                         estimated_tempo, beat_count);
-          }};
+          },
+          nullptr, audio_config};
 
       bd.start();
       SPDLOG_INFO("Started Beat Detector");
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <cmath>
+
+#include "core/beat_schedule.hpp"
+
+namespace beatled::core {
+
+BeatSchedule BeatScheduleTracker::update(uint64_t next_beat_time_ref, double bpm,
+                                         uint32_t beat_count) {
+  BeatSchedule schedule{next_beat_time_ref, beat_count};
+  if (!(bpm > 0)) {
+    reset();
+    return schedule;
+  }
+
+  const double period_us = 60.0 * 1000000.0 / bpm;
+  const uint32_t beats = beat_count - last_count_;
+  if (have_last_ && beats > 0 && beats <= kMaxGapBeats) {
+    const double slope_ns = (period_us - last_period_us_) * 1000.0 / beats;
+    slope_ns_ += kSmoothing * (slope_ns - slope_ns_);
+  } else {
+    slope_ns_ = 0;
+  }
+  have_last_ = true;
+  last_count_ = beat_count;
+  last_period_us_ = period_us;
+
+  const double max_slope_ns = period_us * 1000.0 * kMaxSlope;
+  schedule.tempo_period_us = static_cast<uint32_t>(std::lround(period_us));
+  schedule.period_slope_ns =
+      static_cast<int32_t>(std::lround(std::clamp(slope_ns_, -max_slope_ns, max_slope_ns)));
+  schedule.beat_span = beat_span_;
+  return schedule;
+}
+
+void BeatScheduleTracker::reset() {
+  have_last_ = false;
+  last_count_ = 0;
+  last_period_us_ = 0;
+  slope_ns_ = 0;
+}
+
+} // namespace beatled::core
@@ -0,0 +1,48 @@
+#include "core/client_registry.hpp"
+
+namespace beatled::core {
+
+ClientRegistry::ClientRegistry(ClientStatus::client_map_t clients) : clients_{std::move(clients)} {
+  by_ip_.reserve(clients_.size());
+  by_endpoint_.reserve(clients_.size());
+  by_board_id_.reserve(clients_.size());
+  for (const auto &cs : clients_) {
+    by_ip_.emplace(cs->ip_address, cs);
+    by_board_id_.emplace(cs->board_id, cs);
+    // Entries registered without a source endpoint are only reached by address
+    const auto endpoint = cs->endpoint();
+    if (endpoint.port() != 0) {
+      by_endpoint_.emplace(endpoint, cs);
+    }
+  }
+}
+
+std::size_t ClientRegistry::AddressHash::operator()(const asio::ip::address &address) const {
+  if (address.is_v4()) {
+    return std::hash<uint32_t>{}(address.to_v4().to_uint());
+  }
+  const auto bytes = address.to_v6().to_bytes();
+  return std::hash<std::string_view>{}(
+      std::string_view{reinterpret_cast<const char *>(bytes.data()), bytes.size()});
+}
+
+std::size_t ClientRegistry::EndpointHash::operator()(const asio::ip::udp::endpoint &endpoint) const {
+  return AddressHash{}(endpoint.address()) * 31 + endpoint.port();
+}
+
+ClientStatus::Ptr ClientRegistry::find(const asio::ip::address &ip_address) const {
+  auto it = by_ip_.find(ip_address);
+  return it == by_ip_.end() ? nullptr : it->second;
+}
+
+ClientStatus::Ptr ClientRegistry::find(const asio::ip::udp::endpoint &endpoint) const {
+  auto it = by_endpoint_.find(endpoint);
+  return it == by_endpoint_.end() ? nullptr : it->second;
+}
+
+ClientStatus::Ptr ClientRegistry::find(const ClientStatus::board_id_t &board_id) const {
+  auto it = by_board_id_.find(board_id);
+  return it == by_board_id_.end() ? nullptr : it->second;
+}
+
+} // namespace beatled::core
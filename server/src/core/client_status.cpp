@@ -1,5 +1,25 @@
+#include <cstring>
+
 #include "core/client_status.hpp"
 
 namespace beatled::core {
 // to_json for board_id_t is now defined inline in the header
+
+asio::ip::udp::endpoint ClientStatus::endpoint() const {
+  const EndpointBytes bytes = endpoint_.load();
+  asio::ip::udp::endpoint endpoint;
+  if (bytes.size > 0) {
+    std::memcpy(endpoint.data(), bytes.data.data(), bytes.size);
+    endpoint.resize(bytes.size);
+  }
+  return endpoint;
+}
+
+void ClientStatus::set_endpoint(const asio::ip::udp::endpoint &endpoint) {
+  EndpointBytes bytes;
+  bytes.size = endpoint.size();
+  std::memcpy(bytes.data.data(), endpoint.data(), bytes.size);
+  endpoint_.store(bytes);
+}
+
 } // namespace beatled::core
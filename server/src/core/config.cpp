@@ -23,12 +23,29 @@ Config::Config(int argc, const char *argv[]) {
           fmt::format("port to listen (default: {})", m_http_port)) |
       lyra::opt(m_udp_port, "udp port")["-u"]["--udp-port"](
           fmt::format("port to listen (default: {})", m_udp_port)) |
+      lyra::opt(m_udp_batch, "datagrams")["--udp-batch"](fmt::format(
+          "UDP datagrams handled per wakeup, 1 for one at a time (default: {})", m_udp_batch)) |
+      lyra::opt(m_udp_shards, "sockets")["--udp-shards"](fmt::format(
+          "SO_REUSEPORT sockets on the UDP port, at most one per pool thread (default: {})",
+          m_udp_shards)) |
+      lyra::opt(m_no_kernel_timestamps)["--no-kernel-timestamps"](
+          "Take TIME request receive times in the handler, not from the kernel") |
       lyra::opt(m_broadcasting_address, "broadcasting address")["-c"]["--m_broadcasting-address"](
           fmt::format("port to listen (default: {})", m_broadcasting_address)) |
       lyra::opt(m_broadcasting_port, "broadcasting port")["-b"]["--broadcasting-port"](
           fmt::format("port to listen (default: {})", m_broadcasting_port)) |
-      lyra::opt(m_broadcast_mode, "limited|subnet|unicast")["--broadcast-mode"](
+      lyra::opt(m_broadcast_mode, "limited|subnet|unicast|multicast")["--broadcast-mode"](
           fmt::format("delivery mode for NEXT_BEAT/BEAT/PROGRAM (default: {})", m_broadcast_mode)) |
+      lyra::opt(m_multicast_group, "group")["--multicast-group"](
+          fmt::format("IPv4 group for multicast mode (default: {})", m_multicast_group)) |
+      lyra::opt(m_multicast_ttl, "hops")["--multicast-ttl"](
+          fmt::format("multicast TTL (default: {})", m_multicast_ttl)) |
+      lyra::opt(m_multicast_interface, "address")["--multicast-interface"](
+          "local address of the interface to multicast from (default: routing table)") |
+      lyra::opt(m_beat_schedule_every, "beats")["--beat-schedule-every"](
+          fmt::format("send a BEAT_SCHEDULE every N beats instead of a NEXT_BEAT on every beat; "
+                      "0 disables (default: {})",
+                      m_beat_schedule_every)) |
       lyra::opt(m_pool_size, "thread-pool size")["-n"]["--thread-pool-size"](
           fmt::format("The size of a thread pool to run server (default: {})", m_pool_size)) |
       lyra::opt(m_root_dir, "root-dir")["-r"]["--root-dir"](
@@ -50,7 +67,22 @@ Config::Config(int argc, const char *argv[]) {
                       "(default: {} us)",
                       m_qos_skew_warn_us)) |
       lyra::opt(m_qos_skew_fail_us, "us")["--qos-skew-fail-us"](fmt::format(
-          "Fleet skew above which the QoS pip turns red (default: {} us)", m_qos_skew_fail_us));
+          "Fleet skew above which the QoS pip turns red (default: {} us)", m_qos_skew_fail_us)) |
+      lyra::opt(m_audio_source, "portaudio|file:<path>|pipe:<path>|generator[:<bpm>]")
+          ["--audio-source"](fmt::format("beat detector audio input (default: {})",
+                                         m_audio_source)) |
+      lyra::opt(m_audio_pacing, "realtime|fast")["--audio-pacing"](fmt::format(
+          "pacing of file/pipe/generator audio sources (default: {})", m_audio_pacing)) |
+      lyra::opt(m_audio_loop)["--audio-loop"]("Loop file audio sources") |
+      lyra::opt(m_audio_decimation, "1|2|4")["--audio-decimation"](
+          fmt::format("decimate the audio by this factor before beat tracking (default: {})",
+                      m_audio_decimation)) |
+      lyra::opt(m_audio_hop_size, "frames")["--audio-hop-size"](fmt::format(
+          "capture frames per beat tracker hop (default: {})", m_audio_hop_size)) |
+      lyra::opt(m_fftw_wisdom, "path")["--fftw-wisdom"](fmt::format(
+          "FFTW wisdom cache file; empty disables it (default: '{}')", m_fftw_wisdom)) |
+      lyra::opt(m_fftw_planning, "estimate|measure|patient")["--fftw-planning"](fmt::format(
+          "background FFTW planning rigour (default: {})", m_fftw_planning));
 
   auto parser_result = cli.parse(lyra::args(argc, argv));
   if (!parser_result) {
@@ -85,9 +117,22 @@ void Config::log_config() const {
   SPDLOG_INFO("  Address:            {}", m_address);
   SPDLOG_INFO("  HTTP server:        {} (port {}{})", m_start_http_server ? "on" : "off",
               m_http_port, m_no_tls ? ", no TLS" : "");
-  SPDLOG_INFO("  UDP server:         {} (port {})", m_start_udp_server ? "on" : "off", m_udp_port);
-  SPDLOG_INFO("  Broadcaster:        {} ({}:{}, mode={})", m_start_broadcaster ? "on" : "off",
-              m_broadcasting_address, m_broadcasting_port, m_broadcast_mode);
+  SPDLOG_INFO("  UDP server:         {} (port {}, batch {}, {} shard{}{})",
+              m_start_udp_server ? "on" : "off", m_udp_port, m_udp_batch, m_udp_shards,
+              m_udp_shards == 1 ? "" : "s", m_no_kernel_timestamps ? ", no kernel timestamps" : "");
+  if (m_broadcast_mode == "multicast") {
+    SPDLOG_INFO("  Broadcaster:        {} ({}:{}, mode=multicast, ttl {}, interface {})",
+                m_start_broadcaster ? "on" : "off", m_multicast_group, m_broadcasting_port,
+                m_multicast_ttl, m_multicast_interface.empty() ? "any" : m_multicast_interface);
+  } else {
+    SPDLOG_INFO("  Broadcaster:        {} ({}:{}, mode={})", m_start_broadcaster ? "on" : "off",
+                m_broadcasting_address, m_broadcasting_port, m_broadcast_mode);
+  }
+  if (m_beat_schedule_every == 0) {
+    SPDLOG_INFO("  Beat schedule:      off");
+  } else {
+    SPDLOG_INFO("  Beat schedule:      every {} beats", m_beat_schedule_every);
+  }
   SPDLOG_INFO("  Thread pool size:   {}", m_pool_size);
   SPDLOG_INFO("  Root dir:           {}", m_root_dir);
   SPDLOG_INFO("  Certs dir:          {}", m_certs_dir);
@@ -99,4 +144,10 @@ void Config::log_config() const {
                                               ? std::string("off")
                                               : fmt::format("{} ms", m_status_probe_ms));
   SPDLOG_INFO("  QoS skew warn/fail: {} us / {} us", m_qos_skew_warn_us, m_qos_skew_fail_us);
+  SPDLOG_INFO("  Audio source:       {} ({}{})", m_audio_source, m_audio_pacing,
+              m_audio_loop ? ", loop" : "");
+  SPDLOG_INFO("  Audio decimation:   {}", m_audio_decimation);
+  SPDLOG_INFO("  Audio hop size:     {} frames", m_audio_hop_size);
+  SPDLOG_INFO("  FFTW wisdom:        {} ({})", m_fftw_wisdom.empty() ? "disabled" : m_fftw_wisdom,
+              m_fftw_planning);
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef CORE__BEAT_SCHEDULE_HPP
+#define CORE__BEAT_SCHEDULE_HPP
+
+#include <cstdint>
+
+#include "beatled/protocol.h"
+
+namespace beatled::core {
+
+// The beat grid ahead, as a tempo source predicts it and BEAT_SCHEDULE
+// carries it (see protocol.h): beat `beat_count` at `beat_time_ref`, each
+// following beat `period_slope_ns` longer than the one before for
+// `beat_span` beats, then steady.
+struct BeatSchedule {
+  uint64_t beat_time_ref = 0;
+  uint32_t beat_count = 0;
+  uint32_t tempo_period_us = 0;
+  int32_t period_slope_ns = 0;
+  uint16_t beat_span = 0;
+
+  // Time of beat `count` on this grid
+  uint64_t time_of(uint32_t count) const {
+    const int64_t k = static_cast<int32_t>(count - beat_count);
+    return beat_time_ref + static_cast<uint64_t>(beatled_beat_schedule_offset_us(
+                               tempo_period_us, period_slope_ns, beat_span, k));
+  }
+};
+
+// Turns a tempo source's next-beat predictions into schedules. The slope is
+// the period's change per beat between predictions, smoothed, so a tempo
+// the source keeps ramping carries forward and a single jittery estimate
+// mostly doesn't; it is limited to 1% of the period per beat.
+class BeatScheduleTracker {
+public:
+  explicit BeatScheduleTracker(uint16_t beat_span) : beat_span_{beat_span} {}
+
+  // Schedule anchored at the predicted beat. A tempo of 0 or less gives a
+  // schedule with no period.
+  BeatSchedule update(uint64_t next_beat_time_ref, double bpm, uint32_t beat_count);
+
+  // Forget the previous predictions, e.g. when the source restarts
+  void reset();
+
+  // Predictions further apart than this many beats don't give a slope
+  static constexpr uint32_t kMaxGapBeats = 4;
+  static constexpr double kSmoothing = 0.25;
+  static constexpr double kMaxSlope = 0.01;
+
+private:
+  const uint16_t beat_span_;
+  bool have_last_ = false;
+  uint32_t last_count_ = 0;
+  double last_period_us_ = 0;
+  double slope_ns_ = 0;
+};
+
+} // namespace beatled::core
+
+#endif // CORE__BEAT_SCHEDULE_HPP
@@ -0,0 +1,64 @@
+#ifndef CORE__CLIENT_REGISTRY_HPP
+#define CORE__CLIENT_REGISTRY_HPP
+
+#include <asio.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "client_status.hpp"
+
+namespace beatled::core {
+
+// The registered controllers, in registration order, indexed by address,
+// endpoint and board id. A registry never changes once built: StateManager
+// builds a new one for every registration or expiry and publishes it, and
+// readers (the broadcaster, HTTP handlers, UDP lookups) keep using the one
+// they loaded for as long as they hold it. Registrations are rare and reads
+// are per packet, so the copy is paid on the rare side.
+//
+// The ClientStatus entries themselves are shared between successive
+// registries; their heartbeat and measurement fields are updated in place.
+class ClientRegistry {
+public:
+  using Ptr = std::shared_ptr<const ClientRegistry>;
+
+  ClientRegistry() = default;
+  explicit ClientRegistry(ClientStatus::client_map_t clients);
+
+  ClientStatus::Ptr find(const asio::ip::address &ip_address) const;
+  ClientStatus::Ptr find(const asio::ip::udp::endpoint &endpoint) const;
+  ClientStatus::Ptr find(const ClientStatus::board_id_t &board_id) const;
+
+  const ClientStatus::client_map_t &clients() const { return clients_; }
+  std::size_t size() const { return clients_.size(); }
+  bool empty() const { return clients_.empty(); }
+  const ClientStatus::Ptr &operator[](std::size_t i) const { return clients_[i]; }
+  auto begin() const { return clients_.begin(); }
+  auto end() const { return clients_.end(); }
+
+private:
+  // Not every asio version specializes std::hash for addresses
+  struct AddressHash {
+    std::size_t operator()(const asio::ip::address &address) const;
+  };
+  struct EndpointHash {
+    std::size_t operator()(const asio::ip::udp::endpoint &endpoint) const;
+  };
+  struct BoardIdHash {
+    std::size_t operator()(const ClientStatus::board_id_t &board_id) const {
+      return std::hash<std::string_view>{}(std::string_view{board_id.data(), board_id.size()});
+    }
+  };
+
+  ClientStatus::client_map_t clients_;
+  std::unordered_map<asio::ip::address, ClientStatus::Ptr, AddressHash> by_ip_;
+  std::unordered_map<asio::ip::udp::endpoint, ClientStatus::Ptr, EndpointHash> by_endpoint_;
+  std::unordered_map<ClientStatus::board_id_t, ClientStatus::Ptr, BoardIdHash> by_board_id_;
+};
+
+} // namespace beatled::core
+
+#endif // CORE__CLIENT_REGISTRY_HPP
@@ -4,15 +4,18 @@
 #include <algorithm> // std::copy
 #include <array>
 #include <asio.hpp>
+#include <atomic>
 #include <cstdint>
 #include <fmt/ranges.h>
 #include <forward_list>
 #include <functional>
 #include <iomanip> // std::setw, std::setfill
 #include <sstream> // std::ostringstream
+#include <utility>
 #include <nlohmann/json.hpp>
 
 #include "beatled/protocol.h"
+#include "seqlock.hpp"
 
 namespace beatled::core {
 
@@ -35,20 +38,24 @@ public:
   }
 
   uint16_t client_id;
-  uint64_t last_status_time;
+  // Wall-clock time of the last request, bumped by every request from the
+  // client while the expiry sweep reads it
+  std::atomic<uint64_t> last_status_time{0};
   board_id_t board_id;
   asio::ip::address ip_address;
 
   // UDP endpoint (address + port) the client should be reached at. Populated
   // from the source endpoint of HELLO_REQUEST and updated on subsequent
-  // requests; the broadcaster uses it for unicast delivery.
-  asio::ip::udp::endpoint endpoint;
+  // requests; the broadcaster uses it for unicast delivery. Unset (port 0)
+  // until then.
+  asio::ip::udp::endpoint endpoint() const;
+  void set_endpoint(const asio::ip::udp::endpoint &endpoint);
 
   // Measured one-way delay (server→client) in microseconds, reported by the
   // controller as median(RTT)/2 on TEMPO_REQUEST. Diagnostic only: beat
   // timestamps travel in the synced-clock domain, so delivery delay must
   // NOT be compensated for (doing so double-counts the path delay).
-  uint64_t owd_us = 0;
+  std::atomic<uint64_t> owd_us{0};
 
   // Firmware self-description carried on HELLO_REQUEST (protocol v3).
   // `port_name` is one of "pico", "pico-freertos", "posix",
@@ -82,11 +89,27 @@ public:
     uint32_t time_sync_outlier_total = 0;
     uint16_t valid_sample_count = 0;
     uint16_t last_applied_program_seq = 0;
+    uint32_t rx_slab_exhausted_total = 0; // protocol v6
+    uint16_t rx_slab_high_water = 0;      // protocol v6
     // Server-side bookkeeping not carried on the wire.
     uint64_t server_received_at_us = 0;
     uint32_t last_rtt_us = 0; // populated from STATUS_RESPONSE
   };
-  QosSnapshot latest_qos;
+
+  // The UDP handlers write the snapshot while HTTP threads serialize it:
+  // readers get a consistent copy, writers never wait for them.
+  QosSnapshot latest_qos() const { return latest_qos_.load(); }
+  template <class F> void update_qos(F &&modify) { latest_qos_.update(std::forward<F>(modify)); }
+
+private:
+  // Raw socket address, so the endpoint can live in a Seqlock
+  struct EndpointBytes {
+    std::array<unsigned char, sizeof(asio::ip::udp::endpoint)> data{};
+    std::size_t size = 0;
+  };
+
+  Seqlock<EndpointBytes> endpoint_;
+  Seqlock<QosSnapshot> latest_qos_;
 };
 
 // Server-side estimate of a snapshot's clock-sync error, in microseconds.
@@ -124,29 +147,32 @@ inline void to_json(json &j, const ClientStatus &cs) {
   }
 
   j = json{{"client_id", cs.client_id},
-           {"last_status_time", cs.last_status_time},
+           {"last_status_time", cs.last_status_time.load()},
            {"board_id", hex_stream.str()},
            {"port_name", cs.port_name},
            {"git_sha", cs.git_sha},
            {"build_time_us", cs.build_time_us},
            {"protocol_version_major", cs.protocol_version_major},
            {"protocol_version_minor", cs.protocol_version_minor},
-           {"owd_us", cs.owd_us}};
-  if (cs.latest_qos.valid) {
+           {"owd_us", cs.owd_us.load()}};
+  const ClientStatus::QosSnapshot qos = cs.latest_qos();
+  if (qos.valid) {
     j["qos"] = json{
-        {"current_offset_us", cs.latest_qos.current_offset_us},
-        {"uptime_us", cs.latest_qos.uptime_us},
-        {"median_rtt_us", cs.latest_qos.median_rtt_us},
-        {"next_beat_gap_total", cs.latest_qos.next_beat_gap_total},
-        {"intercore_drop_total", cs.latest_qos.intercore_drop_total},
-        {"time_sync_outlier_total", cs.latest_qos.time_sync_outlier_total},
-        {"valid_sample_count", cs.latest_qos.valid_sample_count},
-        {"last_applied_program_seq", cs.latest_qos.last_applied_program_seq},
-        {"server_received_at_us", cs.latest_qos.server_received_at_us},
-        {"last_rtt_us", cs.latest_qos.last_rtt_us},
+        {"current_offset_us", qos.current_offset_us},
+        {"uptime_us", qos.uptime_us},
+        {"median_rtt_us", qos.median_rtt_us},
+        {"next_beat_gap_total", qos.next_beat_gap_total},
+        {"intercore_drop_total", qos.intercore_drop_total},
+        {"time_sync_outlier_total", qos.time_sync_outlier_total},
+        {"valid_sample_count", qos.valid_sample_count},
+        {"last_applied_program_seq", qos.last_applied_program_seq},
+        {"rx_slab_exhausted_total", qos.rx_slab_exhausted_total},
+        {"rx_slab_high_water", qos.rx_slab_high_water},
+        {"server_received_at_us", qos.server_received_at_us},
+        {"last_rtt_us", qos.last_rtt_us},
     };
     int64_t sync_error_us = 0;
-    if (qos_sync_error_us(cs.latest_qos, sync_error_us)) {
+    if (qos_sync_error_us(qos, sync_error_us)) {
       j["qos"]["sync_error_us"] = sync_error_us;
     } else {
       j["qos"]["sync_error_us"] = nullptr;
@@ -37,10 +37,24 @@ public:
   const std::string &api_token() const { return m_api_token; }
   const std::string &broadcasting_address() const { return m_broadcasting_address; }
   const std::string &broadcast_mode() const { return m_broadcast_mode; }
+  const std::string &multicast_group() const { return m_multicast_group; }
+  const std::string &multicast_interface() const { return m_multicast_interface; }
   const std::string &log_level() const { return m_log_level; }
+  const std::string &audio_source() const { return m_audio_source; }
+  const std::string &audio_pacing() const { return m_audio_pacing; }
+  bool audio_loop() const { return m_audio_loop; }
+  std::uint32_t audio_decimation() const { return m_audio_decimation; }
+  std::uint32_t audio_hop_size() const { return m_audio_hop_size; }
+  const std::string &fftw_wisdom() const { return m_fftw_wisdom; }
+  const std::string &fftw_planning() const { return m_fftw_planning; }
   std::uint16_t http_port() const { return m_http_port; }
   std::uint16_t udp_port() const { return m_udp_port; }
+  std::uint32_t udp_batch() const { return m_udp_batch; }
+  std::uint32_t udp_shards() const { return m_udp_shards; }
+  bool no_kernel_timestamps() const { return m_no_kernel_timestamps; }
   std::uint16_t broadcasting_port() const { return m_broadcasting_port; }
+  std::uint32_t multicast_ttl() const { return m_multicast_ttl; }
+  std::uint32_t beat_schedule_every() const { return m_beat_schedule_every; }
   std::size_t pool_size() const { return m_pool_size; }
   std::uint32_t program_refresh_ms() const { return m_program_refresh_ms; }
   std::uint32_t status_probe_ms() const { return m_status_probe_ms; }
@@ -56,10 +70,26 @@ private:
   bool m_no_tls{false};
   std::uint16_t m_http_port{8443};
   std::uint16_t m_udp_port{9090};
+  std::uint32_t m_udp_batch{32};
+  // SO_REUSEPORT sockets on the UDP port, each drained by its own receive
+  // loop: up to this many pool threads answer requests in parallel.
+  std::uint32_t m_udp_shards{1};
+  bool m_no_kernel_timestamps{false};
   std::string m_broadcasting_address{"255.255.255.255"};
   std::uint16_t m_broadcasting_port{8765};
-  // limited | subnet | unicast (default unicast — most reliable on Wi-Fi).
+  // limited | subnet | unicast | multicast (default unicast — most reliable
+  // on Wi-Fi).
   std::string m_broadcast_mode{"unicast"};
+  // Multicast mode destination. Must match UDP_MULTICAST_GROUP in the
+  // controller's constants.h, which is the group controllers join. TTL 1
+  // keeps the traffic on the local subnet; an empty interface lets the
+  // routing table pick.
+  std::string m_multicast_group{"239.255.66.76"};
+  std::uint32_t m_multicast_ttl{1};
+  std::string m_multicast_interface;
+  // Beats between BEAT_SCHEDULEs (protocol v5.2), which then replace the
+  // per-beat NEXT_BEAT. 0 keeps NEXT_BEAT, for controllers older than v5.2.
+  std::uint32_t m_beat_schedule_every{0};
   std::size_t m_pool_size{2};
   std::string m_root_dir{"."};
   std::string m_certs_dir{"./certs"};
@@ -84,6 +114,23 @@ private:
   // outlier counts also turn the pip red regardless of skew.
   std::uint32_t m_qos_skew_warn_us{5000};
   std::uint32_t m_qos_skew_fail_us{20000};
+  // Beat detector input: portaudio | file:<path> | pipe:<path> |
+  // generator[:<bpm>]. Non-hardware sources are paced at the sample rate
+  // ("realtime") or run as fast as the detector keeps up ("fast").
+  std::string m_audio_source{"portaudio"};
+  std::string m_audio_pacing{"realtime"};
+  bool m_audio_loop{false};
+  // Low-pass and decimate the input by this factor before beat tracking
+  // (1, 2 or 4: 44.1 kHz capture is tracked at 44100, 22050 or 11025 Hz).
+  std::uint32_t m_audio_decimation{1};
+  // Capture frames per beat tracker hop. Smaller hops lower beat latency at
+  // the cost of more tracker iterations per second.
+  std::uint32_t m_audio_hop_size{512};
+  // FFTW wisdom cache of the beat tracker's transforms (empty disables it),
+  // and the rigour of the background planning that fills it: estimate |
+  // measure | patient. Measured once per machine, then a lookup at startup.
+  std::string m_fftw_wisdom{"./fftw.wisdom"};
+  std::string m_fftw_planning{"measure"};
 };
 
 } // namespace beatled::core
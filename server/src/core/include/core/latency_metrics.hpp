@@ -0,0 +1,154 @@
+#ifndef CORE__LATENCY_METRICS_HPP
+#define CORE__LATENCY_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+
+namespace beatled::core {
+
+// Lock-free latency histogram with HDR-style log-linear buckets. Values below
+// 64 us get one bucket each; above that every power of two is split into 32
+// buckets, so any recorded value is reported within ~3% (values are clamped
+// at ~2^40 us, i.e. 12 days). record() is a handful of relaxed atomic adds, so
+// it can be called from the audio and network hot paths; snapshot() can run
+// concurrently from any thread and sees each sample either fully or not at all
+// (counts may be a few samples apart from sum/min/max while writers race).
+class LatencyHistogram {
+public:
+  struct Snapshot {
+    uint64_t count = 0;
+    uint64_t min_us = 0;
+    uint64_t max_us = 0;
+    double mean_us = 0;
+    uint64_t p50_us = 0;
+    uint64_t p90_us = 0;
+    uint64_t p99_us = 0;
+    uint64_t p999_us = 0;
+  };
+
+  void record(uint64_t value_us);
+  Snapshot snapshot() const;
+  void reset();
+
+  // Exposed for tests: bucket of a value, and the largest value mapping to a
+  // bucket (what percentiles report, capped at the recorded max).
+  static std::size_t bucket_index(uint64_t value_us);
+  static uint64_t bucket_upper_bound(std::size_t index);
+
+  static constexpr unsigned kLinearBits = 6;
+  static constexpr uint64_t kLinearBuckets = 1ULL << kLinearBits;
+  static constexpr uint64_t kSubBuckets = kLinearBuckets / 2;
+  static constexpr unsigned kMaxBits = 40;
+  static constexpr std::size_t kBucketCount =
+      kLinearBuckets + (kMaxBits - kLinearBits) * kSubBuckets;
+
+private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+  std::atomic<uint64_t> max_{0};
+};
+
+// Stages of the capture-to-wire path of a beat, in order. Each histogram holds
+// the time spent between the previous checkpoint and this one:
+//
+//   Capture  last sample of the hop digitised (ADC time) -> hop handed to the
+//            pool by the audio callback
+//   Queue    hop handed over -> dequeued by the beat detector loop
+//   Tracker  hop dequeued -> BTrack emitted the next-beat prediction
+//   Post     TempoBroadcaster::broadcast_next_beat called -> running on the
+//            broadcaster strand
+//   Send     running on the strand -> async_send_to completed
+//
+// LeadTime is how far ahead of the predicted beat the NEXT_BEAT left the
+// server (next_beat_time_ref - send completion). Late sends (negative lead)
+// are recorded as 0 and counted separately.
+enum class LatencyStage : std::size_t { Capture, Queue, Tracker, Post, Send, LeadTime, Count };
+
+std::string_view to_string(LatencyStage stage);
+
+// Startup cost of a beat detector session, recorded once per start:
+//
+//   TrackerSetup  session started -> tracker built (FFT planning)
+//   FirstBeat     session started -> first beat or next-beat prediction
+enum class StartupStage : std::size_t { TrackerSetup, FirstBeat, Count };
+
+std::string_view to_string(StartupStage stage);
+
+class LatencyMetrics {
+public:
+  void record(LatencyStage stage, uint64_t value_us) {
+    histograms_[static_cast<std::size_t>(stage)].record(value_us);
+  }
+
+  // Time between two checkpoints; a negative delta (clocks crossing, virtual
+  // audio clocks) is recorded as 0.
+  void record_delta(LatencyStage stage, uint64_t from_us, uint64_t to_us) {
+    record(stage, to_us > from_us ? to_us - from_us : 0);
+  }
+
+  void record_lead_time(uint64_t beat_time_us, uint64_t send_time_us) {
+    if (beat_time_us < send_time_us) {
+      late_beats_.fetch_add(1, std::memory_order_relaxed);
+    }
+    record_delta(LatencyStage::LeadTime, send_time_us, beat_time_us);
+  }
+
+  const LatencyHistogram &histogram(LatencyStage stage) const {
+    return histograms_[static_cast<std::size_t>(stage)];
+  }
+
+  void record_startup(StartupStage stage, uint64_t value_us) {
+    startup_histograms_[static_cast<std::size_t>(stage)].record(value_us);
+  }
+
+  const LatencyHistogram &histogram(StartupStage stage) const {
+    return startup_histograms_[static_cast<std::size_t>(stage)];
+  }
+
+  uint64_t late_beats() const { return late_beats_.load(std::memory_order_relaxed); }
+
+  void reset();
+
+private:
+  std::array<LatencyHistogram, static_cast<std::size_t>(LatencyStage::Count)> histograms_;
+  std::array<LatencyHistogram, static_cast<std::size_t>(StartupStage::Count)> startup_histograms_;
+  std::atomic<uint64_t> late_beats_{0};
+};
+
+inline void to_json(nlohmann::json &j, const LatencyHistogram::Snapshot &snapshot) {
+  j = nlohmann::json{{"count", snapshot.count},     {"min_us", snapshot.min_us},
+                     {"mean_us", snapshot.mean_us}, {"p50_us", snapshot.p50_us},
+                     {"p90_us", snapshot.p90_us},   {"p99_us", snapshot.p99_us},
+                     {"p999_us", snapshot.p999_us}, {"max_us", snapshot.max_us}};
+}
+
+// /api/metrics body: one object per stage, the lead time, the number of
+// NEXT_BEATs that left after the beat they announce, and the detector's
+// startup times.
+inline void to_json(nlohmann::json &j, const LatencyMetrics &metrics) {
+  nlohmann::json stages = nlohmann::json::object();
+  for (auto stage : {LatencyStage::Capture, LatencyStage::Queue, LatencyStage::Tracker,
+                     LatencyStage::Post, LatencyStage::Send}) {
+    stages[std::string(to_string(stage))] = metrics.histogram(stage).snapshot();
+  }
+  nlohmann::json startup = nlohmann::json::object();
+  for (auto stage : {StartupStage::TrackerSetup, StartupStage::FirstBeat}) {
+    startup[std::string(to_string(stage))] = metrics.histogram(stage).snapshot();
+  }
+  j = nlohmann::json{{"stages", std::move(stages)},
+                     {"lead_time", metrics.histogram(LatencyStage::LeadTime).snapshot()},
+                     {"late_beats", metrics.late_beats()},
+                     {"startup", std::move(startup)}};
+}
+
+} // namespace beatled::core
+
+#endif // CORE__LATENCY_METRICS_HPP
@@ -0,0 +1,98 @@
+#ifndef CORE__SEQLOCK_HPP
+#define CORE__SEQLOCK_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace beatled::core {
+
+// A value written by a few threads and read by many, without locks. A
+// writer bumps the sequence to odd, stores, and bumps it back to even;
+// a reader copies the value and retries if the sequence moved meanwhile.
+// Readers never block writers and always see one whole write. Concurrent
+// writers take turns on the odd sequence, which is held for the length of
+// one copy.
+//
+// The value is kept as atomic words, so the racing copies are well-defined
+// (and ThreadSanitizer-clean) rather than a benign data race. Word stores are
+// release and word loads acquire, which orders them against the sequence
+// without standalone fences.
+template <class T> class Seqlock {
+  static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied bytewise");
+
+public:
+  Seqlock() : Seqlock(T{}) {}
+  explicit Seqlock(const T &value) { write_words(value); }
+
+  Seqlock(const Seqlock &) = delete;
+  Seqlock &operator=(const Seqlock &) = delete;
+
+  T load() const {
+    while (true) {
+      const uint64_t seq = seq_.load(std::memory_order_acquire);
+      if (seq & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      T value = read_words();
+      if (seq_.load(std::memory_order_relaxed) == seq) {
+        return value;
+      }
+    }
+  }
+
+  void store(const T &value) {
+    update([&value](T &current) { current = value; });
+  }
+
+  // Read-modify-write: `modify(T &)` edits the current value in place
+  template <class F> void update(F &&modify) {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    while ((seq & 1) ||
+           !seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      if (seq & 1) {
+        std::this_thread::yield();
+        seq = seq_.load(std::memory_order_relaxed);
+      }
+    }
+
+    T value = read_words();
+    modify(value);
+    write_words(value);
+
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+private:
+  static constexpr std::size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  T read_words() const {
+    std::array<uint64_t, WORDS> words;
+    for (std::size_t i = 0; i < WORDS; i++) {
+      words[i] = words_[i].load(std::memory_order_acquire);
+    }
+    T value;
+    std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+    return value;
+  }
+
+  void write_words(const T &value) {
+    std::array<uint64_t, WORDS> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    for (std::size_t i = 0; i < WORDS; i++) {
+      words_[i].store(words[i], std::memory_order_release);
+    }
+  }
+
+  std::atomic<uint64_t> seq_{0};
+  std::array<std::atomic<uint64_t>, WORDS> words_;
+};
+
+} // namespace beatled::core
+
+#endif // CORE__SEQLOCK_HPP
@@ -8,12 +8,22 @@
 #include <mutex>
 #include <time.h>
 
+#include "client_registry.hpp"
 #include "client_status.hpp"
 #include "clock.hpp"
+#include "latency_metrics.hpp"
+#include "seqlock.hpp"
+
+// libc++ has no atomic<shared_ptr> yet, and libstdc++'s spins on a lock bit
+// that ThreadSanitizer cannot see; both fall back to the free functions
+#if defined(__cpp_lib_atomic_shared_ptr) && !defined(__SANITIZE_THREAD__)
+#define CORE__ATOMIC_SHARED_PTR 1
+#endif
 
 namespace beatled::core {
 
-static constexpr uint64_t DEVICE_EXPIRY_US = 30 * 1000000ULL; // 30 seconds
+static constexpr uint64_t DEVICE_EXPIRY_US = 30 * 1000000ULL;      // 30 seconds
+static constexpr uint64_t DEVICE_SWEEP_PERIOD_US = 5 * 1000000ULL;  // 5 seconds
 
 typedef struct tempo_ref {
   uint64_t beat_time_ref;
@@ -44,16 +54,42 @@ public:
   void set_manual_bpm(float bpm) { manual_bpm_ = bpm; }
   float get_manual_bpm() const { return manual_bpm_; }
 
+  // Lookups and snapshots read the published registry and never wait for a
+  // registration in progress.
   ClientStatus::Ptr client_status(const ClientStatus::board_id_t &board_id) const;
   ClientStatus::Ptr client_status(const asio::ip::address &ip_address) const;
   void register_client(ClientStatus::Ptr client_status);
-  ClientStatus::client_map_t get_clients();
+
+  // HELLO heartbeat from a board already registered at this address: bumps
+  // its last_status_time in place, without building a new ClientStatus.
+  // Returns nullptr if the board is new or changed address, in which case
+  // it needs a full register_client().
+  ClientStatus::Ptr refresh_client(const ClientStatus::board_id_t &board_id,
+                                   const asio::ip::address &ip_address, uint64_t status_time);
+
+  // Request from a registered client: bumps its last_status_time and tracks
+  // its source endpoint (the ephemeral port can change across a controller
+  // reboot). Returns nullptr for an unknown address.
+  ClientStatus::Ptr touch_client(const asio::ip::udp::endpoint &endpoint, uint64_t status_time);
+
+  // The registered clients, as of the last registration or expiry. Cheap to
+  // call per packet: no lock, no copy.
+  ClientRegistry::Ptr get_clients() const;
+
+  // Drops the clients not heard from for DEVICE_EXPIRY_US. Run periodically
+  // (every DEVICE_SWEEP_PERIOD_US) by the UDP server. Returns how many left.
+  std::size_t expire_clients(uint64_t now);
 
   // Record a fresh one-way-delay sample for the given client. Smoothed
   // server-side with an EWMA so a single jittery sample doesn't snap the
   // broadcaster's compensation around.
   void update_client_owd(const asio::ip::address &ip_address, uint64_t owd_us);
 
+  // Capture-to-wire latency of every beat, fed by the beat detector and the
+  // tempo broadcaster and served on /api/metrics. Lock-free to record.
+  LatencyMetrics &latency_metrics() { return latency_metrics_; }
+  const LatencyMetrics &latency_metrics() const { return latency_metrics_; }
+
   using on_program_change_cb_t = std::function<void(uint16_t)>;
 
   // Must be called during construction only (before threads start).
@@ -66,16 +102,22 @@ private:
   StateManager(const StateManager &) = delete;
   StateManager &operator=(const StateManager &) = delete;
 
-  float tempo_ = 0.0f;
-  uint64_t time_ref_ = 0;
+  // Read on every TEMPO request, from every UDP shard
+  Seqlock<tempo_ref_t> tempo_ref_;
   std::atomic<uint64_t> next_beat_time_ref_{0};
   std::atomic<uint16_t> program_id_{0};
   std::atomic<float> manual_bpm_{120.0f};
-  mutable std::mutex tempo_mtx_;
-  mutable std::mutex client_mtx_;
-  ClientStatus::client_map_t clients_;
+  // Serializes registry writers; readers go through registry_ alone
+  std::mutex client_mtx_;
+#ifdef CORE__ATOMIC_SHARED_PTR
+  std::atomic<ClientRegistry::Ptr> registry_;
+#else
+  ClientRegistry::Ptr registry_;
+#endif
+  void publish(ClientRegistry::Ptr registry);
   std::vector<on_next_beat_cb_t> on_next_beat_cbs_;
   std::vector<on_program_change_cb_t> on_program_change_cbs_;
+  LatencyMetrics latency_metrics_;
 };
 
 } // namespace beatled::core
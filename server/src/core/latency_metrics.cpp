@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <bit>
+
+#include "core/latency_metrics.hpp"
+
+namespace beatled::core {
+
+std::size_t LatencyHistogram::bucket_index(uint64_t value_us) {
+  value_us = std::min<uint64_t>(value_us, (uint64_t{1} << kMaxBits) - 1);
+  if (value_us < kLinearBuckets) {
+    return static_cast<std::size_t>(value_us);
+  }
+  // Keep the kLinearBits - 1 bits below the leading one
+  const unsigned msb = std::bit_width(value_us) - 1;
+  const unsigned shift = msb - (kLinearBits - 1);
+  const uint64_t mantissa = value_us >> shift;
+  return static_cast<std::size_t>(kLinearBuckets + (shift - 1) * kSubBuckets +
+                                  (mantissa - kSubBuckets));
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+  if (index < kLinearBuckets) {
+    return index;
+  }
+  const uint64_t offset = index - kLinearBuckets;
+  const unsigned shift = static_cast<unsigned>(offset / kSubBuckets) + 1;
+  const uint64_t mantissa = kSubBuckets + offset % kSubBuckets;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_us) {
+  uint64_t current = min_.load(std::memory_order_relaxed);
+  while (value_us < current &&
+         !min_.compare_exchange_weak(current, value_us, std::memory_order_relaxed)) {
+  }
+  current = max_.load(std::memory_order_relaxed);
+  while (value_us > current &&
+         !max_.compare_exchange_weak(current, value_us, std::memory_order_relaxed)) {
+  }
+
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value_us, std::memory_order_relaxed);
+  buckets_[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  std::array<uint64_t, kBucketCount> counts;
+  uint64_t total = 0;
+  for (std::size_t i = 0; i < kBucketCount; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  Snapshot snapshot;
+  if (total == 0) {
+    return snapshot;
+  }
+  snapshot.count = total;
+  snapshot.min_us = min_.load(std::memory_order_relaxed);
+  snapshot.max_us = max_.load(std::memory_order_relaxed);
+  const uint64_t count = count_.load(std::memory_order_relaxed);
+  snapshot.mean_us =
+      count > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / count : 0;
+
+  // Percentiles from the bucket counts (nearest rank), reported as the top of
+  // their bucket but never above the largest value actually seen
+  auto value_at = [&](double percentile) {
+    const uint64_t rank =
+        std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * total + 0.5));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; i++) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(bucket_upper_bound(i), snapshot.max_us);
+      }
+    }
+    return snapshot.max_us;
+  };
+  snapshot.p50_us = value_at(50);
+  snapshot.p90_us = value_at(90);
+  snapshot.p99_us = value_at(99);
+  snapshot.p999_us = value_at(99.9);
+  return snapshot;
+}
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+std::string_view to_string(LatencyStage stage) {
+  switch (stage) {
+  case LatencyStage::Capture:
+    return "capture";
+  case LatencyStage::Queue:
+    return "queue";
+  case LatencyStage::Tracker:
+    return "tracker";
+  case LatencyStage::Post:
+    return "post";
+  case LatencyStage::Send:
+    return "send";
+  case LatencyStage::LeadTime:
+    return "lead_time";
+  case LatencyStage::Count:
+    break;
+  }
+  return "unknown";
+}
+
+std::string_view to_string(StartupStage stage) {
+  switch (stage) {
+  case StartupStage::TrackerSetup:
+    return "tracker_setup";
+  case StartupStage::FirstBeat:
+    return "first_beat";
+  case StartupStage::Count:
+    break;
+  }
+  return "unknown";
+}
+
+void LatencyMetrics::reset() {
+  for (auto &histogram : histograms_) {
+    histogram.reset();
+  }
+  for (auto &histogram : startup_histograms_) {
+    histogram.reset();
+  }
+  late_beats_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace beatled::core
@@ -1,25 +1,22 @@
 #include <cstring>
+#include <fmt/ostream.h>
 #include <spdlog/spdlog.h>
 
 #include "core/state_manager.hpp"
 
 namespace beatled::core {
 
-StateManager::StateManager() {}
+StateManager::StateManager() : registry_{std::make_shared<const ClientRegistry>()} {}
 
 void StateManager::update_tempo(float tempo, uint64_t timeref) {
-  std::unique_lock lk(tempo_mtx_);
-  tempo_ = tempo;
-  time_ref_ = timeref;
+  tempo_ref_.store({.beat_time_ref = timeref,
+                    .tempo_period_us =
+                        tempo > 0.0f ? static_cast<uint32_t>(60 * 1000000UL / tempo) : 0,
+                    .tempo = tempo});
 }
 
 tempo_ref_t StateManager::get_tempo_ref() const {
-  std::unique_lock lk(tempo_mtx_);
-  tempo_ref_t tr = {.beat_time_ref = time_ref_,
-                    .tempo_period_us =
-                        tempo_ > 0.0f ? static_cast<uint32_t>(60 * 1000000UL / tempo_) : 0,
-                    .tempo = tempo_};
-  return tr;
+  return tempo_ref_.load();
 }
 
 void StateManager::update_program_id(uint16_t program_id) {
@@ -50,37 +47,40 @@ uint64_t StateManager::get_next_beat_time_ref() const {
   return next_beat_time_ref_;
 }
 
-ClientStatus::Ptr StateManager::client_status(const ClientStatus::board_id_t &board_id) const {
-  std::unique_lock lk(client_mtx_);
+ClientRegistry::Ptr StateManager::get_clients() const {
+#ifdef CORE__ATOMIC_SHARED_PTR
+  return registry_.load(std::memory_order_acquire);
+#else
+  return std::atomic_load_explicit(&registry_, std::memory_order_acquire);
+#endif
+}
 
-  for (auto &el : clients_) {
-    if (el->board_id == board_id) {
-      return el;
-    }
-  }
-  return nullptr;
+void StateManager::publish(ClientRegistry::Ptr registry) {
+#ifdef CORE__ATOMIC_SHARED_PTR
+  registry_.store(std::move(registry), std::memory_order_release);
+#else
+  std::atomic_store_explicit(&registry_, std::move(registry), std::memory_order_release);
+#endif
 }
 
-ClientStatus::Ptr StateManager::client_status(const asio::ip::address &ip_address) const {
-  std::unique_lock lk(client_mtx_);
+ClientStatus::Ptr StateManager::client_status(const ClientStatus::board_id_t &board_id) const {
+  return get_clients()->find(board_id);
+}
 
-  for (auto &el : clients_) {
-    if (el->ip_address == ip_address) {
-      return el;
-    }
-  }
-  return nullptr;
+ClientStatus::Ptr StateManager::client_status(const asio::ip::address &ip_address) const {
+  return get_clients()->find(ip_address);
 }
 
 void StateManager::register_client(ClientStatus::Ptr client_status) {
   std::unique_lock lk(client_mtx_);
 
-  for (auto it = clients_.begin(); it != clients_.end();) {
+  ClientStatus::client_map_t clients = get_clients()->clients();
+  for (auto it = clients.begin(); it != clients.end();) {
     if (client_status->board_id == (*it)->board_id) {
       // Same board reconnecting
       if (client_status->ip_address == (*it)->ip_address) {
         // Same board, same IP: just update timestamp (lightweight heartbeat)
-        (*it)->last_status_time = client_status->last_status_time;
+        (*it)->last_status_time = client_status->last_status_time.load();
         SPDLOG_DEBUG("Board {} heartbeat from {}", client_status->board_id.data(),
                      client_status->ip_address.to_string());
         return; // Don't add new registration
@@ -88,7 +88,7 @@ void StateManager::register_client(ClientStatus::Ptr client_status) {
         // Same board, different IP: board changed networks, replace registration
         SPDLOG_INFO("Board {} changed IP from {} to {}", client_status->board_id.data(),
                     (*it)->ip_address.to_string(), client_status->ip_address.to_string());
-        it = clients_.erase(it);
+        it = clients.erase(it);
         continue;
       }
     }
@@ -97,39 +97,85 @@ void StateManager::register_client(ClientStatus::Ptr client_status) {
       SPDLOG_INFO("IP {} has new board {}. Replacing old board {}",
                   client_status->ip_address.to_string(), client_status->board_id.data(),
                   (*it)->board_id.data());
-      it = clients_.erase(it);
+      it = clients.erase(it);
       continue;
     }
     it++;
   }
 
-  clients_.push_back(client_status);
+  clients.push_back(std::move(client_status));
+  publish(std::make_shared<const ClientRegistry>(std::move(clients)));
+}
+
+ClientStatus::Ptr StateManager::refresh_client(const ClientStatus::board_id_t &board_id,
+                                               const asio::ip::address &ip_address,
+                                               uint64_t status_time) {
+  auto cs = get_clients()->find(board_id);
+  if (!cs || cs->ip_address != ip_address) {
+    return nullptr;
+  }
+  cs->last_status_time = status_time;
+  SPDLOG_DEBUG("Board {} heartbeat from {}", board_id.data(), fmt::streamed(ip_address));
+  return cs;
+}
+
+ClientStatus::Ptr StateManager::touch_client(const asio::ip::udp::endpoint &endpoint,
+                                             uint64_t status_time) {
+  const ClientRegistry::Ptr registry = get_clients();
+  if (auto cs = registry->find(endpoint)) {
+    cs->last_status_time = status_time;
+    return cs;
+  }
+
+  auto cs = registry->find(endpoint.address());
+  if (!cs) {
+    return nullptr;
+  }
+  cs->last_status_time = status_time;
+
+  // Known address, new source port: re-index under the new endpoint
+  std::unique_lock lk(client_mtx_);
+  const ClientRegistry::Ptr current = get_clients();
+  if (current->find(endpoint.address()) != cs) {
+    // Replaced or expired meanwhile
+    return cs;
+  }
+  SPDLOG_DEBUG("Client {} now at {}", fmt::streamed(endpoint.address()), fmt::streamed(endpoint));
+  cs->set_endpoint(endpoint);
+  publish(std::make_shared<const ClientRegistry>(current->clients()));
+  return cs;
 }
 
-ClientStatus::client_map_t StateManager::get_clients() {
+std::size_t StateManager::expire_clients(uint64_t now) {
   std::unique_lock lk(client_mtx_);
-  uint64_t now = Clock::wall_time_us_64();
-  std::erase_if(clients_, [now](const ClientStatus::Ptr &cs) {
-    return (now - cs->last_status_time) > DEVICE_EXPIRY_US;
+  const ClientRegistry::Ptr current = get_clients();
+
+  ClientStatus::client_map_t clients = current->clients();
+  const std::size_t expired = std::erase_if(clients, [now](const ClientStatus::Ptr &cs) {
+    const uint64_t last_status_time = cs->last_status_time;
+    return now > last_status_time && (now - last_status_time) > DEVICE_EXPIRY_US;
   });
-  return clients_;
+  if (expired > 0) {
+    SPDLOG_INFO("{} client(s) expired, {} left", expired, clients.size());
+    publish(std::make_shared<const ClientRegistry>(std::move(clients)));
+  }
+  return expired;
 }
 
 void StateManager::update_client_owd(const asio::ip::address &ip_address, uint64_t owd_us) {
-  std::unique_lock lk(client_mtx_);
-  for (auto &cs : clients_) {
-    if (cs->ip_address == ip_address) {
-      // EWMA with alpha=1/4 — fresh sample contributes 25%, history 75%.
-      // Tightens the broadcaster's compensation enough to track real changes
-      // (route flap, AP roam) while damping Wi-Fi RTT jitter.
-      if (cs->owd_us == 0) {
-        cs->owd_us = owd_us;
-      } else {
-        cs->owd_us = (cs->owd_us * 3 + owd_us) / 4;
-      }
-      return;
-    }
+  auto cs = get_clients()->find(ip_address);
+  if (!cs) {
+    return;
   }
+  // EWMA with alpha=1/4 — fresh sample contributes 25%, history 75%.
+  // Tightens the broadcaster's compensation enough to track real changes
+  // (route flap, AP roam) while damping Wi-Fi RTT jitter. Two samples from
+  // the same client can be handled on different threads: retry on a race.
+  uint64_t current = cs->owd_us.load(std::memory_order_relaxed);
+  uint64_t smoothed;
+  do {
+    smoothed = current == 0 ? owd_us : (current * 3 + owd_us) / 4;
+  } while (!cs->owd_us.compare_exchange_weak(current, smoothed, std::memory_order_relaxed));
 }
 
 } // namespace beatled::core
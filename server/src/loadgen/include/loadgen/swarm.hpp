@@ -0,0 +1,127 @@
+#ifndef LOADGEN__SWARM_HPP
+#define LOADGEN__SWARM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "core/latency_metrics.hpp"
+
+namespace beatled::loadgen {
+
+// Virtual controllers speaking the wire protocol of beatled/protocol.h to a
+// live server, to load it the way a show's worth of Picos would.
+//
+// Each controller has its own UDP socket bound to its own source address
+// (the server tells controllers apart by address): the first one gets
+// `source_address`, the next one that address + 1, and so on. Any 127.x.y.z
+// address works against a server on this host; against a remote server the
+// addresses have to be configured on a local interface.
+//
+// A controller says HELLO (again every `hello_retry_us` until the server
+// answers), then sends TIME and TEMPO requests at the configured rates, with
+// the QoS block of a real controller, and answers STATUS probes. It counts
+// the NEXT_BEAT, BEAT_SCHEDULE and PROGRAM messages the server sends to its
+// socket (unicast mode), and a shared listener on `beat_port` counts them in
+// broadcast and multicast modes.
+//
+// Controllers are split over `threads` worker threads, each multiplexing its
+// share on one epoll instance. Loss and jitter are injected at the sockets:
+// every datagram, either way, is dropped with probability `loss` and
+// otherwise held back by a uniform delay of up to `jitter_us`.
+class Swarm {
+public:
+  struct parameters_t {
+    std::string server_address = "127.0.0.1";
+    std::uint16_t server_port = 9090;
+    std::string source_address = "127.0.0.2";
+    std::size_t controllers = 100;
+    std::size_t threads = 1;
+    // Requests per controller per second
+    double time_rate_hz = 1.0;
+    double tempo_rate_hz = 0.1;
+    // HELLO again until the server answers
+    std::uint64_t hello_retry_us = 1000000;
+    double loss = 0.0;
+    std::uint32_t jitter_us = 0;
+    // First HELLOs are spread over the ramp; requests stop after `duration_us`
+    // and replies are still collected for `drain_us`
+    std::uint64_t ramp_us = 1000000;
+    std::uint64_t duration_us = 10000000;
+    std::uint64_t drain_us = 500000;
+    // Broadcast / multicast NEXT_BEAT and BEAT_SCHEDULE listener; 0 for none
+    std::uint16_t beat_port = 0;
+    std::string multicast_group = "";
+  };
+
+  struct Report {
+    std::size_t controllers = 0;
+    std::size_t registered = 0;
+    std::uint64_t duration_us = 0;
+
+    std::uint64_t hello_sent = 0;
+    std::uint64_t time_sent = 0;
+    std::uint64_t time_answered = 0;
+    std::uint64_t tempo_sent = 0;
+    std::uint64_t tempo_answered = 0;
+    std::uint64_t status_probes = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t send_failures = 0;
+    // Datagrams the injected loss dropped, both ways
+    std::uint64_t injected_drops = 0;
+
+    std::uint64_t next_beats = 0;
+    // NEXT_BEAT seqs a controller never saw between two it did
+    std::uint64_t next_beat_gaps = 0;
+    std::uint64_t late_next_beats = 0;
+    // The same for BEAT_SCHEDULE, which the server sends instead of
+    // NEXT_BEAT with --beat-schedule-every
+    std::uint64_t beat_schedules = 0;
+    std::uint64_t beat_schedule_gaps = 0;
+    std::uint64_t late_beat_schedules = 0;
+    std::uint64_t programs = 0;
+
+    // TIME round trip less the server's own time (t4 - t1 - (t3 - t2))
+    core::LatencyHistogram::Snapshot time_rtt;
+    // TIME request in, response out, on the server (t3 - t2)
+    core::LatencyHistogram::Snapshot server_time;
+    core::LatencyHistogram::Snapshot tempo_rtt;
+    // How long after the first controller each one got the same NEXT_BEAT
+    core::LatencyHistogram::Snapshot next_beat_spread;
+    // Time left before the announced beat when the NEXT_BEAT arrived, on
+    // the controller's synced clock
+    core::LatencyHistogram::Snapshot next_beat_lead;
+    core::LatencyHistogram::Snapshot beat_schedule_spread;
+    // Time left before the schedule's anchor beat when it arrived
+    core::LatencyHistogram::Snapshot beat_schedule_lead;
+
+    double time_loss() const { return loss(time_sent, time_answered); }
+    double tempo_loss() const { return loss(tempo_sent, tempo_answered); }
+    double next_beat_loss() const { return loss(next_beats + next_beat_gaps, next_beats); }
+    double beat_schedule_loss() const {
+      return loss(beat_schedules + beat_schedule_gaps, beat_schedules);
+    }
+
+  private:
+    static double loss(std::uint64_t sent, std::uint64_t received) {
+      return sent == 0 || received >= sent ? 0.0 : static_cast<double>(sent - received) / sent;
+    }
+  };
+
+  explicit Swarm(const parameters_t &parameters);
+
+  // Runs the swarm for the ramp, the duration and the drain, on `threads`
+  // threads, and blocks until they're done. Throws std::runtime_error when a
+  // socket can't be set up (an address that isn't local, too many files).
+  Report run();
+
+private:
+  parameters_t parameters_;
+};
+
+void to_json(nlohmann::json &j, const Swarm::Report &report);
+
+} // namespace beatled::loadgen
+
+#endif // LOADGEN__SWARM_HPP
@@ -0,0 +1,744 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fmt/format.h>
+#include <functional>
+#include <memory>
+#include <netinet/in.h>
+#include <queue>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/clock.hpp"
+#include "loadgen/swarm.hpp"
+
+using beatled::core::Clock;
+using beatled::core::LatencyHistogram;
+
+namespace beatled::loadgen {
+
+namespace {
+
+// TIME samples a controller keeps; its offset is the one of the fastest
+constexpr std::size_t SYNC_WINDOW = 8;
+// A NEXT_BEAT or BEAT_SCHEDULE seq this far past the last one is a restart
+// or a reorder, not that many lost beats
+constexpr uint16_t MAX_SEQ_GAP = 1000;
+
+constexpr uint32_t TIMER_EVENT = UINT32_MAX - 1;
+constexpr uint32_t LISTENER = UINT32_MAX;
+
+// What the controllers got of one of the beat streams, NEXT_BEAT or
+// BEAT_SCHEDULE, which the server numbers apart
+struct BeatStreamStats {
+  std::atomic<uint64_t> received{0};
+  std::atomic<uint64_t> gaps{0};
+  std::atomic<uint64_t> late{0};
+  LatencyHistogram spread;
+  LatencyHistogram lead;
+
+  // When the first controller got each seq
+  std::array<std::atomic<uint64_t>, 1 << 16> first_arrival{};
+};
+
+// Counters and histograms the workers share
+struct Stats {
+  std::atomic<std::size_t> registered{0};
+  std::atomic<uint64_t> hello_sent{0};
+  std::atomic<uint64_t> time_sent{0};
+  std::atomic<uint64_t> time_answered{0};
+  std::atomic<uint64_t> tempo_sent{0};
+  std::atomic<uint64_t> tempo_answered{0};
+  std::atomic<uint64_t> status_probes{0};
+  std::atomic<uint64_t> errors{0};
+  std::atomic<uint64_t> send_failures{0};
+  std::atomic<uint64_t> injected_drops{0};
+  std::atomic<uint64_t> programs{0};
+
+  LatencyHistogram time_rtt;
+  LatencyHistogram server_time;
+  LatencyHistogram tempo_rtt;
+
+  BeatStreamStats next_beat;
+  BeatStreamStats beat_schedule;
+};
+
+struct Datagram {
+  std::array<uint8_t, 128> bytes;
+  std::size_t size = 0;
+
+  template <class T> static Datagram of(const T &message) {
+    static_assert(sizeof(T) <= sizeof(bytes));
+    Datagram datagram;
+    std::memcpy(datagram.bytes.data(), &message, sizeof(T));
+    datagram.size = sizeof(T);
+    return datagram;
+  }
+
+  template <class T> bool read(T &message) const {
+    if (size < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&message, bytes.data(), sizeof(T));
+    return true;
+  }
+};
+
+enum class Action : uint8_t { Hello, Time, Tempo, Transmit, Deliver };
+
+struct Event {
+  uint64_t due_us;
+  uint32_t controller;
+  Action action;
+  // Transmit and Deliver: the datagram held back by the injected jitter
+  Datagram datagram;
+
+  bool operator>(const Event &other) const { return due_us > other.due_us; }
+};
+
+// What a controller tracks of a beat stream
+struct BeatTracker {
+  bool seen = false;
+  uint16_t last_seq = 0;
+  uint32_t epoch = 0;
+  uint32_t gaps = 0;
+};
+
+struct Controller {
+  int fd = -1;
+  std::array<uint8_t, 2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1> board_id{};
+  uint64_t started_us = 0;
+  bool registered = false;
+  // When the outstanding TEMPO request left, 0 when none is
+  uint64_t tempo_sent_us = 0;
+
+  std::array<uint32_t, SYNC_WINDOW> rtts{};
+  std::array<int64_t, SYNC_WINDOW> offsets{};
+  std::size_t samples = 0;
+  int64_t offset_us = 0;
+
+  BeatTracker beats;
+  BeatTracker schedules;
+  uint16_t program_seq = 0;
+
+  uint32_t median_rtt_us() const {
+    const std::size_t count = std::min(samples, SYNC_WINDOW);
+    if (count == 0) {
+      return 0;
+    }
+    std::array<uint32_t, SYNC_WINDOW> sorted = rtts;
+    std::nth_element(sorted.begin(), sorted.begin() + count / 2, sorted.begin() + count);
+    return sorted[count / 2];
+  }
+};
+
+sockaddr_in make_address(uint32_t host_address, uint16_t port) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(host_address);
+  address.sin_port = htons(port);
+  return address;
+}
+
+uint32_t parse_address(const std::string &text) {
+  in_addr address;
+  if (::inet_pton(AF_INET, text.c_str(), &address) != 1) {
+    throw std::runtime_error(fmt::format("Invalid IPv4 address {}", text));
+  }
+  return ntohl(address.s_addr);
+}
+
+std::string format_address(uint32_t host_address) {
+  return fmt::format("{}.{}.{}.{}", host_address >> 24, (host_address >> 16) & 0xff,
+                     (host_address >> 8) & 0xff, host_address & 0xff);
+}
+
+std::runtime_error system_error(const std::string &what) {
+  return std::runtime_error(fmt::format("{}: {}", what, std::strerror(errno)));
+}
+
+// Thousands of sockets need more than the usual 1024 descriptors
+void reserve_descriptors(std::size_t needed) {
+  rlimit limit;
+  if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= needed) {
+    return;
+  }
+  limit.rlim_cur = std::min<rlim_t>(needed, limit.rlim_max);
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < needed) {
+    throw std::runtime_error(fmt::format(
+        "{} virtual controllers need {} file descriptors, the limit is {} (ulimit -n)",
+        needed - 16, needed, limit.rlim_max));
+  }
+}
+
+// One thread's share of the swarm, multiplexed on one epoll instance. A
+// timerfd wakes it for the next scheduled request or held-back datagram.
+class Worker {
+public:
+  Worker(const Swarm::parameters_t &parameters, Stats &stats, std::size_t first,
+         std::size_t count, bool listener, uint64_t seed)
+      : parameters_{parameters}, stats_{stats}, first_{first}, controllers_(count),
+        random_{seed},
+        server_{make_address(parse_address(parameters.server_address), parameters.server_port)} {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epoll_fd_ < 0 || timer_fd_ < 0) {
+      throw system_error("Can't create the event loop");
+    }
+    watch(timer_fd_, TIMER_EVENT);
+
+    const uint32_t source = parse_address(parameters.source_address);
+    for (std::size_t i = 0; i < count; i++) {
+      open_controller(static_cast<uint32_t>(i), source + static_cast<uint32_t>(first + i));
+    }
+    if (listener && parameters.beat_port != 0) {
+      open_listener();
+    }
+  }
+
+  ~Worker() {
+    for (const auto &controller : controllers_) {
+      if (controller.fd >= 0) {
+        ::close(controller.fd);
+      }
+    }
+    for (int fd : {listener_fd_, timer_fd_, epoll_fd_}) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  Worker(const Worker &) = delete;
+  Worker &operator=(const Worker &) = delete;
+
+  void run(uint64_t start_us) {
+    requests_end_us_ = start_us + parameters_.ramp_us + parameters_.duration_us;
+    const uint64_t end_us = requests_end_us_ + parameters_.drain_us;
+
+    // HELLOs spread evenly over the ramp, across all workers
+    for (std::size_t i = 0; i < controllers_.size(); i++) {
+      const uint64_t offset = parameters_.ramp_us * (first_ + i) / parameters_.controllers;
+      schedule({start_us + offset, static_cast<uint32_t>(i), Action::Hello, {}});
+    }
+
+    std::array<epoll_event, 64> events;
+    while (true) {
+      uint64_t now = Clock::time_us_64();
+      while (!queue_.empty() && queue_.top().due_us <= now) {
+        Event event = queue_.top();
+        queue_.pop();
+        handle(event, now);
+        now = Clock::time_us_64();
+      }
+      if (now >= end_us) {
+        break;
+      }
+      arm_timer(queue_.empty() ? end_us : std::min(queue_.top().due_us, end_us));
+
+      const int ready = ::epoll_wait(epoll_fd_, events.data(), events.size(), -1);
+      if (ready < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw system_error("epoll_wait");
+      }
+      for (int i = 0; i < ready; i++) {
+        const uint32_t id = events[i].data.u32;
+        if (id == TIMER_EVENT) {
+          uint64_t expirations;
+          [[maybe_unused]] auto bytes = ::read(timer_fd_, &expirations, sizeof(expirations));
+        } else {
+          receive(id);
+        }
+      }
+    }
+  }
+
+private:
+  void watch(int fd, uint32_t id) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u32 = id;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+      throw system_error("epoll_ctl");
+    }
+  }
+
+  void open_controller(uint32_t index, uint32_t host_address) {
+    Controller &controller = controllers_[index];
+    controller.fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (controller.fd < 0) {
+      throw system_error("Can't create a virtual controller socket");
+    }
+    const sockaddr_in address = make_address(host_address, 0);
+    if (::bind(controller.fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) !=
+        0) {
+      throw system_error(fmt::format("Can't bind virtual controller {} to {}", first_ + index,
+                                     format_address(host_address)));
+    }
+    watch(controller.fd, index);
+
+    const auto id = fmt::format("LOADGEN{:09}", first_ + index);
+    std::copy_n(id.begin(), std::min(id.size(), controller.board_id.size() - 1),
+                controller.board_id.begin());
+  }
+
+  void open_listener() {
+    listener_fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int on = 1;
+    ::setsockopt(listener_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    const sockaddr_in address = make_address(INADDR_ANY, parameters_.beat_port);
+    if (::bind(listener_fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) !=
+        0) {
+      throw system_error(fmt::format("Can't listen on port {}", parameters_.beat_port));
+    }
+    if (!parameters_.multicast_group.empty()) {
+      ip_mreq membership{};
+      membership.imr_multiaddr.s_addr = htonl(parse_address(parameters_.multicast_group));
+      membership.imr_interface.s_addr = htonl(INADDR_ANY);
+      if (::setsockopt(listener_fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership,
+                       sizeof(membership)) != 0) {
+        throw system_error(fmt::format("Can't join {}", parameters_.multicast_group));
+      }
+    }
+    watch(listener_fd_, LISTENER);
+  }
+
+  void schedule(Event event) { queue_.push(std::move(event)); }
+
+  void arm_timer(uint64_t due_us) {
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(due_us / 1000000);
+    spec.it_value.tv_nsec = static_cast<long>(due_us % 1000000) * 1000;
+    ::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+  }
+
+  bool lost() { return parameters_.loss > 0 && chance_(random_) < parameters_.loss; }
+
+  uint64_t jitter() {
+    return parameters_.jitter_us == 0
+               ? 0
+               : std::uniform_int_distribution<uint64_t>{0, parameters_.jitter_us}(random_);
+  }
+
+  // The network between the controller and the server: drops the datagram
+  // or holds it back
+  void transmit(uint32_t index, const Datagram &datagram, uint64_t now) {
+    if (lost()) {
+      stats_.injected_drops.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (const uint64_t delay = jitter()) {
+      schedule({now + delay, index, Action::Transmit, datagram});
+      return;
+    }
+    send(index, datagram);
+  }
+
+  void send(uint32_t index, const Datagram &datagram) {
+    const ssize_t sent = ::sendto(controllers_[index].fd, datagram.bytes.data(), datagram.size, 0,
+                                  reinterpret_cast<const sockaddr *>(&server_), sizeof(server_));
+    if (sent < 0) {
+      stats_.send_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void receive(uint32_t id) {
+    const int fd = id == LISTENER ? listener_fd_ : controllers_[id].fd;
+    Datagram datagram;
+    while (true) {
+      const ssize_t size = ::recv(fd, datagram.bytes.data(), datagram.bytes.size(), 0);
+      if (size <= 0) {
+        return;
+      }
+      datagram.size = static_cast<std::size_t>(size);
+      const uint64_t now = Clock::time_us_64();
+      if (lost()) {
+        stats_.injected_drops.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (const uint64_t delay = jitter()) {
+        schedule({now + delay, id, Action::Deliver, datagram});
+        continue;
+      }
+      deliver(id, datagram, now);
+    }
+  }
+
+  void handle(const Event &event, uint64_t now) {
+    switch (event.action) {
+    case Action::Hello:
+      send_hello(event.controller, now);
+      break;
+    case Action::Time:
+      if (now < requests_end_us_) {
+        send_time(event.controller, now);
+        schedule({next_due(event.due_us, parameters_.time_rate_hz, now), event.controller,
+                  Action::Time, {}});
+      }
+      break;
+    case Action::Tempo:
+      if (now < requests_end_us_) {
+        send_tempo(event.controller, now);
+        schedule({next_due(event.due_us, parameters_.tempo_rate_hz, now), event.controller,
+                  Action::Tempo, {}});
+      }
+      break;
+    case Action::Transmit:
+      send(event.controller, event.datagram);
+      break;
+    case Action::Deliver:
+      deliver(event.controller, event.datagram, now);
+      break;
+    }
+  }
+
+  // Keeps a request's phase, unless the loop fell a whole period behind
+  static uint64_t next_due(uint64_t due_us, double rate_hz, uint64_t now) {
+    const auto period = static_cast<uint64_t>(1e6 / rate_hz);
+    return due_us + period > now ? due_us + period : now + period;
+  }
+
+  uint64_t phase(double rate_hz) {
+    return std::uniform_int_distribution<uint64_t>{0, static_cast<uint64_t>(1e6 / rate_hz)}(
+        random_);
+  }
+
+  void send_hello(uint32_t index, uint64_t now) {
+    Controller &controller = controllers_[index];
+    if (controller.registered || now >= requests_end_us_) {
+      return;
+    }
+    if (controller.started_us == 0) {
+      controller.started_us = now;
+    }
+    beatled_message_hello_request_t hello{};
+    hello.base.type = BEATLED_MESSAGE_HELLO_REQUEST;
+    hello.version_major = BEATLED_PROTOCOL_VERSION_MAJOR;
+    hello.version_minor = BEATLED_PROTOCOL_VERSION_MINOR;
+    std::copy(controller.board_id.begin(), controller.board_id.end(), hello.board_id);
+    std::strncpy(hello.port_name, "loadgen", sizeof(hello.port_name) - 1);
+    hello.build_time_us = htonll(Clock::wall_time_us_64());
+    stats_.hello_sent.fetch_add(1, std::memory_order_relaxed);
+    transmit(index, Datagram::of(hello), now);
+    schedule({now + parameters_.hello_retry_us, index, Action::Hello, {}});
+  }
+
+  void send_time(uint32_t index, uint64_t now) {
+    beatled_message_time_request_t request{};
+    request.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+    request.orig_time = htonll(now);
+    stats_.time_sent.fetch_add(1, std::memory_order_relaxed);
+    transmit(index, Datagram::of(request), now);
+  }
+
+  void send_tempo(uint32_t index, uint64_t now) {
+    Controller &controller = controllers_[index];
+    beatled_message_tempo_request_t request{};
+    request.base.type = BEATLED_MESSAGE_TEMPO_REQUEST;
+    request.owd_us_estimate = htonl(controller.median_rtt_us() / 2);
+    request.qos = qos(controller, now);
+    controller.tempo_sent_us = now;
+    stats_.tempo_sent.fetch_add(1, std::memory_order_relaxed);
+    transmit(index, Datagram::of(request), now);
+  }
+
+  beatled_qos_block_t qos(const Controller &controller, uint64_t now) const {
+    beatled_qos_block_t qos{};
+    uint64_t offset_bits;
+    std::memcpy(&offset_bits, &controller.offset_us, sizeof(offset_bits));
+    qos.current_offset_us = static_cast<int64_t>(htonll(offset_bits));
+    qos.uptime_us = htonll(now - controller.started_us);
+    qos.median_rtt_us = htonl(controller.median_rtt_us());
+    // A real controller counts the gaps of both streams in one total
+    qos.next_beat_gap_total = htonl(controller.beats.gaps + controller.schedules.gaps);
+    qos.valid_sample_count = htons(static_cast<uint16_t>(std::min(controller.samples, SYNC_WINDOW)));
+    qos.last_applied_program_seq = htons(controller.program_seq);
+    return qos;
+  }
+
+  void deliver(uint32_t id, const Datagram &datagram, uint64_t now) {
+    if (datagram.size == 0) {
+      return;
+    }
+    if (id == LISTENER) {
+      // Broadcast traffic, on the clock of this worker's first controller
+      Controller *reference = controllers_.empty() ? nullptr : &controllers_.front();
+      deliver_broadcast(listener_beats_, listener_schedules_, reference, datagram, now);
+      return;
+    }
+
+    Controller &controller = controllers_[id];
+    switch (datagram.bytes[0]) {
+    case BEATLED_MESSAGE_HELLO_RESPONSE:
+      on_hello_response(id, now);
+      break;
+    case BEATLED_MESSAGE_TIME_RESPONSE:
+      on_time_response(controller, datagram, now);
+      break;
+    case BEATLED_MESSAGE_TEMPO_RESPONSE:
+      stats_.tempo_answered.fetch_add(1, std::memory_order_relaxed);
+      if (controller.tempo_sent_us != 0) {
+        stats_.tempo_rtt.record(now - controller.tempo_sent_us);
+        controller.tempo_sent_us = 0;
+      }
+      break;
+    case BEATLED_MESSAGE_STATUS_REQUEST:
+      on_status_request(id, datagram, now);
+      break;
+    case BEATLED_MESSAGE_ERROR:
+      stats_.errors.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      deliver_broadcast(controller.beats, controller.schedules, &controller, datagram, now);
+      break;
+    }
+  }
+
+  // NEXT_BEAT, BEAT_SCHEDULE and PROGRAM, unicast to a controller or broadcast
+  void deliver_broadcast(BeatTracker &beats, BeatTracker &schedules, Controller *controller,
+                         const Datagram &datagram, uint64_t now) {
+    if (beatled_message_next_beat_t next_beat;
+        datagram.bytes[0] == BEATLED_MESSAGE_NEXT_BEAT && datagram.read(next_beat)) {
+      on_beat(stats_.next_beat, beats, controller, ntohs(next_beat.seq), ntohl(next_beat.epoch),
+              ntohll(next_beat.next_beat_time_ref), now);
+    } else if (beatled_message_beat_schedule_t schedule;
+               datagram.bytes[0] == BEATLED_MESSAGE_BEAT_SCHEDULE && datagram.read(schedule)) {
+      on_beat(stats_.beat_schedule, schedules, controller, ntohs(schedule.seq),
+              ntohl(schedule.epoch), ntohll(schedule.beat_time_ref), now);
+    } else if (beatled_message_program_t program;
+               datagram.bytes[0] == BEATLED_MESSAGE_PROGRAM && datagram.read(program)) {
+      stats_.programs.fetch_add(1, std::memory_order_relaxed);
+      if (controller) {
+        controller->program_seq = ntohs(program.seq);
+      }
+    }
+  }
+
+  void on_hello_response(uint32_t index, uint64_t now) {
+    Controller &controller = controllers_[index];
+    if (controller.registered) {
+      return;
+    }
+    controller.registered = true;
+    stats_.registered.fetch_add(1, std::memory_order_relaxed);
+    // Spread each controller's requests over their period
+    if (parameters_.time_rate_hz > 0) {
+      schedule({now + phase(parameters_.time_rate_hz), index, Action::Time, {}});
+    }
+    if (parameters_.tempo_rate_hz > 0) {
+      schedule({now + phase(parameters_.tempo_rate_hz), index, Action::Tempo, {}});
+    }
+  }
+
+  void on_time_response(Controller &controller, const Datagram &datagram, uint64_t now) {
+    beatled_message_time_response_t response;
+    if (!datagram.read(response)) {
+      return;
+    }
+    stats_.time_answered.fetch_add(1, std::memory_order_relaxed);
+    const int64_t t1 = static_cast<int64_t>(ntohll(response.orig_time));
+    const int64_t t2 = static_cast<int64_t>(ntohll(response.recv_time));
+    const int64_t t3 = static_cast<int64_t>(ntohll(response.xmit_time));
+    const int64_t t4 = static_cast<int64_t>(now);
+    const int64_t server_time = std::max<int64_t>(t3 - t2, 0);
+    const int64_t rtt = std::max<int64_t>(t4 - t1 - server_time, 0);
+    stats_.time_rtt.record(static_cast<uint64_t>(rtt));
+    stats_.server_time.record(static_cast<uint64_t>(server_time));
+
+    const std::size_t slot = controller.samples++ % SYNC_WINDOW;
+    controller.rtts[slot] = static_cast<uint32_t>(std::min<int64_t>(rtt, UINT32_MAX));
+    controller.offsets[slot] = ((t2 - t1) + (t3 - t4)) / 2;
+    const std::size_t count = std::min(controller.samples, SYNC_WINDOW);
+    const auto fastest = std::min_element(controller.rtts.begin(), controller.rtts.begin() + count);
+    controller.offset_us = controller.offsets[fastest - controller.rtts.begin()];
+  }
+
+  void on_status_request(uint32_t index, const Datagram &datagram, uint64_t now) {
+    beatled_message_status_request_t request;
+    if (!datagram.read(request)) {
+      return;
+    }
+    stats_.status_probes.fetch_add(1, std::memory_order_relaxed);
+    beatled_message_status_response_t response{};
+    response.base.type = BEATLED_MESSAGE_STATUS_RESPONSE;
+    response.echo_server_send_time_us = request.server_send_time_us;
+    response.qos = qos(controllers_[index], now);
+    transmit(index, Datagram::of(response), now);
+  }
+
+  // A NEXT_BEAT or BEAT_SCHEDULE announcing a beat at `beat_time` (server
+  // clock)
+  void on_beat(BeatStreamStats &stream, BeatTracker &beats, Controller *controller, uint16_t seq,
+               uint32_t epoch, uint64_t beat_time, uint64_t now) {
+    if (beats.seen && beats.epoch == epoch) {
+      const uint16_t delta = static_cast<uint16_t>(seq - beats.last_seq);
+      if (delta == 0 || delta > MAX_SEQ_GAP) {
+        return; // duplicate or stale
+      }
+      beats.gaps += delta - 1;
+      stream.gaps.fetch_add(delta - 1, std::memory_order_relaxed);
+    }
+    beats.seen = true;
+    beats.last_seq = seq;
+    beats.epoch = epoch;
+    stream.received.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t first = 0;
+    if (!stream.first_arrival[seq].compare_exchange_strong(first, now,
+                                                           std::memory_order_relaxed)) {
+      stream.spread.record(now > first ? now - first : 0);
+    } else {
+      stream.spread.record(0);
+    }
+
+    if (controller && controller->samples > 0) {
+      const int64_t lead =
+          static_cast<int64_t>(beat_time) - (static_cast<int64_t>(now) + controller->offset_us);
+      if (lead < 0) {
+        stream.late.fetch_add(1, std::memory_order_relaxed);
+      }
+      stream.lead.record(static_cast<uint64_t>(std::max<int64_t>(lead, 0)));
+    }
+  }
+
+  const Swarm::parameters_t &parameters_;
+  Stats &stats_;
+  const std::size_t first_;
+  std::vector<Controller> controllers_;
+  std::mt19937_64 random_;
+  std::uniform_real_distribution<double> chance_{0.0, 1.0};
+  const sockaddr_in server_;
+
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+  int listener_fd_ = -1;
+  BeatTracker listener_beats_;
+  BeatTracker listener_schedules_;
+
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> queue_;
+  uint64_t requests_end_us_ = 0;
+};
+
+} // namespace
+
+Swarm::Swarm(const parameters_t &parameters) : parameters_{parameters} {
+  if (parameters_.controllers == 0) {
+    throw std::runtime_error("The swarm needs at least one controller");
+  }
+  parameters_.threads = std::clamp<std::size_t>(parameters_.threads, 1, parameters_.controllers);
+}
+
+Swarm::Report Swarm::run() {
+  reserve_descriptors(parameters_.controllers + 3 * parameters_.threads + 16);
+  auto stats = std::make_unique<Stats>();
+
+  // Sockets are all set up before any thread starts, so a bad address fails
+  // the run rather than one worker
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::size_t first = 0;
+  for (std::size_t t = 0; t < parameters_.threads; t++) {
+    const std::size_t count = (parameters_.controllers - first) / (parameters_.threads - t);
+    workers.push_back(std::make_unique<Worker>(parameters_, *stats, first, count, t == 0, t + 1));
+    first += count;
+  }
+
+  SPDLOG_INFO("Swarm of {} controllers on {} thread{} -> {}:{}", parameters_.controllers,
+              workers.size(), workers.size() == 1 ? "" : "s", parameters_.server_address,
+              parameters_.server_port);
+  const uint64_t start_us = Clock::time_us_64();
+  std::vector<std::thread> threads;
+  for (auto &worker : workers) {
+    threads.emplace_back([&worker, start_us]() {
+      try {
+        worker->run(start_us);
+      } catch (const std::exception &exception) {
+        SPDLOG_ERROR("Swarm worker stopped: {}", exception.what());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  Report report;
+  report.controllers = parameters_.controllers;
+  report.registered = stats->registered.load();
+  report.duration_us = Clock::time_us_64() - start_us;
+  report.hello_sent = stats->hello_sent.load();
+  report.time_sent = stats->time_sent.load();
+  report.time_answered = stats->time_answered.load();
+  report.tempo_sent = stats->tempo_sent.load();
+  report.tempo_answered = stats->tempo_answered.load();
+  report.status_probes = stats->status_probes.load();
+  report.errors = stats->errors.load();
+  report.send_failures = stats->send_failures.load();
+  report.injected_drops = stats->injected_drops.load();
+  report.next_beats = stats->next_beat.received.load();
+  report.next_beat_gaps = stats->next_beat.gaps.load();
+  report.late_next_beats = stats->next_beat.late.load();
+  report.beat_schedules = stats->beat_schedule.received.load();
+  report.beat_schedule_gaps = stats->beat_schedule.gaps.load();
+  report.late_beat_schedules = stats->beat_schedule.late.load();
+  report.programs = stats->programs.load();
+  report.time_rtt = stats->time_rtt.snapshot();
+  report.server_time = stats->server_time.snapshot();
+  report.tempo_rtt = stats->tempo_rtt.snapshot();
+  report.next_beat_spread = stats->next_beat.spread.snapshot();
+  report.next_beat_lead = stats->next_beat.lead.snapshot();
+  report.beat_schedule_spread = stats->beat_schedule.spread.snapshot();
+  report.beat_schedule_lead = stats->beat_schedule.lead.snapshot();
+  return report;
+}
+
+void to_json(nlohmann::json &j, const Swarm::Report &report) {
+  j = nlohmann::json{
+      {"controllers", report.controllers},
+      {"registered", report.registered},
+      {"duration_us", report.duration_us},
+      {"hello_sent", report.hello_sent},
+      {"time", {{"sent", report.time_sent},
+                {"answered", report.time_answered},
+                {"loss", report.time_loss()},
+                {"rtt", report.time_rtt},
+                {"server_time", report.server_time}}},
+      {"tempo", {{"sent", report.tempo_sent},
+                 {"answered", report.tempo_answered},
+                 {"loss", report.tempo_loss()},
+                 {"rtt", report.tempo_rtt}}},
+      {"next_beat", {{"received", report.next_beats},
+                     {"gaps", report.next_beat_gaps},
+                     {"loss", report.next_beat_loss()},
+                     {"late", report.late_next_beats},
+                     {"spread", report.next_beat_spread},
+                     {"lead", report.next_beat_lead}}},
+      {"beat_schedule", {{"received", report.beat_schedules},
+                         {"gaps", report.beat_schedule_gaps},
+                         {"loss", report.beat_schedule_loss()},
+                         {"late", report.late_beat_schedules},
+                         {"spread", report.beat_schedule_spread},
+                         {"lead", report.beat_schedule_lead}}},
+      {"programs", report.programs},
+      {"status_probes", report.status_probes},
+      {"errors", report.errors},
+      {"send_failures", report.send_failures},
+      {"injected_drops", report.injected_drops},
+  };
+}
+
+} // namespace beatled::loadgen
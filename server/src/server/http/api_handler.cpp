@@ -112,7 +112,7 @@ APIHandler::req_status_t APIHandler::on_get_status(const req_handle_t &req, rout
   response_body["status"] = service_status;
   response_body["tempo"] = service_manager_.state_manager().get_tempo_ref().tempo;
   response_body["manualBpm"] = service_manager_.state_manager().get_manual_bpm();
-  response_body["deviceCount"] = service_manager_.state_manager().get_clients().size();
+  response_body["deviceCount"] = service_manager_.state_manager().get_clients()->size();
   response_body["uptime_us"] = service_manager_.uptime_us();
 
   return init_resp(req->create_response(restinio::status_ok()))
@@ -500,7 +500,7 @@ APIHandler::req_status_t APIHandler::on_get_devices(const req_handle_t &req,
   auto clients = service_manager_.state_manager().get_clients();
 
   json devices = json::array();
-  for (const auto &cs : clients) {
+  for (const auto &cs : *clients) {
     json device = *cs;
     // Add ip_address (not included in NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE)
     device["ip_address"] = cs->ip_address.to_string();
@@ -509,7 +509,7 @@ APIHandler::req_status_t APIHandler::on_get_devices(const req_handle_t &req,
 
   json response_body;
   response_body["devices"] = devices;
-  response_body["count"] = clients.size();
+  response_body["count"] = clients->size();
 
   return init_resp(req->create_response(restinio::status_ok()))
       .set_body(response_body.dump())
@@ -544,12 +544,13 @@ APIHandler::req_status_t APIHandler::on_get_qos(const req_handle_t &req, route_p
   uint64_t total_intercore_drops = 0;
   uint64_t total_time_sync_outliers = 0;
   std::string slowest_id;
-  for (const auto &cs : clients) {
-    if (!cs->latest_qos.valid) {
+  for (const auto &cs : *clients) {
+    // One consistent copy per device, even while its next report lands
+    const auto qos = cs->latest_qos();
+    if (!qos.valid) {
       continue;
     }
     ++reporting;
-    const auto &qos = cs->latest_qos;
     if (qos.current_offset_us < min_offset_us)
       min_offset_us = qos.current_offset_us;
     if (qos.current_offset_us > max_offset_us)
@@ -585,7 +586,7 @@ APIHandler::req_status_t APIHandler::on_get_qos(const req_handle_t &req, route_p
   }
 
   json response;
-  response["device_count"] = clients.size();
+  response["device_count"] = clients->size();
   response["reporting_count"] = reporting;
   if (reporting > 0) {
     response["min_offset_us"] = min_offset_us;
@@ -637,6 +638,18 @@ APIHandler::req_status_t APIHandler::on_get_qos(const req_handle_t &req, route_p
   return init_resp(req->create_response(restinio::status_ok())).set_body(response.dump()).done();
 }
 
+APIHandler::req_status_t APIHandler::on_get_metrics(const req_handle_t &req,
+                                                    route_params_t params) {
+  if (!check_auth(req)) {
+    return init_resp(req->create_response(restinio::status_unauthorized()))
+        .set_body(R"({"error":"Unauthorized"})")
+        .done();
+  }
+
+  json response = service_manager_.state_manager().latency_metrics();
+  return init_resp(req->create_response(restinio::status_ok())).set_body(response.dump()).done();
+}
+
 APIHandler::req_status_t APIHandler::on_get_health(const req_handle_t &req, route_params_t params) {
   return init_resp(req->create_response(restinio::status_ok()))
       .set_body(R"({"status":"ok"})")
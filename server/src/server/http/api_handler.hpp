@@ -55,6 +55,7 @@ public:
   req_status_t on_get_log(const req_handle_t &req, route_params_t params);
   req_status_t on_get_devices(const req_handle_t &req, route_params_t params);
   req_status_t on_get_qos(const req_handle_t &req, route_params_t params);
+  req_status_t on_get_metrics(const req_handle_t &req, route_params_t params);
 
   req_status_t on_get_health(const req_handle_t &req, route_params_t params);
   req_status_t on_preflight(const req_handle_t &req, route_params_t params);
@@ -84,6 +84,8 @@ std::unique_ptr<router_t> HTTPServer::server_handler(const std::string &root_dir
 
   router->http_get("/api/qos", by_api_handler(&APIHandler::on_get_qos));
 
+  router->http_get("/api/metrics", by_api_handler(&APIHandler::on_get_metrics));
+
   // GET request to homepage.
   router->http_get(R"(/:path(.*)\.:ext(.*))", restinio::path2regex::options_t{}.strict(true),
                    by_file_handler(&FileHandler::on_file_request));
@@ -16,6 +16,8 @@
 #include <string>
 #include <vector>
 
+#include "beat_detector/audio/audio_source_config.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
 #include "core/config.hpp"
 #include "http_server/http_server.hpp"
 #include "logger/logger.hpp"
@@ -49,6 +51,13 @@ public:
     // QoS health-pip thresholds (microseconds) consumed by /api/qos.
     std::uint32_t qos_skew_warn_us = 5000;
     std::uint32_t qos_skew_fail_us = 20000;
+    // Beat detector input (--audio-source / --audio-pacing / --audio-loop /
+    // --audio-decimation).
+    detector::AudioSourceConfig audio_source;
+    // Capture frames per beat tracker hop (--audio-hop-size).
+    std::uint32_t audio_hop_size = 512;
+    // Beat tracker FFT planning (--fftw-wisdom / --fftw-planning).
+    detector::FftwWisdomConfig fftw_wisdom;
   };
 
   /// Construct the server to listen on the specified TCP address and port, and
@@ -6,9 +6,11 @@
 #include <chrono>
 #include <functional>
 
+#include "core/beat_schedule.hpp"
 #include "core/interfaces/service_controller.hpp"
 #include "core/state_manager.hpp"
 
+using beatled::core::BeatSchedule;
 using beatled::core::ServiceControllerInterface;
 using beatled::core::StateManager;
 
@@ -28,9 +30,12 @@ public:
   // Matches BeatDetector::beat_detector_cb_t: (next_beat_time_ref, tempo,
   // estimated_tempo, beat_count).
   using next_beat_cb_t = std::function<void(uint64_t, double, double, uint32_t)>;
+  // Matches BeatDetector::beat_schedule_cb_t
+  using beat_schedule_cb_t = std::function<void(const BeatSchedule &)>;
 
   ManualTempo(const std::string &id, asio::io_context &io_context, StateManager &state_manager,
-              next_beat_cb_t next_beat_callback);
+              next_beat_cb_t next_beat_callback,
+              beat_schedule_cb_t beat_schedule_callback = nullptr);
   ~ManualTempo();
 
   void start_sync() override;
@@ -50,6 +55,7 @@ private:
 
   StateManager &state_manager_;
   next_beat_cb_t next_beat_callback_;
+  beat_schedule_cb_t beat_schedule_callback_;
 
   asio::strand<asio::io_context::executor_type> strand_;
   asio::high_resolution_timer beat_timer_;
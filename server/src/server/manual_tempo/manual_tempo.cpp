@@ -15,10 +15,12 @@ static constexpr double kMinBpm = 20.0;
 static constexpr double kMaxBpm = 400.0;
 
 ManualTempo::ManualTempo(const std::string &id, asio::io_context &io_context,
-                         StateManager &state_manager, next_beat_cb_t next_beat_callback)
+                         StateManager &state_manager, next_beat_cb_t next_beat_callback,
+                         beat_schedule_cb_t beat_schedule_callback)
     : ServiceControllerInterface{id}, state_manager_{state_manager},
-      next_beat_callback_{std::move(next_beat_callback)}, strand_{asio::make_strand(io_context)},
-      beat_timer_{strand_} {
+      next_beat_callback_{std::move(next_beat_callback)},
+      beat_schedule_callback_{std::move(beat_schedule_callback)},
+      strand_{asio::make_strand(io_context)}, beat_timer_{strand_} {
   SPDLOG_INFO("Creating {}", name());
 }
 
@@ -56,6 +58,12 @@ void ManualTempo::emit_beat() {
     // fire at that timestamp, not the one just emitted (see protocol.h).
     next_beat_callback_(next_beat_time_ref, bpm, bpm, beat_count_ + 1);
   }
+  if (beat_schedule_callback_) {
+    // A metronome's grid is exact until the operator changes the BPM, so the
+    // schedule holds its period indefinitely: no ramp, no span.
+    beat_schedule_callback_(
+        BeatSchedule{next_beat_time_ref, beat_count_ + 1, static_cast<uint32_t>(period_us)});
+  }
 
   schedule_next_beat();
 }
@@ -94,9 +94,68 @@ Server::parameters_t make_server_parameters(const core::Config &config) {
     mode = BroadcastMode::Subnet;
   } else if (broadcast_mode == "unicast") {
     mode = BroadcastMode::Unicast;
+  } else if (broadcast_mode == "multicast") {
+    mode = BroadcastMode::Multicast;
   } else {
+    throw std::runtime_error{
+        fmt::format("Invalid --broadcast-mode '{}' (must be limited, subnet, unicast or multicast)",
+                    broadcast_mode)};
+  }
+  if (config.multicast_ttl() > 255) {
+    throw std::runtime_error{
+        fmt::format("Invalid --multicast-ttl {} (must be from 0 to 255)", config.multicast_ttl())};
+  }
+  const auto multicast_ttl = static_cast<std::uint8_t>(config.multicast_ttl());
+  const std::string &broadcasting_address = mode == BroadcastMode::Multicast
+                                                ? config.multicast_group()
+                                                : config.broadcasting_address();
+
+  detector::AudioSourceConfig audio_source;
+  try {
+    audio_source =
+        detector::parse_audio_source_config(config.audio_source(), config.audio_pacing());
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error{fmt::format("Invalid --audio-source/--audio-pacing: {}", e.what())};
+  }
+  audio_source.loop = config.audio_loop();
+  const auto decimation = config.audio_decimation();
+  if (decimation != 1 && decimation != 2 && decimation != 4) {
+    throw std::runtime_error{
+        fmt::format("Invalid --audio-decimation {} (must be 1, 2 or 4)", decimation)};
+  }
+  audio_source.decimation = decimation;
+  const auto hop_size = config.audio_hop_size();
+  if (hop_size < 64 || hop_size > 4096 || (hop_size & (hop_size - 1)) != 0) {
+    throw std::runtime_error{fmt::format(
+        "Invalid --audio-hop-size {} (must be a power of two from 64 to 4096)", hop_size)};
+  }
+
+  // recvmmsg takes at most UIO_MAXIOV (1024) messages per call
+  const auto udp_batch = config.udp_batch();
+  if (udp_batch < 1 || udp_batch > 1024) {
+    throw std::runtime_error{
+        fmt::format("Invalid --udp-batch {} (must be from 1 to 1024)", udp_batch)};
+  }
+  // A shard's receive loop occupies one pool thread while it runs
+  const auto udp_shards = config.udp_shards();
+  if (udp_shards < 1 || udp_shards > config.pool_size()) {
+    throw std::runtime_error{
+        fmt::format("Invalid --udp-shards {} (must be from 1 to --thread-pool-size, {})",
+                    udp_shards, config.pool_size())};
+  }
+
+  const auto beat_schedule_every = config.beat_schedule_every();
+  if (beat_schedule_every > 64) {
     throw std::runtime_error{fmt::format(
-        "Invalid --broadcast-mode '{}' (must be limited, subnet, or unicast)", broadcast_mode)};
+        "Invalid --beat-schedule-every {} (must be from 0 to 64)", beat_schedule_every)};
+  }
+
+  detector::FftwWisdomConfig fftw_wisdom;
+  fftw_wisdom.path = config.fftw_wisdom();
+  try {
+    fftw_wisdom.planning = detector::parse_fftw_planning(config.fftw_planning());
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error{fmt::format("Invalid --fftw-planning: {}", e.what())};
   }
 
   return Server::parameters_t{
@@ -115,14 +174,25 @@ Server::parameters_t make_server_parameters(const core::Config &config) {
               config.qos_skew_warn_us(), // qos_skew_warn_us
               config.qos_skew_fail_us(), // qos_skew_fail_us
           },
-      .udp = {config.udp_port()},
-      .broadcasting = {config.broadcasting_address(), config.broadcasting_port(), mode},
+      .udp = {config.udp_port(), udp_batch, udp_shards, !config.no_kernel_timestamps()},
+      .broadcasting =
+          {
+              broadcasting_address,                            // address
+              config.broadcasting_port(),                      // port
+              mode,                                            // mode
+              multicast_ttl,                                   // multicast_ttl
+              config.multicast_interface(),                    // multicast_interface
+              static_cast<std::uint16_t>(beat_schedule_every), // beat_schedule_every
+          },
       .logger = {20, config.log_level()},
       .thread_pool_size = config.pool_size(),
       .program_refresh_ms = config.program_refresh_ms(),
       .status_probe_ms = config.status_probe_ms(),
       .qos_skew_warn_us = config.qos_skew_warn_us(),
       .qos_skew_fail_us = config.qos_skew_fail_us(),
+      .audio_source = audio_source,
+      .audio_hop_size = hop_size,
+      .fftw_wisdom = fftw_wisdom,
   };
 }
 
@@ -3,11 +3,15 @@
 
 #include <asio.hpp>
 #include <chrono>
+#include <optional>
+#include <string>
 
+#include "core/beat_schedule.hpp"
 #include "core/interfaces/service_controller.hpp"
 #include "core/state_manager.hpp"
 #include "udp/udp_buffer.hpp"
 
+using beatled::core::BeatSchedule;
 using beatled::core::ServiceControllerInterface;
 using beatled::core::StateManager;
 
@@ -21,7 +25,12 @@ namespace beatled::server {
 // - Unicast:  send one packet per registered client to their last-known
 //             endpoint, with per-client OWD compensation applied to
 //             NEXT_BEAT timestamps. Preferred when client count is modest.
-enum class BroadcastMode { Limited, Subnet, Unicast };
+// - Multicast: send to the IPv4 group configured via --multicast-group, which
+//             controllers join at startup. One packet per beat like broadcast,
+//             but only group members receive it and APs that rate-limit
+//             broadcast frames pass it at the normal rate. STATUS probes go
+//             to the group too.
+enum class BroadcastMode { Limited, Subnet, Unicast, Multicast };
 
 class TempoBroadcaster : public ServiceControllerInterface {
 public:
@@ -29,6 +38,15 @@ public:
     const std::string address;
     std::uint16_t port;
     BroadcastMode mode = BroadcastMode::Limited;
+    // Multicast only: hop limit, and the local address of the interface to
+    // send from (empty lets the routing table pick)
+    std::uint8_t multicast_ttl = 1;
+    std::string multicast_interface = "";
+    // Beats between BEAT_SCHEDULEs, which then replace NEXT_BEAT; one also
+    // goes out as soon as a prediction strays from the last one sent. 0
+    // sends a NEXT_BEAT on every beat instead, for controllers older than
+    // protocol v5.2.
+    std::uint16_t beat_schedule_every = 0;
   };
 
   TempoBroadcaster(const std::string &id, asio::io_context &io_context,
@@ -42,6 +60,9 @@ public:
   void stop_sync() override;
 
   void broadcast_next_beat(uint64_t next_beat_time_ref, uint32_t beat_count);
+  // The tempo sources call both this and broadcast_next_beat on every beat;
+  // beat_schedule_every picks which one reaches the wire.
+  void broadcast_beat_schedule(const BeatSchedule &schedule);
   void broadcast_beat(uint64_t beat_time_ref, uint32_t beat_count);
 
   // Push the current program_id immediately. Called from the StateManager
@@ -53,18 +74,29 @@ private:
   const char *SERVICE_NAME = "Tempo Broadcaster";
   const char *service_name() const override { return SERVICE_NAME; }
 
+  // Latency checkpoints carried by a NEXT_BEAT until its send completes, so
+  // the completion handler can record the Send stage and the lead time.
+  struct beat_trace_t {
+    uint64_t next_beat_time_ref;
+    uint64_t strand_time_us;
+  };
+
   // Send a single buffer either as broadcast or as N unicast frames. The
   // same bytes go to every client: timestamps are in the shared synced-clock
   // domain, so no per-recipient delivery compensation is needed (or correct).
-  void dispatch(DataBuffer::Ptr response_buffer);
+  // Buffers come from make_shared_buffer, so the whole send is pooled.
+  void dispatch(std::shared_ptr<DataBuffer> buffer,
+                std::optional<beat_trace_t> trace = std::nullopt);
 
   void send_to_endpoint(std::shared_ptr<DataBuffer> buffer,
-                        const asio::ip::udp::endpoint &endpoint);
+                        const asio::ip::udp::endpoint &endpoint,
+                        std::optional<beat_trace_t> trace = std::nullopt);
 
   void schedule_program_refresh();
 
   // Server-initiated STATUS probe (protocol v4). Fires a unicast
-  // STATUS_REQUEST to every registered client every `status_probe_period`;
+  // STATUS_REQUEST to every registered client every `status_probe_period`
+  // (a single one to the group in multicast mode);
   // controllers reply with STATUS_RESPONSE which the request handler
   // decodes back onto ClientStatus::latest_qos. status_probe_period == 0
   // disables the probe entirely.
@@ -91,6 +123,10 @@ private:
   std::atomic<uint16_t> next_beat_seq_{0};
   std::atomic<uint16_t> beat_seq_{0};
   std::atomic<uint16_t> program_seq_{0};
+  std::atomic<uint16_t> beat_schedule_seq_{0};
+
+  // Last BEAT_SCHEDULE sent, touched only on the strand
+  std::optional<BeatSchedule> last_beat_schedule_;
 
   // Per-server-boot epoch (protocol v5), stamped on every NEXT_BEAT / BEAT /
   // PROGRAM. The seq counters above reset to 0 on every process restart;
@@ -1,4 +1,5 @@
 #include <asio.hpp>
+#include <cstdlib>
 #include <fmt/ostream.h>
 #include <random>
 #include <spdlog/spdlog.h>
@@ -11,6 +12,7 @@
 namespace beatled::server {
 
 using asio::ip::udp;
+using beatled::core::Clock;
 using beatled::core::StateManager;
 using beatled::core::tempo_ref_t;
 
@@ -38,15 +40,31 @@ TempoBroadcaster::TempoBroadcaster(const std::string &id, asio::io_context &io_c
   }
 
   socket_->set_option(udp::socket::reuse_address(true));
-  if (broadcasting_server_parameters_.mode != BroadcastMode::Unicast) {
+  const char *mode_name = "limited-broadcast";
+  switch (broadcasting_server_parameters_.mode) {
+  case BroadcastMode::Limited:
+    socket_->set_option(asio::socket_base::broadcast(true));
+    break;
+  case BroadcastMode::Subnet:
     socket_->set_option(asio::socket_base::broadcast(true));
+    mode_name = "subnet-broadcast";
+    break;
+  case BroadcastMode::Unicast:
+    mode_name = "unicast";
+    break;
+  case BroadcastMode::Multicast:
+    if (!broadcast_endpoint_.address().is_multicast()) {
+      throw std::runtime_error{fmt::format("{} is not a multicast group",
+                                           broadcast_endpoint_.address().to_string())};
+    }
+    socket_->set_option(asio::ip::multicast::hops(broadcasting_server_parameters_.multicast_ttl));
+    if (!broadcasting_server_parameters_.multicast_interface.empty()) {
+      socket_->set_option(asio::ip::multicast::outbound_interface(
+          asio::ip::make_address_v4(broadcasting_server_parameters_.multicast_interface)));
+    }
+    mode_name = "multicast";
+    break;
   }
-
-  const char *mode_name =
-      broadcasting_server_parameters_.mode == BroadcastMode::Unicast
-          ? "unicast"
-          : (broadcasting_server_parameters_.mode == BroadcastMode::Subnet ? "subnet-broadcast"
-                                                                           : "limited-broadcast");
   SPDLOG_INFO("{} mode={} bind={} dst={}", name(), mode_name,
               fmt::streamed(socket_->local_endpoint()), fmt::streamed(broadcast_endpoint_));
 
@@ -60,18 +78,62 @@ TempoBroadcaster::TempoBroadcaster(const std::string &id, asio::io_context &io_c
 
 TempoBroadcaster::~TempoBroadcaster() {}
 
+// A BEAT_SCHEDULE also goes out as soon as a fresh prediction is this far
+// from where the last one sent put the beat: well under an LED frame.
+static constexpr uint64_t kBeatScheduleToleranceUs = 2000;
+
 void TempoBroadcaster::broadcast_next_beat(uint64_t next_beat_time_ref, uint32_t beat_count) {
   if (!is_running()) {
     SPDLOG_INFO("TempoBroadcaster is not on. Dropping next beat broadcast.");
     return;
   }
+  if (broadcasting_server_parameters_.beat_schedule_every > 0) {
+    return; // BEAT_SCHEDULE carries this beat
+  }
+
+  const uint64_t post_time_us = Clock::time_us_64();
+  asio::post(strand_, [this, next_beat_time_ref, beat_count, post_time_us]() {
+    const uint64_t strand_time_us = Clock::time_us_64();
+    state_manager_.latency_metrics().record_delta(core::LatencyStage::Post, post_time_us,
+                                                  strand_time_us);
 
-  asio::post(strand_, [this, next_beat_time_ref, beat_count]() {
     uint16_t seq = next_beat_seq_.fetch_add(1, std::memory_order_relaxed);
-    auto buffer = std::make_unique<NextBeatBuffer>(next_beat_time_ref, beat_count, seq, epoch_);
+    auto buffer = make_shared_buffer<NextBeatBuffer>(next_beat_time_ref, beat_count, seq, epoch_);
     // Per-beat traffic — same reasoning as application.cpp.
     SPDLOG_DEBUG("{} next_beat seq={} t={} count={}", name(), seq, next_beat_time_ref, beat_count);
-    dispatch(std::move(buffer));
+    dispatch(std::move(buffer), beat_trace_t{next_beat_time_ref, strand_time_us});
+  });
+}
+
+void TempoBroadcaster::broadcast_beat_schedule(const BeatSchedule &schedule) {
+  const uint16_t every = broadcasting_server_parameters_.beat_schedule_every;
+  if (every == 0 || schedule.tempo_period_us == 0 || !is_running()) {
+    return;
+  }
+
+  const uint64_t post_time_us = Clock::time_us_64();
+  asio::post(strand_, [this, schedule, every, post_time_us]() {
+    if (last_beat_schedule_) {
+      const uint32_t beats = schedule.beat_count - last_beat_schedule_->beat_count;
+      const int64_t error = static_cast<int64_t>(schedule.beat_time_ref -
+                                                 last_beat_schedule_->time_of(schedule.beat_count));
+      if (beats < every && std::abs(error) <= static_cast<int64_t>(kBeatScheduleToleranceUs)) {
+        return; // controllers already have this beat where it is now predicted
+      }
+    }
+    last_beat_schedule_ = schedule;
+
+    const uint64_t strand_time_us = Clock::time_us_64();
+    state_manager_.latency_metrics().record_delta(core::LatencyStage::Post, post_time_us,
+                                                  strand_time_us);
+    uint16_t seq = beat_schedule_seq_.fetch_add(1, std::memory_order_relaxed);
+    auto buffer = make_shared_buffer<BeatScheduleBuffer>(
+        schedule.beat_time_ref, schedule.beat_count, schedule.tempo_period_us,
+        schedule.period_slope_ns, schedule.beat_span, seq, epoch_);
+    SPDLOG_DEBUG("{} beat_schedule seq={} t={} count={} period={} slope={}ns", name(), seq,
+                 schedule.beat_time_ref, schedule.beat_count, schedule.tempo_period_us,
+                 schedule.period_slope_ns);
+    dispatch(std::move(buffer), beat_trace_t{schedule.beat_time_ref, strand_time_us});
   });
 }
 
@@ -83,7 +145,7 @@ void TempoBroadcaster::broadcast_beat(uint64_t beat_time_ref, uint32_t beat_coun
 
   asio::post(strand_, [this, beat_time_ref, beat_count]() {
     uint16_t seq = beat_seq_.fetch_add(1, std::memory_order_relaxed);
-    auto buffer = std::make_unique<BeatBuffer>(beat_time_ref, beat_count, seq, epoch_);
+    auto buffer = make_shared_buffer<BeatBuffer>(beat_time_ref, beat_count, seq, epoch_);
     dispatch(std::move(buffer));
   });
 }
@@ -98,7 +160,7 @@ void TempoBroadcaster::push_program_now() {
     SPDLOG_INFO("{} program push seq={} pid={}", name(), seq, pid);
 
     // Immediate send.
-    dispatch(std::make_unique<ProgramPushBuffer>(pid, seq, epoch_));
+    dispatch(make_shared_buffer<ProgramPushBuffer>(pid, seq, epoch_));
 
     // Retry 50 ms later with the same seq so controllers that already
     // applied the first packet treat the retry as an idempotent no-op
@@ -113,7 +175,7 @@ void TempoBroadcaster::push_program_now() {
           if (ec || !is_running()) {
             return;
           }
-          dispatch(std::make_unique<ProgramPushBuffer>(pid, seq, epoch_));
+          dispatch(make_shared_buffer<ProgramPushBuffer>(pid, seq, epoch_));
         }));
   });
 }
@@ -136,44 +198,55 @@ void TempoBroadcaster::schedule_program_refresh() {
       }));
 }
 
-void TempoBroadcaster::dispatch(DataBuffer::Ptr response_buffer) {
+void TempoBroadcaster::dispatch(std::shared_ptr<DataBuffer> buffer,
+                                std::optional<beat_trace_t> trace) {
   // Timestamps in these messages live in the shared synced-clock domain:
   // controllers convert them with the NTP-style offset they negotiated over
   // TIME_REQUEST, which already accounts for path delay symmetrically. The
   // per-client OWD rewrite this used to do on NEXT_BEAT/BEAT double-counted
   // that delay and made each controller fire early by its own OWD — skewing
   // controllers against each other by the *difference* of their estimates.
-  auto shared = std::shared_ptr<DataBuffer>(std::move(response_buffer));
-
   if (broadcasting_server_parameters_.mode != BroadcastMode::Unicast) {
-    // Broadcast mode: one packet for everyone.
-    send_to_endpoint(std::move(shared), broadcast_endpoint_);
+    // Broadcast and multicast modes: one packet for everyone.
+    send_to_endpoint(std::move(buffer), broadcast_endpoint_, trace);
     return;
   }
 
-  // Unicast mode. Snapshot the client list (also prunes stale entries) and
-  // send the same bytes to every registered client.
+  // Unicast mode. Send the same bytes to every client of the current
+  // registry snapshot.
   auto clients = state_manager_.get_clients();
-  for (const auto &cs : clients) {
-    if (cs->endpoint.port() == 0) {
+  for (const auto &cs : *clients) {
+    const auto endpoint = cs->endpoint();
+    if (endpoint.port() == 0) {
       continue; // never observed a real endpoint
     }
-    send_to_endpoint(shared, cs->endpoint);
+    send_to_endpoint(buffer, endpoint, trace);
   }
 }
 
 void TempoBroadcaster::send_to_endpoint(std::shared_ptr<DataBuffer> buffer,
-                                        const asio::ip::udp::endpoint &endpoint) {
+                                        const asio::ip::udp::endpoint &endpoint,
+                                        std::optional<beat_trace_t> trace) {
   socket_->async_send_to(
       asio::buffer(buffer->data(), buffer->size()), endpoint,
-      asio::bind_executor(strand_, [buffer, endpoint](std::error_code ec, std::size_t /*sent*/) {
+      asio::bind_executor(strand_, [this, buffer, endpoint, trace](std::error_code ec,
+                                                                   std::size_t /*sent*/) {
         if (ec) {
           SPDLOG_ERROR("Send to {} failed: {}", fmt::streamed(endpoint), ec.message());
+          return;
+        }
+        if (trace) {
+          const uint64_t sent_time_us = Clock::time_us_64();
+          auto &metrics = state_manager_.latency_metrics();
+          metrics.record_delta(core::LatencyStage::Send, trace->strand_time_us, sent_time_us);
+          metrics.record_lead_time(trace->next_beat_time_ref, sent_time_us);
         }
       }));
 }
 
 void TempoBroadcaster::start_sync() {
+  // A new run announces its grid from scratch
+  asio::post(strand_, [this]() { last_beat_schedule_.reset(); });
   schedule_program_refresh();
   if (status_probe_period_.count() > 0) {
     schedule_status_probe();
@@ -207,21 +280,27 @@ void TempoBroadcaster::schedule_status_probe() {
 }
 
 void TempoBroadcaster::send_status_probes() {
-  // Probe every registered client whose endpoint we've observed. Snapshot
-  // the client list first to keep the strand's lock window short — the
+  // Probe every registered client whose endpoint we've observed. The
   // actual sends are queued via send_to_endpoint, which already runs on
   // this strand.
   auto clients = state_manager_.get_clients();
-  if (clients.empty()) {
+  if (clients->empty()) {
     return;
   }
   const uint64_t send_time_us = beatled::core::Clock::wall_time_us_64();
-  for (const auto &cs : clients) {
-    if (cs->endpoint.port() == 0) {
+  if (broadcasting_server_parameters_.mode == BroadcastMode::Multicast) {
+    // Every member answers the same probe; replies come back unicast to the
+    // UDP server and are matched to clients by their source endpoint.
+    send_to_endpoint(make_shared_buffer<StatusRequestBuffer>(send_time_us), broadcast_endpoint_);
+    return;
+  }
+  for (const auto &cs : *clients) {
+    const auto endpoint = cs->endpoint();
+    if (endpoint.port() == 0) {
       continue; // no observed endpoint yet
     }
-    auto buf = std::shared_ptr<DataBuffer>(new StatusRequestBuffer(send_time_us));
-    send_to_endpoint(std::move(buf), cs->endpoint);
+    auto buf = make_shared_buffer<StatusRequestBuffer>(send_time_us);
+    send_to_endpoint(std::move(buf), endpoint);
   }
 }
 
@@ -0,0 +1,78 @@
+#include <atomic>
+
+#include "udp/buffer_pool.hpp"
+
+namespace beatled::server {
+
+namespace {
+
+struct FreeList {
+  struct Block {
+    Block *next;
+  };
+
+  Block *head = nullptr;
+  std::size_t size = 0;
+  // Buffers can still be freed while the thread exits, after the list is gone
+  bool alive = true;
+
+  ~FreeList() {
+    alive = false;
+    while (head) {
+      Block *block = head;
+      head = block->next;
+      ::operator delete(block);
+    }
+    size = 0;
+  }
+};
+
+thread_local FreeList free_list;
+
+std::atomic<uint64_t> reused{0};
+std::atomic<uint64_t> heap{0};
+
+} // namespace
+
+void *BufferPool::allocate(std::size_t size) {
+  if (size > BLOCK_SIZE) {
+    heap.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  FreeList &list = free_list;
+  if (list.head) {
+    FreeList::Block *block = list.head;
+    list.head = block->next;
+    list.size--;
+    reused.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+  heap.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(BLOCK_SIZE);
+}
+
+void BufferPool::deallocate(void *block, std::size_t size) noexcept {
+  if (!block) {
+    return;
+  }
+  FreeList &list = free_list;
+  if (size > BLOCK_SIZE || !list.alive || list.size >= MAX_FREE_BLOCKS) {
+    ::operator delete(block);
+    return;
+  }
+  auto *free_block = static_cast<FreeList::Block *>(block);
+  free_block->next = list.head;
+  list.head = free_block;
+  list.size++;
+}
+
+uint64_t BufferPool::reused_count() {
+  return reused.load(std::memory_order_relaxed);
+}
+
+uint64_t BufferPool::heap_count() {
+  return heap.load(std::memory_order_relaxed);
+}
+
+} // namespace beatled::server
@@ -0,0 +1,60 @@
+#ifndef UDP__BUFFER_POOL_HPP
+#define UDP__BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace beatled::server {
+
+// Fixed-size blocks for packet buffers, recycled through a free list per
+// thread. Once every thread that handles packets has warmed up its list, a
+// buffer costs a pointer pop and a push instead of a malloc and a free.
+//
+// A block freed on another thread than the one that allocated it joins the
+// freeing thread's list. Lists are bounded; surplus blocks go back to the
+// heap.
+class BufferPool {
+public:
+  // Fits every DataBuffer subclass, alone (unique_ptr) or inside the control
+  // block of a shared_ptr made with make_shared_buffer
+  static constexpr std::size_t BLOCK_SIZE = 256;
+
+  // Free blocks kept per thread
+  static constexpr std::size_t MAX_FREE_BLOCKS = 1024;
+
+  static void *allocate(std::size_t size);
+  static void deallocate(void *block, std::size_t size) noexcept;
+
+  // Allocations served from a free list, and the ones that had to go to the
+  // heap: a cold list, or an object bigger than a block. In steady state
+  // only the first grows. Process-wide.
+  static uint64_t reused_count();
+  static uint64_t heap_count();
+};
+
+// Standard allocator over BufferPool, for std::allocate_shared
+template <class T> class BufferAllocator {
+public:
+  using value_type = T;
+
+  BufferAllocator() noexcept = default;
+  template <class U> BufferAllocator(const BufferAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) { return static_cast<T *>(BufferPool::allocate(n * sizeof(T))); }
+  void deallocate(T *p, std::size_t n) noexcept { BufferPool::deallocate(p, n * sizeof(T)); }
+
+  template <class U> bool operator==(const BufferAllocator<U> &) const noexcept { return true; }
+};
+
+// A buffer shared by several sends, with its reference counts in the same
+// pooled block
+template <class T, class... Args> std::shared_ptr<T> make_shared_buffer(Args &&...args) {
+  return std::allocate_shared<T>(BufferAllocator<T>{}, std::forward<Args>(args)...);
+}
+
+} // namespace beatled::server
+
+#endif // UDP__BUFFER_POOL_HPP
@@ -0,0 +1,100 @@
+#ifndef UDP__HANDLER_MEMORY_HPP
+#define UDP__HANDLER_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace beatled::server {
+
+// Storage for the state asio keeps while an async operation is pending. asio
+// allocates it per operation; its own per-thread cache only holds a couple of
+// blocks, so a receive alternating with sends of a different size keeps
+// missing it. A chain of operations that is never pending twice at once
+// (a socket's receive loop) reuses one block instead.
+//
+// Falls back to the heap when the block is taken or too small. A completion
+// may free the block on one pool thread while another allocates, so the
+// block is claimed atomically. Handlers share ownership of it: an operation
+// still pending when its socket's owner goes away is destroyed with the
+// io_context, and frees its block then.
+class HandlerMemory {
+public:
+  HandlerMemory() = default;
+  HandlerMemory(const HandlerMemory &) = delete;
+  HandlerMemory &operator=(const HandlerMemory &) = delete;
+
+  void *allocate(std::size_t size) {
+    if (size <= sizeof(storage_) && !in_use_.exchange(true, std::memory_order_acquire)) {
+      return &storage_;
+    }
+    return ::operator new(size);
+  }
+
+  void deallocate(void *pointer) noexcept {
+    if (pointer == &storage_) {
+      in_use_.store(false, std::memory_order_release);
+    } else {
+      ::operator delete(pointer);
+    }
+  }
+
+private:
+  alignas(std::max_align_t) unsigned char storage_[512];
+  std::atomic<bool> in_use_{false};
+};
+
+// Standard allocator over a HandlerMemory, associated with a handler by
+// PooledHandler
+template <class T> class HandlerAllocator {
+public:
+  using value_type = T;
+
+  explicit HandlerAllocator(std::shared_ptr<HandlerMemory> memory) noexcept
+      : memory_{std::move(memory)} {}
+  template <class U>
+  HandlerAllocator(const HandlerAllocator<U> &other) noexcept : memory_{other.memory_} {}
+
+  T *allocate(std::size_t n) { return static_cast<T *>(memory_->allocate(n * sizeof(T))); }
+  void deallocate(T *p, std::size_t /*n*/) noexcept { memory_->deallocate(p); }
+
+  template <class U> bool operator==(const HandlerAllocator<U> &other) const noexcept {
+    return memory_ == other.memory_;
+  }
+
+private:
+  template <class> friend class HandlerAllocator;
+  std::shared_ptr<HandlerMemory> memory_;
+};
+
+// Wraps a completion handler so asio allocates the operation from `memory`
+template <class Handler> class PooledHandler {
+public:
+  using allocator_type = HandlerAllocator<Handler>;
+
+  PooledHandler(std::shared_ptr<HandlerMemory> memory, Handler handler)
+      : memory_{std::move(memory)}, handler_{std::move(handler)} {}
+
+  allocator_type get_allocator() const noexcept { return allocator_type{memory_}; }
+
+  template <class... Args> void operator()(Args &&...args) {
+    handler_(std::forward<Args>(args)...);
+  }
+
+private:
+  std::shared_ptr<HandlerMemory> memory_;
+  Handler handler_;
+};
+
+template <class Handler>
+PooledHandler<std::decay_t<Handler>> make_pooled_handler(std::shared_ptr<HandlerMemory> memory,
+                                                         Handler &&handler) {
+  return {std::move(memory), std::forward<Handler>(handler)};
+}
+
+} // namespace beatled::server
+
+#endif // UDP__HANDLER_MEMORY_HPP
@@ -1,6 +1,7 @@
 #ifndef UDP__UDP_BUFFER_H
 #define UDP__UDP_BUFFER_H
 
+#include <algorithm>
 #include <array>
 #include <asio.hpp>
 #include <cstdint>
@@ -13,22 +14,56 @@
 #include <type_traits>
 
 #include "beatled/protocol.h"
+#include "buffer_pool.hpp"
 #include "udp_buffer.hpp"
 
 namespace beatled::server {
 
+// Largest message of the protocol
+constexpr std::size_t max_message_size = std::max({
+    sizeof(beatled_message_error_t),
+    sizeof(beatled_message_hello_request_t),
+    sizeof(beatled_message_hello_response_t),
+    sizeof(beatled_message_tempo_request_t),
+    sizeof(beatled_message_tempo_response_t),
+    sizeof(beatled_message_time_request_t),
+    sizeof(beatled_message_time_response_t),
+    sizeof(beatled_message_program_t),
+    sizeof(beatled_message_next_beat_t),
+    sizeof(beatled_message_beat_t),
+    sizeof(beatled_message_beat_schedule_t),
+    sizeof(beatled_message_status_request_t),
+    sizeof(beatled_message_status_response_t),
+    sizeof(beatled_message_time_burst_request_t),
+    sizeof(beatled_message_time_burst_response_t),
+});
+
 class DataBuffer {
 public:
   using Ptr = std::unique_ptr<DataBuffer>;
 
-  constexpr static int BUFFER_SIZE = 1024;
+  // Room for every message, with headroom for fields a newer controller
+  // appends. Longer datagrams are truncated on receive.
+  constexpr static std::size_t BUFFER_SIZE = 128;
+  static_assert(max_message_size <= BUFFER_SIZE);
   typedef std::array<uint8_t, BUFFER_SIZE> buffer_t;
 
   DataBuffer() = default;
+  virtual ~DataBuffer() = default;
+
+  // Buffers live on the per-thread pool, not the heap
+  static void *operator new(std::size_t size) { return BufferPool::allocate(size); }
+  static void operator delete(void *block, std::size_t size) noexcept {
+    BufferPool::deallocate(block, size);
+  }
 
   const buffer_t &data() const { return data_; }
   std::size_t size() const { return size_; }
   uint8_t type() const;
+  // Rewrites the xmit_time of a TIME or TIME_BURST response, so the server
+  // can stamp it right before the send system call. Other messages are left
+  // alone.
+  void set_transmit_time(uint64_t xmit_time);
   friend std::ostream &operator<<(std::ostream &os, const DataBuffer &buffer);
 
   [[nodiscard]] auto begin() const noexcept { return data_.begin(); }
@@ -67,6 +102,12 @@ public:
   TimeResponseBuffer(uint64_t orig_time, uint64_t recv_time, uint64_t xmit_time);
 };
 
+class TimeBurstResponseBuffer : public ResponseBuffer<beatled_message_time_burst_response_t> {
+public:
+  TimeBurstResponseBuffer(uint64_t orig_time, uint64_t recv_time, uint64_t xmit_time,
+                          uint8_t index);
+};
+
 class TempoResponseBuffer : public ResponseBuffer<beatled_message_tempo_response_t> {
 public:
   TempoResponseBuffer(uint64_t beat_time_ref, uint32_t tempo_period_us, uint16_t program_id);
@@ -82,6 +123,12 @@ public:
   BeatBuffer(uint64_t beat_time_ref, uint32_t beat_count, uint16_t seq, uint32_t epoch);
 };
 
+class BeatScheduleBuffer : public ResponseBuffer<beatled_message_beat_schedule_t> {
+public:
+  BeatScheduleBuffer(uint64_t beat_time_ref, uint32_t beat_count, uint32_t tempo_period_us,
+                     int32_t period_slope_ns, uint16_t beat_span, uint16_t seq, uint32_t epoch);
+};
+
 class ProgramPushBuffer : public ResponseBuffer<beatled_message_program_t> {
 public:
   ProgramPushBuffer(uint16_t program_id, uint16_t seq, uint32_t epoch);
@@ -114,10 +161,19 @@ public:
 
   asio::ip::udp::endpoint &remote_endpoint() { return remote_endpoint_; };
 
+  // When the kernel queued the datagram, on the Clock::time_us_64() clock;
+  // 0 when the socket doesn't timestamp receives
+  uint64_t receive_time_us() const { return receive_time_us_; }
+  void set_receive_time_us(uint64_t receive_time_us) { receive_time_us_ = receive_time_us; }
+
 private:
   asio::ip::udp::endpoint remote_endpoint_;
+  uint64_t receive_time_us_ = 0;
 };
 
+static_assert(sizeof(UDPRequestBuffer) <= BufferPool::BLOCK_SIZE,
+              "Request buffers must fit a pool block");
+
 } // namespace beatled::server
 
 #endif // UDP__UDP_BUFFER_H
\ No newline at end of file
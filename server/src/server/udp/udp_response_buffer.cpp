@@ -1,4 +1,6 @@
 #include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
 #include "beatled/network.h"
@@ -33,6 +35,30 @@ TimeResponseBuffer::TimeResponseBuffer(uint64_t orig_time, uint64_t recv_time, u
   set_data(time_resp_msg);
 }
 
+TimeBurstResponseBuffer::TimeBurstResponseBuffer(uint64_t orig_time, uint64_t recv_time,
+                                                 uint64_t xmit_time, uint8_t index) {
+  beatled_message_time_burst_response_t burst_resp_msg;
+  burst_resp_msg.base.type = BEATLED_MESSAGE_TIME_BURST_RESPONSE;
+  burst_resp_msg.orig_time = htonll(orig_time);
+  burst_resp_msg.recv_time = htonll(recv_time);
+  burst_resp_msg.xmit_time = htonll(xmit_time);
+  burst_resp_msg.index = index;
+
+  set_data(burst_resp_msg);
+}
+
+void DataBuffer::set_transmit_time(uint64_t xmit_time) {
+  static_assert(offsetof(beatled_message_time_burst_response_t, xmit_time) ==
+                offsetof(beatled_message_time_response_t, xmit_time));
+  if (size_ < sizeof(beatled_message_time_response_t) ||
+      (type() != BEATLED_MESSAGE_TIME_RESPONSE && type() != BEATLED_MESSAGE_TIME_BURST_RESPONSE)) {
+    return;
+  }
+  const uint64_t wire_time = htonll(xmit_time);
+  std::memcpy(&data_[offsetof(beatled_message_time_response_t, xmit_time)], &wire_time,
+              sizeof(wire_time));
+}
+
 TempoResponseBuffer::TempoResponseBuffer(uint64_t beat_time_ref, uint32_t tempo_period_us,
                                          uint16_t program_id)
     : ResponseBuffer() {
@@ -57,6 +83,22 @@ NextBeatBuffer::NextBeatBuffer(uint64_t next_beat_time_ref, uint32_t beat_count,
   set_data(msg);
 }
 
+BeatScheduleBuffer::BeatScheduleBuffer(uint64_t beat_time_ref, uint32_t beat_count,
+                                       uint32_t tempo_period_us, int32_t period_slope_ns,
+                                       uint16_t beat_span, uint16_t seq, uint32_t epoch) {
+  beatled_message_beat_schedule_t msg;
+  msg.base.type = BEATLED_MESSAGE_BEAT_SCHEDULE;
+  msg.beat_time_ref = htonll(beat_time_ref);
+  msg.beat_count = htonl(beat_count);
+  msg.tempo_period_us = htonl(tempo_period_us);
+  msg.period_slope_ns = static_cast<int32_t>(htonl(static_cast<uint32_t>(period_slope_ns)));
+  msg.beat_span = htons(beat_span);
+  msg.seq = htons(seq);
+  msg.epoch = htonl(epoch);
+
+  set_data(msg);
+}
+
 BeatBuffer::BeatBuffer(uint64_t beat_time_ref, uint32_t beat_count, uint16_t seq, uint32_t epoch) {
   beatled_message_beat_t msg;
   msg.base.type = BEATLED_MESSAGE_BEAT;
@@ -4,23 +4,43 @@
 #include <asio.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/interfaces/service_controller.hpp"
 #include "core/state_manager.hpp"
+#include "udp/udp_buffer.hpp"
 
 using beatled::core::ServiceControllerInterface;
 using beatled::core::StateManager;
 
 namespace beatled::server {
 
+class UDPBatch;
+
 class UDPServer : public ServiceControllerInterface {
 public:
   struct parameters_t {
     std::uint16_t port;
+    // Datagrams handled per wakeup (Linux). Above 1, everything queued on
+    // the socket is drained with recvmmsg and answered with one sendmmsg;
+    // 1 keeps one async receive and one async send per datagram.
+    std::size_t batch_size = 1;
+    // Sockets bound to `port` with SO_REUSEPORT (Linux), each with its own
+    // receive loop. The kernel hashes every controller to one of them, so up
+    // to `shards` pool threads handle requests at once; 1 is a single socket.
+    std::size_t shards = 1;
+    // Take TIME_REQUEST receive times from the kernel's receive timestamps
+    // (SO_TIMESTAMPNS, Linux) rather than from the clock once a handler
+    // runs, so time spent in the socket queue doesn't skew the sync.
+    bool kernel_timestamps = true;
   };
 
   UDPServer(const std::string &id, asio::io_context &io_context,
             const parameters_t &server_parameters, StateManager &state_manager);
+  ~UDPServer();
+
+  asio::ip::udp::endpoint local_endpoint() const;
+  std::size_t shard_count() const { return shards_.size(); }
 
   void start_sync() override;
   void stop_sync() override;
@@ -29,9 +49,16 @@ private:
   const char *SERVICE_NAME = "UDP Server";
   const char *service_name() const override { return SERVICE_NAME; }
 
-  void do_receive();
+  struct Shard;
+
+  void do_receive(Shard &shard);
+  void handle_request(Shard &shard, std::unique_ptr<UDPRequestBuffer> request_buffer_ptr);
+  void do_receive_batch(Shard &shard);
+  void send_batch(Shard &shard, std::size_t count);
+  void schedule_client_expiry();
 
-  asio::ip::udp::socket socket_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  asio::steady_timer expiry_timer_;
 
   StateManager &state_manager_;
 };
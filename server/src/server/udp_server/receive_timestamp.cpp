@@ -0,0 +1,69 @@
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+
+#include "receive_timestamp.hpp"
+
+using namespace beatled::server;
+
+namespace {
+
+int64_t to_ns(const timespec &ts) {
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+ReceiveClock::ReceiveClock() {
+  timespec realtime;
+  timespec monotonic;
+  clock_gettime(CLOCK_REALTIME, &realtime);
+  clock_gettime(CLOCK_MONOTONIC, &monotonic);
+  realtime_minus_monotonic_ns_ = to_ns(realtime) - to_ns(monotonic);
+}
+
+uint64_t ReceiveClock::receive_time_us(const msghdr &header) const {
+  for (const cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&header), const_cast<cmsghdr *>(cmsg))) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPNS) {
+      continue;
+    }
+    timespec stamp;
+    std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+    const int64_t monotonic_ns = to_ns(stamp) - realtime_minus_monotonic_ns_;
+    return monotonic_ns > 0 ? static_cast<uint64_t>(monotonic_ns) / 1000 : 0;
+  }
+  return 0;
+}
+
+std::size_t beatled::server::receive_datagram(int fd, UDPRequestBuffer &request,
+                                              std::error_code &ec) {
+  ec.clear();
+  auto &endpoint = request.remote_endpoint();
+  iovec iov{request.data().data(), UDPRequestBuffer::BUFFER_SIZE};
+  ReceiveControl control;
+
+  msghdr header{};
+  header.msg_name = endpoint.data();
+  header.msg_namelen = static_cast<socklen_t>(endpoint.capacity());
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  header.msg_control = control.buffer;
+  header.msg_controllen = sizeof(control.buffer);
+
+  const ssize_t received = ::recvmsg(fd, &header, MSG_DONTWAIT);
+  if (received < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      ec.assign(errno, std::system_category());
+    }
+    return 0;
+  }
+
+  endpoint.resize(header.msg_namelen);
+  request.setSize(static_cast<std::size_t>(received));
+  request.set_receive_time_us(ReceiveClock{}.receive_time_us(header));
+  return static_cast<std::size_t>(received);
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,52 @@
+#ifndef UDP__RECEIVE_TIMESTAMP_HPP
+#define UDP__RECEIVE_TIMESTAMP_HPP
+
+#if defined(__linux__)
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/socket.h>
+#include <system_error>
+#include <time.h>
+
+#include "udp/udp_buffer.hpp"
+
+namespace beatled::server {
+
+// Kernel receive timestamps (SO_TIMESTAMPNS). The kernel stamps a datagram
+// when it reaches the socket and hands the stamp over as a control message
+// of recvmsg / recvmmsg. Unlike a clock read in the handler, it doesn't
+// include the time the datagram waited in the queue or for a pool thread,
+// which is what TIME_REQUEST's recv_time is meant to leave out.
+
+// Control message room for the timestamp of one datagram
+union ReceiveControl {
+  cmsghdr header;
+  char buffer[CMSG_SPACE(sizeof(timespec))];
+};
+
+// Kernel timestamps are CLOCK_REALTIME, the time sync protocol runs on
+// CLOCK_MONOTONIC (Clock::time_us_64()). Both are slewed alike, so one
+// offset sampled per wakeup converts every datagram read in it.
+class ReceiveClock {
+public:
+  ReceiveClock();
+
+  // The receive time of the datagram `header` was filled in for, on the
+  // monotonic clock; 0 when it carries no timestamp
+  uint64_t receive_time_us(const msghdr &header) const;
+
+private:
+  int64_t realtime_minus_monotonic_ns_;
+};
+
+// Reads one datagram into `request`, with its receive time, without
+// blocking. Returns its size (0 once the queue is empty, which is not an
+// error).
+std::size_t receive_datagram(int fd, UDPRequestBuffer &request, std::error_code &ec);
+
+} // namespace beatled::server
+
+#endif // defined(__linux__)
+
+#endif // UDP__RECEIVE_TIMESTAMP_HPP
@@ -0,0 +1,111 @@
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+
+#include "core/clock.hpp"
+#include "udp_batch.hpp"
+
+using namespace beatled::server;
+using beatled::core::Clock;
+
+UDPBatch::UDPBatch(std::size_t capacity)
+    : requests_(capacity), responses_(capacity), recv_headers_(capacity),
+      recv_iovecs_(capacity), recv_controls_(capacity), send_headers_(capacity), send_iovecs_(capacity) {
+  send_indices_.reserve(capacity);
+}
+
+std::size_t UDPBatch::receive(int fd, std::size_t first, std::error_code &ec) {
+  ec.clear();
+  if (first >= capacity()) {
+    return 0;
+  }
+
+  // The kernel overwrites the address and control lengths, so the headers
+  // are set up again for every call
+  for (std::size_t i = first; i < capacity(); i++) {
+    auto &endpoint = requests_[i].remote_endpoint();
+    recv_iovecs_[i] = {requests_[i].data().data(), UDPRequestBuffer::BUFFER_SIZE};
+
+    msghdr &header = recv_headers_[i].msg_hdr;
+    std::memset(&recv_headers_[i], 0, sizeof(mmsghdr));
+    header.msg_name = endpoint.data();
+    header.msg_namelen = static_cast<socklen_t>(endpoint.capacity());
+    header.msg_iov = &recv_iovecs_[i];
+    header.msg_iovlen = 1;
+    header.msg_control = recv_controls_[i].buffer;
+    header.msg_controllen = sizeof(recv_controls_[i].buffer);
+  }
+
+  const int received = ::recvmmsg(fd, &recv_headers_[first],
+                                  static_cast<unsigned>(capacity() - first), MSG_DONTWAIT, nullptr);
+  if (received < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      ec.assign(errno, std::system_category());
+    }
+    return 0;
+  }
+
+  const ReceiveClock clock;
+  for (std::size_t i = first; i < first + static_cast<std::size_t>(received); i++) {
+    requests_[i].remote_endpoint().resize(recv_headers_[i].msg_hdr.msg_namelen);
+    requests_[i].setSize(recv_headers_[i].msg_len);
+    requests_[i].set_receive_time_us(clock.receive_time_us(recv_headers_[i].msg_hdr));
+  }
+  return static_cast<std::size_t>(received);
+}
+
+std::size_t UDPBatch::send(int fd, std::size_t count, std::error_code &ec) {
+  ec.clear();
+
+  send_indices_.clear();
+  for (std::size_t i = 0; i < count; i++) {
+    if (!responses_[i]) {
+      continue;
+    }
+    auto &endpoint = requests_[i].remote_endpoint();
+    const std::size_t slot = send_indices_.size();
+    // sendmmsg doesn't write through the payload pointer
+    send_iovecs_[slot] = {const_cast<uint8_t *>(responses_[i]->data().data()),
+                          responses_[i]->size()};
+
+    std::memset(&send_headers_[slot], 0, sizeof(mmsghdr));
+    msghdr &header = send_headers_[slot].msg_hdr;
+    header.msg_name = endpoint.data();
+    header.msg_namelen = static_cast<socklen_t>(endpoint.size());
+    header.msg_iov = &send_iovecs_[slot];
+    header.msg_iovlen = 1;
+    send_indices_.push_back(i);
+  }
+
+  // sendmmsg stops at the first datagram that fails. Carry on past partial
+  // sends, and past a datagram the kernel refused (dropped, like a failed
+  // async_send_to), until the socket pushes back.
+  std::size_t next = 0;
+  std::size_t sent = 0;
+  while (next < send_indices_.size()) {
+    const uint64_t xmit_time = Clock::time_us_64();
+    for (std::size_t slot = next; slot < send_indices_.size(); slot++) {
+      responses_[send_indices_[slot]]->set_transmit_time(xmit_time);
+    }
+    const int result = ::sendmmsg(fd, &send_headers_[next],
+                                  static_cast<unsigned>(send_indices_.size() - next), MSG_DONTWAIT);
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    if (result <= 0) {
+      ec.assign(result < 0 ? errno : EIO, std::system_category());
+      responses_[send_indices_[next]].reset();
+      next++;
+      continue;
+    }
+    for (int i = 0; i < result; i++) {
+      responses_[send_indices_[next + i]].reset();
+    }
+    next += static_cast<std::size_t>(result);
+    sent += static_cast<std::size_t>(result);
+  }
+  return sent;
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,79 @@
+#ifndef UDP__BATCH_HPP
+#define UDP__BATCH_HPP
+
+#if defined(__linux__)
+
+#include <cstddef>
+#include <span>
+#include <sys/socket.h>
+#include <system_error>
+#include <vector>
+
+#include "receive_timestamp.hpp"
+#include "udp/udp_buffer.hpp"
+
+namespace beatled::server {
+
+// Preallocated recvmmsg / sendmmsg state for one socket: a fixed array of
+// request buffers, the response of each request, and the message headers
+// pointing into them. Datagrams are received straight into the request
+// buffers (payload, source address and kernel receive timestamp), and
+// responses are sent from their own buffers to the address of their request,
+// so a batch costs one system call each way and no copies.
+//
+// Not thread-safe: one batch belongs to one outstanding receive.
+class UDPBatch {
+public:
+  explicit UDPBatch(std::size_t capacity);
+
+  UDPBatch(const UDPBatch &) = delete;
+  UDPBatch &operator=(const UDPBatch &) = delete;
+
+  std::size_t capacity() const { return requests_.size(); }
+
+  UDPRequestBuffer &request(std::size_t index) { return requests_[index]; }
+
+  std::span<UDPRequestBuffer> requests(std::size_t count) { return {requests_.data(), count}; }
+  std::span<DataBuffer::Ptr> responses(std::size_t count) { return {responses_.data(), count}; }
+
+  // Drains the datagrams queued on `fd` into requests [first, capacity())
+  // without blocking. Returns how many were received (0 once the queue is
+  // empty, which is not an error).
+  std::size_t receive(int fd, std::size_t first, std::error_code &ec);
+
+  // Sends the non-null responses of the first `count` requests, each to the
+  // endpoint of its request, with as few sendmmsg calls as possible. Sent
+  // responses are released, and so are the ones the kernel refused (`ec`
+  // holds the last error). What didn't fit in a full send buffer stays in
+  // `responses()` for the caller to send another way. TIME responses get
+  // their xmit_time right before each sendmmsg. Returns the number of
+  // datagrams sent.
+  std::size_t send(int fd, std::size_t count, std::error_code &ec);
+
+private:
+  std::vector<UDPRequestBuffer> requests_;
+  std::vector<DataBuffer::Ptr> responses_;
+
+  std::vector<mmsghdr> recv_headers_;
+  std::vector<iovec> recv_iovecs_;
+  std::vector<ReceiveControl> recv_controls_;
+
+  std::vector<mmsghdr> send_headers_;
+  std::vector<iovec> send_iovecs_;
+  std::vector<std::size_t> send_indices_;
+};
+
+} // namespace beatled::server
+
+#else // !defined(__linux__)
+
+namespace beatled::server {
+
+// recvmmsg / sendmmsg are Linux-only: elsewhere UDPServer never creates a batch
+class UDPBatch {};
+
+} // namespace beatled::server
+
+#endif // defined(__linux__)
+
+#endif // UDP__BATCH_HPP
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cstring>
+#include <fmt/ostream.h>
 #include <spdlog/spdlog.h>
 #include <string>
 
@@ -36,6 +38,8 @@ void decode_qos_block(const beatled_qos_block_t &qos_in, ClientStatus::QosSnapsh
   qos.time_sync_outlier_total = ntohl(qos_in.time_sync_outlier_total);
   qos.valid_sample_count = ntohs(qos_in.valid_sample_count);
   qos.last_applied_program_seq = ntohs(qos_in.last_applied_program_seq);
+  qos.rx_slab_exhausted_total = ntohl(qos_in.rx_slab_exhausted_total);
+  qos.rx_slab_high_water = ntohs(qos_in.rx_slab_high_water);
 }
 
 } // namespace
@@ -54,6 +58,9 @@ DataBuffer::Ptr UDPRequestHandler::response() {
     case BEATLED_MESSAGE_TIME_REQUEST:
       return process_time_request();
 
+    case BEATLED_MESSAGE_TIME_BURST_REQUEST:
+      return process_time_burst_request();
+
     case BEATLED_MESSAGE_TEMPO_REQUEST:
       return process_tempo_request();
 
@@ -66,12 +73,25 @@ DataBuffer::Ptr UDPRequestHandler::response() {
   }
 }
 
+std::size_t UDPRequestHandler::handle_batch(std::span<UDPRequestBuffer> requests,
+                                            std::span<DataBuffer::Ptr> responses,
+                                            StateManager &state_manager) {
+  std::size_t replies = 0;
+  for (std::size_t i = 0; i < requests.size(); i++) {
+    responses[i] = UDPRequestHandler{&requests[i], state_manager}.response();
+    if (responses[i]) {
+      replies++;
+    }
+  }
+  return replies;
+}
+
 DataBuffer::Ptr UDPRequestHandler::error_response(uint8_t error_code) {
   return std::make_unique<ErrorResponseBuffer>(error_code);
 }
 
 DataBuffer::Ptr UDPRequestHandler::process_hello_request() {
-  SPDLOG_INFO("Hello request");
+  SPDLOG_DEBUG("Hello request");
 
   if (request_buffer_ptr_->size() < sizeof(beatled_message_hello_request_t)) {
     SPDLOG_ERROR("Hello request too small: {} bytes (expected {})", request_buffer_ptr_->size(),
@@ -96,11 +116,20 @@ DataBuffer::Ptr UDPRequestHandler::process_hello_request() {
     return error_response(BEATLED_ERROR_VERSION_MISMATCH);
   }
 
+  // Controllers repeat HELLO as a heartbeat: a board already registered at
+  // this address only needs its timestamp refreshed
+  ClientStatus::board_id_t board_id;
+  std::copy_n(hello_req.board_id, board_id.size(), board_id.begin());
+  if (auto registered = state_manager_.refresh_client(
+          board_id, request_buffer_ptr_->remote_endpoint().address(), Clock::wall_time_us_64())) {
+    return std::make_unique<HelloResponseBuffer>(registered->client_id);
+  }
+
   ClientStatus::Ptr cs = std::make_shared<ClientStatus>(
-      hello_req.board_id, request_buffer_ptr_->remote_endpoint().address());
+      board_id, request_buffer_ptr_->remote_endpoint().address());
   cs->last_status_time = Clock::wall_time_us_64();
   // Remember the full endpoint (incl. ephemeral port) for unicast delivery.
-  cs->endpoint = request_buffer_ptr_->remote_endpoint();
+  cs->set_endpoint(request_buffer_ptr_->remote_endpoint());
 
   cs->protocol_version_major = hello_req.version_major;
   cs->protocol_version_minor = hello_req.version_minor;
@@ -121,32 +150,52 @@ DataBuffer::Ptr UDPRequestHandler::process_hello_request() {
 }
 
 DataBuffer::Ptr UDPRequestHandler::process_time_request() {
-  SPDLOG_INFO("Time request");
+  SPDLOG_DEBUG("Time request");
 
   if (request_buffer_ptr_->size() < sizeof(beatled_message_time_request_t)) {
     SPDLOG_ERROR("Time request too small: {} bytes", request_buffer_ptr_->size());
     return error_response(BEATLED_ERROR_NO_DATA);
   }
 
-  using namespace std::chrono;
-  uint64_t ms_start = Clock::time_us_64();
-
-  auto cs = state_manager_.client_status(request_buffer_ptr_->remote_endpoint().address());
-  if (cs) {
-    cs->last_status_time = Clock::wall_time_us_64();
-  }
+  const uint64_t recv_time = receive_time();
+  state_manager_.touch_client(request_buffer_ptr_->remote_endpoint(), Clock::wall_time_us_64());
 
   beatled_message_time_request_t time_req_msg;
   std::memcpy(&time_req_msg, request_buffer_ptr_->data().data(), sizeof(time_req_msg));
 
   uint64_t orig_time = ntohll(time_req_msg.orig_time);
 
-  SPDLOG_INFO("Sending time request. (n) \n - orig_time: {0} / {0:x}", orig_time);
-  return std::make_unique<TimeResponseBuffer>(orig_time, ms_start, Clock::time_us_64());
+  SPDLOG_DEBUG("Sending time request. (n) \n - orig_time: {0} / {0:x}", orig_time);
+  // UDPServer stamps xmit_time again right before the send
+  return std::make_unique<TimeResponseBuffer>(orig_time, recv_time, Clock::time_us_64());
+}
+
+DataBuffer::Ptr UDPRequestHandler::process_time_burst_request() {
+  if (request_buffer_ptr_->size() < sizeof(beatled_message_time_burst_request_t)) {
+    SPDLOG_ERROR("Time burst request too small: {} bytes", request_buffer_ptr_->size());
+    return error_response(BEATLED_ERROR_NO_DATA);
+  }
+
+  const uint64_t recv_time = receive_time();
+  state_manager_.touch_client(request_buffer_ptr_->remote_endpoint(), Clock::wall_time_us_64());
+
+  beatled_message_time_burst_request_t burst_req_msg;
+  std::memcpy(&burst_req_msg, request_buffer_ptr_->data().data(), sizeof(burst_req_msg));
+
+  SPDLOG_DEBUG("Time burst request {}", burst_req_msg.index);
+  return std::make_unique<TimeBurstResponseBuffer>(ntohll(burst_req_msg.orig_time), recv_time,
+                                                   Clock::time_us_64(), burst_req_msg.index);
+}
+
+uint64_t UDPRequestHandler::receive_time() const {
+  // The kernel's receive timestamp leaves out the time the request spent
+  // queued on the socket; the clock here is the fallback without one
+  return request_buffer_ptr_->receive_time_us() != 0 ? request_buffer_ptr_->receive_time_us()
+                                                     : Clock::time_us_64();
 }
 
 DataBuffer::Ptr UDPRequestHandler::process_tempo_request() {
-  SPDLOG_INFO("Tempo request");
+  SPDLOG_DEBUG("Tempo request");
 
   if (request_buffer_ptr_->size() < sizeof(beatled_message_tempo_request_t)) {
     SPDLOG_ERROR("Tempo request too small: {} bytes", request_buffer_ptr_->size());
@@ -158,15 +207,14 @@ DataBuffer::Ptr UDPRequestHandler::process_tempo_request() {
   const auto remote = request_buffer_ptr_->remote_endpoint();
   uint32_t owd_us = ntohl(tempo_req.owd_us_estimate);
 
-  auto cs = state_manager_.client_status(remote.address());
+  // Also tracks the latest endpoint (the ephemeral source port can shift on
+  // FreeRTOS sockets across reboots).
+  auto cs = state_manager_.touch_client(remote, Clock::wall_time_us_64());
   if (cs) {
-    cs->last_status_time = Clock::wall_time_us_64();
-    // Track the latest endpoint too (the ephemeral source port can shift on
-    // FreeRTOS sockets across reboots).
-    cs->endpoint = remote;
     // Protocol v4: decode the trailing diagnostic block into
     // ClientStatus::QosSnapshot. STATUS_RESPONSE shares the same helper.
-    decode_qos_block(tempo_req.qos, cs->latest_qos);
+    cs->update_qos(
+        [&tempo_req](ClientStatus::QosSnapshot &qos) { decode_qos_block(tempo_req.qos, qos); });
   }
   if (owd_us > 0) {
     state_manager_.update_client_owd(remote.address(), owd_us);
@@ -188,21 +236,22 @@ DataBuffer::Ptr UDPRequestHandler::process_status_response() {
   std::memcpy(&resp, request_buffer_ptr_->data().data(), sizeof(resp));
   const auto remote = request_buffer_ptr_->remote_endpoint();
 
-  auto cs = state_manager_.client_status(remote.address());
+  auto cs = state_manager_.touch_client(remote, Clock::wall_time_us_64());
   if (cs) {
-    cs->last_status_time = Clock::wall_time_us_64();
-    cs->endpoint = remote;
-    decode_qos_block(resp.qos, cs->latest_qos);
     // Fresh server-controlled RTT measurement: now − echoed send-time.
     const uint64_t send_time = ntohll(resp.echo_server_send_time_us);
-    const uint64_t now = Clock::wall_time_us_64();
-    if (now > send_time) {
-      const uint64_t rtt = now - send_time;
-      cs->latest_qos.last_rtt_us = rtt > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rtt);
-    }
+    ClientStatus::QosSnapshot stored;
+    cs->update_qos([&](ClientStatus::QosSnapshot &qos) {
+      decode_qos_block(resp.qos, qos);
+      const uint64_t now = Clock::wall_time_us_64();
+      if (now > send_time) {
+        const uint64_t rtt = now - send_time;
+        qos.last_rtt_us = rtt > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rtt);
+      }
+      stored = qos;
+    });
     SPDLOG_DEBUG("Status response from {}: rtt_us={} median_rtt_us={}",
-                 remote.address().to_string(), cs->latest_qos.last_rtt_us,
-                 cs->latest_qos.median_rtt_us);
+                 fmt::streamed(remote.address()), stored.last_rtt_us, stored.median_rtt_us);
   } else {
     // STATUS_RESPONSE from an unknown source — controller hasn't said
     // HELLO yet, or we restarted between probe and reply. Log + drop.
@@ -2,6 +2,7 @@
 #define UDP__REQUEST_HANDLER_HPP
 
 #include <asio.hpp>
+#include <span>
 #include <vector>
 
 #include "core/state_manager.hpp"
@@ -16,12 +17,22 @@ public:
   UDPRequestHandler(UDPRequestBuffer *request_buffer_ptr, StateManager &state_manager);
   DataBuffer::Ptr response();
 
+  // Handles a batch of received datagrams in arrival order: responses[i] is
+  // the reply to requests[i] (null when the message needs none). Returns the
+  // number of replies.
+  static std::size_t handle_batch(std::span<UDPRequestBuffer> requests,
+                                  std::span<DataBuffer::Ptr> responses,
+                                  StateManager &state_manager);
+
 private:
   DataBuffer::Ptr process_tempo_request();
   DataBuffer::Ptr process_time_request();
+  DataBuffer::Ptr process_time_burst_request();
   DataBuffer::Ptr process_hello_request();
   DataBuffer::Ptr process_status_response();
   DataBuffer::Ptr error_response(uint8_t error_code);
+  // When the request reached the server, for the TIME recv_time
+  uint64_t receive_time() const;
 
   UDPRequestBuffer *request_buffer_ptr_;
   StateManager &state_manager_;
@@ -1,76 +1,287 @@
+#include <algorithm>
 #include <array>
 #include <asio/signal_set.hpp>
 #include <asio/ts/buffer.hpp>
 #include <asio/ts/internet.hpp>
+#include <chrono>
 #include <cstdlib>
 #include <fmt/ostream.h>
 #include <spdlog/spdlog.h>
 #include <string>
 
+#include "receive_timestamp.hpp"
+#include "udp/handler_memory.hpp"
 #include "udp/udp_buffer.hpp"
+#include "udp_batch.hpp"
 #include "udp_request_handler.hpp"
 #include "udp_server/udp_server.hpp"
 
 using namespace beatled::server;
 using asio::ip::udp;
+using beatled::core::Clock;
+using beatled::core::DEVICE_SWEEP_PERIOD_US;
+
+// One socket and its receive loop. A shard never has more than one receive
+// pending, so its handlers run one at a time (on whichever pool thread) and
+// its batch needs no lock; separate shards run on separate threads.
+struct UDPServer::Shard {
+  Shard(asio::io_context &io_context, std::uint16_t port, bool reuse_port,
+        const parameters_t &parameters)
+      : socket{io_context} {
+    socket.open(udp::v4());
+#if defined(__linux__)
+    if (reuse_port) {
+      socket.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    }
+    if (parameters.kernel_timestamps) {
+      // Without them, receive times fall back to the clock in the handler
+      asio::error_code ec;
+      socket.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_TIMESTAMPNS>(true),
+                        ec);
+      if (ec) {
+        SPDLOG_WARN("UDP kernel receive timestamps unavailable: {}", ec.message());
+      }
+    }
+    if (parameters.batch_size > 1) {
+      batch = std::make_unique<UDPBatch>(parameters.batch_size);
+    }
+#endif
+    socket.bind(udp::endpoint(udp::v4(), port));
+  }
+
+  udp::socket socket;
+  std::unique_ptr<UDPBatch> batch;
+  // One receive is pending at a time; sends rarely overlap
+  std::shared_ptr<HandlerMemory> receive_memory = std::make_shared<HandlerMemory>();
+  std::shared_ptr<HandlerMemory> send_memory = std::make_shared<HandlerMemory>();
+};
 
 UDPServer::UDPServer(const std::string &id, asio::io_context &io_context,
                      const parameters_t &server_parameters, StateManager &state_manager)
-    : ServiceControllerInterface{id},
-      socket_{io_context, udp::endpoint(udp::v4(), server_parameters.port)},
-      state_manager_{state_manager} {
+    : ServiceControllerInterface{id}, expiry_timer_{io_context}, state_manager_{state_manager} {
   SPDLOG_INFO("Creating {}", name());
+  std::size_t shards = std::max<std::size_t>(server_parameters.shards, 1);
+#if !defined(__linux__)
+  if (server_parameters.batch_size > 1) {
+    SPDLOG_WARN("{}: batched receive needs recvmmsg (Linux), handling one datagram at a time",
+                name());
+  }
+  if (shards > 1) {
+    // Elsewhere SO_REUSEPORT hands unicast datagrams to one socket only
+    SPDLOG_WARN("{}: sharding needs SO_REUSEPORT load balancing (Linux), using one socket",
+                name());
+    shards = 1;
+  }
+#endif
+
+  // The first shard resolves port 0 to the port the others share
+  const bool reuse_port = shards > 1;
+  shards_.push_back(
+      std::make_unique<Shard>(io_context, server_parameters.port, reuse_port, server_parameters));
+  const auto port = shards_.front()->socket.local_endpoint().port();
+  while (shards_.size() < shards) {
+    shards_.push_back(std::make_unique<Shard>(io_context, port, reuse_port, server_parameters));
+  }
+}
+
+UDPServer::~UDPServer() = default;
+
+asio::ip::udp::endpoint UDPServer::local_endpoint() const {
+  return shards_.front()->socket.local_endpoint();
 }
 
 void UDPServer::start_sync() {
-  SPDLOG_INFO("{}: listening on {}", name(), fmt::streamed(socket_.local_endpoint()));
-  do_receive();
+  SPDLOG_INFO("{}: listening on {} ({} socket{})", name(), fmt::streamed(local_endpoint()),
+              shards_.size(), shards_.size() > 1 ? "s" : "");
+  schedule_client_expiry();
+  for (const auto &shard : shards_) {
+#if defined(__linux__)
+    if (shard->batch) {
+      do_receive_batch(*shard);
+      continue;
+    }
+#endif
+    do_receive(*shard);
+  }
+#if defined(__linux__)
+  if (shards_.front()->batch) {
+    SPDLOG_INFO("{}: handling up to {} datagrams per wakeup", name(),
+                shards_.front()->batch->capacity());
+  }
+#endif
 }
 void UDPServer::stop_sync() {
-  socket_.cancel();
+  expiry_timer_.cancel();
+  for (const auto &shard : shards_) {
+    shard->socket.cancel();
+  }
 }
 
-void UDPServer::do_receive() {
+// Clients that stopped talking are dropped here, off the lookup path
+void UDPServer::schedule_client_expiry() {
+  expiry_timer_.expires_after(std::chrono::microseconds(DEVICE_SWEEP_PERIOD_US));
+  expiry_timer_.async_wait([this](const asio::error_code &error) {
+    if (error == asio::error::operation_aborted) {
+      return;
+    }
+    if (error) {
+      SPDLOG_ERROR("Client expiry timer error: {}", error.message());
+      return;
+    }
+    state_manager_.expire_clients(Clock::wall_time_us_64());
+    if (is_running()) {
+      schedule_client_expiry();
+    }
+  });
+}
+
+#if defined(__linux__)
+
+// asio waits for the socket to be readable; the datagram itself is read with
+// recvmsg, which also returns its kernel receive timestamp
+void UDPServer::do_receive(Shard &shard) {
+  shard.socket.async_wait(
+      udp::socket::wait_read,
+      make_pooled_handler(shard.receive_memory, [this, &shard](std::error_code ec) {
+        if (ec == asio::error::operation_aborted) {
+          return;
+        }
+        if (ec) {
+          SPDLOG_ERROR("UDP receive error: {}", ec.message());
+          do_receive(shard);
+          return;
+        }
+
+        auto request_buffer_ptr = std::make_unique<UDPRequestBuffer>();
+        const std::size_t bytes_recvd =
+            receive_datagram(shard.socket.native_handle(), *request_buffer_ptr, ec);
+        if (ec) {
+          SPDLOG_ERROR("UDP receive error: {}", ec.message());
+        } else if (bytes_recvd > 0) {
+          handle_request(shard, std::move(request_buffer_ptr));
+        }
+
+        do_receive(shard);
+      }));
+}
+
+#else // !defined(__linux__)
+
+void UDPServer::do_receive(Shard &shard) {
   std::unique_ptr<UDPRequestBuffer> request_buffer_ptr = std::make_unique<UDPRequestBuffer>();
+  // The handler takes ownership, and arguments are evaluated in no
+  // particular order: don't read through request_buffer_ptr next to the move
+  UDPRequestBuffer &request_buffer = *request_buffer_ptr;
 
-  socket_.async_receive_from(
-      asio::buffer(request_buffer_ptr->data(), request_buffer_ptr->BUFFER_SIZE),
-      request_buffer_ptr->remote_endpoint(),
-      [this, request_buffer_ptr = std::move(request_buffer_ptr)](std::error_code ec,
-                                                                 std::size_t bytes_recvd) mutable {
-        if (!ec && bytes_recvd > 0) {
-
-          SPDLOG_INFO("Received request from {}",
-                      fmt::streamed(request_buffer_ptr->remote_endpoint()));
-
-          request_buffer_ptr->setSize(bytes_recvd);
-
-          UDPRequestHandler requestHandler{request_buffer_ptr.get(), state_manager_};
-
-          DataBuffer::Ptr response_buffer_ptr = requestHandler.response();
-
-          if (response_buffer_ptr) {
-            SPDLOG_INFO("Sending response: {::x} to {}", *response_buffer_ptr,
-                        fmt::streamed(request_buffer_ptr->remote_endpoint()));
-
-            // Capture response_buffer_ptr to keep it alive until send completes.
-            socket_.async_send_to(
-                asio::buffer(response_buffer_ptr->data(), response_buffer_ptr->size()),
-                request_buffer_ptr->remote_endpoint(),
-                [resp = std::move(response_buffer_ptr)](std::error_code /*ec*/,
-                                                        std::size_t /*bytes_sent*/) {});
-          } else {
-            // Some message types (e.g. STATUS_RESPONSE — controller's reply to
-            // the server's STATUS probe) are terminal and need no reply.
-            SPDLOG_DEBUG("No response to send for request from {}",
-                         fmt::streamed(request_buffer_ptr->remote_endpoint()));
-          }
+  shard.socket.async_receive_from(
+      asio::buffer(request_buffer.data(), request_buffer.BUFFER_SIZE),
+      request_buffer.remote_endpoint(),
+      make_pooled_handler(
+          shard.receive_memory,
+          [this, &shard, request_buffer_ptr = std::move(request_buffer_ptr)](
+              std::error_code ec, std::size_t bytes_recvd) mutable {
+            if (!ec && bytes_recvd > 0) {
+              request_buffer_ptr->setSize(bytes_recvd);
+              handle_request(shard, std::move(request_buffer_ptr));
+            }
+
+            if (ec) {
+              SPDLOG_ERROR("UDP receive error: {}", ec.message());
+            }
+
+            do_receive(shard);
+          }));
+}
+
+#endif // defined(__linux__)
+
+void UDPServer::handle_request(Shard &shard, std::unique_ptr<UDPRequestBuffer> request_buffer_ptr) {
+  SPDLOG_DEBUG("Received request from {}", fmt::streamed(request_buffer_ptr->remote_endpoint()));
+
+  UDPRequestHandler requestHandler{request_buffer_ptr.get(), state_manager_};
+
+  DataBuffer::Ptr response_buffer_ptr = requestHandler.response();
+
+  if (response_buffer_ptr) {
+    SPDLOG_DEBUG("Sending response: {::x} to {}", *response_buffer_ptr,
+                 fmt::streamed(request_buffer_ptr->remote_endpoint()));
+
+    // asio tries the send right away, so this is as late as xmit_time gets
+    response_buffer_ptr->set_transmit_time(Clock::time_us_64());
+
+    // Capture response_buffer_ptr to keep it alive until send completes.
+    const DataBuffer &response_buffer = *response_buffer_ptr;
+    shard.socket.async_send_to(
+        asio::buffer(response_buffer.data(), response_buffer.size()),
+        request_buffer_ptr->remote_endpoint(),
+        make_pooled_handler(shard.send_memory,
+                            [resp = std::move(response_buffer_ptr)](std::error_code /*ec*/,
+                                                                    std::size_t /*bytes_sent*/) {}));
+  } else {
+    // Some message types (e.g. STATUS_RESPONSE — controller's reply to
+    // the server's STATUS probe) are terminal and need no reply.
+    SPDLOG_DEBUG("No response to send for request from {}",
+                 fmt::streamed(request_buffer_ptr->remote_endpoint()));
+  }
+}
+
+#if defined(__linux__)
+
+// asio waits for the socket to be readable without losing a wakeup. Whatever
+// queued up is then drained with recvmmsg, handled in order, and answered
+// with one sendmmsg.
+void UDPServer::do_receive_batch(Shard &shard) {
+  shard.socket.async_wait(
+      udp::socket::wait_read,
+      make_pooled_handler(shard.receive_memory, [this, &shard](std::error_code ec) {
+        if (ec == asio::error::operation_aborted) {
+          return;
+        }
+        if (ec) {
+          SPDLOG_ERROR("UDP receive error: {}", ec.message());
+          do_receive_batch(shard);
+          return;
         }
 
+        UDPBatch &batch = *shard.batch;
+        const std::size_t count = batch.receive(shard.socket.native_handle(), 0, ec);
         if (ec) {
           SPDLOG_ERROR("UDP receive error: {}", ec.message());
         }
 
-        do_receive();
-      });
+        if (count > 0) {
+          const std::size_t replies = UDPRequestHandler::handle_batch(
+              batch.requests(count), batch.responses(count), state_manager_);
+          SPDLOG_DEBUG("Handled {} requests, {} replies", count, replies);
+          if (replies > 0) {
+            send_batch(shard, count);
+          }
+        }
+
+        do_receive_batch(shard);
+      }));
 }
+
+void UDPServer::send_batch(Shard &shard, std::size_t count) {
+  UDPBatch &batch = *shard.batch;
+  std::error_code ec;
+  batch.send(shard.socket.native_handle(), count, ec);
+  if (ec) {
+    SPDLOG_ERROR("UDP send error: {}", ec.message());
+  }
+
+  // Replies that didn't fit in the socket's send buffer wait for it to drain,
+  // one at a time as the per-datagram path sends them
+  auto responses = batch.responses(count);
+  for (std::size_t i = 0; i < count; i++) {
+    if (!responses[i]) {
+      continue;
+    }
+    DataBuffer &response = *responses[i];
+    shard.socket.async_send_to(
+        asio::buffer(response.data(), response.size()), batch.request(i).remote_endpoint(),
+        [resp = std::move(responses[i])](std::error_code /*ec*/, std::size_t /*bytes_sent*/) {});
+  }
+}
+
+#endif // defined(__linux__)
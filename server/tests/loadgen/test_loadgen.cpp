@@ -0,0 +1,190 @@
+// The swarm against an in-process UDP server and unicast broadcaster on
+// loopback. Virtual controllers use 127.0.0.x source addresses, which Linux
+// routes to lo without configuration.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <asio.hpp>
+#include <chrono>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "core/beat_schedule.hpp"
+#include "core/clock.hpp"
+#include "core/state_manager.hpp"
+#include "loadgen/swarm.hpp"
+#include "tempo_broadcaster/tempo_broadcaster.hpp"
+#include "udp_server/udp_server.hpp"
+
+using namespace std::chrono_literals;
+using beatled::core::BeatSchedule;
+using beatled::core::Clock;
+using beatled::core::StateManager;
+using beatled::loadgen::Swarm;
+using beatled::server::BroadcastMode;
+using beatled::server::TempoBroadcaster;
+using beatled::server::UDPServer;
+
+namespace {
+
+constexpr std::size_t CONTROLLERS = 20;
+
+class LoopbackServer {
+public:
+  // A BEAT_SCHEDULE every `beat_schedule_every` beats instead of NEXT_BEATs
+  explicit LoopbackServer(uint16_t beat_schedule_every = 0)
+      : server_{"udp", io_context_, {0, 16}, state_manager_},
+        broadcaster_{"tempo",
+                     io_context_,
+                     500ms,
+                     200ms,
+                     {"127.0.0.1", 0, BroadcastMode::Unicast, 1, "", beat_schedule_every},
+                     state_manager_} {
+    state_manager_.update_tempo(120, Clock::time_us_64());
+    server_.start();
+    broadcaster_.start();
+    thread_ = std::thread{[this]() { io_context_.run(); }};
+  }
+
+  ~LoopbackServer() {
+    broadcaster_.stop();
+    server_.stop();
+    io_context_.stop();
+    thread_.join();
+  }
+
+  uint16_t port() const { return server_.local_endpoint().port(); }
+
+  std::size_t clients() const { return state_manager_.get_clients()->size(); }
+
+  void broadcast_next_beat(uint32_t beat_count) {
+    broadcaster_.broadcast_next_beat(Clock::time_us_64() + 100000, beat_count);
+  }
+
+  void broadcast_beat_schedule(uint32_t beat_count) {
+    broadcaster_.broadcast_beat_schedule(
+        BeatSchedule{Clock::time_us_64() + 100000, beat_count, 500000, -1000, 4});
+  }
+
+private:
+  asio::io_context io_context_;
+  StateManager state_manager_;
+  UDPServer server_;
+  TempoBroadcaster broadcaster_;
+  std::thread thread_;
+};
+
+Swarm::parameters_t swarm_parameters(uint16_t port) {
+  Swarm::parameters_t parameters;
+  parameters.server_port = port;
+  parameters.controllers = CONTROLLERS;
+  parameters.threads = 2;
+  parameters.time_rate_hz = 20;
+  parameters.tempo_rate_hz = 5;
+  parameters.ramp_us = 200000;
+  parameters.duration_us = 1500000;
+  parameters.drain_us = 300000;
+  return parameters;
+}
+
+bool wait_for_clients(const LoopbackServer &server, std::size_t count) {
+  const auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (server.clients() < count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Every virtual controller registers, syncs and gets every beat", "[loadgen]") {
+  spdlog::set_level(spdlog::level::warn);
+  LoopbackServer server;
+  Swarm swarm{swarm_parameters(server.port())};
+  auto report = std::async(std::launch::async, [&swarm]() { return swarm.run(); });
+
+  REQUIRE(wait_for_clients(server, CONTROLLERS));
+  constexpr uint32_t BEATS = 10;
+  for (uint32_t beat = 0; beat < BEATS; beat++) {
+    server.broadcast_next_beat(beat);
+    std::this_thread::sleep_for(50ms);
+  }
+
+  const Swarm::Report result = report.get();
+  REQUIRE(result.registered == CONTROLLERS);
+  REQUIRE(result.errors == 0);
+  REQUIRE(result.send_failures == 0);
+
+  REQUIRE(result.time_sent > CONTROLLERS * 20);
+  REQUIRE(result.time_answered == result.time_sent);
+  REQUIRE(result.time_rtt.count == result.time_answered);
+  REQUIRE(result.time_rtt.p50_us < 100000);
+  REQUIRE(result.tempo_answered == result.tempo_sent);
+  REQUIRE(result.tempo_rtt.count == result.tempo_answered);
+
+  REQUIRE(result.next_beats == CONTROLLERS * BEATS);
+  REQUIRE(result.next_beat_gaps == 0);
+  REQUIRE(result.next_beat_loss() == 0.0);
+  REQUIRE(result.next_beat_spread.count == result.next_beats);
+  REQUIRE(result.late_next_beats == 0);
+  REQUIRE(result.beat_schedules == 0);
+  REQUIRE(result.programs > 0);
+  REQUIRE(result.status_probes > 0);
+}
+
+TEST_CASE("Beat schedules are counted and checked like NEXT_BEATs", "[loadgen]") {
+  spdlog::set_level(spdlog::level::warn);
+  LoopbackServer server{1};
+  Swarm swarm{swarm_parameters(server.port())};
+  auto report = std::async(std::launch::async, [&swarm]() { return swarm.run(); });
+
+  REQUIRE(wait_for_clients(server, CONTROLLERS));
+  constexpr uint32_t BEATS = 10;
+  for (uint32_t beat = 0; beat < BEATS; beat++) {
+    // Schedules replace NEXT_BEAT on the wire
+    server.broadcast_next_beat(beat);
+    server.broadcast_beat_schedule(beat);
+    std::this_thread::sleep_for(50ms);
+  }
+
+  const Swarm::Report result = report.get();
+  REQUIRE(result.registered == CONTROLLERS);
+  REQUIRE(result.next_beats == 0);
+  REQUIRE(result.beat_schedules == CONTROLLERS * BEATS);
+  REQUIRE(result.beat_schedule_gaps == 0);
+  REQUIRE(result.beat_schedule_loss() == 0.0);
+  REQUIRE(result.beat_schedule_spread.count == result.beat_schedules);
+  REQUIRE(result.late_beat_schedules == 0);
+  REQUIRE(result.beat_schedule_lead.count > 0);
+}
+
+TEST_CASE("Injected loss drops requests and replies but not registrations", "[loadgen]") {
+  spdlog::set_level(spdlog::level::warn);
+  LoopbackServer server;
+  Swarm::parameters_t parameters = swarm_parameters(server.port());
+  parameters.source_address = "127.0.1.2";
+  parameters.hello_retry_us = 100000;
+  parameters.loss = 0.2;
+  parameters.jitter_us = 2000;
+  const Swarm::Report result = Swarm{parameters}.run();
+
+  // HELLO is retried until it gets through
+  REQUIRE(result.registered == CONTROLLERS);
+  REQUIRE(result.injected_drops > 0);
+  // Either leg is dropped 1 time in 5: 36% of the requests go unanswered
+  REQUIRE(result.time_loss() > 0.2);
+  REQUIRE(result.time_loss() < 0.5);
+  REQUIRE(result.time_rtt.count == result.time_answered);
+}
+
+TEST_CASE("A swarm needs local source addresses", "[loadgen]") {
+  Swarm::parameters_t parameters;
+  parameters.controllers = 2;
+  parameters.source_address = "192.0.2.1";
+  REQUIRE_THROWS_AS(Swarm{parameters}.run(), std::runtime_error);
+}
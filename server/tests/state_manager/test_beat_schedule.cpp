@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+#include <core/beat_schedule.hpp>
+
+using beatled::core::BeatSchedule;
+using beatled::core::BeatScheduleTracker;
+
+namespace {
+
+double bpm_of(double period_us) { return 60.0 * 1000000.0 / period_us; }
+
+} // namespace
+
+TEST_CASE("BeatSchedule places beats along its ramp", "[beat_schedule]") {
+  const BeatSchedule schedule{1000000, 10, 500000, 2000, 4};
+  REQUIRE(schedule.time_of(10) == 1000000);
+  REQUIRE(schedule.time_of(9) == 500000);
+  REQUIRE(schedule.time_of(11) == 1500000);
+  // Periods 500000, 500002, 500004, 500006, 500006
+  REQUIRE(schedule.time_of(14) == 3000012);
+  REQUIRE(schedule.time_of(15) == 3500018);
+}
+
+TEST_CASE("BeatScheduleTracker follows the tempo source", "[beat_schedule]") {
+  BeatScheduleTracker tracker{4};
+
+  SECTION("A steady tempo gives a flat schedule") {
+    BeatSchedule schedule;
+    for (uint32_t beat = 1; beat <= 8; beat++) {
+      schedule = tracker.update(beat * 500000ULL, 120.0, beat);
+    }
+    REQUIRE(schedule.beat_time_ref == 4000000);
+    REQUIRE(schedule.beat_count == 8);
+    REQUIRE(schedule.tempo_period_us == 500000);
+    REQUIRE(schedule.period_slope_ns == 0);
+    REQUIRE(schedule.beat_span == 4);
+  }
+
+  SECTION("A ramp carries forward as a slope") {
+    // The period shrinks by 1 ms a beat: the slope closes in on -1 ms
+    int32_t previous = 0;
+    for (uint32_t beat = 1; beat <= 12; beat++) {
+      const BeatSchedule schedule = tracker.update(0, bpm_of(500000.0 - beat * 1000.0), beat);
+      REQUIRE(schedule.period_slope_ns <= previous);
+      REQUIRE(schedule.period_slope_ns >= -1000000);
+      previous = schedule.period_slope_ns;
+    }
+    REQUIRE(previous < -950000);
+  }
+
+  SECTION("The slope is limited to 1% of the period") {
+    tracker.update(0, 120.0, 1);
+    const BeatSchedule schedule = tracker.update(0, 60.0, 2);
+    REQUIRE(schedule.tempo_period_us == 1000000);
+    REQUIRE(schedule.period_slope_ns == 10000000);
+  }
+
+  SECTION("A gap or a reset starts the slope over") {
+    tracker.update(0, 120.0, 1);
+    REQUIRE(tracker.update(0, bpm_of(490000), 2).period_slope_ns != 0);
+    REQUIRE(tracker.update(0, bpm_of(480000), 2 + 1 + BeatScheduleTracker::kMaxGapBeats)
+                .period_slope_ns == 0);
+    tracker.reset();
+    REQUIRE(tracker.update(0, bpm_of(470000), 8).period_slope_ns == 0);
+  }
+
+  SECTION("No tempo gives no period") {
+    tracker.update(0, 120.0, 1);
+    const BeatSchedule schedule = tracker.update(500000, 0.0, 2);
+    REQUIRE(schedule.tempo_period_us == 0);
+    REQUIRE(schedule.period_slope_ns == 0);
+  }
+}
@@ -101,17 +101,19 @@ TEST_CASE("ClientStatus JSON serialization", "[client_status][json]") {
     auto cs = std::make_shared<ClientStatus>(board_id, ip_addr);
     cs->owd_us = 1500;
 
-    cs->latest_qos.valid = true;
-    cs->latest_qos.current_offset_us = -42;
-    cs->latest_qos.uptime_us = 9999;
-    cs->latest_qos.median_rtt_us = 1234;
-    cs->latest_qos.next_beat_gap_total = 3;
-    cs->latest_qos.intercore_drop_total = 1;
-    cs->latest_qos.time_sync_outlier_total = 5;
-    cs->latest_qos.valid_sample_count = 8;
-    cs->latest_qos.last_applied_program_seq = 7;
-    cs->latest_qos.server_received_at_us = 1700000000000000ULL;
-    cs->latest_qos.last_rtt_us = 555;
+    cs->update_qos([](ClientStatus::QosSnapshot &qos) {
+      qos.valid = true;
+      qos.current_offset_us = -42;
+      qos.uptime_us = 9999;
+      qos.median_rtt_us = 1234;
+      qos.next_beat_gap_total = 3;
+      qos.intercore_drop_total = 1;
+      qos.time_sync_outlier_total = 5;
+      qos.valid_sample_count = 8;
+      qos.last_applied_program_seq = 7;
+      qos.server_received_at_us = 1700000000000000ULL;
+      qos.last_rtt_us = 555;
+    });
 
     json j = *cs;
     REQUIRE(j["owd_us"] == 1500u);
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+#include <core/latency_metrics.hpp>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+using beatled::core::LatencyHistogram;
+using beatled::core::LatencyMetrics;
+using beatled::core::LatencyStage;
+using beatled::core::StartupStage;
+
+TEST_CASE("LatencyHistogram buckets", "[latency]") {
+  SECTION("Small values are exact") {
+    for (uint64_t v = 0; v < LatencyHistogram::kLinearBuckets; v++) {
+      REQUIRE(LatencyHistogram::bucket_upper_bound(LatencyHistogram::bucket_index(v)) == v);
+    }
+  }
+
+  SECTION("Every value falls in a bucket that covers it, within ~3%") {
+    for (uint64_t v = 1; v < (1ULL << 36); v = v * 3 / 2 + 1) {
+      const auto index = LatencyHistogram::bucket_index(v);
+      REQUIRE(index < LatencyHistogram::kBucketCount);
+      const uint64_t upper = LatencyHistogram::bucket_upper_bound(index);
+      REQUIRE(upper >= v);
+      REQUIRE(upper - v <= v / 32 + 1);
+    }
+  }
+
+  SECTION("Buckets are contiguous") {
+    for (std::size_t i = 1; i < LatencyHistogram::kBucketCount; i++) {
+      const uint64_t first = LatencyHistogram::bucket_upper_bound(i - 1) + 1;
+      REQUIRE(LatencyHistogram::bucket_index(first) == i);
+    }
+  }
+
+  SECTION("Huge values are clamped to the last bucket") {
+    REQUIRE(LatencyHistogram::bucket_index(UINT64_MAX) == LatencyHistogram::kBucketCount - 1);
+  }
+}
+
+TEST_CASE("LatencyHistogram snapshot", "[latency]") {
+  LatencyHistogram histogram;
+  REQUIRE(histogram.snapshot().count == 0);
+
+  // 1..1000 us
+  for (uint64_t v = 1; v <= 1000; v++) {
+    histogram.record(v);
+  }
+  auto snapshot = histogram.snapshot();
+  REQUIRE(snapshot.count == 1000);
+  REQUIRE(snapshot.min_us == 1);
+  REQUIRE(snapshot.max_us == 1000);
+  REQUIRE(snapshot.mean_us == 500.5);
+  REQUIRE(snapshot.p50_us >= 500);
+  REQUIRE(snapshot.p50_us <= 516);
+  REQUIRE(snapshot.p99_us >= 990);
+  REQUIRE(snapshot.p99_us <= 1000);
+  REQUIRE(snapshot.p999_us == 1000);
+
+  histogram.reset();
+  REQUIRE(histogram.snapshot().count == 0);
+}
+
+TEST_CASE("LatencyHistogram concurrent recording", "[latency]") {
+  LatencyHistogram histogram;
+  constexpr int kThreads = 4;
+  constexpr int kSamples = 20000;
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kThreads; t++) {
+    writers.emplace_back([&histogram, t]() {
+      for (int i = 0; i < kSamples; i++) {
+        histogram.record(static_cast<uint64_t>(t * 1000 + i % 1000));
+      }
+    });
+  }
+  // Snapshots taken while writers run must stay self-consistent
+  for (int i = 0; i < 100; i++) {
+    auto snapshot = histogram.snapshot();
+    REQUIRE(snapshot.p50_us <= snapshot.p99_us);
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+
+  auto snapshot = histogram.snapshot();
+  REQUIRE(snapshot.count == kThreads * kSamples);
+  REQUIRE(snapshot.min_us == 0);
+  REQUIRE(snapshot.max_us == (kThreads - 1) * 1000 + 999);
+}
+
+TEST_CASE("LatencyMetrics lead time and JSON", "[latency]") {
+  LatencyMetrics metrics;
+  metrics.record_delta(LatencyStage::Capture, 1000, 1250);
+  metrics.record_delta(LatencyStage::Queue, 1250, 1200); // clocks crossed
+  metrics.record_lead_time(50000, 20000);
+  metrics.record_lead_time(50000, 60000); // late
+
+  REQUIRE(metrics.histogram(LatencyStage::Capture).snapshot().max_us == 250);
+  REQUIRE(metrics.histogram(LatencyStage::Queue).snapshot().max_us == 0);
+  REQUIRE(metrics.histogram(LatencyStage::LeadTime).snapshot().count == 2);
+  REQUIRE(metrics.late_beats() == 1);
+
+  nlohmann::json j = metrics;
+  for (const char *stage : {"capture", "queue", "tracker", "post", "send"}) {
+    REQUIRE(j["stages"].contains(stage));
+  }
+  REQUIRE(j["stages"]["capture"]["count"] == 1);
+  REQUIRE(j["stages"]["capture"]["p50_us"] == 250);
+  REQUIRE(j["stages"]["tracker"]["count"] == 0);
+  REQUIRE(j["lead_time"]["max_us"] == 30000);
+  REQUIRE(j["late_beats"] == 1);
+  REQUIRE(j["startup"]["first_beat"]["count"] == 0);
+}
+
+TEST_CASE("LatencyMetrics startup times", "[latency]") {
+  LatencyMetrics metrics;
+  metrics.record_startup(StartupStage::TrackerSetup, 1200);
+  metrics.record_startup(StartupStage::FirstBeat, 2'400'000);
+
+  nlohmann::json j = metrics;
+  REQUIRE(j["startup"]["tracker_setup"]["max_us"] == 1200);
+  REQUIRE(j["startup"]["first_beat"]["count"] == 1);
+  REQUIRE(j["stages"]["tracker"]["count"] == 0);
+
+  metrics.reset();
+  REQUIRE(metrics.histogram(StartupStage::FirstBeat).snapshot().count == 0);
+}
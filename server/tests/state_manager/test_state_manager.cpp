@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <core/clock.hpp>
 #include <core/state_manager.hpp>
+#include <cstdio>
+#include <string>
 #include <thread>
 
 using beatled::core::ClientStatus;
@@ -198,7 +200,7 @@ TEST_CASE("StateManager initial defaults", "[state_manager]") {
   }
 
   SECTION("No clients registered initially") {
-    REQUIRE(sm.get_clients().empty());
+    REQUIRE(sm.get_clients()->empty());
   }
 }
 
@@ -217,7 +219,7 @@ TEST_CASE("StateManager zero tempo", "[state_manager]") {
 TEST_CASE("StateManager client expiry", "[state_manager]") {
   StateManager sm;
 
-  SECTION("Expired clients are removed by get_clients()") {
+  SECTION("Expired clients are removed by expire_clients()") {
     ClientStatus::board_id_t bid{};
     bid[0] = 'X';
     auto cs = std::make_shared<ClientStatus>(bid, asio::ip::make_address("10.0.0.1"));
@@ -225,23 +227,28 @@ TEST_CASE("StateManager client expiry", "[state_manager]") {
     cs->last_status_time = Clock::wall_time_us_64() - DEVICE_EXPIRY_US - 1000000ULL;
     sm.register_client(cs);
 
-    // Client is registered
+    // Client is registered until the next sweep: reads don't prune
     REQUIRE(sm.client_status(asio::ip::make_address("10.0.0.1")) != nullptr);
+    REQUIRE(sm.get_clients()->size() == 1);
 
-    // get_clients() should prune it
-    auto clients = sm.get_clients();
-    REQUIRE(clients.empty());
+    REQUIRE(sm.expire_clients(Clock::wall_time_us_64()) == 1);
+    REQUIRE(sm.get_clients()->empty());
+    REQUIRE(sm.client_status(asio::ip::make_address("10.0.0.1")) == nullptr);
+    REQUIRE(sm.client_status(bid) == nullptr);
   }
 
-  SECTION("Fresh clients are preserved by get_clients()") {
+  SECTION("Fresh clients are preserved by expire_clients()") {
     ClientStatus::board_id_t bid{};
     bid[0] = 'F';
     auto cs = std::make_shared<ClientStatus>(bid, asio::ip::make_address("10.0.0.2"));
     cs->last_status_time = Clock::wall_time_us_64();
     sm.register_client(cs);
 
-    auto clients = sm.get_clients();
-    REQUIRE(clients.size() == 1);
+    auto before = sm.get_clients();
+    REQUIRE(sm.expire_clients(Clock::wall_time_us_64()) == 0);
+    // Nothing expired, nothing republished
+    REQUIRE(sm.get_clients() == before);
+    REQUIRE(sm.get_clients()->size() == 1);
   }
 
   SECTION("Mixed fresh and expired clients - only fresh survive") {
@@ -257,9 +264,77 @@ TEST_CASE("StateManager client expiry", "[state_manager]") {
     fresh->last_status_time = Clock::wall_time_us_64();
     sm.register_client(fresh);
 
+    sm.expire_clients(Clock::wall_time_us_64());
+    auto clients = sm.get_clients();
+    REQUIRE(clients->size() == 1);
+    REQUIRE((*clients)[0]->ip_address == asio::ip::make_address("10.0.0.2"));
+  }
+}
+
+TEST_CASE("StateManager registry snapshots", "[state_manager]") {
+  StateManager sm;
+  const auto now = Clock::wall_time_us_64();
+  auto make_client = [now](char id, const char *ip, uint16_t port) {
+    ClientStatus::board_id_t bid{};
+    bid[0] = id;
+    auto cs = std::make_shared<ClientStatus>(bid, asio::ip::make_address(ip));
+    cs->last_status_time = now;
+    cs->set_endpoint(asio::ip::udp::endpoint(cs->ip_address, port));
+    return cs;
+  };
+
+  SECTION("A snapshot outlives later registrations") {
+    sm.register_client(make_client('A', "10.0.0.1", 9000));
+    auto snapshot = sm.get_clients();
+    sm.register_client(make_client('B', "10.0.0.2", 9000));
+
+    REQUIRE(snapshot->size() == 1);
+    REQUIRE(sm.get_clients()->size() == 2);
+    REQUIRE(snapshot->find(asio::ip::make_address("10.0.0.2")) == nullptr);
+  }
+
+  SECTION("Clients are indexed by address, endpoint and board id") {
+    // A big fleet
+    for (int i = 0; i < 1000; i++) {
+      ClientStatus::board_id_t bid{};
+      std::snprintf(bid.data(), bid.size(), "board-%d", i);
+      auto cs = std::make_shared<ClientStatus>(
+          bid, asio::ip::make_address("10.1." + std::to_string(i / 256) + "." +
+                                      std::to_string(i % 256)));
+      cs->last_status_time = now;
+      cs->set_endpoint(asio::ip::udp::endpoint(cs->ip_address, 9000));
+      sm.register_client(cs);
+    }
     auto clients = sm.get_clients();
-    REQUIRE(clients.size() == 1);
-    REQUIRE(clients[0]->ip_address == asio::ip::make_address("10.0.0.2"));
+    REQUIRE(clients->size() == 1000);
+
+    ClientStatus::board_id_t bid{};
+    std::snprintf(bid.data(), bid.size(), "board-%d", 700);
+    const auto address = asio::ip::make_address("10.1.2.188");
+    auto cs = sm.client_status(bid);
+    REQUIRE(cs);
+    REQUIRE(cs->ip_address == address);
+    REQUIRE(sm.client_status(address) == cs);
+    REQUIRE(clients->find(asio::ip::udp::endpoint(address, 9000)) == cs);
+    REQUIRE(clients->find(asio::ip::udp::endpoint(address, 9001)) == nullptr);
+  }
+
+  SECTION("touch_client follows a client to a new source port") {
+    auto cs = make_client('A', "10.0.0.1", 9000);
+    cs->last_status_time = 1;
+    sm.register_client(cs);
+
+    REQUIRE(sm.touch_client(asio::ip::udp::endpoint(cs->ip_address, 9000), now) == cs);
+    REQUIRE(cs->last_status_time == now);
+
+    const asio::ip::udp::endpoint moved(cs->ip_address, 9100);
+    REQUIRE(sm.touch_client(moved, now + 1) == cs);
+    REQUIRE(cs->endpoint() == moved);
+    REQUIRE(sm.get_clients()->find(moved) == cs);
+    REQUIRE(sm.get_clients()->find(asio::ip::udp::endpoint(cs->ip_address, 9000)) == nullptr);
+
+    REQUIRE(sm.touch_client(asio::ip::udp::endpoint(asio::ip::make_address("10.0.0.9"), 9000),
+                            now) == nullptr);
   }
 }
 
@@ -32,20 +32,30 @@ template <typename T> T parse_message(const std::vector<uint8_t> &datagram) {
   return msg;
 }
 
+const auto loopback = asio::ip::make_address_v4("127.0.0.1");
+const auto multicast_group = asio::ip::make_address_v4("239.255.66.76");
+
 // One loopback "controller": a bound UDP socket plus the ClientStatus
-// registration that points the broadcaster's unicast path at it.
+// registration that points the broadcaster's unicast path at it. In
+// multicast mode it binds the wildcard address (a socket bound to 127.0.0.1
+// never sees group traffic) and joins the group on the loopback interface.
 struct FakeController {
-  explicit FakeController(asio::io_context &io)
-      : socket(io, udp::endpoint(asio::ip::make_address_v4("127.0.0.1"), 0)) {
+  explicit FakeController(asio::io_context &io, bool multicast = false)
+      : socket(io, udp::endpoint(multicast ? asio::ip::address_v4::any() : loopback, 0)) {
+    if (multicast) {
+      socket.set_option(asio::ip::multicast::join_group(multicast_group, loopback));
+    }
     arm();
   }
 
-  void register_with(StateManager &sm) {
+  udp::endpoint endpoint() const { return {loopback, socket.local_endpoint().port()}; }
+
+  void register_with(StateManager &sm, char board = 'T') {
     ClientStatus::board_id_t bid{};
-    bid[0] = 'T';
-    auto cs = std::make_shared<ClientStatus>(bid, socket.local_endpoint().address());
+    bid[0] = board;
+    auto cs = std::make_shared<ClientStatus>(bid, endpoint().address());
     cs->last_status_time = Clock::wall_time_us_64();
-    cs->endpoint = socket.local_endpoint();
+    cs->set_endpoint(endpoint());
     sm.register_client(cs);
   }
 
@@ -64,12 +74,23 @@ struct FakeController {
 };
 
 struct Harness {
-  explicit Harness(std::chrono::nanoseconds status_probe_period = std::chrono::nanoseconds{0})
-      : controller(io), broadcaster("test", io, std::chrono::hours(1), status_probe_period,
-                                    {"127.0.0.1", 0, BroadcastMode::Unicast}, state_manager) {
+  explicit Harness(std::chrono::nanoseconds status_probe_period = std::chrono::nanoseconds{0},
+                   BroadcastMode mode = BroadcastMode::Unicast, uint16_t beat_schedule_every = 0)
+      : controller(io, mode == BroadcastMode::Multicast),
+        broadcaster("test", io, std::chrono::hours(1), status_probe_period,
+                    parameters(mode, controller, beat_schedule_every), state_manager) {
     controller.register_with(state_manager);
   }
 
+  static TempoBroadcaster::parameters_t
+  parameters(BroadcastMode mode, const FakeController &controller, uint16_t beat_schedule_every) {
+    if (mode == BroadcastMode::Multicast) {
+      return {multicast_group.to_string(), controller.endpoint().port(), mode, 1, "127.0.0.1",
+              beat_schedule_every};
+    }
+    return {"127.0.0.1", 0, mode, 1, "", beat_schedule_every};
+  }
+
   ~Harness() { broadcaster.stop(); }
 
   void run_for(std::chrono::milliseconds d) {
@@ -106,6 +127,47 @@ TEST_CASE("broadcast_next_beat unicasts NEXT_BEAT with incrementing seq", "[temp
   CHECK(ntohs(second.seq) == 1);
 }
 
+TEST_CASE("BEAT_SCHEDULE replaces NEXT_BEAT every N beats or when the grid moves",
+          "[tempo_broadcaster]") {
+  Harness h(std::chrono::nanoseconds{0}, BroadcastMode::Unicast, 4);
+  h.broadcaster.start();
+
+  constexpr uint64_t t0 = 1000000000ULL;
+  constexpr uint32_t period = 500000;
+  auto predict = [&](uint32_t beat, int64_t error_us = 0) {
+    const uint64_t t = t0 + beat * period + error_us;
+    h.broadcaster.broadcast_next_beat(t, beat);
+    h.broadcaster.broadcast_beat_schedule({t, beat, period, 0, 0});
+  };
+
+  // Beats 0..8 on the grid: schedules for 0, 4 and 8 only
+  for (uint32_t beat = 0; beat <= 8; beat++) {
+    predict(beat);
+  }
+  h.run_for(std::chrono::milliseconds(100));
+  REQUIRE(h.controller.received.size() == 3);
+  for (std::size_t i = 0; i < 3; i++) {
+    auto msg = parse_message<beatled_message_beat_schedule_t>(h.controller.received[i]);
+    CHECK(msg.base.type == BEATLED_MESSAGE_BEAT_SCHEDULE);
+    CHECK(ntohl(msg.beat_count) == 4 * i);
+    CHECK(ntohll(msg.beat_time_ref) == t0 + 4 * i * period);
+    CHECK(ntohl(msg.tempo_period_us) == period);
+    CHECK(ntohs(msg.seq) == i);
+  }
+
+  // Within tolerance of the grid: nothing. Off it: sent at once.
+  predict(9, 1500);
+  h.run_for(std::chrono::milliseconds(50));
+  REQUIRE(h.controller.received.size() == 3);
+  predict(10, 5000);
+  h.run_for(std::chrono::milliseconds(50));
+  REQUIRE(h.controller.received.size() == 4);
+  auto moved = parse_message<beatled_message_beat_schedule_t>(h.controller.received[3]);
+  CHECK(ntohl(moved.beat_count) == 10);
+  CHECK(ntohll(moved.beat_time_ref) == t0 + 10 * period + 5000);
+  CHECK(ntohs(moved.seq) == 3);
+}
+
 TEST_CASE("push_program_now sends twice with the same seq (50 ms retry)", "[tempo_broadcaster]") {
   Harness h;
   h.state_manager.update_program_id(3);
@@ -162,3 +224,58 @@ TEST_CASE("a stopped broadcaster drops broadcasts", "[tempo_broadcaster]") {
 
   CHECK(h.controller.received.empty());
 }
+
+TEST_CASE("multicast mode sends one packet per beat to the group", "[tempo_broadcaster]") {
+  Harness h(std::chrono::nanoseconds{0}, BroadcastMode::Multicast);
+  // More registered clients must not mean more sends: unicast mode would
+  // deliver one copy per registration to this socket
+  for (char board = 'A'; board < 'J'; board++) {
+    h.controller.register_with(h.state_manager, board);
+  }
+  h.broadcaster.start();
+
+  h.broadcaster.broadcast_next_beat(123456789ULL, 42);
+  h.broadcaster.broadcast_next_beat(123956789ULL, 43);
+  h.run_for(std::chrono::milliseconds(100));
+
+  REQUIRE(h.controller.received.size() == 2);
+  auto first = parse_message<beatled_message_next_beat_t>(h.controller.received[0]);
+  CHECK(first.base.type == BEATLED_MESSAGE_NEXT_BEAT);
+  CHECK(ntohll(first.next_beat_time_ref) == 123456789ULL);
+  CHECK(ntohs(first.seq) == 0);
+  auto second = parse_message<beatled_message_next_beat_t>(h.controller.received[1]);
+  CHECK(ntohs(second.seq) == 1);
+}
+
+TEST_CASE("multicast mode sends PROGRAM pushes and STATUS probes to the group",
+          "[tempo_broadcaster]") {
+  Harness h(std::chrono::milliseconds(40), BroadcastMode::Multicast);
+  for (char board = 'A'; board < 'J'; board++) {
+    h.controller.register_with(h.state_manager, board);
+  }
+  h.state_manager.update_program_id(5);
+  h.broadcaster.start();
+
+  h.broadcaster.push_program_now();
+  h.run_for(std::chrono::milliseconds(100));
+
+  std::size_t programs = 0;
+  std::size_t probes = 0;
+  for (const auto &datagram : h.controller.received) {
+    // beatled_message_t::type leads every message
+    programs += datagram.at(0) == BEATLED_MESSAGE_PROGRAM ? 1 : 0;
+    probes += datagram.at(0) == BEATLED_MESSAGE_STATUS_REQUEST ? 1 : 0;
+  }
+  // The push and its retry; one probe per period for the whole group
+  CHECK(programs == 2);
+  CHECK(probes >= 1);
+  CHECK(probes <= 3);
+}
+
+TEST_CASE("multicast mode rejects a non-multicast address", "[tempo_broadcaster]") {
+  asio::io_context io;
+  StateManager sm;
+  REQUIRE_THROWS_AS(TempoBroadcaster("test", io, std::chrono::hours(1), std::chrono::nanoseconds{0},
+                                     {"127.0.0.1", 8765, BroadcastMode::Multicast}, sm),
+                    std::runtime_error);
+}
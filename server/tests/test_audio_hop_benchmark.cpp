@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <fftw3.h>
+#include <string>
+#include <vector>
+
+#include "../src/beat_detector/audio/audio_ring.hpp"
+#include "../src/beat_detector/process_hop.hpp"
+#include "../src/config.hpp"
+#include "beat_detector/audio/config.h"
+
+// Per-hop cost of the capture -> onset path, before and after the float32
+// pipeline. Each iteration takes one 512-sample hop of captured float audio,
+// copies it into the audio ring, slides it into a 1024-sample frame, windows
+// it and runs a real FFT (the shape of BTrack's onset detection function).
+//
+// "legacy" reproduces the old path: per-sample widening push_back into a
+// vector<double> and double-precision FFTW. "double" is the bulk-converting
+// copy with FFTW, "float" is the end-to-end single-precision path (memcpy +
+// fftwf). "float32 view" reads the whole frame in place from a ring with one
+// hop of overlap, with no sliding copy. The real-time budget per hop is
+// 11.6 ms at 44.1 kHz and 10.7 ms at 48 kHz.
+//
+// The float32 variants need fftwf, linked with BEATLED_AUDIO_FLOAT32 only.
+// "Hop hand-over" leaves the FFT out and times what the tracker is actually
+// given in either build: BTrack takes a vector<double>, so process_hop()
+// copies (double build) or converts (float32 build) each hop into it.
+//
+// Run with: ./test_audio_hop_benchmark "[!benchmark]"
+
+using namespace beatled::detector;
+
+namespace {
+
+constexpr std::size_t HOP = beatled::constants::audio_buffer_size;
+constexpr std::size_t FRAME = 2 * HOP;
+
+std::vector<float> make_capture(double sample_rate) {
+  // One second of a 440 Hz tone with a 2 Hz amplitude pulse
+  std::vector<float> capture(static_cast<std::size_t>(sample_rate));
+  for (std::size_t i = 0; i < capture.size(); i++) {
+    double t = i / sample_rate;
+    capture[i] = static_cast<float>(0.5 * (1.0 + std::sin(2 * M_PI * 2.0 * t)) *
+                                    std::sin(2 * M_PI * 440.0 * t));
+  }
+  return capture;
+}
+
+template <typename T> struct Fft;
+
+template <> struct Fft<double> {
+  Fft() : in(fftw_alloc_real(FRAME)), out(fftw_alloc_complex(FRAME / 2 + 1)) {
+    plan = fftw_plan_dft_r2c_1d(FRAME, in, out, FFTW_ESTIMATE);
+  }
+  ~Fft() {
+    fftw_destroy_plan(plan);
+    fftw_free(in);
+    fftw_free(out);
+  }
+  void execute() { fftw_execute(plan); }
+  double magnitude() const {
+    double sum = 0;
+    for (std::size_t i = 0; i < FRAME / 2 + 1; i++) {
+      sum += std::hypot(out[i][0], out[i][1]);
+    }
+    return sum;
+  }
+
+  double *in;
+  fftw_complex *out;
+  fftw_plan plan;
+};
+
+#ifdef BEATLED_AUDIO_FLOAT32
+template <> struct Fft<float> {
+  Fft() : in(fftwf_alloc_real(FRAME)), out(fftwf_alloc_complex(FRAME / 2 + 1)) {
+    plan = fftwf_plan_dft_r2c_1d(FRAME, in, out, FFTW_ESTIMATE);
+  }
+  ~Fft() {
+    fftwf_destroy_plan(plan);
+    fftwf_free(in);
+    fftwf_free(out);
+  }
+  void execute() { fftwf_execute(plan); }
+  double magnitude() const {
+    double sum = 0;
+    for (std::size_t i = 0; i < FRAME / 2 + 1; i++) {
+      sum += std::hypot(out[i][0], out[i][1]);
+    }
+    return sum;
+  }
+
+  float *in;
+  fftwf_complex *out;
+  fftwf_plan plan;
+};
+#endif
+
+/**
+ * @brief Frame, window and FFT state shared by the three variants
+ */
+template <typename T> struct HopProcessor {
+  HopProcessor() : frame(FRAME, T(0)), window(FRAME) {
+    for (std::size_t i = 0; i < FRAME; i++) {
+      window[i] = static_cast<T>(0.5 * (1.0 - std::cos(2 * M_PI * i / (FRAME - 1))));
+    }
+  }
+
+  double process(const T *hop) {
+    std::copy(frame.begin() + HOP, frame.end(), frame.begin());
+    std::copy(hop, hop + HOP, frame.begin() + HOP);
+    return process_frame(frame.data());
+  }
+
+  double process_frame(const T *samples) {
+    for (std::size_t i = 0; i < FRAME; i++) {
+      fft.in[i] = samples[i] * window[i];
+    }
+    fft.execute();
+    return fft.magnitude();
+  }
+
+  std::vector<T> frame;
+  std::vector<T> window;
+  Fft<T> fft;
+};
+
+// BTrack's interface, reading enough of the frame that the copy stays
+struct VectorSink {
+  void process_audio_frame(const std::vector<double> &frame) {
+    sum += frame.front() + frame.back();
+  }
+  double sum = 0;
+};
+
+template <typename T> double hand_over_hop(const std::vector<float> &capture, std::size_t &cursor,
+                                           BasicAudioRing<T> &ring, VectorSink &sink,
+                                           std::vector<double> &scratch) {
+  if (cursor + HOP > capture.size()) {
+    cursor = 0;
+  }
+  ring.write(capture.data() + cursor, HOP, 0, 0);
+  cursor += HOP;
+  auto view = ring.acquire_blocking();
+  process_hop(sink, view.samples, scratch);
+  ring.release();
+  return sink.sum;
+}
+
+template <typename T> double run_hop(const std::vector<float> &capture, std::size_t &cursor,
+                                     BasicAudioRing<T> &ring, HopProcessor<T> &processor) {
+  if (cursor + HOP > capture.size()) {
+    cursor = 0;
+  }
+  ring.write(capture.data() + cursor, HOP, 0, 0);
+  cursor += HOP;
+  auto view = ring.acquire_blocking();
+  const double result = ring.overlap() == 0 ? processor.process(view.samples.data())
+                                            : processor.process_frame(view.samples.data());
+  ring.release();
+  return result;
+}
+
+} // namespace
+
+TEST_CASE("Per-hop processing cost", "[!benchmark][audio]") {
+  for (double sample_rate : {44100.0, 48000.0}) {
+    const auto capture = make_capture(sample_rate);
+    const std::string rate = std::to_string(static_cast<int>(sample_rate)) + " Hz";
+
+    {
+      std::vector<double> legacy;
+      legacy.reserve(HOP);
+      HopProcessor<double> processor;
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " legacy per-sample double") {
+        if (cursor + HOP > capture.size()) {
+          cursor = 0;
+        }
+        legacy.resize(0);
+        for (std::size_t i = 0; i < HOP; i++) {
+          legacy.push_back(capture[cursor + i]);
+        }
+        cursor += HOP;
+        return processor.process(legacy.data());
+      };
+    }
+
+    {
+      BasicAudioRing<double> ring(HOP, sample_rate);
+      HopProcessor<double> processor;
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " bulk double") { return run_hop(capture, cursor, ring, processor); };
+    }
+
+#ifdef BEATLED_AUDIO_FLOAT32
+    {
+      BasicAudioRing<float> ring(HOP, sample_rate);
+      HopProcessor<float> processor;
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " float32") { return run_hop(capture, cursor, ring, processor); };
+    }
+
+    {
+      BasicAudioRing<float> ring(HOP, sample_rate, FRAME - HOP);
+      HopProcessor<float> processor;
+      std::vector<float> silence(FRAME - HOP, 0.0f);
+      ring.write(silence.data(), silence.size(), 0, 0);
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " float32 view") { return run_hop(capture, cursor, ring, processor); };
+    }
+#endif
+  }
+}
+
+TEST_CASE("Hop hand-over cost", "[!benchmark][audio]") {
+  for (double sample_rate : {44100.0, 48000.0}) {
+    const auto capture = make_capture(sample_rate);
+    const std::string rate = std::to_string(static_cast<int>(sample_rate)) + " Hz";
+    std::vector<double> scratch;
+    scratch.reserve(HOP);
+
+    {
+      VectorSink sink;
+      std::vector<double> legacy;
+      legacy.reserve(HOP);
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " legacy per-sample double") {
+        if (cursor + HOP > capture.size()) {
+          cursor = 0;
+        }
+        legacy.resize(0);
+        for (std::size_t i = 0; i < HOP; i++) {
+          legacy.push_back(capture[cursor + i]);
+        }
+        cursor += HOP;
+        sink.process_audio_frame(legacy);
+        return sink.sum;
+      };
+    }
+
+    {
+      VectorSink sink;
+      BasicAudioRing<double> ring(HOP, sample_rate);
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " double ring") {
+        return hand_over_hop(capture, cursor, ring, sink, scratch);
+      };
+    }
+
+    {
+      VectorSink sink;
+      BasicAudioRing<float> ring(HOP, sample_rate);
+      std::size_t cursor = 0;
+      BENCHMARK(rate + " float32 ring") {
+        return hand_over_hop(capture, cursor, ring, sink, scratch);
+      };
+    }
+  }
+}
+
+TEST_CASE("Float and double hops agree", "[audio]") {
+  const auto capture = make_capture(44100.0);
+
+  BasicAudioRing<double> double_ring(HOP, 44100.0);
+  BasicAudioRing<float> float_ring(HOP, 44100.0);
+  double_ring.write(capture.data(), HOP, 0, 0);
+  float_ring.write(capture.data(), HOP, 0, 0);
+
+  auto double_hop = double_ring.acquire_blocking();
+  auto float_hop = float_ring.acquire_blocking();
+  REQUIRE(double_hop.size() == HOP);
+  REQUIRE(float_hop.size() == HOP);
+  for (std::size_t i = 0; i < HOP; i++) {
+    REQUIRE(double_hop.samples[i] == static_cast<double>(float_hop.samples[i]));
+  }
+}
+
+TEST_CASE("Overlapped views match the sliding frame", "[audio]") {
+  const auto capture = make_capture(44100.0);
+
+  BasicAudioRing<audio_buffer_t> ring(HOP, 44100.0, FRAME - HOP);
+  std::vector<float> silence(FRAME - HOP, 0.0f);
+  ring.write(silence.data(), silence.size(), 0, 0);
+  HopProcessor<audio_buffer_t> sliding;
+  HopProcessor<audio_buffer_t> in_place;
+
+  for (std::size_t cursor = 0; cursor + HOP <= 8 * HOP; cursor += HOP) {
+    ring.write(capture.data() + cursor, HOP, 0, 0);
+    auto view = ring.acquire_blocking();
+    REQUIRE(view.size() == FRAME);
+    const std::vector<audio_buffer_t> hop(capture.begin() + cursor,
+                                          capture.begin() + cursor + HOP);
+    REQUIRE(in_place.process_frame(view.samples.data()) == sliding.process(hop.data()));
+    ring.release();
+  }
+}
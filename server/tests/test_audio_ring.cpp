@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../src/beat_detector/audio/audio_ring.hpp"
+#include "../src/config.hpp"
+
+using namespace beatled::detector;
+
+constexpr std::size_t HOP = beatled::constants::audio_buffer_size;
+constexpr double SAMPLE_RATE = 1000.0;
+
+namespace {
+
+// Samples numbered from `first`, so views can be checked for content
+std::vector<float> ramp(std::size_t count, float first = 0) {
+  std::vector<float> samples(count);
+  for (std::size_t i = 0; i < count; i++) {
+    samples[i] = first + static_cast<float>(i);
+  }
+  return samples;
+}
+
+bool is_ramp(std::span<const audio_buffer_t> samples, float first) {
+  for (std::size_t i = 0; i < samples.size(); i++) {
+    if (samples[i] != static_cast<audio_buffer_t>(first + static_cast<float>(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("AudioRing sizing", "[AudioRing]") {
+  SECTION("Capacity is a whole number of hops") {
+    AudioRing ring(HOP, SAMPLE_RATE, 0, 3000);
+    REQUIRE(ring.capacity() == 6 * HOP);
+    REQUIRE(ring.free_space() == ring.capacity());
+    REQUIRE(ring.window_size() == HOP);
+  }
+
+  SECTION("Capacity fits a window and a hop") {
+    AudioRing ring(HOP, SAMPLE_RATE, 3 * HOP, 0);
+    REQUIRE(ring.window_size() == 4 * HOP);
+    REQUIRE(ring.overlap() == 3 * HOP);
+    REQUIRE(ring.capacity() >= 5 * HOP);
+  }
+
+  SECTION("Zero hop is rejected") {
+    REQUIRE_THROWS_AS(AudioRing(0, SAMPLE_RATE), std::invalid_argument);
+  }
+}
+
+TEST_CASE("AudioRing hands out hops in place", "[AudioRing]") {
+  AudioRing ring(HOP, SAMPLE_RATE);
+  const auto samples = ramp(HOP + HOP / 2);
+
+  SECTION("A view needs the whole window") {
+    ring.write(samples.data(), HOP / 2, 1000, 7);
+    AudioRing::View view;
+    REQUIRE(!ring.try_acquire(view));
+    REQUIRE(ring.queued_views() == 0);
+
+    ring.write(samples.data() + HOP / 2, HOP, 1000 + 1e6 * (HOP / 2) / SAMPLE_RATE, 9);
+    REQUIRE(ring.queued_views() == 1);
+    REQUIRE(ring.try_acquire(view));
+    REQUIRE(view.size() == HOP);
+    REQUIRE(view.index == 0);
+    REQUIRE(is_ramp(view.samples, 0));
+    REQUIRE(view.start_time == 1000);
+    REQUIRE(view.ready_time == 9);
+    REQUIRE(view.end_time() == 1000 + static_cast<uint64_t>(1e6 * HOP / SAMPLE_RATE));
+  }
+
+  SECTION("Each hop is stamped with the capture time of its first sample") {
+    // Hop 2 starts part-way through the second write
+    const auto more = ramp(2 * HOP, static_cast<float>(HOP + HOP / 2));
+    ring.write(samples.data(), samples.size(), 1'000'000, 1);
+    ring.write(more.data(), more.size(), 1'000'000 + 1e6 * samples.size() / SAMPLE_RATE, 2);
+
+    AudioRing::View view = ring.acquire_blocking();
+    REQUIRE(view.start_time == 1'000'000);
+    ring.release();
+
+    view = ring.acquire_blocking();
+    REQUIRE(view.index == 1);
+    REQUIRE(is_ramp(view.samples, HOP));
+    REQUIRE(view.start_time == 1'000'000 + static_cast<uint64_t>(1e6 * HOP / SAMPLE_RATE));
+    REQUIRE(view.ready_time == 2);
+    ring.release();
+
+    view = ring.acquire_blocking();
+    REQUIRE(is_ramp(view.samples, 2 * HOP));
+    REQUIRE(view.start_time == 1'000'000 + static_cast<uint64_t>(1e6 * 2 * HOP / SAMPLE_RATE));
+  }
+}
+
+TEST_CASE("AudioRing overlapping windows", "[AudioRing]") {
+  // Windows of four hops over a small ring, so views wrap around many times
+  constexpr std::size_t hop = 64;
+  AudioRing ring(hop, SAMPLE_RATE, 3 * hop, 8 * hop);
+  const auto samples = ramp(100 * hop);
+
+  std::size_t written = 0;
+  std::size_t views = 0;
+  bool contents_ok = true;
+  while (written < samples.size()) {
+    // Odd-sized writes so hop boundaries and the wrap fall mid-write
+    const std::size_t count = std::min<std::size_t>(ring.free_space(), 37);
+    written += ring.write(samples.data() + written, std::min(count, samples.size() - written),
+                          1e6 * written / SAMPLE_RATE, 0);
+    AudioRing::View view;
+    while (ring.try_acquire(view)) {
+      REQUIRE(view.size() == 4 * hop);
+      contents_ok = contents_ok && is_ramp(view.samples, static_cast<float>(view.index * hop));
+      contents_ok = contents_ok &&
+                    view.start_time == static_cast<uint64_t>(1e6 * view.index * hop / SAMPLE_RATE);
+      ring.release();
+      views++;
+    }
+  }
+
+  REQUIRE(contents_ok);
+  REQUIRE(views == 97);
+  REQUIRE(ring.overrun_count() == 0);
+}
+
+TEST_CASE("AudioRing overrun", "[AudioRing]") {
+  AudioRing ring(HOP, SAMPLE_RATE, 0, 2 * HOP);
+  const auto samples = ramp(3 * HOP);
+
+  SECTION("A full ring drops the frames that don't fit and counts an overrun") {
+    // Must not block or allocate: the audio callback drops the frames instead
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(ring.write(samples.data(), samples.size(), 0, 0) == 2 * HOP);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(elapsed < std::chrono::milliseconds(50));
+    REQUIRE(ring.overrun_count() == 1);
+    REQUIRE(ring.free_space() == 0);
+    REQUIRE(ring.write(samples.data(), 1, 0, 0) == 0);
+    REQUIRE(ring.overrun_count() == 2);
+  }
+
+  SECTION("Releasing a view frees its hop") {
+    ring.write(samples.data(), 2 * HOP, 0, 0);
+    REQUIRE(ring.acquire_blocking());
+    REQUIRE(ring.free_space() == 0);
+    ring.release();
+    REQUIRE(ring.free_space() == HOP);
+    REQUIRE(ring.write(samples.data() + 2 * HOP, HOP, 0, 0) == HOP);
+    REQUIRE(ring.overrun_count() == 0);
+  }
+}
+
+TEST_CASE("AudioRing reset", "[AudioRing]") {
+  AudioRing ring(HOP, SAMPLE_RATE);
+  const auto samples = ramp(2 * HOP);
+  ring.write(samples.data(), samples.size(), 0, 0);
+  REQUIRE(ring.queued_views() == 2);
+
+  ring.reset(48000.0);
+  REQUIRE(ring.queued_views() == 0);
+  REQUIRE(ring.free_space() == ring.capacity());
+  REQUIRE(ring.sample_rate() == 48000.0);
+
+  ring.write(samples.data() + HOP, HOP, 555, 0);
+  AudioRing::View view = ring.acquire_blocking();
+  REQUIRE(view.index == 0);
+  REQUIRE(view.start_time == 555);
+  REQUIRE(view.sample_rate == 48000.0);
+  REQUIRE(is_ramp(view.samples, HOP));
+}
+
+TEST_CASE("AudioRing resync", "[AudioRing]") {
+  // A paused consumer in front of a stream that kept running: the ring is
+  // full, and the hop being written when it filled up is cut short
+  AudioRing ring(HOP, SAMPLE_RATE, 0, 2 * HOP);
+  const auto samples = ramp(4 * HOP);
+  ring.write(samples.data(), HOP + HOP / 2, 0, 0);
+  REQUIRE(ring.acquire_blocking());
+  ring.release();
+  REQUIRE(ring.write(samples.data() + HOP + HOP / 2, 2 * HOP, 0, 0) == HOP + HOP / 2);
+  REQUIRE(ring.overrun_count() == 1);
+
+  SECTION("Stale views are hidden until the producer resyncs") {
+    ring.request_resync();
+    REQUIRE(ring.resync_pending());
+    AudioRing::View view;
+    REQUIRE(!ring.try_acquire(view));
+  }
+
+  SECTION("The stream restarts on a hop boundary with fresh timestamps") {
+    ring.request_resync();
+    const auto fresh = ramp(HOP + HOP / 2, 10000);
+    REQUIRE(ring.write(fresh.data(), fresh.size(), 5'000'000, 42) == fresh.size());
+    REQUIRE(!ring.resync_pending());
+    REQUIRE(ring.overrun_count() == 1);
+
+    AudioRing::View view = ring.acquire_blocking();
+    REQUIRE(view.index == 1);
+    REQUIRE(is_ramp(view.samples, 10000));
+    REQUIRE(view.start_time == 5'000'000);
+    REQUIRE(view.ready_time == 42);
+    ring.release();
+    REQUIRE(ring.queued_views() == 0);
+    REQUIRE(ring.free_space() == ring.capacity() - HOP / 2);
+  }
+}
+
+TEST_CASE("AudioRing acquire_blocking with set_active", "[AudioRing]") {
+  AudioRing ring(HOP, SAMPLE_RATE);
+
+  SECTION("Setting inactive unblocks acquire") {
+    AudioRing::View result;
+    result.index = 42;
+    std::thread consumer([&]() { result = ring.acquire_blocking(); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ring.set_active(false);
+
+    consumer.join();
+    REQUIRE(!result);
+  }
+
+  SECTION("Complete views are still handed out once inactive") {
+    const auto samples = ramp(HOP);
+    ring.write(samples.data(), samples.size(), 0, 0);
+    ring.set_active(false);
+    REQUIRE(ring.acquire_blocking());
+    ring.release();
+    REQUIRE(!ring.acquire_blocking());
+  }
+}
+
+TEST_CASE("AudioRing concurrent access", "[AudioRing]") {
+  AudioRing ring(HOP, SAMPLE_RATE, HOP / 2, 4 * HOP);
+
+  SECTION("Producer and consumer threads hand hops over in order") {
+    // One producer (the audio callback) and one consumer (the detector
+    // thread). The producer spins rather than blocking when the ring is
+    // full, like a callback dropping frames, but retries what didn't fit.
+    constexpr std::size_t N = 2000;
+    const auto samples = ramp(HOP * N + HOP / 2);
+
+    auto producer = [&]() {
+      std::size_t written = 0;
+      while (written < samples.size()) {
+        const std::size_t count = std::min<std::size_t>(samples.size() - written, 300);
+        written += ring.write(samples.data() + written, count, 1e6 * written / SAMPLE_RATE, 0);
+        std::this_thread::yield();
+      }
+    };
+
+    uint64_t expected = 0;
+    bool in_order = true;
+    auto consumer = [&]() {
+      for (std::size_t i = 0; i < N; i++) {
+        auto view = ring.acquire_blocking();
+        in_order = in_order && view.index == expected &&
+                   is_ramp(view.samples, static_cast<float>(expected * HOP)) &&
+                   view.start_time == static_cast<uint64_t>(1e6 * expected * HOP / SAMPLE_RATE);
+        expected++;
+        ring.release();
+      }
+    };
+
+    std::thread prod(producer);
+    std::thread cons(consumer);
+
+    prod.join();
+    cons.join();
+
+    REQUIRE(in_order);
+    REQUIRE(expected == N);
+    REQUIRE(ring.queued_views() == 0);
+  }
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/beat_detector/audio/audio_ring.hpp"
+#include "../src/beat_detector/audio/generator_audio_source.hpp"
+#include "../src/beat_detector/audio/pipe_audio_source.hpp"
+#include "../src/config.hpp"
+#include "beat_detector/audio/audio_source_config.hpp"
+
+using namespace beatled::detector;
+
+constexpr std::size_t BUF_SIZE = beatled::constants::audio_buffer_size;
+constexpr double SAMPLE_RATE = 44100.0;
+
+TEST_CASE("parse_audio_source_config", "[AudioSource]") {
+  SECTION("Defaults to PortAudio in real time") {
+    auto config = parse_audio_source_config("portaudio");
+    REQUIRE(config.kind == AudioSourceConfig::Kind::PortAudio);
+    REQUIRE(config.pacing == AudioPacing::RealTime);
+  }
+
+  SECTION("File source keeps the whole path") {
+    auto config = parse_audio_source_config("file:/tmp/a:b.wav", "fast");
+    REQUIRE(config.kind == AudioSourceConfig::Kind::File);
+    REQUIRE(config.path == "/tmp/a:b.wav");
+    REQUIRE(config.pacing == AudioPacing::AsFastAsPossible);
+  }
+
+  SECTION("Pipe defaults to stdin") {
+    auto config = parse_audio_source_config("pipe");
+    REQUIRE(config.kind == AudioSourceConfig::Kind::Pipe);
+    REQUIRE(config.path == "-");
+  }
+
+  SECTION("Generator tempo") {
+    REQUIRE(parse_audio_source_config("generator").generator_bpm == 120.0);
+    REQUIRE(parse_audio_source_config("generator:96.5").generator_bpm == 96.5);
+  }
+
+  SECTION("Malformed specs are rejected") {
+    REQUIRE_THROWS_AS(parse_audio_source_config("file"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_audio_source_config("generator:fast"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_audio_source_config("generator:-10"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_audio_source_config("alsa"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_audio_source_config("portaudio", "slow"), std::invalid_argument);
+  }
+}
+
+TEST_CASE("GeneratorAudioSource as fast as possible", "[AudioSource]") {
+  AudioRing ring(BUF_SIZE, SAMPLE_RATE);
+  GeneratorAudioSource source(&ring, 120.0, SAMPLE_RATE, AudioPacing::AsFastAsPossible, BUF_SIZE);
+
+  REQUIRE(source.open());
+  REQUIRE(source.start());
+
+  // Two seconds of audio, consumed far faster than real time, with no drops
+  const std::size_t hops = static_cast<std::size_t>(2 * SAMPLE_RATE) / BUF_SIZE;
+  std::vector<uint64_t> start_times;
+  for (std::size_t i = 0; i < hops; i++) {
+    auto hop = ring.acquire_blocking();
+    REQUIRE(hop);
+    REQUIRE(hop.size() == BUF_SIZE);
+    start_times.push_back(hop.start_time);
+    ring.release();
+  }
+  source.stop();
+
+  REQUIRE(ring.overrun_count() == 0);
+
+  // Timestamps follow the virtual clock: one hop apart
+  const double hop_us = 1e6 * BUF_SIZE / SAMPLE_RATE;
+  for (std::size_t i = 1; i < start_times.size(); i++) {
+    const double diff = static_cast<double>(start_times[i] - start_times[i - 1]);
+    REQUIRE(diff >= hop_us - 1);
+    REQUIRE(diff <= hop_us + 1);
+  }
+}
+
+TEST_CASE("GeneratorAudioSource in real time", "[AudioSource]") {
+  AudioRing ring(BUF_SIZE, SAMPLE_RATE);
+  GeneratorAudioSource source(&ring, 120.0, SAMPLE_RATE, AudioPacing::RealTime, BUF_SIZE);
+
+  REQUIRE(source.open());
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE(source.start());
+
+  // 10 hops is ~116 ms of audio; it must not arrive (much) earlier than that
+  for (int i = 0; i < 10; i++) {
+    REQUIRE(ring.acquire_blocking());
+    ring.release();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  source.stop();
+
+  REQUIRE(elapsed >= std::chrono::milliseconds(100));
+}
+
+TEST_CASE("PipeAudioSource reads f32le PCM until the writer closes", "[AudioSource]") {
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  const std::string path = "/dev/fd/" + std::to_string(fds[0]);
+
+  AudioRing ring(BUF_SIZE, SAMPLE_RATE);
+  PipeAudioSource source(&ring, path, SAMPLE_RATE, AudioPacing::AsFastAsPossible, BUF_SIZE);
+  REQUIRE(source.open());
+  REQUIRE(source.start());
+
+  // Three full hops plus a partial one, written from another thread
+  const std::size_t frame_count = 3 * BUF_SIZE + 100;
+  std::thread writer([&]() {
+    std::vector<float> samples(frame_count);
+    for (std::size_t i = 0; i < frame_count; i++) {
+      samples[i] = static_cast<float>(i);
+    }
+    const char *bytes = reinterpret_cast<const char *>(samples.data());
+    std::size_t remaining = samples.size() * sizeof(float);
+    while (remaining > 0) {
+      ssize_t n = ::write(fds[1], bytes, remaining);
+      if (n <= 0) {
+        break;
+      }
+      bytes += n;
+      remaining -= static_cast<std::size_t>(n);
+    }
+    ::close(fds[1]);
+  });
+
+  std::size_t hops = 0;
+  float expected = 0;
+  bool in_order = true;
+  while (auto hop = ring.acquire_blocking()) {
+    for (std::size_t i = 0; i < hop.size(); i++) {
+      in_order = in_order && (hop.samples[i] == expected++);
+    }
+    hops++;
+    ring.release();
+  }
+
+  writer.join();
+  source.stop();
+  ::close(fds[0]);
+
+  // End of stream deactivates the ring; the trailing partial hop is not sent
+  REQUIRE(hops == 3);
+  REQUIRE(in_order);
+  REQUIRE(source.frames_delivered() == frame_count);
+}
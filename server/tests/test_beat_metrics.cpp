@@ -0,0 +1,143 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "beat_detector/evaluation/beat_metrics.hpp"
+
+using namespace beatled::detector;
+using Catch::Approx;
+
+namespace {
+
+// 120 BPM from 0 to 30 s
+std::vector<double> grid(double period = 0.5, double offset = 0.0, double end = 30.0) {
+  std::vector<double> beats;
+  for (double t = offset; t < end; t += period) {
+    beats.push_back(t);
+  }
+  return beats;
+}
+
+} // namespace
+
+TEST_CASE("Perfect tracking", "[BeatMetrics]") {
+  const auto annotated = grid();
+  const auto metrics = evaluate_beats(annotated, annotated);
+
+  REQUIRE(metrics.f_measure == Approx(1.0));
+  REQUIRE(metrics.cml_c == Approx(1.0));
+  REQUIRE(metrics.cml_t == Approx(1.0));
+  REQUIRE(metrics.aml_c == Approx(1.0));
+  REQUIRE(metrics.aml_t == Approx(1.0));
+  REQUIRE(metrics.mean_error_ms == Approx(0.0).margin(1e-9));
+}
+
+TEST_CASE("Beats before the skip window are ignored", "[BeatMetrics]") {
+  const auto annotated = grid();
+  auto detected = grid(0.5, 5.0);
+  detected.insert(detected.begin(), {0.1, 0.3, 1.7});
+
+  const auto metrics = evaluate_beats(annotated, detected);
+  REQUIRE(metrics.annotated_beats == 50);
+  REQUIRE(metrics.detected_beats == 50);
+  REQUIRE(metrics.f_measure == Approx(1.0));
+}
+
+TEST_CASE("Constant offset", "[BeatMetrics]") {
+  const auto annotated = grid();
+
+  SECTION("Inside the F-measure window") {
+    const auto metrics = evaluate_beats(annotated, grid(0.5, 0.03));
+    REQUIRE(metrics.f_measure == Approx(1.0));
+    REQUIRE(metrics.mean_error_ms == Approx(30.0));
+    REQUIRE(metrics.p95_error_ms == Approx(30.0));
+    REQUIRE(metrics.mean_offset_ms == Approx(30.0));
+  }
+
+  SECTION("Early beats have a negative offset") {
+    const auto metrics = evaluate_beats(annotated, grid(0.5, -0.02 + 0.5));
+    REQUIRE(metrics.mean_offset_ms == Approx(-20.0));
+    REQUIRE(metrics.mean_error_ms == Approx(20.0));
+  }
+
+  SECTION("Outside the window") {
+    const auto metrics = evaluate_beats(annotated, grid(0.5, 0.08));
+    REQUIRE(metrics.f_measure == 0.0);
+    REQUIRE(metrics.matched_beats == 0);
+    // 80 ms is within 17.5% of a 500 ms beat, so continuity still holds
+    REQUIRE(metrics.cml_t == Approx(1.0));
+  }
+}
+
+TEST_CASE("Metrical level errors", "[BeatMetrics]") {
+  const auto annotated = grid();
+
+  SECTION("Double tempo") {
+    const auto metrics = evaluate_beats(annotated, grid(0.25));
+    REQUIRE(metrics.precision == Approx(0.5));
+    REQUIRE(metrics.recall == Approx(1.0));
+    REQUIRE(metrics.cml_t == Approx(0.0));
+    // The last detected beat falls after the last interpolated one
+    REQUIRE(metrics.aml_c == Approx(99.0 / 100.0));
+    REQUIRE(metrics.aml_t == Approx(99.0 / 100.0));
+  }
+
+  SECTION("Half tempo") {
+    const auto metrics = evaluate_beats(annotated, grid(1.0));
+    REQUIRE(metrics.precision == Approx(1.0));
+    REQUIRE(metrics.recall == Approx(0.5));
+    REQUIRE(metrics.cml_t == Approx(0.0));
+    REQUIRE(metrics.aml_t == Approx(1.0));
+  }
+
+  SECTION("Off-beat") {
+    const auto metrics = evaluate_beats(annotated, grid(0.5, 0.25));
+    REQUIRE(metrics.f_measure == 0.0);
+    REQUIRE(metrics.cml_t == Approx(0.0));
+    REQUIRE(metrics.aml_t == Approx(49.0 / 50.0));
+  }
+}
+
+TEST_CASE("Continuity breaks at a dropout", "[BeatMetrics]") {
+  const auto annotated = grid();
+  std::vector<double> detected;
+  for (double t : annotated) {
+    // Lose the beat between 15 s and 17 s
+    if (t < 15.0 || t >= 17.0) {
+      detected.push_back(t);
+    }
+  }
+
+  const auto metrics = evaluate_beats(annotated, detected);
+  // 20 correct beats before the gap and 25 after it: the first beat after the
+  // gap is in phase but follows a 2.5 s interval
+  REQUIRE(metrics.cml_t == Approx(45.0 / 50.0));
+  REQUIRE(metrics.cml_c == Approx(25.0 / 50.0));
+  REQUIRE(metrics.recall == Approx(46.0 / 50.0));
+}
+
+TEST_CASE("Percentile", "[BeatMetrics]") {
+  std::vector<double> values;
+  for (int i = 1; i <= 100; i++) {
+    values.push_back(i);
+  }
+  REQUIRE(percentile(values, 95) == 95);
+  REQUIRE(percentile(values, 100) == 100);
+  REQUIRE(percentile(values, 0) == 1);
+  REQUIRE(percentile({}, 95) == 0);
+}
+
+TEST_CASE("load_beat_annotations", "[BeatMetrics]") {
+  const auto path = std::filesystem::temp_directory_path() / "beatled_test_annotations.beats";
+  {
+    std::ofstream out(path);
+    out << "# ballroom style\n0.5 1\n1.0 2\n\n  1.5\t3\n2.0,4\n";
+  }
+  const auto beats = load_beat_annotations(path);
+  std::filesystem::remove(path);
+
+  REQUIRE(beats == std::vector<double>{0.5, 1.0, 1.5, 2.0});
+  REQUIRE_THROWS(load_beat_annotations(path));
+}
@@ -0,0 +1,113 @@
+#include <AudioFile/AudioFile.h>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "beat_detector/evaluation/corpus_evaluator.hpp"
+
+using namespace beatled::detector;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr double kSampleRate = 44100;
+constexpr double kSeconds = 12;
+
+// A click track and its annotation, beats `period` seconds apart
+void write_click_track(const fs::path &stem, double period) {
+  AudioFile<float> audio;
+  audio.setAudioBufferSize(1, static_cast<int>(kSampleRate * kSeconds));
+  audio.setSampleRate(static_cast<unsigned>(kSampleRate));
+  audio.setBitDepth(16);
+
+  std::ofstream beats(fs::path(stem).replace_extension(".beats"));
+  const std::size_t click = static_cast<std::size_t>(0.01 * kSampleRate);
+  for (double t = 0.25; t < kSeconds; t += period) {
+    beats << t << "\n";
+    const std::size_t start = static_cast<std::size_t>(t * kSampleRate);
+    for (std::size_t i = 0; i < click && start + i < audio.samples[0].size(); i++) {
+      audio.samples[0][start + i] = 0.8f * std::sin(2 * M_PI * 1000 * i / kSampleRate);
+    }
+  }
+  REQUIRE(audio.save(fs::path(stem).replace_extension(".wav").string()));
+}
+
+// Annotated click tracks at a few tempos, removed at the end of the test
+class ClickCorpus {
+public:
+  explicit ClickCorpus(std::size_t files)
+      : dir_{fs::temp_directory_path() / ("test_corpus_evaluator." + std::to_string(getpid()))} {
+    fs::create_directories(dir_);
+    for (std::size_t i = 0; i < files; i++) {
+      write_click_track(dir_ / ("click" + std::to_string(i)), 60.0 / (100 + 10 * i));
+    }
+  }
+
+  ~ClickCorpus() { fs::remove_all(dir_); }
+
+  const fs::path &dir() const { return dir_; }
+
+private:
+  fs::path dir_;
+};
+
+CorpusEvaluation evaluate(const std::vector<CorpusEntry> &entries, std::size_t threads,
+                          unsigned decimation = 1) {
+  CorpusEvaluator::parameters_t parameters;
+  parameters.threads = threads;
+  parameters.decimation = decimation;
+  return CorpusEvaluator{parameters}.evaluate(entries);
+}
+
+} // namespace
+
+TEST_CASE("Workers track files side by side", "[CorpusEvaluator]") {
+  spdlog::set_level(spdlog::level::warn);
+  constexpr std::size_t FILES = 6;
+  const ClickCorpus corpus{FILES};
+  const auto entries = CorpusEvaluator::find_entries(corpus.dir());
+  REQUIRE(entries.size() == FILES);
+
+  // Every worker builds and drops a tracker per file, all at once
+  const auto parallel = evaluate(entries, FILES);
+  REQUIRE(parallel.threads == FILES);
+  REQUIRE(parallel.evaluated_files == FILES);
+  REQUIRE(parallel.failed_files == 0);
+
+  // A file's beats don't depend on which worker, or how many, tracked it
+  const auto serial = evaluate(entries, 1);
+  for (std::size_t i = 0; i < FILES; i++) {
+    REQUIRE(parallel.files[i].ok);
+    REQUIRE(!parallel.files[i].detected_beats.empty());
+    REQUIRE(parallel.files[i].detected_beats == serial.files[i].detected_beats);
+  }
+}
+
+TEST_CASE("Decimated tracking", "[CorpusEvaluator]") {
+  spdlog::set_level(spdlog::level::warn);
+  const ClickCorpus corpus{2};
+  const auto entries = CorpusEvaluator::find_entries(corpus.dir());
+
+  for (unsigned decimation : {2u, 4u}) {
+    const auto evaluation = evaluate(entries, 2, decimation);
+    REQUIRE(evaluation.evaluated_files == entries.size());
+    for (const auto &file : evaluation.files) {
+      REQUIRE(!file.detected_beats.empty());
+      // Stamped with the hop start at the decimated rate, on the file's clock
+      REQUIRE(file.detected_beats.back() < kSeconds);
+    }
+  }
+
+  // The tracker hop is a whole number of decimated samples
+  CorpusEvaluator::parameters_t parameters;
+  parameters.hop_size = 510;
+  parameters.decimation = 4;
+  REQUIRE_THROWS_AS(CorpusEvaluator{parameters}, std::invalid_argument);
+}
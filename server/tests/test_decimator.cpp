@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/beat_detector/audio/audio_ring.hpp"
+#include "../src/beat_detector/audio/audio_source.hpp"
+#include "../src/beat_detector/audio/decimator.hpp"
+#include "../src/config.hpp"
+
+using namespace beatled::detector;
+
+constexpr std::size_t BUF_SIZE = beatled::constants::audio_buffer_size;
+constexpr double SAMPLE_RATE = 44100.0;
+
+namespace {
+
+std::vector<float> sine(double frequency, std::size_t count) {
+  std::vector<float> samples(count);
+  for (std::size_t i = 0; i < count; i++) {
+    samples[i] = static_cast<float>(std::sin(2 * M_PI * frequency * i / SAMPLE_RATE));
+  }
+  return samples;
+}
+
+std::vector<float> decimate(Decimator &decimator, const std::vector<float> &input,
+                            std::size_t chunk) {
+  std::vector<float> output;
+  std::vector<float> block(decimator.max_block() / decimator.factor() + 1);
+  for (std::size_t offset = 0; offset < input.size(); offset += chunk) {
+    std::size_t first = 0;
+    const std::size_t count = std::min(chunk, input.size() - offset);
+    const std::size_t produced =
+        decimator.process(input.data() + offset, count, block.data(), first);
+    output.insert(output.end(), block.begin(), block.begin() + produced);
+  }
+  return output;
+}
+
+// Peak amplitude once the filter has settled
+float settled_peak(const std::vector<float> &samples) {
+  float peak = 0;
+  for (std::size_t i = samples.size() / 2; i < samples.size(); i++) {
+    peak = std::max(peak, std::abs(samples[i]));
+  }
+  return peak;
+}
+
+// Exposes `write_frames`, as an audio callback would call it
+class ManualAudioSource : public AudioSource {
+public:
+  using AudioSource::AudioSource;
+
+  bool open() override {
+    reset_ring();
+    return true;
+  }
+  bool close() override { return true; }
+  bool start() override { return true; }
+  bool stop() override { return true; }
+  bool is_active() override { return true; }
+  bool wait() override { return true; }
+
+  std::size_t push(const float *frames, std::size_t count, uint64_t capture_time_us) {
+    return write_frames(frames, count, capture_time_us);
+  }
+};
+
+} // namespace
+
+TEST_CASE("Decimator filters out what would alias", "[Decimator]") {
+  for (unsigned factor : {2u, 4u}) {
+    const double output_nyquist = SAMPLE_RATE / factor / 2;
+
+    Decimator pass(factor);
+    const float pass_peak = settled_peak(decimate(pass, sine(0.3 * output_nyquist, 16384), 512));
+    REQUIRE(pass_peak > 0.99f);
+    REQUIRE(pass_peak < 1.01f);
+
+    // Past the output Nyquist frequency: would fold back into the band
+    Decimator stop(factor);
+    const float stop_peak = settled_peak(decimate(stop, sine(1.2 * output_nyquist, 16384), 512));
+    REQUIRE(stop_peak < 1e-3f);
+  }
+}
+
+TEST_CASE("Decimator output does not depend on the block size", "[Decimator]") {
+  const std::vector<float> input = sine(440.0, 10000);
+
+  Decimator reference(4);
+  const std::vector<float> expected = decimate(reference, input, 1024);
+  REQUIRE(expected.size() == input.size() / 4);
+
+  for (std::size_t chunk : {1u, 3u, 7u, 441u, 512u}) {
+    Decimator decimator(4);
+    REQUIRE(decimate(decimator, input, chunk) == expected);
+  }
+}
+
+TEST_CASE("Decimator rejects a zero factor", "[Decimator]") {
+  REQUIRE_THROWS_AS(Decimator(0), std::invalid_argument);
+}
+
+TEST_CASE("Decimated hops keep the capture time of their first sample", "[Decimator]") {
+  constexpr unsigned factor = 4;
+  AudioRing ring(BUF_SIZE / factor, SAMPLE_RATE / factor);
+  ManualAudioSource source(&ring, SAMPLE_RATE);
+  source.set_decimation(factor);
+  REQUIRE(source.open());
+  REQUIRE(source.effective_sample_rate() == SAMPLE_RATE / factor);
+
+  // An impulse at a sample index that isn't on the output grid, captured in
+  // 512-frame callbacks that don't line up with the output hops either
+  const uint64_t capture_start_us = 1'000'000;
+  const std::size_t impulse_index = 10 * BUF_SIZE + 123;
+  std::vector<float> input(20 * BUF_SIZE, 0.0f);
+  input[impulse_index] = 1.0f;
+
+  std::vector<uint64_t> start_times;
+  std::vector<float> output;
+  for (std::size_t offset = 0; offset < input.size(); offset += BUF_SIZE) {
+    const uint64_t capture_time =
+        capture_start_us + static_cast<uint64_t>(1e6 * offset / SAMPLE_RATE);
+    source.push(input.data() + offset, BUF_SIZE, capture_time);
+    AudioRing::View hop;
+    while (ring.try_acquire(hop)) {
+      REQUIRE(hop.size() == BUF_SIZE / factor);
+      start_times.push_back(hop.start_time);
+      output.insert(output.end(), hop.samples.begin(), hop.samples.end());
+      ring.release();
+    }
+  }
+  REQUIRE(ring.overrun_count() == 0);
+
+  // Hops still last 512 input samples
+  const double hop_us = 1e6 * BUF_SIZE / SAMPLE_RATE;
+  for (std::size_t i = 1; i < start_times.size(); i++) {
+    const double diff = static_cast<double>(start_times[i] - start_times[i - 1]);
+    REQUIRE(diff >= hop_us - 1);
+    REQUIRE(diff <= hop_us + 1);
+  }
+
+  // The (symmetric) filtered impulse peaks where the impulse was captured
+  const auto peak = static_cast<std::size_t>(
+      std::max_element(output.begin(), output.end()) - output.begin());
+  const std::size_t hop = peak / (BUF_SIZE / factor);
+  const double peak_time_us = static_cast<double>(start_times[hop]) +
+                              1e6 * static_cast<double>(peak % (BUF_SIZE / factor)) *
+                                  factor / SAMPLE_RATE;
+  const double impulse_time_us = capture_start_us + 1e6 * impulse_index / SAMPLE_RATE;
+  const double output_period_us = 1e6 * factor / SAMPLE_RATE;
+  REQUIRE(std::abs(peak_time_us - impulse_time_us) <= output_period_us);
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+#include <fftw3.h>
+#include <filesystem>
+#include <stdexcept>
+#include <span>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/beat_detector/process_hop.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
+
+using namespace beatled::detector;
+
+namespace {
+
+// BTrack's interface: converted double frames
+struct VectorTracker {
+  void process_audio_frame(const std::vector<double> &) {}
+};
+
+// A tracker that reads float hops in place
+struct FloatSpanTracker {
+  void process_audio_frame(std::span<const float>) {}
+};
+
+void forget_wisdom() {
+  auto lock = FftwWisdom::planner_lock();
+  fftw_forget_wisdom();
+#ifdef BEATLED_AUDIO_FLOAT32
+  fftwf_forget_wisdom();
+#endif
+}
+
+std::string temporary_wisdom_path() {
+  return (std::filesystem::temp_directory_path() /
+          ("test_fftw_wisdom." + std::to_string(getpid())))
+      .string();
+}
+
+} // namespace
+
+TEST_CASE("FFTW planning options", "[fftw]") {
+  REQUIRE(parse_fftw_planning("estimate") == FftwPlanning::Estimate);
+  REQUIRE(parse_fftw_planning("measure") == FftwPlanning::Measure);
+  REQUIRE(parse_fftw_planning("patient") == FftwPlanning::Patient);
+  REQUIRE_THROWS_AS(parse_fftw_planning("exhaustive"), std::invalid_argument);
+  REQUIRE(std::string(to_string(FftwPlanning::Patient)) == "patient");
+}
+
+TEST_CASE("Beat tracker transforms", "[fftw]") {
+  // A frame as long as the autocorrelation shares its complex transforms
+  REQUIRE(beat_tracker_fft_shapes(512, 1024).size() == 4);
+  REQUIRE(beat_tracker_fft_shapes(1024, 1024).size() == 3);
+  REQUIRE(beat_tracker_fft_shapes(256, 1024)[0].size == 256);
+  REQUIRE(beat_tracker_fft_shapes(256, 512).back().size == 512);
+}
+
+TEST_CASE("Wisdom precision follows the tracker", "[fftw]") {
+  // BTrack plans double FFTW whatever the capture precision
+  STATIC_REQUIRE(fft_precision_of<tracker_sample_t<VectorTracker, float>> ==
+                 FftPrecision::Double);
+  STATIC_REQUIRE(fft_precision_of<tracker_sample_t<VectorTracker, double>> ==
+                 FftPrecision::Double);
+  STATIC_REQUIRE(fft_precision_of<tracker_sample_t<FloatSpanTracker, float>> ==
+                 FftPrecision::Single);
+
+  REQUIRE(FftwWisdom({"", FftwPlanning::Measure}).precision() == FftPrecision::Double);
+#ifdef BEATLED_AUDIO_FLOAT32
+  REQUIRE(FftwWisdom({"", FftwPlanning::Measure}, FftPrecision::Single).precision() ==
+          FftPrecision::Single);
+#else
+  REQUIRE_THROWS_AS(FftwWisdom({"", FftwPlanning::Measure}, FftPrecision::Single),
+                    std::invalid_argument);
+#endif
+}
+
+TEST_CASE("FFTW wisdom cache", "[fftw]") {
+  const std::string path = temporary_wisdom_path();
+  std::filesystem::remove(path);
+  forget_wisdom();
+  const auto shapes = beat_tracker_fft_shapes(256, 1024);
+
+  SECTION("Nothing to import on the first run") {
+    FftwWisdom wisdom({path, FftwPlanning::Measure});
+    REQUIRE(!wisdom.import_wisdom());
+  }
+
+  SECTION("Disabled without a path") {
+    FftwWisdom wisdom({"", FftwPlanning::Measure});
+    REQUIRE(!wisdom.import_wisdom());
+    REQUIRE(!wisdom.export_wisdom());
+  }
+
+  SECTION("Estimate doesn't plan in the background") {
+    FftwWisdom wisdom({path, FftwPlanning::Estimate});
+    wisdom.plan_async(shapes);
+    wisdom.wait();
+    REQUIRE(wisdom.planned_count() == 0);
+    REQUIRE(!std::filesystem::exists(path));
+  }
+
+  SECTION("Measured plans survive a restart") {
+    {
+      FftwWisdom wisdom({path, FftwPlanning::Measure});
+      wisdom.plan_async(shapes);
+      wisdom.wait();
+      REQUIRE(wisdom.planned_count() == shapes.size());
+      REQUIRE(wisdom.cached_count() == 0);
+      REQUIRE(std::filesystem::exists(path));
+      REQUIRE(!std::filesystem::exists(path + ".tmp"));
+    }
+
+    // A new process starts without wisdom...
+    forget_wisdom();
+    FftwWisdom wisdom({path, FftwPlanning::Measure});
+    REQUIRE(!wisdom.has_wisdom(shapes[0], FftwPlanning::Measure));
+
+    // ...and gets the measured plans back from the cache, without measuring
+    REQUIRE(wisdom.import_wisdom());
+    for (const auto &shape : shapes) {
+      REQUIRE(wisdom.has_wisdom(shape, FftwPlanning::Measure));
+      REQUIRE(wisdom.has_wisdom(shape, FftwPlanning::Estimate));
+    }
+    wisdom.plan_async(shapes);
+    wisdom.wait();
+    REQUIRE(wisdom.planned_count() == 0);
+    REQUIRE(wisdom.cached_count() == shapes.size());
+  }
+
+  std::filesystem::remove(path);
+  forget_wisdom();
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <beat_tracker.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fftw3.h>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/beat_detector/beat_tracker_factory.hpp"
+#include "beat_detector/fftw_wisdom.hpp"
+
+// Beat tracker startup, cold and with the wisdom an earlier run cached.
+// "setup" builds the tracker, which plans its transforms: what the detector
+// reports as TrackerSetup. "first beat" goes on to feed it a click track,
+// as fast as hops are processed, until its first beat: the part of the
+// detector's time to first beat that planning and kernels can change. The
+// audio up to that beat ("audio") comes on top, the same either way.
+//
+// The first start with --fftw-planning measure also plans in the background
+// ("background planning"); later starts import its result instead.
+//
+// Run with: ./test_tracker_setup_benchmark "[!benchmark]"
+
+using namespace beatled::detector;
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+constexpr int RUNS = 15;
+constexpr double SAMPLE_RATE = 44100;
+constexpr double MAX_SECONDS = 30;
+
+double elapsed_us(SteadyClock::time_point start) {
+  return std::chrono::duration<double, std::micro>(SteadyClock::now() - start).count();
+}
+
+void forget_wisdom() {
+  auto lock = FftwWisdom::planner_lock();
+  fftw_forget_wisdom();
+}
+
+std::string temporary_wisdom_path() {
+  return (std::filesystem::temp_directory_path() /
+          ("test_tracker_setup_benchmark." + std::to_string(getpid())))
+      .string();
+}
+
+// 10 ms of 1 kHz every half second, from sample `offset`
+void fill_clicks(std::vector<double> &hop, std::size_t offset) {
+  const auto period = static_cast<std::size_t>(SAMPLE_RATE / 2);
+  const auto click = static_cast<std::size_t>(SAMPLE_RATE / 100);
+  for (std::size_t i = 0; i < hop.size(); i++) {
+    const std::size_t n = offset + i;
+    hop[i] = n % period < click ? 0.8 * std::sin(2 * M_PI * 1000 * n / SAMPLE_RATE) : 0.0;
+  }
+}
+
+struct Startup {
+  double setup_us = 0;
+  double first_beat_us = 0;
+  std::size_t hops = 0;
+};
+
+Startup start_tracker(std::size_t hop_size) {
+  const auto start = SteadyClock::now();
+  std::unique_ptr<btrack::BTrack> tracker;
+  {
+    auto lock = FftwWisdom::planner_lock();
+    tracker = make_beat_tracker<btrack::BTrack>(hop_size);
+  }
+  Startup startup;
+  startup.setup_us = elapsed_us(start);
+
+  bool beat = false;
+  tracker->set_sampling_rate(SAMPLE_RATE);
+  tracker->set_beat_callback([&](double, double) { beat = true; });
+  std::vector<double> hop(hop_size);
+  const auto max_hops = static_cast<std::size_t>(MAX_SECONDS * SAMPLE_RATE / hop_size);
+  while (!beat && startup.hops < max_hops) {
+    fill_clicks(hop, startup.hops * hop_size);
+    tracker->process_audio_frame(hop);
+    startup.hops++;
+  }
+  startup.first_beat_us = elapsed_us(start);
+
+  auto lock = FftwWisdom::planner_lock();
+  tracker.reset();
+  return startup;
+}
+
+// Median of RUNS startups, each prepared by `prepare`
+template <typename Prepare> Startup median_startup(std::size_t hop_size, Prepare &&prepare) {
+  std::vector<Startup> startups;
+  for (int run = 0; run < RUNS; run++) {
+    prepare();
+    startups.push_back(start_tracker(hop_size));
+  }
+  auto median = [&](auto member) {
+    std::sort(startups.begin(), startups.end(),
+              [&](const Startup &a, const Startup &b) { return a.*member < b.*member; });
+    return startups[RUNS / 2].*member;
+  };
+  Startup result;
+  result.setup_us = median(&Startup::setup_us);
+  result.first_beat_us = median(&Startup::first_beat_us);
+  result.hops = startups.front().hops;
+  return result;
+}
+
+void print_row(std::size_t hop_size, const char *wisdom, const Startup &startup) {
+  std::printf("%5zu  %-8s %10.1f %15.1f %10.0f\n", hop_size, wisdom, startup.setup_us,
+              startup.first_beat_us, 1000.0 * startup.hops * hop_size / SAMPLE_RATE);
+}
+
+} // namespace
+
+TEST_CASE("Tracker startup, cold and from cached wisdom", "[!benchmark][fftw]") {
+  spdlog::set_level(spdlog::level::warn);
+  const std::string path = temporary_wisdom_path();
+  std::printf("%5s  %-8s %10s %15s %10s\n", "hop", "wisdom", "setup us", "first beat us",
+              "audio ms");
+
+  // 512 at the capture rate, 256 decimated by 2
+  for (std::size_t hop_size : {std::size_t{512}, std::size_t{256}}) {
+    const auto shapes = tracker_fft_shapes<btrack::BTrack>(hop_size);
+
+    // Without a cache every start plans from nothing
+    const Startup cold = median_startup(hop_size, forget_wisdom);
+
+    // The first start with a cache measures in the background and saves it
+    forget_wisdom();
+    std::filesystem::remove(path);
+    uint64_t planning_us = 0;
+    {
+      FftwWisdom wisdom({path, FftwPlanning::Measure});
+      wisdom.plan_async(shapes);
+      wisdom.wait();
+      REQUIRE(wisdom.planned_count() == shapes.size());
+      planning_us = wisdom.planning_time_us();
+    }
+
+    // Later starts import it before the tracker is built
+    double import_us = 0;
+    const Startup cached = median_startup(hop_size, [&]() {
+      forget_wisdom();
+      FftwWisdom wisdom({path, FftwPlanning::Measure});
+      const auto start = SteadyClock::now();
+      REQUIRE(wisdom.import_wisdom());
+      import_us = elapsed_us(start);
+    });
+
+    print_row(hop_size, "none", cold);
+    print_row(hop_size, "cached", cached);
+    std::printf("       background planning %llu us, import %.1f us\n",
+                (unsigned long long)planning_us, import_us);
+  }
+
+  std::filesystem::remove(path);
+  forget_wisdom();
+}
@@ -0,0 +1,295 @@
+// Heap allocations on the UDP packet path. malloc is interposed (glibc) so
+// that every allocation made by a tracked thread is counted, whether it comes
+// from operator new, asio, fmt or the C library. Elsewhere the replaceable
+// operator new is hooked instead.
+//
+// Each test warms the path up first: free lists fill, asio caches its
+// handler memory, the client registers. After that, handling requests must
+// not touch the heap at all.
+
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <new>
+#include <poll.h>
+#include <thread>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/state_manager.hpp"
+#include "udp/buffer_pool.hpp"
+#include "udp/udp_buffer.hpp"
+#include "udp_server/udp_server.hpp"
+
+// UDPRequestHandler header is not in a public include dir, include directly.
+#include "../../src/server/udp_server/udp_request_handler.hpp"
+
+using namespace beatled::server;
+using asio::ip::udp;
+using beatled::core::StateManager;
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+thread_local bool tracked = false;
+
+void count_allocation() {
+  if (tracked) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) {
+  count_allocation();
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  count_allocation();
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  count_allocation();
+  return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  count_allocation();
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+  count_allocation();
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr ? 0 : ENOMEM;
+}
+}
+
+#else // !defined(__GLIBC__)
+
+void *operator new(std::size_t size) {
+  count_allocation();
+  if (void *ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+#endif // defined(__GLIBC__)
+
+namespace {
+
+// Allocations made by this thread while running `work`
+template <typename F> uint64_t allocations_during(F &&work) {
+  const uint64_t before = allocation_count.load();
+  tracked = true;
+  work();
+  tracked = false;
+  return allocation_count.load() - before;
+}
+
+template <typename T> UDPRequestBuffer make_request(const T &msg, const char *ip = "10.0.0.1") {
+  UDPRequestBuffer buf(udp::endpoint(asio::ip::make_address(ip), 9000));
+  std::memcpy(buf.data().data(), &msg, sizeof(msg));
+  buf.setSize(sizeof(msg));
+  return buf;
+}
+
+beatled_message_hello_request_t hello_request() {
+  beatled_message_hello_request_t hello{};
+  hello.base.type = BEATLED_MESSAGE_HELLO_REQUEST;
+  hello.version_major = BEATLED_PROTOCOL_VERSION_MAJOR;
+  hello.version_minor = BEATLED_PROTOCOL_VERSION_MINOR;
+  std::memcpy(hello.board_id, "E6614103E7A1B2C3", 16);
+  return hello;
+}
+
+beatled_message_time_request_t time_request(uint64_t orig_time) {
+  beatled_message_time_request_t request{};
+  request.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+  request.orig_time = htonll(orig_time);
+  return request;
+}
+
+beatled_message_tempo_request_t tempo_request() {
+  beatled_message_tempo_request_t request{};
+  request.base.type = BEATLED_MESSAGE_TEMPO_REQUEST;
+  request.owd_us_estimate = htonl(1500);
+  return request;
+}
+
+beatled_message_status_response_t status_response() {
+  beatled_message_status_response_t response{};
+  response.base.type = BEATLED_MESSAGE_STATUS_RESPONSE;
+  return response;
+}
+
+bool wait_readable(udp::socket &socket, int timeout_ms) {
+  pollfd fd{socket.native_handle(), POLLIN, 0};
+  return ::poll(&fd, 1, timeout_ms) == 1;
+}
+
+} // namespace
+
+TEST_CASE("The hook sees heap allocations", "[udp][allocations]") {
+  REQUIRE(allocations_during([]() { delete new std::vector<int>(1000); }) >= 2);
+}
+
+TEST_CASE("Request handling allocates nothing once warm", "[udp][allocations]") {
+  StateManager sm;
+  sm.update_tempo(120.0f, 1000);
+
+  std::vector<UDPRequestBuffer> requests;
+  requests.push_back(make_request(hello_request()));
+  requests.push_back(make_request(time_request(42)));
+  requests.push_back(make_request(tempo_request()));
+  requests.push_back(make_request(status_response()));
+  uint8_t unknown = 0xFF;
+  requests.push_back(make_request(unknown));
+  std::vector<DataBuffer::Ptr> responses(requests.size());
+
+  // Registers the client, fills this thread's free list
+  for (int i = 0; i < 10; i++) {
+    UDPRequestHandler::handle_batch(requests, responses, sm);
+    for (auto &response : responses) {
+      response.reset();
+    }
+  }
+  REQUIRE(sm.get_clients()->size() == 1);
+
+  const uint64_t heap_before = BufferPool::heap_count();
+  std::size_t replies = 0;
+  const uint64_t allocations = allocations_during([&]() {
+    for (int i = 0; i < 1000; i++) {
+      // HELLO again is a heartbeat
+      replies += UDPRequestHandler::handle_batch(requests, responses, sm);
+      for (auto &response : responses) {
+        response.reset();
+      }
+    }
+  });
+  REQUIRE(allocations == 0);
+  REQUIRE(replies == 4000);
+  REQUIRE(BufferPool::heap_count() == heap_before);
+  REQUIRE(sm.get_clients()->size() == 1);
+}
+
+TEST_CASE("Shared broadcast buffers come from the pool", "[udp][allocations]") {
+  // One buffer, referenced by a send per controller
+  std::vector<std::shared_ptr<DataBuffer>> sends;
+  sends.reserve(3);
+  auto dispatch = [&]() {
+    auto buffer = make_shared_buffer<NextBeatBuffer>(1000, 1, 1, 1);
+    for (int i = 0; i < 3; i++) {
+      sends.push_back(buffer);
+    }
+    sends.clear();
+  };
+  dispatch();
+
+  REQUIRE(allocations_during([&]() {
+            for (int i = 0; i < 1000; i++) {
+              dispatch();
+            }
+          }) == 0);
+  REQUIRE(make_shared_buffer<NextBeatBuffer>(1000, 1, 1, 1)->type() == BEATLED_MESSAGE_NEXT_BEAT);
+}
+
+TEST_CASE("UDPServer request path allocates nothing once warm", "[udp][allocations]") {
+  const std::size_t batch_size = GENERATE(1, 16);
+
+  asio::io_context io_context;
+  StateManager sm;
+  UDPServer server{"udp", io_context, {0, batch_size}, sm};
+  server.start();
+  std::thread server_thread([&]() { io_context.run(); });
+  const udp::endpoint endpoint{asio::ip::address_v4::loopback(), server.local_endpoint().port()};
+
+  // Count only what the server thread allocates
+  auto track_server = [&](bool track) {
+    std::promise<void> done;
+    asio::post(io_context, [&]() {
+      tracked = track;
+      done.set_value();
+    });
+    done.get_future().wait();
+  };
+
+  asio::io_context client_io;
+  udp::socket client{client_io, udp::endpoint(asio::ip::address_v4::loopback(), 0)};
+  beatled_message_hello_request_t hello = hello_request();
+  const auto tempo = tempo_request();
+  std::array<uint8_t, 64> reply;
+
+  // A window of requests in flight, then all the replies
+  auto exchange = [&](std::size_t rounds) {
+    std::size_t replies = 0;
+    for (std::size_t round = 0; round < rounds; round++) {
+      client.send_to(asio::buffer(&hello, sizeof(hello)), endpoint);
+      for (uint64_t i = 0; i < 8; i++) {
+        const auto request = time_request(round * 8 + i);
+        client.send_to(asio::buffer(&request, sizeof(request)), endpoint);
+      }
+      client.send_to(asio::buffer(&tempo, sizeof(tempo)), endpoint);
+      for (int i = 0; i < 10 && wait_readable(client, 1000); i++) {
+        client.receive(asio::buffer(reply));
+        replies++;
+      }
+    }
+    return replies;
+  };
+
+  const std::size_t warm_up_replies = exchange(50);
+
+  const uint64_t before = allocation_count.load();
+  track_server(true);
+  const std::size_t replies = exchange(200);
+  track_server(false);
+  const uint64_t allocations = allocation_count.load() - before;
+
+  server.stop();
+  io_context.stop();
+  server_thread.join();
+
+  REQUIRE(warm_up_replies == 500);
+  REQUIRE(replies == 2000);
+  REQUIRE(allocations == 0);
+}
@@ -0,0 +1,178 @@
+#include <arpa/inet.h>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdio>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/state_manager.hpp"
+#include "udp_server/udp_server.hpp"
+
+// UDP request throughput over loopback, one async receive/send per datagram
+// (--udp-batch 1) against recvmmsg/sendmmsg batches (--udp-batch 32), and
+// over one to four SO_REUSEPORT shards (--udp-shards) with a pool thread each.
+//
+// Each client keeps a window of requests in flight: it sends the whole
+// window, then waits for all the replies. With one request in flight batching
+// can't help (nothing queues up behind it); with a swarm of controllers
+// requesting at once it saves a system call and a reactor round trip per
+// datagram. Every client has its own loopback address (127.0.0.2, ...) and is
+// registered, as a real controller would be, so TEMPO requests go through
+// the client lookup and QoS update. Logging is turned down to warnings so
+// the I/O path dominates. Shards only scale with free cores to run them.
+//
+// Run with: ./test_udp_benchmark "[!benchmark]"
+
+using namespace beatled::server;
+using asio::ip::udp;
+using beatled::core::ClientStatus;
+using beatled::core::Clock;
+using beatled::core::StateManager;
+
+namespace {
+
+// A multiple of every window
+constexpr std::size_t REQUESTS_PER_CLIENT = 320 * 64;
+
+struct Result {
+  double packets_per_second;
+  std::size_t lost;
+};
+
+struct Load {
+  std::size_t clients;
+  std::size_t window;
+};
+
+asio::ip::address_v4 client_address(std::size_t c) {
+  return asio::ip::address_v4{static_cast<asio::ip::address_v4::uint_type>(0x7f000002 + c)};
+}
+
+// Sends REQUESTS_PER_CLIENT requests of `type` (TIME or TEMPO), `window` at a
+// time, and counts the replies. Lost datagrams (a full receive buffer) end a
+// window on timeout.
+std::size_t run_client(const udp::endpoint &server, std::size_t c, uint8_t type,
+                       std::size_t window) {
+  asio::io_context io_context;
+  udp::socket socket{io_context, udp::endpoint(client_address(c), 0)};
+
+  beatled_message_time_request_t time_request{};
+  time_request.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+  beatled_message_tempo_request_t tempo_request{};
+  tempo_request.base.type = BEATLED_MESSAGE_TEMPO_REQUEST;
+  tempo_request.owd_us_estimate = htonl(1500);
+  std::array<uint8_t, 64> response{};
+
+  std::size_t replies = 0;
+  for (std::size_t sent = 0; sent < REQUESTS_PER_CLIENT; sent += window) {
+    for (std::size_t i = 0; i < window; i++) {
+      if (type == BEATLED_MESSAGE_TIME_REQUEST) {
+        time_request.orig_time = htonll(sent + i);
+        socket.send_to(asio::buffer(&time_request, sizeof(time_request)), server);
+      } else {
+        tempo_request.qos.uptime_us = htonll(sent + i);
+        socket.send_to(asio::buffer(&tempo_request, sizeof(tempo_request)), server);
+      }
+    }
+    for (std::size_t i = 0; i < window; i++) {
+      // asio's blocking receive ignores SO_RCVTIMEO
+      pollfd fd{socket.native_handle(), POLLIN, 0};
+      if (::poll(&fd, 1, 200) != 1) {
+        break;
+      }
+      socket.receive(asio::buffer(response));
+      replies++;
+    }
+  }
+  return replies;
+}
+
+Result measure(std::size_t batch_size, std::size_t shards, uint8_t type, const Load &load) {
+  asio::io_context io_context;
+  StateManager state_manager;
+  state_manager.update_tempo(120.0f, Clock::wall_time_us_64());
+  for (std::size_t c = 0; c < load.clients; c++) {
+    ClientStatus::board_id_t board_id{};
+    std::snprintf(board_id.data(), board_id.size(), "bench%02zu", c);
+    auto cs = std::make_shared<ClientStatus>(board_id, client_address(c));
+    cs->last_status_time = Clock::wall_time_us_64();
+    state_manager.register_client(cs);
+  }
+
+  UDPServer server{"udp", io_context, {0, batch_size, shards}, state_manager};
+  server.start();
+  std::vector<std::thread> server_threads;
+  for (std::size_t i = 0; i < shards; i++) {
+    server_threads.emplace_back([&]() { io_context.run(); });
+  }
+  const udp::endpoint endpoint{asio::ip::address_v4::loopback(), server.local_endpoint().port()};
+
+  std::vector<std::size_t> replies(load.clients);
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> client_threads;
+  for (std::size_t c = 0; c < load.clients; c++) {
+    client_threads.emplace_back(
+        [&, c]() { replies[c] = run_client(endpoint, c, type, load.window); });
+  }
+  for (auto &thread : client_threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  server.stop();
+  io_context.stop();
+  for (auto &thread : server_threads) {
+    thread.join();
+  }
+
+  std::size_t total = 0;
+  for (auto r : replies) {
+    total += r;
+  }
+  return {static_cast<double>(total) / elapsed.count(),
+          load.clients * REQUESTS_PER_CLIENT - total};
+}
+
+} // namespace
+
+TEST_CASE("UDP request throughput", "[!benchmark][udp]") {
+  const auto level = spdlog::get_level();
+  spdlog::set_level(spdlog::level::warn);
+
+  for (const Load load : {Load{1, 1}, Load{1, 64}, Load{4, 64}}) {
+    for (const std::size_t batch_size : {1u, 32u}) {
+      const Result result = measure(batch_size, 1, BEATLED_MESSAGE_TIME_REQUEST, load);
+      std::printf("%zu client(s), %2zu in flight, batch %2zu: %9.0f packets/s (%zu lost)\n",
+                  load.clients, load.window, batch_size, result.packets_per_second, result.lost);
+      CHECK(result.packets_per_second > 0);
+    }
+  }
+
+  spdlog::set_level(level);
+}
+
+TEST_CASE("UDP request throughput across shards", "[!benchmark][udp]") {
+  const auto level = spdlog::get_level();
+  spdlog::set_level(spdlog::level::warn);
+
+  std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+  const Load load{16, 64};
+  for (const uint8_t type : {BEATLED_MESSAGE_TIME_REQUEST, BEATLED_MESSAGE_TEMPO_REQUEST}) {
+    for (const std::size_t batch_size : {1u, 32u}) {
+      for (const std::size_t shards : {1u, 2u, 4u}) {
+        const Result result = measure(batch_size, shards, type, load);
+        std::printf("%s, %zu clients, batch %2zu, %zu shard(s): %9.0f packets/s (%zu lost)\n",
+                    type == BEATLED_MESSAGE_TIME_REQUEST ? "TIME " : "TEMPO", load.clients,
+                    batch_size, shards, result.packets_per_second, result.lost);
+        CHECK(result.packets_per_second > 0);
+      }
+    }
+  }
+
+  spdlog::set_level(level);
+}
@@ -0,0 +1,182 @@
+// Per-client telemetry under concurrent writers and readers, the way a
+// server with --thread-pool-size > 1 sees it: network threads decode
+// TEMPO_REQUEST / STATUS_RESPONSE QoS blocks onto the same ClientStatus
+// while HTTP threads serialize it (/api/devices, /api/qos) and the
+// broadcaster reads its endpoint.
+//
+// Every QoS block a writer sends is derived from one counter, so a reader
+// that sees fields from two different blocks has caught a torn write. Run
+// it in a -DBEATLED_SANITIZER=thread build to check for data races too.
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/state_manager.hpp"
+#include "udp/udp_buffer.hpp"
+
+// UDPRequestHandler header is not in a public include dir, include directly.
+#include "../../src/server/udp_server/udp_request_handler.hpp"
+
+using namespace beatled::server;
+using asio::ip::udp;
+using beatled::core::ClientStatus;
+using beatled::core::Clock;
+using beatled::core::StateManager;
+
+namespace {
+
+constexpr int WRITERS = 4;
+constexpr int READERS = 4;
+constexpr uint32_t REPORTS_PER_WRITER = 20000;
+constexpr uint16_t BASE_PORT = 9000;
+
+const auto client_address = asio::ip::make_address("10.0.0.1");
+
+// A QoS block whose every field is a function of `k`
+beatled_qos_block_t qos_block(uint64_t k) {
+  beatled_qos_block_t qos{};
+  const int64_t offset = -static_cast<int64_t>(k);
+  uint64_t offset_bits;
+  std::memcpy(&offset_bits, &offset, sizeof(offset_bits));
+  qos.current_offset_us = static_cast<int64_t>(htonll(offset_bits));
+  qos.uptime_us = htonll(k);
+  qos.median_rtt_us = htonl(static_cast<uint32_t>(k));
+  qos.next_beat_gap_total = htonl(static_cast<uint32_t>(k));
+  qos.intercore_drop_total = htonl(static_cast<uint32_t>(k));
+  qos.time_sync_outlier_total = htonl(static_cast<uint32_t>(k));
+  qos.valid_sample_count = htons(static_cast<uint16_t>(k));
+  qos.last_applied_program_seq = htons(static_cast<uint16_t>(k));
+  return qos;
+}
+
+bool consistent(const ClientStatus::QosSnapshot &qos) {
+  if (!qos.valid) {
+    return true;
+  }
+  const uint64_t k = qos.uptime_us;
+  return qos.current_offset_us == -static_cast<int64_t>(k) && qos.median_rtt_us == k &&
+         qos.next_beat_gap_total == k && qos.intercore_drop_total == k &&
+         qos.time_sync_outlier_total == k && qos.valid_sample_count == static_cast<uint16_t>(k) &&
+         qos.last_applied_program_seq == static_cast<uint16_t>(k);
+}
+
+bool consistent(const beatled::core::json &device) {
+  if (device["qos"].is_null()) {
+    return true;
+  }
+  const auto &qos = device["qos"];
+  const uint64_t k = qos["uptime_us"];
+  return qos["current_offset_us"] == -static_cast<int64_t>(k) && qos["median_rtt_us"] == k &&
+         qos["next_beat_gap_total"] == k && qos["intercore_drop_total"] == k &&
+         qos["time_sync_outlier_total"] == k &&
+         qos["valid_sample_count"] == static_cast<uint16_t>(k) &&
+         qos["last_applied_program_seq"] == static_cast<uint16_t>(k);
+}
+
+// One network thread: TEMPO requests and status replies from the client,
+// each from its own source port so the endpoint keeps moving too
+void writer(StateManager &sm, int id) {
+  const udp::endpoint source{client_address, static_cast<uint16_t>(BASE_PORT + id)};
+  for (uint32_t i = 0; i < REPORTS_PER_WRITER; i++) {
+    const uint64_t k = i * WRITERS + id + 1;
+    UDPRequestBuffer request{source};
+    if (i % 2 == 0) {
+      beatled_message_tempo_request_t tempo{};
+      tempo.base.type = BEATLED_MESSAGE_TEMPO_REQUEST;
+      tempo.owd_us_estimate = htonl(static_cast<uint32_t>(k));
+      tempo.qos = qos_block(k);
+      std::memcpy(request.data().data(), &tempo, sizeof(tempo));
+      request.setSize(sizeof(tempo));
+    } else {
+      beatled_message_status_response_t status{};
+      status.base.type = BEATLED_MESSAGE_STATUS_RESPONSE;
+      status.echo_server_send_time_us = htonll(Clock::wall_time_us_64() - k);
+      status.qos = qos_block(k);
+      std::memcpy(request.data().data(), &status, sizeof(status));
+      request.setSize(sizeof(status));
+    }
+    UDPRequestHandler{&request, sm}.response();
+  }
+}
+
+} // namespace
+
+TEST_CASE("Client QoS survives concurrent writers and readers", "[udp][qos][stress]") {
+  // Creates spdlog's registry here rather than racing to it from the writers
+  spdlog::set_level(spdlog::level::warn);
+
+  StateManager sm;
+  sm.update_tempo(120.0f, 1000);
+  ClientStatus::board_id_t board_id{};
+  board_id[0] = 'S';
+  auto cs = std::make_shared<ClientStatus>(board_id, client_address);
+  cs->last_status_time = Clock::wall_time_us_64();
+  cs->set_endpoint(udp::endpoint{client_address, BASE_PORT});
+  sm.register_client(cs);
+
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> torn{0};
+  std::atomic<uint64_t> bad_endpoints{0};
+
+  auto reader = [&](int id) {
+    while (!done.load(std::memory_order_acquire)) {
+      // Hold the snapshot: a temporary would die before the loop body runs
+      const auto clients = sm.get_clients();
+      for (const auto &client : *clients) {
+        if (id % 2 == 0) {
+          // /api/devices
+          const beatled::core::json device = *client;
+          torn += consistent(device) ? 0 : 1;
+        } else {
+          // /api/qos and the broadcaster
+          const auto qos = client->latest_qos();
+          int64_t sync_error_us;
+          beatled::core::qos_sync_error_us(qos, sync_error_us);
+          torn += consistent(qos) ? 0 : 1;
+          const auto endpoint = client->endpoint();
+          if (endpoint.address() != client_address || endpoint.port() < BASE_PORT ||
+              endpoint.port() >= BASE_PORT + WRITERS) {
+            bad_endpoints++;
+          }
+        }
+        reads++;
+      }
+    }
+  };
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < READERS; i++) {
+    readers.emplace_back(reader, i);
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < WRITERS; i++) {
+    writers.emplace_back(writer, std::ref(sm), i);
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+
+  REQUIRE(reads > 0);
+  REQUIRE(torn == 0);
+  REQUIRE(bad_endpoints == 0);
+
+  // Every write landed whole: the last one left is one writer's final report
+  const auto qos = cs->latest_qos();
+  REQUIRE(qos.valid);
+  REQUIRE(consistent(qos));
+  REQUIRE(qos.uptime_us > (REPORTS_PER_WRITER - 1) * WRITERS);
+  REQUIRE(cs->owd_us > 0);
+  REQUIRE(sm.get_clients()->size() == 1);
+}
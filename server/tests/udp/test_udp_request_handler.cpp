@@ -1,6 +1,7 @@
 #include <arpa/inet.h>
 #include <catch2/catch_test_macros.hpp>
 #include <cstring>
+#include <vector>
 
 #include "beatled/network.h"
 #include "beatled/protocol.h"
@@ -174,6 +175,44 @@ TEST_CASE("UDPRequestHandler time request", "[udp][handler]") {
     auto resp = handler.response();
     REQUIRE(resp->type() == BEATLED_MESSAGE_ERROR);
   }
+
+  SECTION("Time burst request echoes its index with the timestamps") {
+    beatled_message_time_burst_request_t burst_req{};
+    burst_req.base.type = BEATLED_MESSAGE_TIME_BURST_REQUEST;
+    burst_req.orig_time = htonll(5000000ULL);
+    burst_req.index = 6;
+
+    auto buf = make_request(&burst_req, sizeof(burst_req));
+    buf.set_receive_time_us(7000000ULL);
+    UDPRequestHandler handler(&buf, sm);
+
+    auto resp = handler.response();
+    REQUIRE(resp->type() == BEATLED_MESSAGE_TIME_BURST_RESPONSE);
+    REQUIRE(resp->size() == sizeof(beatled_message_time_burst_response_t));
+
+    beatled_message_time_burst_response_t msg;
+    std::memcpy(&msg, resp->data().data(), sizeof(msg));
+    REQUIRE(ntohll(msg.orig_time) == 5000000ULL);
+    REQUIRE(ntohll(msg.recv_time) == 7000000ULL);
+    REQUIRE(msg.index == 6);
+
+    // The server stamps xmit_time at the send, as for TIME_RESPONSE
+    resp->set_transmit_time(8000000ULL);
+    std::memcpy(&msg, resp->data().data(), sizeof(msg));
+    REQUIRE(ntohll(msg.xmit_time) == 8000000ULL);
+    REQUIRE(msg.index == 6);
+  }
+
+  SECTION("Undersized time burst request returns error") {
+    beatled_message_time_request_t time_req{};
+    time_req.base.type = BEATLED_MESSAGE_TIME_BURST_REQUEST;
+
+    auto buf = make_request(&time_req, sizeof(time_req));
+    UDPRequestHandler handler(&buf, sm);
+
+    auto resp = handler.response();
+    REQUIRE(resp->type() == BEATLED_MESSAGE_ERROR);
+  }
 }
 
 TEST_CASE("UDPRequestHandler tempo request", "[udp][handler]") {
@@ -215,6 +254,8 @@ TEST_CASE("UDPRequestHandler tempo request", "[udp][handler]") {
     resp.qos.next_beat_gap_total = htonl(9);
     resp.qos.intercore_drop_total = htonl(3);
     resp.qos.time_sync_outlier_total = htonl(13);
+    resp.qos.rx_slab_exhausted_total = htonl(4);
+    resp.qos.rx_slab_high_water = htons(9);
     resp.qos.valid_sample_count = htons(6);
     resp.qos.last_applied_program_seq = htons(99);
 
@@ -225,14 +266,16 @@ TEST_CASE("UDPRequestHandler tempo request", "[udp][handler]") {
 
     auto stored = sm.client_status(asio::ip::make_address("10.0.0.1"));
     REQUIRE(stored != nullptr);
-    REQUIRE(stored->latest_qos.valid);
-    REQUIRE(stored->latest_qos.median_rtt_us == 7777u);
-    REQUIRE(stored->latest_qos.next_beat_gap_total == 9u);
-    REQUIRE(stored->latest_qos.intercore_drop_total == 3u);
-    REQUIRE(stored->latest_qos.time_sync_outlier_total == 13u);
-    REQUIRE(stored->latest_qos.valid_sample_count == 6u);
-    REQUIRE(stored->latest_qos.last_applied_program_seq == 99u);
-    REQUIRE(stored->latest_qos.last_rtt_us > 0u);
+    REQUIRE(stored->latest_qos().valid);
+    REQUIRE(stored->latest_qos().median_rtt_us == 7777u);
+    REQUIRE(stored->latest_qos().next_beat_gap_total == 9u);
+    REQUIRE(stored->latest_qos().intercore_drop_total == 3u);
+    REQUIRE(stored->latest_qos().time_sync_outlier_total == 13u);
+    REQUIRE(stored->latest_qos().rx_slab_exhausted_total == 4u);
+    REQUIRE(stored->latest_qos().rx_slab_high_water == 9u);
+    REQUIRE(stored->latest_qos().valid_sample_count == 6u);
+    REQUIRE(stored->latest_qos().last_applied_program_seq == 99u);
+    REQUIRE(stored->latest_qos().last_rtt_us > 0u);
   }
 
   SECTION("v4 qos block decodes onto ClientStatus") {
@@ -268,7 +311,7 @@ TEST_CASE("UDPRequestHandler tempo request", "[udp][handler]") {
 
     auto stored = sm.client_status(asio::ip::make_address("10.0.0.1"));
     REQUIRE(stored != nullptr);
-    const auto &qos = stored->latest_qos;
+    const auto qos = stored->latest_qos();
     REQUIRE(qos.valid);
     REQUIRE(qos.current_offset_us == kOffsetUs);
     REQUIRE(qos.uptime_us == kUptimeUs);
@@ -281,3 +324,29 @@ TEST_CASE("UDPRequestHandler tempo request", "[udp][handler]") {
     REQUIRE(qos.server_received_at_us > 0u);
   }
 }
+
+TEST_CASE("UDPRequestHandler batch", "[udp][handler]") {
+  StateManager sm;
+
+  beatled_message_time_request_t time_req{};
+  time_req.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+  time_req.orig_time = htonll(1234);
+  beatled_message_status_response_t status{};
+  status.base.type = BEATLED_MESSAGE_STATUS_RESPONSE;
+  uint8_t bad_type = 0xFF;
+
+  std::vector<UDPRequestBuffer> requests;
+  requests.push_back(make_request(&time_req, sizeof(time_req)));
+  requests.push_back(make_request(&status, sizeof(status)));
+  requests.push_back(make_request(&bad_type, 1));
+  std::vector<DataBuffer::Ptr> responses(requests.size());
+
+  // One reply per request, in order, and none for the terminal STATUS_RESPONSE
+  REQUIRE(UDPRequestHandler::handle_batch(requests, responses, sm) == 2);
+  REQUIRE(responses[0]->type() == BEATLED_MESSAGE_TIME_RESPONSE);
+  const auto *msg =
+      reinterpret_cast<const beatled_message_time_response_t *>(&responses[0]->data());
+  REQUIRE(ntohll(msg->orig_time) == 1234);
+  REQUIRE(responses[1] == nullptr);
+  REQUIRE(responses[2]->type() == BEATLED_MESSAGE_ERROR);
+}
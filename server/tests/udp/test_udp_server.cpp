@@ -0,0 +1,164 @@
+#include <arpa/inet.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstring>
+#include <poll.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/state_manager.hpp"
+#include "udp_server/udp_server.hpp"
+
+using namespace beatled::server;
+using asio::ip::udp;
+using beatled::core::StateManager;
+
+namespace {
+
+// A UDPServer on an ephemeral loopback port, run by a thread per shard
+class LoopbackServer {
+public:
+  explicit LoopbackServer(std::size_t batch_size, std::size_t shards = 1)
+      : server_{"udp", io_context_, {0, batch_size, shards}, state_manager_} {
+    server_.start();
+    for (std::size_t i = 0; i < shards; i++) {
+      threads_.emplace_back([this]() { io_context_.run(); });
+    }
+  }
+
+  ~LoopbackServer() {
+    server_.stop();
+    io_context_.stop();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  std::size_t shard_count() const { return server_.shard_count(); }
+
+  udp::endpoint endpoint() const {
+    return {asio::ip::address_v4::loopback(), server_.local_endpoint().port()};
+  }
+
+  StateManager &state_manager() { return state_manager_; }
+
+private:
+  asio::io_context io_context_;
+  StateManager state_manager_;
+  UDPServer server_;
+  std::vector<std::thread> threads_;
+};
+
+udp::socket make_client(asio::io_context &io_context) {
+  return udp::socket{io_context, udp::endpoint(asio::ip::address_v4::loopback(), 0)};
+}
+
+// asio's blocking receive ignores SO_RCVTIMEO, so wait for a reply with poll
+bool wait_readable(udp::socket &socket, int timeout_ms) {
+  pollfd fd{socket.native_handle(), POLLIN, 0};
+  return ::poll(&fd, 1, timeout_ms) == 1;
+}
+
+void send_time_request(udp::socket &socket, const udp::endpoint &server, uint64_t orig_time) {
+  beatled_message_time_request_t request{};
+  request.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+  request.orig_time = htonll(orig_time);
+  socket.send_to(asio::buffer(&request, sizeof(request)), server);
+}
+
+// Reads TIME responses until none comes for a second; returns their orig_time
+std::set<uint64_t> receive_time_responses(udp::socket &socket, std::size_t expected) {
+  std::set<uint64_t> orig_times;
+  while (orig_times.size() < expected && wait_readable(socket, 1000)) {
+    beatled_message_time_response_t response{};
+    const std::size_t size = socket.receive(asio::buffer(&response, sizeof(response)));
+    if (size == sizeof(response) && response.base.type == BEATLED_MESSAGE_TIME_RESPONSE) {
+      orig_times.insert(ntohll(response.orig_time));
+    }
+  }
+  return orig_times;
+}
+
+} // namespace
+
+TEST_CASE("UDPServer answers every request of a burst", "[udp][server]") {
+  const std::size_t batch_size = GENERATE(1, 16);
+  LoopbackServer server(batch_size);
+
+  // Several controllers at once, so batches mix endpoints
+  constexpr std::size_t CLIENTS = 3;
+  constexpr std::size_t REQUESTS = 50;
+  asio::io_context io_context;
+  std::vector<udp::socket> clients;
+  for (std::size_t c = 0; c < CLIENTS; c++) {
+    clients.push_back(make_client(io_context));
+  }
+
+  for (std::size_t i = 0; i < REQUESTS; i++) {
+    for (std::size_t c = 0; c < CLIENTS; c++) {
+      send_time_request(clients[c], server.endpoint(), c * 1000 + i);
+    }
+  }
+
+  for (std::size_t c = 0; c < CLIENTS; c++) {
+    const auto orig_times = receive_time_responses(clients[c], REQUESTS);
+    REQUIRE(orig_times.size() == REQUESTS);
+    REQUIRE(*orig_times.begin() == c * 1000);
+    REQUIRE(*orig_times.rbegin() == c * 1000 + REQUESTS - 1);
+  }
+}
+
+TEST_CASE("UDPServer batches skip messages that need no reply", "[udp][server]") {
+  LoopbackServer server(16);
+  asio::io_context io_context;
+  udp::socket client = make_client(io_context);
+
+  // STATUS_RESPONSE is terminal: only the TIME requests around it are answered
+  beatled_message_status_response_t status{};
+  status.base.type = BEATLED_MESSAGE_STATUS_RESPONSE;
+  send_time_request(client, server.endpoint(), 1);
+  client.send_to(asio::buffer(&status, sizeof(status)), server.endpoint());
+  send_time_request(client, server.endpoint(), 2);
+
+  REQUIRE(receive_time_responses(client, 3) == std::set<uint64_t>{1, 2});
+}
+
+TEST_CASE("UDPServer shards answer every controller on one port", "[udp][server]") {
+  const std::size_t batch_size = GENERATE(1, 16);
+  LoopbackServer server(batch_size, 4);
+  REQUIRE(server.shard_count() == 4);
+
+  // Enough source ports that the kernel's hash lands on every shard
+  constexpr std::size_t CLIENTS = 16;
+  constexpr std::size_t REQUESTS = 50;
+  // Requests in flight per client: the hash can put most clients on one
+  // shard, whose receive buffer must hold all of theirs
+  constexpr std::size_t WINDOW = 5;
+  asio::io_context io_context;
+  std::vector<udp::socket> clients;
+  for (std::size_t c = 0; c < CLIENTS; c++) {
+    clients.push_back(make_client(io_context));
+  }
+
+  std::vector<std::set<uint64_t>> received(CLIENTS);
+  for (std::size_t start = 0; start < REQUESTS; start += WINDOW) {
+    for (std::size_t i = start; i < start + WINDOW; i++) {
+      for (std::size_t c = 0; c < CLIENTS; c++) {
+        send_time_request(clients[c], server.endpoint(), c * 1000 + i);
+      }
+    }
+    for (std::size_t c = 0; c < CLIENTS; c++) {
+      received[c].merge(receive_time_responses(clients[c], WINDOW));
+    }
+  }
+
+  for (std::size_t c = 0; c < CLIENTS; c++) {
+    const auto &orig_times = received[c];
+    REQUIRE(orig_times.size() == REQUESTS);
+    REQUIRE(*orig_times.begin() == c * 1000);
+    REQUIRE(*orig_times.rbegin() == c * 1000 + REQUESTS - 1);
+  }
+}
@@ -0,0 +1,120 @@
+// TIME_REQUEST receive times from the kernel versus from the handler. A
+// request that waits on the server's socket (a busy pool, a backlog of
+// other controllers) looks like one-way network delay when the server
+// reads its clock in the handler, which skews the controller's offset by
+// half the wait. The kernel's receive timestamp doesn't include the wait.
+//
+// Client and server share this host's monotonic clock, so the true offset
+// is 0 and whatever the NTP formula reports is error. The spread is the
+// interquartile range, which a test thread preempted now and then doesn't
+// throw off the way it does a standard deviation.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <poll.h>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "beatled/network.h"
+#include "beatled/protocol.h"
+#include "core/clock.hpp"
+#include "core/state_manager.hpp"
+#include "udp_server/udp_server.hpp"
+
+using namespace beatled::server;
+using asio::ip::udp;
+using beatled::core::Clock;
+using beatled::core::StateManager;
+
+namespace {
+
+constexpr int ROUNDS = 60;
+// Longest a request waits on the socket before the server gets to it
+constexpr int MAX_QUEUE_US = 1000;
+
+struct OffsetStats {
+  double median_us;
+  double spread_us;
+};
+
+OffsetStats stats(std::vector<double> offsets) {
+  std::sort(offsets.begin(), offsets.end());
+  const auto quantile = [&offsets](double q) {
+    return offsets[static_cast<std::size_t>(q * (offsets.size() - 1))];
+  };
+  return {quantile(0.5), quantile(0.75) - quantile(0.25)};
+}
+
+// Runs the server on this thread only once each request has been queued for
+// a random while, and computes the offset the controller would from every
+// reply
+OffsetStats measure_offsets(std::size_t batch_size, bool kernel_timestamps) {
+  asio::io_context io_context;
+  StateManager state_manager;
+  UDPServer server{"udp", io_context, {0, batch_size, 1, kernel_timestamps}, state_manager};
+  server.start();
+  const udp::endpoint server_endpoint{asio::ip::address_v4::loopback(),
+                                      server.local_endpoint().port()};
+
+  udp::socket client{io_context, udp::endpoint(asio::ip::address_v4::loopback(), 0)};
+  std::mt19937 random{42};
+  std::uniform_int_distribution<int> queue_us{0, MAX_QUEUE_US};
+
+  std::vector<double> offsets;
+  for (int i = 0; i < ROUNDS; i++) {
+    beatled_message_time_request_t request{};
+    request.base.type = BEATLED_MESSAGE_TIME_REQUEST;
+    const uint64_t t1 = Clock::time_us_64();
+    request.orig_time = htonll(t1);
+    client.send_to(asio::buffer(&request, sizeof(request)), server_endpoint);
+
+    std::this_thread::sleep_for(std::chrono::microseconds(queue_us(random)));
+    io_context.poll();
+
+    pollfd fd{client.native_handle(), POLLIN, 0};
+    REQUIRE(::poll(&fd, 1, 1000) == 1);
+    beatled_message_time_response_t response{};
+    REQUIRE(client.receive(asio::buffer(&response, sizeof(response))) == sizeof(response));
+    const uint64_t t4 = Clock::time_us_64();
+
+    REQUIRE(ntohll(response.orig_time) == t1);
+    const uint64_t t2 = ntohll(response.recv_time);
+    const uint64_t t3 = ntohll(response.xmit_time);
+    REQUIRE(t1 <= t2);
+    REQUIRE(t2 <= t3);
+    REQUIRE(t3 <= t4);
+    offsets.push_back((static_cast<double>(t2) - t1 + static_cast<double>(t3) - t4) / 2);
+  }
+
+  server.stop();
+  return stats(offsets);
+}
+
+} // namespace
+
+TEST_CASE("Kernel receive timestamps take queueing out of the clock offset", "[udp][time]") {
+  spdlog::set_level(spdlog::level::warn);
+  const std::size_t batch_size = GENERATE(1, 16);
+
+  const OffsetStats handler = measure_offsets(batch_size, false);
+  const OffsetStats kernel = measure_offsets(batch_size, true);
+  INFO("handler clock: median " << handler.median_us << " us, spread " << handler.spread_us
+                                 << " us");
+  INFO("kernel stamps: median " << kernel.median_us << " us, spread " << kernel.spread_us
+                                << " us");
+
+  // The handler's receive time is late by the whole wait, so the offset is
+  // off by half of it: ~MAX_QUEUE_US / 4, spread as widely as the wait
+  REQUIRE(handler.median_us > MAX_QUEUE_US / 8);
+  REQUIRE(handler.spread_us > MAX_QUEUE_US / 8);
+
+  REQUIRE(std::abs(kernel.median_us) < handler.median_us / 4);
+  REQUIRE(kernel.spread_us < handler.spread_us / 4);
+}